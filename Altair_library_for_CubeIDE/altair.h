@@ -2,12 +2,23 @@
 #define ALTAIR_H
 
 #include "can_lib.h"
+#include "can_mdd.h"
 #include "encoder.h"
 #include "gpio_lib.h"
+#include "gpio_wave.h"
 #include "kinematics.h"
 #include "motor_driver.h"
+#include "motor_output.h"
+#include "msg_schema.h"
 #include "pid.h"
+#include "pid_autotune.h"
+#include "rate_executive.h"
+#include "safety_monitor.h"
 #include "serial_lib.h"
+#include "servo_group.h"
+#include "snapshot.h"
+#include "stepper.h"
+#include "timebase.h"
 #include "usart_lib.h"
 
 #endif /* ALTAIR_H */
@@ -1,9 +1,14 @@
 #include "can_lib.h"
+#include "timebase.h"
+#include <string.h>
 
 // 受信データの実体（外部から参照できるようにする）
 CanRxData g_can1_rx_data = {0};
 CanRxData g_can2_rx_data = {0};
 
+static volatile CanRxHook s_can1_rx_hook = NULL;
+static volatile CanRxHook s_can2_rx_hook = NULL;
+
 CanInitConfig Can_DefaultInitConfig(CAN_HandleTypeDef *hcan) {
     CanInitConfig config;
 
@@ -24,6 +29,7 @@ HAL_StatusTypeDef Can_Init(CAN_HandleTypeDef *hcan, const CanInitConfig *config)
     CAN_FilterTypeDef filter;
     CanInitConfig local_config;
 
+    Timebase_Begin();
     if (config == NULL) {
         local_config = Can_DefaultInitConfig(hcan);
         config = &local_config;
@@ -44,45 +50,214 @@ HAL_StatusTypeDef Can_Init(CAN_HandleTypeDef *hcan, const CanInitConfig *config)
     if (HAL_CAN_ConfigFilter(hcan, &filter) != HAL_OK) return HAL_ERROR;
     if (HAL_CAN_Start(hcan) != HAL_OK) return HAL_ERROR;
 
-    // 受信割り込み（FIFO0メッセージ待機）を有効化
-    if (HAL_CAN_ActivateNotification(hcan, CAN_IT_RX_FIFO0_MSG_PENDING) != HAL_OK) return HAL_ERROR;
+    // 受信割り込み（FIFO0メッセージ待機）と送信完了割り込みを有効化
+    if (HAL_CAN_ActivateNotification(hcan, CAN_IT_RX_FIFO0_MSG_PENDING | CAN_IT_TX_MAILBOX_EMPTY) != HAL_OK) return HAL_ERROR;
 
     return HAL_OK;
 }
 
-// 送信関数（空きメールボックス待機・タイムアウト付き）
-HAL_StatusTypeDef Can_Transmit(CAN_HandleTypeDef *hcan, uint32_t std_id, uint8_t *pData, uint8_t size) {
+// 送信キューの要素
+typedef struct {
+    uint32_t std_id;
+    uint8_t  data[8];
+    uint8_t  dlc;
+    uint32_t enqueue_us;     // キュー投入時刻 [us]（遅延統計用、timebase.h）
+} CanTxFrame;
+
+// CANインスタンスごとの送信キュー
+// entries は std_id の降順に並べ、末尾が最優先（IDが最小）となる
+typedef struct {
+    CanTxFrame entries[CAN_TX_QUEUE_SIZE];
+    uint8_t    count;
+    CanTxStats stats;
+} CanTxQueue;
+
+static CanTxQueue s_can1_tx_queue;
+static CanTxQueue s_can2_tx_queue;
+
+static CanTxQueue *Can_GetTxQueue(CAN_HandleTypeDef *hcan)
+{
+    if (hcan->Instance == CAN1) {
+        return &s_can1_tx_queue;
+    } else if (hcan->Instance == CAN2) {
+        return &s_can2_tx_queue;
+    }
+    return NULL;
+}
+
+// 空いているメールボックスへキュー先頭（最優先）から詰める
+// 割り込み禁止区間内から呼ぶこと
+static void Can_PumpTxQueue(CAN_HandleTypeDef *hcan, CanTxQueue *queue)
+{
     CAN_TxHeaderTypeDef tx_header;
     uint32_t tx_mailbox;
-    uint32_t deadline = HAL_GetTick() + CAN_TX_TIMEOUT_MS;
 
-    // 空きメールボックスができるまで待つ
-    while (HAL_CAN_GetTxMailboxesFreeLevel(hcan) == 0) {
-        if (HAL_GetTick() >= deadline) {
-            // タイムアウト：詰まった古い送信要求を全キャンセルして新しいデータを送る
-            HAL_CAN_AbortTxRequest(hcan, CAN_TX_MAILBOX0 | CAN_TX_MAILBOX1 | CAN_TX_MAILBOX2);
+    tx_header.RTR                = CAN_RTR_DATA;
+    tx_header.IDE                = CAN_ID_STD;
+    tx_header.TransmitGlobalTime = DISABLE;
+
+    while (queue->count > 0 && HAL_CAN_GetTxMailboxesFreeLevel(hcan) > 0) {
+        CanTxFrame *frame = &queue->entries[queue->count - 1];
+        uint32_t latency;
+
+        tx_header.StdId = frame->std_id;
+        tx_header.DLC   = frame->dlc;
+        if (HAL_CAN_AddTxMessage(hcan, &tx_header, frame->data, &tx_mailbox) != HAL_OK) {
             break;
         }
+
+        latency = Timebase_micros() - frame->enqueue_us;
+        queue->stats.total_latency_us += latency;
+        if (latency > queue->stats.max_latency_us) {
+            queue->stats.max_latency_us = latency;
+        }
+        queue->count--;
     }
+    queue->stats.depth = queue->count;
+}
 
-    tx_header.StdId              = std_id;
-    tx_header.RTR                = CAN_RTR_DATA;
-    tx_header.IDE                = CAN_ID_STD;
-    tx_header.DLC                = size;
-    tx_header.TransmitGlobalTime = DISABLE;
+// 送信関数（ノンブロッキング）
+// フレームはCAN IDの優先度順に送信キューへ積まれ、空きメールボックスと
+// 送信完了割り込みから順に送出される。キュー内に同じIDがあれば最新の内容で上書きする。
+// キュー満杯時は、新しいフレームの方が優先度が高ければ最も優先度の低いフレームを捨てる。
+HAL_StatusTypeDef Can_Transmit(CAN_HandleTypeDef *hcan, uint32_t std_id, uint8_t *pData, uint8_t size) {
+    CanTxQueue *queue = Can_GetTxQueue(hcan);
+    HAL_StatusTypeDef status = HAL_OK;
+    uint32_t primask;
+    int pos;
+    int i;
+
+    if (queue == NULL || pData == NULL || size > 8) {
+        return HAL_ERROR;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    // 同じIDがキューに残っていれば上書き（最新値優先）
+    for (i = 0; i < queue->count; i++) {
+        if (queue->entries[i].std_id == std_id) {
+            memcpy(queue->entries[i].data, pData, size);
+            queue->entries[i].dlc = size;
+            queue->stats.coalesced++;
+            Can_PumpTxQueue(hcan, queue);
+            __set_PRIMASK(primask);
+            return HAL_OK;
+        }
+    }
+
+    if (queue->count >= CAN_TX_QUEUE_SIZE) {
+        // entries[0] が最も優先度の低いフレーム
+        if (std_id >= queue->entries[0].std_id) {
+            queue->stats.dropped++;
+            Can_PumpTxQueue(hcan, queue);
+            __set_PRIMASK(primask);
+            return HAL_BUSY;
+        }
+        memmove(&queue->entries[0], &queue->entries[1], (queue->count - 1) * sizeof(CanTxFrame));
+        queue->count--;
+        queue->stats.dropped++;
+        status = HAL_BUSY;
+    }
+
+    // 挿入ソート（降順を維持）
+    pos = queue->count;
+    while (pos > 0 && queue->entries[pos - 1].std_id < std_id) {
+        queue->entries[pos] = queue->entries[pos - 1];
+        pos--;
+    }
+    queue->entries[pos].std_id = std_id;
+    memcpy(queue->entries[pos].data, pData, size);
+    queue->entries[pos].dlc = size;
+    queue->entries[pos].enqueue_us = Timebase_micros();
+    queue->count++;
+
+    queue->stats.queued++;
+    if (queue->count > queue->stats.max_depth) {
+        queue->stats.max_depth = queue->count;
+    }
+
+    Can_PumpTxQueue(hcan, queue);
+    __set_PRIMASK(primask);
+
+    return status;
+}
+
+const CanTxStats *Can_GetTxStats(CAN_HandleTypeDef *hcan)
+{
+    CanTxQueue *queue = Can_GetTxQueue(hcan);
+    if (queue == NULL) {
+        return NULL;
+    }
+    return &queue->stats;
+}
+
+void Can_ResetTxStats(CAN_HandleTypeDef *hcan)
+{
+    CanTxQueue *queue = Can_GetTxQueue(hcan);
+    uint32_t primask;
+
+    if (queue == NULL) {
+        return;
+    }
 
-    return HAL_CAN_AddTxMessage(hcan, &tx_header, pData, &tx_mailbox);
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memset(&queue->stats, 0, sizeof(queue->stats));
+    queue->stats.depth = queue->count;
+    queue->stats.max_depth = queue->count;
+    __set_PRIMASK(primask);
+}
+
+// 送信完了：統計を更新し、キューの次のフレームをメールボックスへ
+static void Can_TxComplete(CAN_HandleTypeDef *hcan, uint8_t aborted)
+{
+    CanTxQueue *queue = Can_GetTxQueue(hcan);
+    uint32_t primask;
+
+    if (queue == NULL) {
+        return;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (aborted) {
+        queue->stats.aborted++;
+    } else {
+        queue->stats.sent++;
+    }
+    Can_PumpTxQueue(hcan, queue);
+    __set_PRIMASK(primask);
+}
+
+// HALの送信完了・アボートコールバックをオーバーライド
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan) { Can_TxComplete(hcan, 0); }
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan) { Can_TxComplete(hcan, 0); }
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan) { Can_TxComplete(hcan, 0); }
+void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *hcan) { Can_TxComplete(hcan, 1); }
+void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *hcan) { Can_TxComplete(hcan, 1); }
+void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *hcan) { Can_TxComplete(hcan, 1); }
+
+void Can_SetRxHook(CAN_HandleTypeDef *hcan, CanRxHook hook) {
+    if (hcan->Instance == CAN1) {
+        s_can1_rx_hook = hook;
+    } else if (hcan->Instance == CAN2) {
+        s_can2_rx_hook = hook;
+    }
 }
 
 // HALの受信完了コールバックをオーバーライド
 void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
     CAN_RxHeaderTypeDef rx_header;
     CanRxData *target_rx_data = NULL;
+    CanRxHook hook;
 
     if (hcan->Instance == CAN1) {
         target_rx_data = &g_can1_rx_data;
+        hook = s_can1_rx_hook;
     } else if (hcan->Instance == CAN2) {
         target_rx_data = &g_can2_rx_data;
+        hook = s_can2_rx_hook;
     } else {
         return;
     }
@@ -91,5 +266,8 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
         target_rx_data->std_id        = rx_header.StdId;
         target_rx_data->dlc           = rx_header.DLC;
         target_rx_data->new_data_flag = 1;
+        if (hook != NULL) {
+            hook(hcan, target_rx_data);
+        }
     }
 }
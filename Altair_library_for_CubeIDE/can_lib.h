@@ -3,7 +3,18 @@
 
 #include "stm32f4xx_hal.h"
 
-// 送信タイムアウト[ms]（メールボックスが空くまでの最大待機時間）
+// 送信キューの段数（CANインスタンスごと）
+// ユーザ側で can_lib.h をインクルードする前に定義すると上書き可能。
+#ifndef CAN_TX_QUEUE_SIZE
+#define CAN_TX_QUEUE_SIZE  16
+#endif
+// 段数は uint8_t（count・depth・max_depth）で数えるので 255 まで
+#if CAN_TX_QUEUE_SIZE < 1 || CAN_TX_QUEUE_SIZE > 255
+#error "CAN_TX_QUEUE_SIZE must be between 1 and 255"
+#endif
+
+// 非推奨・未使用：Can_Transmit は待機しなくなったので、この値はどこでも使わない
+// （参照している既存のコードがビルドできるように定義だけ残す）
 #define CAN_TX_TIMEOUT_MS  10
 
 // 受信データを管理する構造体
@@ -21,6 +32,23 @@ typedef struct {
     uint32_t slave_start_filter_bank; // デュアルCAN時の分割開始バンク（単体CAN時は無視）
 } CanInitConfig;
 
+// 送信キューの統計情報
+typedef struct {
+    uint32_t queued;           // キューに積んだフレーム数
+    uint32_t coalesced;        // 同一IDの上書きでまとめられたフレーム数
+    uint32_t dropped;          // キュー満杯で捨てたフレーム数
+    uint32_t sent;             // 送信完了したフレーム数
+    uint32_t aborted;          // メールボックスでアボートされたフレーム数
+    uint8_t  depth;            // 現在のキュー段数
+    uint8_t  max_depth;        // キュー段数の最大値
+    uint32_t max_latency_us;   // キュー投入からメールボックス投入までの最大遅延[us]
+    uint64_t total_latency_us; // 遅延の合計[us]（sent + aborted で割ると平均。メールボックスに入れたフレームはどちらかで数える）
+} CanTxStats;
+
+// 受信割り込みの中で、g_canX_rx_data を書いた直後に呼ばれる関数
+// 次のフレームで上書きされる前に取り込みたいフレームを、ここで自前のバッファへ移す（割り込みから呼ばれるので短く）
+typedef void (*CanRxHook)(CAN_HandleTypeDef *hcan, const CanRxData *rx);
+
 extern CanRxData g_can1_rx_data;
 extern CanRxData g_can2_rx_data;
 
@@ -28,6 +56,13 @@ extern CanRxData g_can2_rx_data;
 HAL_StatusTypeDef Can_Init(CAN_HandleTypeDef *hcan, const CanInitConfig *config);
 HAL_StatusTypeDef Can_Transmit(CAN_HandleTypeDef *hcan, uint32_t std_id, uint8_t *pData, uint8_t size);
 
+// 受信フックの登録（CANインスタンスごとに 1 つ。NULL で解除）
+void Can_SetRxHook(CAN_HandleTypeDef *hcan, CanRxHook hook);
+
+// 送信キューの統計取得・クリア
+const CanTxStats *Can_GetTxStats(CAN_HandleTypeDef *hcan);
+void Can_ResetTxStats(CAN_HandleTypeDef *hcan);
+
 // デフォルト設定ヘルパ
 CanInitConfig Can_DefaultInitConfig(CAN_HandleTypeDef *hcan);
 
@@ -0,0 +1,220 @@
+#include "can_mdd.h"
+#include "timebase.h"
+#include <string.h>
+
+// float を int16 に丸めて格納（範囲外は飽和）
+static void CanMdd_PackInt16(uint8_t *dst, float value, float scale)
+{
+    float scaled = value * scale;
+    int16_t v;
+
+    if (scaled > 32767.0f) {
+        v = 32767;
+    } else if (scaled < -32768.0f) {
+        v = -32768;
+    } else {
+        v = (int16_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+    }
+    dst[0] = (uint8_t)(v & 0xFF);
+    dst[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+static float CanMdd_UnpackInt16(const uint8_t *src, float scale)
+{
+    int16_t v = (int16_t)((uint16_t)src[0] | ((uint16_t)src[1] << 8));
+    return (float)v / scale;
+}
+
+// 受信割り込みで拾った ACK のリングバッファ（CANインスタンスごと）
+// g_canX_rx_data は 1 フレーム分しかなく、ACK を読む前にテレメトリで上書きされることがあるので、
+// ACK だけは割り込みの中でここへ移しておく。書くのは割り込み（head）、読むのは CanMdd_Tcp（tail）だけ
+#define CAN_MDD_ACK_RING_SIZE  8U
+
+typedef struct {
+    uint32_t std_id;
+    uint8_t  seq;
+    uint8_t  command;
+} CanMddAck;
+
+typedef struct {
+    volatile CanMddAck frames[CAN_MDD_ACK_RING_SIZE];
+    volatile uint8_t   head;
+    volatile uint8_t   tail;
+    volatile uint32_t  dropped;   // 満杯で捨てた ACK の数
+} CanMddAckRing;
+
+static CanMddAckRing s_can1_acks;
+static CanMddAckRing s_can2_acks;
+
+static CanMddAckRing *CanMdd_GetAckRing(CAN_HandleTypeDef *hcan)
+{
+    if (hcan->Instance == CAN1) {
+        return &s_can1_acks;
+    } else if (hcan->Instance == CAN2) {
+        return &s_can2_acks;
+    }
+    return NULL;
+}
+
+// 受信フック（割り込みの中）：どのノードの ACK でもリングへ積む
+static void CanMdd_RxHook(CAN_HandleTypeDef *hcan, const CanRxData *rx)
+{
+    CanMddAckRing *ring = CanMdd_GetAckRing(hcan);
+    uint8_t next;
+
+    if (ring == NULL || rx->dlc < 2 || rx->std_id < CAN_MDD_BASE_ID
+        || ((rx->std_id - CAN_MDD_BASE_ID) & 7U) != CAN_MDD_OFS_ACK) {
+        return;
+    }
+    next = (uint8_t)((ring->head + 1U) % CAN_MDD_ACK_RING_SIZE);
+    if (next == ring->tail) {
+        ring->dropped++;
+        return;
+    }
+    ring->frames[ring->head].std_id = rx->std_id;
+    ring->frames[ring->head].seq = rx->data[0];
+    ring->frames[ring->head].command = rx->data[1];
+    ring->head = next;
+}
+
+void CanMdd_Init(CanMdd *mdd, CAN_HandleTypeDef *hcan, uint8_t node)
+{
+    mdd->hcan = hcan;
+    mdd->base_id = CAN_MDD_BASE_ID + ((uint32_t)node << 3);
+    mdd->seq = 0;
+    mdd->ack_seq = 0;
+    mdd->ack_command = 0;
+    mdd->ack_flag = 0;
+    memset(mdd->telemetry_rps, 0, sizeof(mdd->telemetry_rps));
+    mdd->telemetry_flag = 0;
+    Can_SetRxHook(hcan, CanMdd_RxHook);
+}
+
+// 1 コマンド分のフレームを送信する
+static HAL_StatusTypeDef CanMdd_Send(CanMdd *mdd, uint8_t id, const float command_data[4], uint8_t seq)
+{
+    uint8_t data[8];
+    HAL_StatusTypeDef status = HAL_OK;
+    int i;
+
+    if (id == MOTOR_RPS_COMMAND_MODE || id == MOTOR_PWM_COMMAND_MODE) {
+        // 4 モータ分の指令を 1 フレームにまとめる
+        float scale = (id == MOTOR_RPS_COMMAND_MODE) ? CAN_MDD_RPS_SCALE : CAN_MDD_PWM_SCALE;
+        uint32_t ofs = (id == MOTOR_RPS_COMMAND_MODE) ? CAN_MDD_OFS_RPS : CAN_MDD_OFS_PWM;
+        for (i = 0; i < 4; i++) {
+            CanMdd_PackInt16(&data[i * 2], command_data[i], scale);
+        }
+        return Can_Transmit(mdd->hcan, mdd->base_id + ofs, data, 8);
+    }
+
+    // 設定コマンドは float 1 個ずつ、ID を分けて 4 フレームで送る
+    // （送信キューでの同一ID上書きに巻き込まれないようにするため）
+    for (i = 0; i < 4; i++) {
+        data[0] = id;
+        data[1] = seq;
+        data[2] = 0;
+        data[3] = 0;
+        memcpy(&data[4], &command_data[i], sizeof(float));
+        status = Can_Transmit(mdd->hcan, mdd->base_id + CAN_MDD_OFS_CONFIG + i, data, 8);
+        if (status != HAL_OK) {
+            return status;
+        }
+    }
+    return status;
+}
+
+HAL_StatusTypeDef CanMdd_Udp(CanMdd *mdd, uint8_t id, const float command_data[4])
+{
+    return CanMdd_Send(mdd, id, command_data, ++mdd->seq);
+}
+
+HAL_StatusTypeDef CanMdd_Tcp(CanMdd *mdd, uint8_t id, const float command_data[4],
+                             uint32_t resend_ms, uint32_t max_wait_ms)
+{
+    CanMddAckRing *ring = CanMdd_GetAckRing(mdd->hcan);
+    uint8_t seq = ++mdd->seq;
+    // 指令フレームには seq を載せられないため、MDD はコマンドID のみを返す（seq=0）
+    uint8_t expect_seq = (id == MOTOR_RPS_COMMAND_MODE || id == MOTOR_PWM_COMMAND_MODE) ? 0 : seq;
+    uint64_t start_time = Timebase_nowUs();
+    uint64_t send_time = start_time;
+    uint64_t now;
+    HAL_StatusTypeDef status;
+
+    if (ring == NULL) {
+        return HAL_ERROR;
+    }
+    // 前のコマンドへの遅れた ACK を取り違えないよう、送る前に溜まっている分を捨てる
+    ring->tail = ring->head;
+    status = CanMdd_Send(mdd, id, command_data, seq);
+    if (status != HAL_OK) {
+        return status;
+    }
+
+    while ((now = Timebase_nowUs()) - start_time < (uint64_t)max_wait_ms * 1000U) {
+        // ACK はリングから取り出すので、g_canX_rx_data（ユーザのテレメトリ受信）には触らない
+        while (ring->tail != ring->head) {
+            uint8_t tail = ring->tail;
+            uint32_t std_id = ring->frames[tail].std_id;
+            uint8_t ack_seq = ring->frames[tail].seq;
+            uint8_t ack_command = ring->frames[tail].command;
+
+            ring->tail = (uint8_t)((tail + 1U) % CAN_MDD_ACK_RING_SIZE);
+            if (std_id != mdd->base_id + CAN_MDD_OFS_ACK) {
+                continue;   // 他ノードの ACK
+            }
+            mdd->ack_seq = ack_seq;
+            mdd->ack_command = ack_command;
+            if (ack_seq == expect_seq && ack_command == id) {
+                return HAL_OK;
+            }
+        }
+        if (now - send_time >= (uint64_t)resend_ms * 1000U) {
+            status = CanMdd_Send(mdd, id, command_data, seq);
+            if (status != HAL_OK) {
+                return status;
+            }
+            send_time = now;
+        }
+    }
+    return HAL_TIMEOUT;
+}
+
+HAL_StatusTypeDef CanMdd_Sync(CAN_HandleTypeDef *hcan)
+{
+    uint8_t dummy = 0;
+    return Can_Transmit(hcan, CAN_MDD_SYNC_ID, &dummy, 0);
+}
+
+uint8_t CanMdd_HandleRx(CanMdd *mdd, const CanRxData *rx)
+{
+    int i;
+
+    if (rx->std_id == mdd->base_id + CAN_MDD_OFS_ACK && rx->dlc >= 2) {
+        mdd->ack_seq = rx->data[0];
+        mdd->ack_command = rx->data[1];
+        mdd->ack_flag = 1;
+        return 1;
+    }
+    if (rx->std_id == mdd->base_id + CAN_MDD_OFS_TELEMETRY && rx->dlc == 8) {
+        for (i = 0; i < 4; i++) {
+            mdd->telemetry_rps[i] = CanMdd_UnpackInt16(&rx->data[i * 2], CAN_MDD_RPS_SCALE);
+        }
+        mdd->telemetry_flag = 1;
+        return 1;
+    }
+    return 0;
+}
+
+uint8_t CanMdd_ReadTelemetry(CanMdd *mdd, float rps[4])
+{
+    int i;
+
+    if (!mdd->telemetry_flag) {
+        return 0;
+    }
+    for (i = 0; i < 4; i++) {
+        rps[i] = mdd->telemetry_rps[i];
+    }
+    mdd->telemetry_flag = 0;
+    return 1;
+}
@@ -0,0 +1,62 @@
+#ifndef CAN_MDD_H
+#define CAN_MDD_H
+
+#include "can_lib.h"
+#include "msg_schema.h"
+
+// SkenMdd（UART）と同じコマンド体系を CAN フレームで送るためのプロトコル
+//
+// ID 割り当て（ノードごとに 8 ID を使用、IDが小さいほど優先度が高い）
+//   CAN_MDD_SYNC_ID            : 全ノード共通の同期フレーム（DLC=0）
+//   base + CAN_MDD_OFS_RPS     : 4 モータ分の RPS 指令（int16 x4, 0.01rps 単位）
+//   base + CAN_MDD_OFS_PWM     : 4 モータ分の PWM 指令（int16 x4, 0.01% 単位）
+//   base + CAN_MDD_OFS_ACK     : MDD からの ACK（[0]=seq, [1]=コマンドID）
+//   base + CAN_MDD_OFS_TELEMETRY : MDD からの実測 RPS（int16 x4, 0.01rps 単位）
+//   base + CAN_MDD_OFS_CONFIG + n : 設定コマンドの n 番目の float（[0]=コマンドID, [1]=seq, [4..7]=float）
+//                                   n=0..3 の 4 フレームで 1 コマンド。MDD は n=3 受信時に反映する
+// base = CAN_MDD_BASE_ID + node * 8
+
+#define CAN_MDD_SYNC_ID        0x080U
+#define CAN_MDD_BASE_ID        0x100U
+
+#define CAN_MDD_OFS_RPS        0U
+#define CAN_MDD_OFS_PWM        1U
+#define CAN_MDD_OFS_ACK        2U
+#define CAN_MDD_OFS_TELEMETRY  3U
+#define CAN_MDD_OFS_CONFIG     4U
+
+#define CAN_MDD_RPS_SCALE      100.0f
+#define CAN_MDD_PWM_SCALE      100.0f
+
+typedef struct {
+    CAN_HandleTypeDef *hcan;
+    uint32_t base_id;
+    uint8_t  seq;
+    uint8_t  ack_seq;         // 最後に受信した ACK の seq
+    uint8_t  ack_command;     // 最後に受信した ACK のコマンドID
+    uint8_t  ack_flag;        // ACK 受信フラグ
+    float    telemetry_rps[4];
+    uint8_t  telemetry_flag;  // テレメトリ受信フラグ（読み取りでクリア）
+} CanMdd;
+
+void CanMdd_Init(CanMdd *mdd, CAN_HandleTypeDef *hcan, uint8_t node);
+
+// 応答を待たずに送信（SkenMdd::udp 相当）
+HAL_StatusTypeDef CanMdd_Udp(CanMdd *mdd, uint8_t id, const float command_data[4]);
+
+// ACK を待つ送信（SkenMdd::tcp 相当）。resend_ms ごとに再送し、max_wait_ms で HAL_TIMEOUT
+// 送信に失敗したら（キュー満杯など）その HAL の戻り値をすぐ返す
+// ACK は CanMdd_Init が登録した受信フックが割り込みの中でリングへ移すので、待機中に g_canX_rx_data は読まない
+HAL_StatusTypeDef CanMdd_Tcp(CanMdd *mdd, uint8_t id, const float command_data[4],
+                             uint32_t resend_ms, uint32_t max_wait_ms);
+
+// 全ノードへ同期フレームを送信（各 MDD は受信済みの指令をこのタイミングで反映する）
+HAL_StatusTypeDef CanMdd_Sync(CAN_HandleTypeDef *hcan);
+
+// 受信フレームを解釈する（自ノード宛てなら 1 を返す）
+uint8_t CanMdd_HandleRx(CanMdd *mdd, const CanRxData *rx);
+
+// テレメトリを読み出す（新しいデータがあれば 1 を返す）
+uint8_t CanMdd_ReadTelemetry(CanMdd *mdd, float rps[4]);
+
+#endif /* CAN_MDD_H */
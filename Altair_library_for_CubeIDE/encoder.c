@@ -10,7 +10,8 @@ void Encoder_Init(Encoder *encoder, TIM_HandleTypeDef *htim, double diameter, in
     encoder->limit = 0;
     encoder->before_rot = 0.0;
     encoder->before_deg = 0.0;
-    encoder->last_time = 0;
+    Timebase_Begin();
+    encoder->last_time = Timebase_nowUs();
 
     encoder->htim->Init.Prescaler = 0;
     encoder->htim->Init.CounterMode = TIM_COUNTERMODE_UP;
@@ -60,14 +61,18 @@ void Encoder_Interrupt(Encoder *encoder, EncoderData *encoder_data)
     encoder_data->deg = encoder_data->rot * 360.0;
     encoder_data->distance = encoder_data->rot * (PI * encoder->diameter);
 
-    if (HAL_GetTick() - encoder->last_time >= (uint32_t)encoder->period)
+    // period [ms] たったら、実際の経過時間 [us] で速度を計算する
+    // 呼ぶ周期が period と同じでも揺れで 1 回飛ばさないように、0.5ms 手前から計算する
+    uint64_t now = Timebase_nowUs();
+    uint64_t elapsed = now - encoder->last_time;
+    if (elapsed + 500U >= (uint64_t)encoder->period * 1000U && elapsed > 0U)
     {
-        encoder_data->rps = (encoder_data->rot - encoder->before_rot) * 1000.0 / encoder->period;
+        encoder_data->rps = (encoder_data->rot - encoder->before_rot) * 1000000.0 / (double)elapsed;
         encoder_data->velocity = encoder_data->rps * PI * encoder->diameter;
 
         encoder->before_rot = encoder_data->rot;
         encoder->before_deg = encoder_data->deg;
-        encoder->last_time = HAL_GetTick();
+        encoder->last_time = now;
     }
 }
 
@@ -3,6 +3,7 @@
 
 #include "stm32f4xx_hal.h"
 #include <math.h>
+#include "timebase.h"
 
 #define PI 3.14159265359
 
@@ -25,7 +26,7 @@ typedef struct
     int limit;
     double before_rot;
     double before_deg;
-    uint32_t last_time;      // 速度計算用タイムスタンプ（複数インスタンス対応）
+    uint64_t last_time;      // 前回速度を計算した時刻 [us]（timebase.h）
 } Encoder;
 
 void Encoder_Init(Encoder *encoder, TIM_HandleTypeDef *htim, double diameter, int ppr, int period);
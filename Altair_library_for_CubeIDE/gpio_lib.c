@@ -1,21 +1,11 @@
 #include "gpio_lib.h"
 
-HAL_StatusTypeDef GpioLib_Init(GpioLib *gpio, GPIO_TypeDef *port, uint16_t pin, GpioLibMode mode)
+// ピン（複数可）をモードに合わせて初期化する内部関数
+static HAL_StatusTypeDef GpioLib_ConfigPins(GPIO_TypeDef *port, uint16_t pins, GpioLibMode mode)
 {
     GPIO_InitTypeDef init = {0};
 
-    if (gpio == NULL || port == NULL) {
-        return HAL_ERROR;
-    }
-
-    gpio->port = port;
-    gpio->pin = pin;
-    gpio->mode = mode;
-    gpio->htim = NULL;
-    gpio->channel = 0U;
-    gpio->pwm_period = 0U;
-
-    init.Pin = pin;
+    init.Pin = pins;
     init.Speed = GPIO_SPEED_FREQ_HIGH;
 
     switch (mode) {
@@ -43,34 +33,75 @@ HAL_StatusTypeDef GpioLib_Init(GpioLib *gpio, GPIO_TypeDef *port, uint16_t pin,
     return HAL_OK;
 }
 
+HAL_StatusTypeDef GpioLib_Init(GpioLib *gpio, GPIO_TypeDef *port, uint16_t pin, GpioLibMode mode)
+{
+    if (gpio == NULL || port == NULL) {
+        return HAL_ERROR;
+    }
+
+    gpio->port = port;
+    gpio->pin = pin;
+    gpio->mode = mode;
+    gpio->htim = NULL;
+    gpio->channel = 0U;
+    gpio->pwm_period = 0U;
+    gpio->ccr = NULL;
+    gpio->duty_scale = 0.0f;
+    gpio->permille_scale_q16 = 0U;
+
+    return GpioLib_ConfigPins(port, pin, mode);
+}
+
 HAL_StatusTypeDef GpioLib_InitPwm(GpioLib *gpio, GPIO_TypeDef *port, uint16_t pin,
                                   TIM_HandleTypeDef *htim, uint32_t channel)
 {
     if (gpio == NULL || port == NULL || htim == NULL) {
         return HAL_ERROR;
     }
+    // CCR1〜CCR4 は並んでいて、TIM_CHANNEL_1〜4 は 0, 4, 8, 12
+    // TIM_CHANNEL_5 / 6（G4・F3・L4 など）の CCR5 / CCR6 と TIM_CHANNEL_ALL はこの並びにないので受け付けない
+    if (channel != TIM_CHANNEL_1 && channel != TIM_CHANNEL_2 && channel != TIM_CHANNEL_3 && channel != TIM_CHANNEL_4) {
+        return HAL_ERROR;
+    }
 
     gpio->port = port;
     gpio->pin = pin;
     gpio->mode = GPIO_LIB_MODE_OUTPUT;
     gpio->htim = htim;
     gpio->channel = channel;
-    gpio->pwm_period = __HAL_TIM_GET_AUTORELOAD(htim);
+    gpio->ccr = &htim->Instance->CCR1 + (channel >> 2);
+    GpioLib_UpdatePwmScale(gpio);
 
     if (HAL_TIM_PWM_Start(htim, channel) != HAL_OK) {
         return HAL_ERROR;
     }
 
-    __HAL_TIM_SET_COMPARE(htim, channel, 0U);
+    *gpio->ccr = 0U;
     return HAL_OK;
 }
 
+// ARR から Duty → CCR の係数を計算し直す（初期化後に ARR を変えたら呼ぶ）
+void GpioLib_UpdatePwmScale(GpioLib *gpio)
+{
+    uint64_t scale_q16;
+
+    if (gpio == NULL || gpio->htim == NULL) {
+        return;
+    }
+
+    gpio->pwm_period = __HAL_TIM_GET_AUTORELOAD(gpio->htim);
+    gpio->duty_scale = (float)gpio->pwm_period / 100.0f;
+    // 切り上げておくと 1000‰ でちょうど ARR になる（ARR が 6553 万未満なら誤差は 1 カウント未満）
+    scale_q16 = (((uint64_t)gpio->pwm_period << 16) + 999U) / 1000U;
+    gpio->permille_scale_q16 = (scale_q16 > 0xFFFFFFFFU) ? 0xFFFFFFFFU : (uint32_t)scale_q16;
+}
+
 void GpioLib_Write(GpioLib *gpio, GPIO_PinState state)
 {
     if (gpio == NULL || gpio->port == NULL) {
         return;
     }
-    HAL_GPIO_WritePin(gpio->port, gpio->pin, state);
+    gpio->port->BSRR = (state != GPIO_PIN_RESET) ? (uint32_t)gpio->pin : (uint32_t)gpio->pin << 16;
 }
 
 void GpioLib_Toggle(GpioLib *gpio)
@@ -78,7 +109,8 @@ void GpioLib_Toggle(GpioLib *gpio)
     if (gpio == NULL || gpio->port == NULL) {
         return;
     }
-    HAL_GPIO_TogglePin(gpio->port, gpio->pin);
+    uint32_t odr = gpio->port->ODR;
+    gpio->port->BSRR = ((odr & gpio->pin) << 16) | (~odr & gpio->pin);
 }
 
 GPIO_PinState GpioLib_Read(GpioLib *gpio)
@@ -86,14 +118,12 @@ GPIO_PinState GpioLib_Read(GpioLib *gpio)
     if (gpio == NULL || gpio->port == NULL) {
         return GPIO_PIN_RESET;
     }
-    return HAL_GPIO_ReadPin(gpio->port, gpio->pin);
+    return (gpio->port->IDR & gpio->pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
 }
 
 void GpioLib_WriteDuty(GpioLib *gpio, float duty_percent)
 {
-    uint32_t compare;
-
-    if (gpio == NULL || gpio->htim == NULL) {
+    if (gpio == NULL || gpio->ccr == NULL) {
         return;
     }
 
@@ -104,7 +134,31 @@ void GpioLib_WriteDuty(GpioLib *gpio, float duty_percent)
         duty_percent = 100.0f;
     }
 
-    gpio->pwm_period = __HAL_TIM_GET_AUTORELOAD(gpio->htim);
-    compare = (uint32_t)((duty_percent / 100.0f) * (float)gpio->pwm_period);
-    __HAL_TIM_SET_COMPARE(gpio->htim, gpio->channel, compare);
+    *gpio->ccr = (uint32_t)(duty_percent * gpio->duty_scale);
+}
+
+// Duty を 0.1% 単位の整数（0〜1000）で設定する（浮動小数点なし）
+void GpioLib_WriteDutyPermille(GpioLib *gpio, uint32_t duty_permille)
+{
+    if (gpio == NULL || gpio->ccr == NULL) {
+        return;
+    }
+
+    if (duty_permille > 1000U) {
+        duty_permille = 1000U;
+    }
+
+    *gpio->ccr = (uint32_t)(((uint64_t)duty_permille * gpio->permille_scale_q16) >> 16);
+}
+
+HAL_StatusTypeDef GpioBundle_Init(GpioBundle *bundle, GPIO_TypeDef *port, uint16_t pins, GpioLibMode mode)
+{
+    if (bundle == NULL || port == NULL || pins == 0U) {
+        return HAL_ERROR;
+    }
+
+    bundle->port = port;
+    bundle->mask = pins;
+
+    return GpioLib_ConfigPins(port, pins, mode);
 }
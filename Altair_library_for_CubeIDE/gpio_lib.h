@@ -16,9 +16,20 @@ typedef struct {
     GpioLibMode mode;
     TIM_HandleTypeDef *htim;
     uint32_t channel;
-    uint32_t pwm_period;
+    uint32_t pwm_period;            // ARR のキャッシュ（Duty 100% のときの CCR）
+    volatile uint32_t *ccr;         // チャンネルの CCR
+    float duty_scale;               // 1% あたりのカウント値（ARR から事前計算）
+    uint32_t permille_scale_q16;    // 0.1% あたりのカウント値（Q16 固定小数点、ARR から事前計算）
 } GpioLib;
 
+// 同じポートの複数ピンをまとめて読み書きするためのバンドル
+// 書き込みは BSRR への 1 回のストア、読み出しは IDR の 1 回のロードなので、途中の組み合わせが出力されない
+// 値はピンの位置のビット（GPIO_PIN_x の OR）で渡す・返す
+typedef struct {
+    GPIO_TypeDef *port;
+    uint16_t mask;                  // バンドルのピン
+} GpioBundle;
+
 HAL_StatusTypeDef GpioLib_Init(GpioLib *gpio, GPIO_TypeDef *port, uint16_t pin, GpioLibMode mode);
 HAL_StatusTypeDef GpioLib_InitPwm(GpioLib *gpio, GPIO_TypeDef *port, uint16_t pin,
                                   TIM_HandleTypeDef *htim, uint32_t channel);
@@ -26,5 +37,40 @@ void GpioLib_Write(GpioLib *gpio, GPIO_PinState state);
 void GpioLib_Toggle(GpioLib *gpio);
 GPIO_PinState GpioLib_Read(GpioLib *gpio);
 void GpioLib_WriteDuty(GpioLib *gpio, float duty_percent);
+void GpioLib_WriteDutyPermille(GpioLib *gpio, uint32_t duty_permille);
+void GpioLib_UpdatePwmScale(GpioLib *gpio);
+
+HAL_StatusTypeDef GpioBundle_Init(GpioBundle *bundle, GPIO_TypeDef *port, uint16_t pins, GpioLibMode mode);
+
+// バンドルの全ピンを value の通りにする（value の 1 のピンを High、0 のピンを Low）
+static inline void GpioBundle_write(const GpioBundle *bundle, uint16_t value)
+{
+    bundle->port->BSRR = ((uint32_t)(bundle->mask & (uint16_t)~value) << 16) | (bundle->mask & value);
+}
+
+// pins のピンだけ High / Low にする（他のピンはそのまま）
+static inline void GpioBundle_set(const GpioBundle *bundle, uint16_t pins)
+{
+    bundle->port->BSRR = bundle->mask & pins;
+}
+
+static inline void GpioBundle_reset(const GpioBundle *bundle, uint16_t pins)
+{
+    bundle->port->BSRR = (uint32_t)(bundle->mask & pins) << 16;
+}
+
+// pins のピンを反転する（ODR を読んでから BSRR に書くので、同じピンを割り込みからも書く場合は呼ぶ側で割り込みを止める）
+static inline void GpioBundle_toggle(const GpioBundle *bundle, uint16_t pins)
+{
+    uint32_t odr = bundle->port->ODR;
+    pins &= bundle->mask;
+    bundle->port->BSRR = ((odr & pins) << 16) | (~odr & pins);
+}
+
+// バンドルのピンの入力を返す（バンドル外のピンは 0）
+static inline uint16_t GpioBundle_read(const GpioBundle *bundle)
+{
+    return (uint16_t)(bundle->port->IDR & bundle->mask);
+}
 
 #endif /* GPIO_LIB_H */
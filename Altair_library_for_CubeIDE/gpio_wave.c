@@ -0,0 +1,409 @@
+#include "gpio_wave.h"
+#include "gpio_lib.h"
+#include "motor_driver.h"
+
+// DMA の割り込みから GpioWave を探すための一覧
+static GpioWave *gpio_wave_list[GPIO_WAVE_MAX];
+
+static GpioWave *GpioWave_Find(DMA_HandleTypeDef *hdma)
+{
+    int i;
+
+    for (i = 0; i < GPIO_WAVE_MAX; i++)
+    {
+        if (gpio_wave_list[i] != NULL && gpio_wave_list[i]->htim->hdma[TIM_DMA_ID_UPDATE] == hdma)
+        {
+            return gpio_wave_list[i];
+        }
+    }
+    return NULL;
+}
+
+// バッファの半分（half：0 が前半、1 が後半）を次の波形で埋める内部関数
+static void GpioWave_Refill(GpioWave *wave, uint8_t half)
+{
+    uint16_t size = wave->length / 2U;
+    uint32_t *words = wave->buffer + (half ? size : 0U);
+    uint16_t written = 0;
+    uint16_t i;
+
+    if (!wave->ending)
+    {
+        written = wave->fill(wave->context, words, size);
+        if (written < size)
+        {
+            wave->ending = 1;
+            wave->last_half = half;
+        }
+    }
+    // 波形が終わった後は 0（ピンを変えない）で埋める
+    for (i = written; i < size; i++)
+    {
+        words[i] = 0U;
+    }
+}
+
+// 前半を出し終えた
+static void GpioWave_DmaHalfComplete(DMA_HandleTypeDef *hdma)
+{
+    GpioWave *wave = GpioWave_Find(hdma);
+
+    if (wave == NULL || wave->fill == NULL)
+    {
+        return;
+    }
+    if (wave->ending && wave->last_half == 0U)
+    {
+        GpioWave_Stop(wave);
+        return;
+    }
+    GpioWave_Refill(wave, 0);
+}
+
+// 後半（GpioWave_Play では全体）を出し終えた
+static void GpioWave_DmaComplete(DMA_HandleTypeDef *hdma)
+{
+    GpioWave *wave = GpioWave_Find(hdma);
+
+    if (wave == NULL)
+    {
+        return;
+    }
+    if (wave->fill == NULL)
+    {
+        // GpioWave_Play：繰り返しなら DMA が先頭に戻って続ける
+        if (hdma->Init.Mode != DMA_CIRCULAR)
+        {
+            GpioWave_Stop(wave);
+        }
+        return;
+    }
+    if (wave->ending && wave->last_half == 1U)
+    {
+        GpioWave_Stop(wave);
+        return;
+    }
+    GpioWave_Refill(wave, 1);
+}
+
+// DMA を「メモリ → BSRR、32 ビット、1 サンプルずつ」に設定し直して開始する内部関数
+static HAL_StatusTypeDef GpioWave_StartDma(GpioWave *wave, const uint32_t *words, uint16_t count, uint32_t mode)
+{
+    DMA_HandleTypeDef *hdma = wave->htim->hdma[TIM_DMA_ID_UPDATE];
+
+    hdma->Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma->Init.MemInc = DMA_MINC_ENABLE;
+    hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma->Init.Mode = mode;
+    hdma->Init.Priority = DMA_PRIORITY_VERY_HIGH;
+    hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(hdma) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    hdma->XferCpltCallback = GpioWave_DmaComplete;
+    hdma->XferHalfCpltCallback = (wave->fill != NULL) ? GpioWave_DmaHalfComplete : NULL;
+
+    wave->busy = 1;
+    if (HAL_DMA_Start_IT(hdma, (uint32_t)words, (uint32_t)&wave->port->BSRR, count) != HAL_OK)
+    {
+        wave->busy = 0;
+        return HAL_ERROR;
+    }
+
+    // 最初のサンプルは次の更新イベントで出る
+    __HAL_TIM_SET_COUNTER(wave->htim, 0U);
+    __HAL_TIM_ENABLE_DMA(wave->htim, TIM_DMA_UPDATE);
+    __HAL_TIM_ENABLE(wave->htim);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef GpioWave_Init(GpioWave *wave, TIM_HandleTypeDef *htim, GPIO_TypeDef *port, uint16_t pins,
+                                uint32_t *buffer, uint16_t length)
+{
+    GpioBundle bundle;
+    int i;
+    int slot = -1;
+
+    if (wave == NULL || htim == NULL || port == NULL || htim->hdma[TIM_DMA_ID_UPDATE] == NULL)
+    {
+        return HAL_ERROR;
+    }
+    // GPIO（AHB1）に書けるのは DMA2 だけ
+    if (htim->Instance != TIM1 && htim->Instance != TIM8)
+    {
+        return HAL_ERROR;
+    }
+
+    for (i = 0; i < GPIO_WAVE_MAX; i++)
+    {
+        if (gpio_wave_list[i] == wave || (gpio_wave_list[i] != NULL && gpio_wave_list[i]->htim == htim))
+        {
+            slot = i;
+            break;
+        }
+        if (gpio_wave_list[i] == NULL && slot < 0)
+        {
+            slot = i;
+        }
+    }
+    if (slot < 0)
+    {
+        return HAL_ERROR;
+    }
+
+    wave->htim = htim;
+    wave->port = port;
+    wave->mask = pins;
+    wave->buffer = buffer;
+    wave->length = length & (uint16_t)~1U;   // 半分ずつ使うので偶数にする
+    wave->fill = NULL;
+    wave->context = NULL;
+    wave->sample_hz = 0;
+    wave->busy = 0;
+    wave->ending = 0;
+    wave->last_half = 0;
+
+    if (GpioBundle_Init(&bundle, port, pins, GPIO_LIB_MODE_OUTPUT) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    gpio_wave_list[slot] = wave;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef GpioWave_setSampleRate(GpioWave *wave, uint32_t sample_hz)
+{
+    uint32_t tim_clk = MotorDriver_GetTimerClock(wave->htim);
+    uint32_t prescaler;
+    uint32_t arr;
+
+    // 1 サンプルに 2 カウント以上（sample_hz * 2 は桁あふれするので割り算で比べる）
+    if (sample_hz == 0U || sample_hz > tim_clk / 2U)
+    {
+        return HAL_ERROR;
+    }
+    // ARR が 16 ビットに収まる最小のプリスケーラ（MotorDriver_setPwmFrequency と同じ計算）
+    if (MotorDriver_CalcTimerDivider(tim_clk, sample_hz, &prescaler, &arr) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    __HAL_TIM_DISABLE(wave->htim);
+    __HAL_TIM_SET_PRESCALER(wave->htim, prescaler);
+    __HAL_TIM_SET_AUTORELOAD(wave->htim, arr);
+    wave->htim->Instance->EGR = TIM_EGR_UG;  // プリスケーラをすぐ反映する
+    wave->htim->Instance->SR = 0U;
+    wave->htim->Init.Prescaler = prescaler;
+    wave->htim->Init.Period = arr;
+
+    wave->sample_hz = tim_clk / (prescaler + 1U) / (arr + 1U);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef GpioWave_Play(GpioWave *wave, const uint32_t *words, uint16_t count, uint8_t loop)
+{
+    if (wave == NULL || words == NULL || count == 0U || wave->busy)
+    {
+        return HAL_ERROR;
+    }
+
+    wave->fill = NULL;
+    wave->ending = 0;
+    return GpioWave_StartDma(wave, words, count, loop ? DMA_CIRCULAR : DMA_NORMAL);
+}
+
+HAL_StatusTypeDef GpioWave_Stream(GpioWave *wave, GpioWaveFill fill, void *context)
+{
+    if (wave == NULL || fill == NULL || wave->buffer == NULL || wave->length < 2U || wave->busy)
+    {
+        return HAL_ERROR;
+    }
+
+    wave->fill = fill;
+    wave->context = context;
+    wave->ending = 0;
+    GpioWave_Refill(wave, 0);
+    GpioWave_Refill(wave, 1);
+    return GpioWave_StartDma(wave, wave->buffer, wave->length, DMA_CIRCULAR);
+}
+
+void GpioWave_Stop(GpioWave *wave)
+{
+    if (wave == NULL)
+    {
+        return;
+    }
+
+    __HAL_TIM_DISABLE(wave->htim);
+    __HAL_TIM_DISABLE_DMA(wave->htim, TIM_DMA_UPDATE);
+    HAL_DMA_Abort(wave->htim->hdma[TIM_DMA_ID_UPDATE]);
+    wave->busy = 0;
+}
+
+uint16_t GpioWave_hold(uint32_t *words, uint16_t capacity, uint16_t mask, uint16_t value, uint16_t samples)
+{
+    uint16_t i;
+
+    if (samples > capacity)
+    {
+        samples = capacity;
+    }
+    for (i = 0; i < samples; i++)
+    {
+        // 変化は最初のサンプルだけでよい
+        words[i] = (i == 0U) ? GpioWave_word(mask, value) : 0U;
+    }
+    return samples;
+}
+
+uint16_t GpioWave_shiftOut(uint32_t *words, uint16_t capacity, uint16_t data_pin, uint16_t clock_pin,
+                           uint16_t latch_pin, const uint8_t *bytes, uint16_t count)
+{
+    uint32_t needed = (uint32_t)count * 16U + 2U;
+    uint16_t n = 0;
+    uint16_t i;
+    int bit;
+
+    if (needed > capacity)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        for (bit = 7; bit >= 0; bit--)
+        {
+            uint16_t data = (bytes[i] & (1U << bit)) ? data_pin : 0U;
+            words[n++] = GpioWave_word(data_pin | clock_pin | latch_pin, data);   // データを出して CLK Low
+            words[n++] = clock_pin;                                               // CLK の立ち上がりで取り込む
+        }
+    }
+    words[n++] = GpioWave_word(clock_pin | latch_pin, latch_pin);   // LATCH の立ち上がりで出力に反映
+    words[n++] = (uint32_t)latch_pin << 16;
+    return n;
+}
+
+void GpioWaveStepper_Init(GpioWaveStepper *stepper, uint16_t step_pin, uint16_t dir_pin)
+{
+    stepper->step_pin = step_pin;
+    stepper->dir_pin = dir_pin;
+    stepper->direction = 1;
+    stepper->step_high = 0;
+    stepper->dir_pending = 0;
+    stepper->remaining = 0;
+    stepper->velocity = 0.0f;
+    stepper->start_velocity = 0.0f;
+    stepper->max_velocity = 0.0f;
+    stepper->acceleration = 0.0f;
+    stepper->phase = 0.0f;
+}
+
+HAL_StatusTypeDef GpioWaveStepper_move(GpioWaveStepper *stepper, int32_t steps, float start_velocity,
+                                       float max_velocity, float acceleration, uint32_t sample_hz)
+{
+    float per_sample;
+
+    // 速度 0 では位相が進まず、fill が終わらなくなる（NaN もここで弾く）
+    if (sample_hz == 0U || !(max_velocity > 0.0f))
+    {
+        stepper->remaining = 0;
+        stepper->dir_pending = 0;
+        stepper->step_high = 0;
+        return HAL_ERROR;
+    }
+    per_sample = 1.0f / (float)sample_hz;
+
+    stepper->direction = (steps < 0) ? -1 : 1;
+    stepper->remaining = (uint32_t)((steps < 0) ? -steps : steps);
+    stepper->dir_pending = 1;
+    stepper->step_high = 0;
+    stepper->phase = 0.0f;
+
+    // [step/s] → [step/sample]
+    stepper->max_velocity = max_velocity * per_sample;
+    if (stepper->max_velocity > 0.5f)
+    {
+        stepper->max_velocity = 0.5f;
+    }
+    stepper->acceleration = acceleration * per_sample * per_sample;
+    stepper->start_velocity = start_velocity * per_sample;
+    if (stepper->acceleration <= 0.0f || stepper->start_velocity > stepper->max_velocity)
+    {
+        stepper->start_velocity = stepper->max_velocity;   // 加速しない
+    }
+    // 速度 0 で止まったままにならないようにする
+    if (stepper->start_velocity < stepper->acceleration)
+    {
+        stepper->start_velocity = stepper->acceleration;
+    }
+    stepper->velocity = stepper->start_velocity;
+    return HAL_OK;
+}
+
+uint16_t GpioWaveStepper_fill(void *context, uint32_t *words, uint16_t count)
+{
+    GpioWaveStepper *stepper = (GpioWaveStepper *)context;
+    float v0_squared = stepper->start_velocity * stepper->start_velocity;
+    uint16_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        uint32_t word = 0U;
+
+        if (stepper->dir_pending)
+        {
+            // 最初の 1 サンプルは DIR だけ出す（STEP の前に DIR を確定させる）
+            word = GpioWave_word(stepper->dir_pin, (stepper->direction > 0) ? stepper->dir_pin : 0U);
+            stepper->dir_pending = 0;
+        }
+        else if (stepper->remaining == 0U && !stepper->step_high)
+        {
+            break;
+        }
+        else
+        {
+            if (stepper->remaining > 0U)
+            {
+                // 残りのステップで start_velocity まで落とせなくなったら減速する
+                float v = stepper->velocity;
+                if ((v * v - v0_squared) >= 2.0f * stepper->acceleration * (float)stepper->remaining)
+                {
+                    v -= stepper->acceleration;
+                    if (v < stepper->start_velocity)
+                    {
+                        v = stepper->start_velocity;
+                    }
+                }
+                else if (v < stepper->max_velocity)
+                {
+                    v += stepper->acceleration;
+                    if (v > stepper->max_velocity)
+                    {
+                        v = stepper->max_velocity;
+                    }
+                }
+                stepper->velocity = v;
+                stepper->phase += v;
+            }
+
+            // STEP を Low に戻すサンプルでも位相は進める（High のサンプルと重なったら次のサンプルに出す）
+            if (stepper->step_high)
+            {
+                word = (uint32_t)stepper->step_pin << 16;
+                stepper->step_high = 0;
+            }
+            else if (stepper->phase >= 1.0f)
+            {
+                stepper->phase -= 1.0f;
+                stepper->remaining--;
+                stepper->step_high = 1;
+                word = stepper->step_pin;
+            }
+        }
+        words[i] = word;
+    }
+    return i;
+}
@@ -0,0 +1,103 @@
+#ifndef GPIO_WAVE_H_
+#define GPIO_WAVE_H_
+
+#include "stm32f4xx_hal.h"
+
+// タイマの更新イベントで DMA を起動し、BSRR に書く値の列を GPIO ポートへ流して波形を出す
+//   - 1 サンプル = BSRR への 1 回の書き込み。同じポートの複数ピンが同時に切り替わり、CPU を使わない
+//   - 出力のタイミングはタイマで決まるので、割り込みや他の処理で揺れない
+//   - 決まった波形は GpioWave_Play（1 回 / 繰り返し）、長い波形は GpioWave_Stream（半分ずつ作りながら流す）
+//   - STM32F4 で GPIO に書ける DMA は DMA2 だけなので、使えるタイマは TIM1（DMA2 Stream5 Ch6）/ TIM8（DMA2 Stream1 Ch7）
+// BSRR に 0 を書いてもピンは変わらないので、変化のないサンプルは 0 にしておけばよい
+
+// 同時に使える GpioWave の数（TIM1 と TIM8）
+#ifndef GPIO_WAVE_MAX
+#define GPIO_WAVE_MAX 2
+#endif
+
+// ストリーミングで波形を作る関数
+// words に最大 count サンプル分の BSRR の値を書き、書いた数を返す（count より少なければそこで波形が終わる）
+// DMA の割り込みから呼ばれる
+typedef uint16_t (*GpioWaveFill)(void *context, uint32_t *words, uint16_t count);
+
+typedef struct
+{
+    TIM_HandleTypeDef *htim;     // サンプル周期を作るタイマ（TIM1 / TIM8）
+    GPIO_TypeDef *port;          // 出力するポート
+    uint16_t mask;               // 出力するピン
+    uint32_t *buffer;            // ストリーミング用のバッファ（length サンプル、半分ずつ作る）
+    uint16_t length;
+    GpioWaveFill fill;           // ストリーミングで波形を作る関数
+    void *context;
+    uint32_t sample_hz;          // サンプル周波数 [Hz]
+    volatile uint8_t busy;       // 出力中なら 1
+    uint8_t ending;              // fill が波形の終わりを返した
+    uint8_t last_half;           // 波形の最後が入っている半分（0：前半、1：後半）
+} GpioWave;
+
+// 1 サンプル分の BSRR の値（mask のピンを value の通りにする。value はピンの位置のビット）
+static inline uint32_t GpioWave_word(uint16_t mask, uint16_t value)
+{
+    return ((uint32_t)(mask & (uint16_t)~value) << 16) | (mask & value);
+}
+
+// 初期化する関数（CubeMX で TIMx_UP の DMA を追加しておくこと）
+// pins: 出力するピン（出力に初期化する）、buffer / length: ストリーミング用のバッファ（使わなければ NULL / 0）
+HAL_StatusTypeDef GpioWave_Init(GpioWave *wave, TIM_HandleTypeDef *htim, GPIO_TypeDef *port, uint16_t pins,
+                                uint32_t *buffer, uint16_t length);
+
+// サンプル周波数 [Hz] を設定する関数（実際の周波数は wave->sample_hz。タイマクロックの半分まで）
+HAL_StatusTypeDef GpioWave_setSampleRate(GpioWave *wave, uint32_t sample_hz);
+
+// 決まった波形を出力する関数（words は出力が終わるまで残しておく。loop が 1 なら GpioWave_Stop まで繰り返す）
+HAL_StatusTypeDef GpioWave_Play(GpioWave *wave, const uint32_t *words, uint16_t count, uint8_t loop);
+
+// fill で半分ずつ作りながら出力する関数（fill が count より少ない数を返したら、そこまで出して止まる）
+HAL_StatusTypeDef GpioWave_Stream(GpioWave *wave, GpioWaveFill fill, void *context);
+
+void GpioWave_Stop(GpioWave *wave);
+
+static inline uint8_t GpioWave_isBusy(const GpioWave *wave)
+{
+    return wave->busy;
+}
+
+// 同じ値を samples サンプル続ける波形を words に書き、書いた数を返す
+uint16_t GpioWave_hold(uint32_t *words, uint16_t capacity, uint16_t mask, uint16_t value, uint16_t samples);
+
+// シフトレジスタ（74HC595 など）へ bytes を MSB から送る波形を words に書き、書いた数を返す（入り切らなければ 0）
+// 1 ビット 2 サンプル（データと CLK Low → CLK High）、最後に LATCH を 1 サンプル High にする
+uint16_t GpioWave_shiftOut(uint32_t *words, uint16_t capacity, uint16_t data_pin, uint16_t clock_pin,
+                           uint16_t latch_pin, const uint8_t *bytes, uint16_t count);
+
+// ステッピングモータの STEP / DIR パルス列を台形の速度で作るジェネレータ（GpioWave_Stream に渡す）
+//   - サンプルごとに速度を加速度分だけ変え、位相が 1 を越えたサンプルで STEP を 1 サンプル High にする
+//   - 残りのステップ数で止まれる速度まで落とすので、最後のステップで start_velocity に戻る
+//   - ステップのタイミングはサンプル周期に丸められる（100kHz なら 10us 刻み）
+typedef struct
+{
+    uint16_t step_pin;
+    uint16_t dir_pin;
+    int8_t direction;            // 1：DIR High、-1：DIR Low
+    uint8_t step_high;           // STEP が High のサンプルを出した
+    uint8_t dir_pending;         // 最初のサンプルで DIR を出す
+    uint32_t remaining;          // 残りのステップ数
+    float velocity;              // 今の速度 [step/sample]
+    float start_velocity;        // 最初と最後の速度 [step/sample]
+    float max_velocity;          // 最高速度 [step/sample]
+    float acceleration;          // 加速度 [step/sample^2]
+    float phase;                 // 次のステップまでの位相（1 でステップ）
+} GpioWaveStepper;
+
+void GpioWaveStepper_Init(GpioWaveStepper *stepper, uint16_t step_pin, uint16_t dir_pin);
+
+// steps ステップ（負なら逆方向）動かす設定をする関数。速度は [step/s]、加速度は [step/s^2]
+// 最高速度はサンプル周波数の半分（STEP の High と Low に 1 サンプルずつ）までに制限する
+// max_velocity が 0 以下なら HAL_ERROR（何も出さずに終わる）
+HAL_StatusTypeDef GpioWaveStepper_move(GpioWaveStepper *stepper, int32_t steps, float start_velocity,
+                                       float max_velocity, float acceleration, uint32_t sample_hz);
+
+// GpioWave_Stream に渡す fill 関数（context は GpioWaveStepper*）
+uint16_t GpioWaveStepper_fill(void *context, uint32_t *words, uint16_t count);
+
+#endif /* GPIO_WAVE_H_ */
@@ -1,37 +1,76 @@
 #include "kinematics.h"
 #include <math.h>
+#include <stddef.h>
+
+void Kinematics_Init(Kinematics *kin, float robot_diameter, float wheel_radius, WheelMode mode) {
+    kin->robot_diameter = robot_diameter;
+    kin->wheel_radius = wheel_radius;
+    kin->mode = mode;
+    Kinematics_setWheelLimits(kin, NULL, TWIST_LIMIT_UNIFORM);
+    kin->applied_lx = 0;
+    kin->applied_ly = 0;
+    kin->applied_rx = 0;
+    kin->saturated = 0;
+}
+
+void Kinematics_setWheelLimits(Kinematics *kin, const float *limits, TwistLimitPolicy policy) {
+    for (int i = 0; i < 4; i++) {
+        kin->wheel_limit[i] = limits ? limits[i] : 0;
+    }
+    kin->limit_policy = policy;
+}
 
 void Kinematics_GetTargetSpeeds(Kinematics *kin, float lx, float ly, float rx, float *speedFR, float *speedFL, float *speedBR, float *speedBL) {
     float WH = kin->wheel_radius;  // ホイール半径
     float DI = kin->robot_diameter / 2;  // ロボットの半径（中心からホイールまでの距離）
+    float K = 1.0f / (2 * M_PI * WH);   // mm/s → rps
+
+    // 各ホイール速度を並進成分と回転成分に分けて計算（FR, FL, BR, BL の順）
+    float translation[4] = {0, 0, 0, 0};
+    float rotation[4] = {0, 0, 0, 0};
+    float wheel[4];
+    int count = 4;
+    float rx_rad = rx * M_PI / 180;
 
-    // 各ホイール速度の計算
     switch (kin->mode) {
     	case OMNI_3:
     		// 120度間隔で配置された3輪オムニホイールの速度計算式
-    		rx = rx * M_PI/180;
-    		*speedFR = (lx * cos(M_PI / 3) + ly * sin(M_PI / 3) + DI * rx) / (2 * M_PI * WH);
-    		*speedFL = (lx * cos(M_PI) + ly * sin(M_PI) + DI * rx) / (2 * M_PI * WH);
-    		*speedBR = (lx * cos(-M_PI / 3) + ly * sin(-M_PI / 3) + DI * rx) / (2 * M_PI * WH);
-    		if (speedBL) *speedBL = 0; // OMNI_3では不要
+    		translation[0] = (lx * cos(M_PI / 3) + ly * sin(M_PI / 3)) * K;
+    		translation[1] = (lx * cos(M_PI) + ly * sin(M_PI)) * K;
+    		translation[2] = (lx * cos(-M_PI / 3) + ly * sin(-M_PI / 3)) * K;
+    		count = 3; // OMNI_3では BL は不要
     		break;
 
         case OMNI_4:
             // OMNI_4 モードの速度計算式（ホイールが90度ごとに配置されている場合）
-        	 rx = rx * M_PI/180;
-            *speedFR = (-(sqrt(2) / 2) * lx + (sqrt(2) / 2) * ly + DI * rx) / (2 * M_PI * WH);
-            *speedFL = ((sqrt(2) / 2) * lx + (sqrt(2) / 2) * ly + DI * rx) / (2 * M_PI * WH);
-            *speedBR = ((sqrt(2) / 2) * lx - (sqrt(2) / 2) * ly + DI * rx) / (2 * M_PI * WH);
-            *speedBL = (-(sqrt(2) / 2) * lx - (sqrt(2) / 2) * ly + DI * rx) / (2 * M_PI * WH);
+            translation[0] = (-(sqrt(2) / 2) * lx + (sqrt(2) / 2) * ly) * K;
+            translation[1] = ((sqrt(2) / 2) * lx + (sqrt(2) / 2) * ly) * K;
+            translation[2] = ((sqrt(2) / 2) * lx - (sqrt(2) / 2) * ly) * K;
+            translation[3] = (-(sqrt(2) / 2) * lx - (sqrt(2) / 2) * ly) * K;
             break;
 
         case MEKANUM:
             // MEKANUM モードの速度計算式（メカナムホイール特有の動き）
-        	 rx = rx * M_PI/180;
-            *speedFR = ((lx - ly) / sqrt(2) + DI * rx) / (2 * M_PI * WH);
-            *speedFL = ((-lx - ly) / sqrt(2) + DI * rx) / (2 * M_PI * WH);
-            *speedBR = ((-lx + ly) / sqrt(2) + DI * rx) / (2 * M_PI * WH);
-            *speedBL = ((lx + ly) / sqrt(2) + DI * rx) / (2 * M_PI * WH);
+            translation[0] = ((lx - ly) / sqrt(2)) * K;
+            translation[1] = ((-lx - ly) / sqrt(2)) * K;
+            translation[2] = ((-lx + ly) / sqrt(2)) * K;
+            translation[3] = ((lx + ly) / sqrt(2)) * K;
             break;
     }
+    for (int i = 0; i < count; i++) {
+        rotation[i] = DI * rx_rad * K;
+    }
+
+    // 車輪の飽和を解いて、全車輪が上限に収まる機体速度にする
+    float st, sr;
+    TwistLimit_solve(translation, rotation, kin->wheel_limit, count, kin->limit_policy, wheel, &st, &sr);
+    kin->applied_lx = lx * st;
+    kin->applied_ly = ly * st;
+    kin->applied_rx = rx * sr;
+    kin->saturated = (st < 1.0f || sr < 1.0f);
+
+    *speedFR = wheel[0];
+    *speedFL = wheel[1];
+    *speedBR = wheel[2];
+    if (speedBL) *speedBL = (count == 4) ? wheel[3] : 0;
 }
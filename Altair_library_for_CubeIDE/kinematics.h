@@ -3,6 +3,8 @@
 #ifndef KINEMATICS_H
 #define KINEMATICS_H
 
+#include "twist_limit.h"
+
 typedef enum {
     OMNI_3,
     OMNI_4,
@@ -13,12 +15,26 @@ typedef struct {
     float robot_diameter;   // ロボットの直径
     float wheel_radius;     // ホイールの半径
     WheelMode mode;         // 動作モード
+
+    // 車輪の上限 [rps]（FR, FL, BR, BL の順、0 で制限なし）と飽和時の方針
+    float wheel_limit[4];
+    TwistLimitPolicy limit_policy;
+
+    // 直前の Kinematics_GetTargetSpeeds で実際に出した機体速度（飽和で縮めた後）
+    float applied_lx;
+    float applied_ly;
+    float applied_rx;
+    int saturated;
 } Kinematics;
 
-// 初期化関数
+// 初期化関数（車輪の上限なし）
 void Kinematics_Init(Kinematics *kinematics, float robot_diameter, float wheel_radius, WheelMode mode);
 
+// 車輪の上限 [rps] と飽和時の方針を設定する（limits は FR, FL, BR, BL の順。NULL で制限なし）
+void Kinematics_setWheelLimits(Kinematics *kinematics, const float *limits, TwistLimitPolicy policy);
+
 // モーターの目標速度を計算する関数
+// 上限を超える車輪があると、方針に従って機体速度を縮めてから各車輪の速度を求める
 void Kinematics_GetTargetSpeeds(Kinematics *kinematics, float lx, float ly, float rx, float *speedFR, float *speedFL, float *speedBR, float *speedBL);
 
 #endif // KINEMATICS_H
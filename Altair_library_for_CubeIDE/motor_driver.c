@@ -6,8 +6,8 @@
 // を用意すると、その値が使用される
 __attribute__((weak)) uint32_t g_motor_driver_default_pwm_hz = MOTOR_DRIVER_DEFAULT_PWM_HZ;
 
-// タイマクロックを取得する内部関数
-static uint32_t MotorDriver_GetTimerClock(TIM_HandleTypeDef *htim)
+// タイマクロックを取得する関数（servo_group からも使う）
+uint32_t MotorDriver_GetTimerClock(TIM_HandleTypeDef *htim)
 {
     RCC_ClkInitTypeDef clkconfig;
     uint32_t flashLatency;
@@ -45,36 +45,51 @@ static uint32_t MotorDriver_GetTimerClock(TIM_HandleTypeDef *htim)
     }
 }
 
-// 1 つのタイマを指定周波数に設定する内部関数
-static HAL_StatusTypeDef MotorDriver_ConfigTimerFrequency(TIM_HandleTypeDef *htim, uint32_t frequency_hz)
+// タイマクロックと周波数から、ARR が 16bit に収まる最小のプリスケーラと ARR を求める関数（stepper からも使う）
+HAL_StatusTypeDef MotorDriver_CalcTimerDivider(uint32_t tim_clk, uint32_t frequency_hz, uint32_t *prescaler, uint32_t *arr)
 {
-    if (frequency_hz == 0U)
+    if (frequency_hz == 0U || tim_clk == 0U)
     {
         return HAL_ERROR;
     }
 
-    uint32_t tim_clk = MotorDriver_GetTimerClock(htim);
-    if (tim_clk == 0U)
+    // 1 周期のカウント数が 65536 以下になる (PSC+1) の最小値（レジスタ値は (PSC+1) なので 1 を引く）
+    uint64_t counts = ((uint64_t)frequency_hz * 65536ULL);
+    uint32_t psc = (uint32_t)(((uint64_t)tim_clk + counts - 1U) / counts);
+    if (psc > 0U)
     {
-        return HAL_ERROR;
+        psc -= 1U;
+    }
+    if (psc > 0xFFFFU)
+    {
+        psc = 0xFFFFU;
     }
 
-    // ARR が 16bit に収まるようにプリスケーラを計算
-    uint32_t prescaler = tim_clk / (frequency_hz * 65536UL);
-    if (prescaler > 0U)
+    uint32_t timer_freq = tim_clk / (psc + 1U);
+    uint32_t period = timer_freq / frequency_hz;
+    if (period == 0U)
     {
-        prescaler -= 1U;  // レジスタ値は (PSC+1) なので 1 を引く
+        return HAL_ERROR;
     }
-    if (prescaler > 0xFFFFU)
+    if (period > 0x10000U)
     {
-        prescaler = 0xFFFFU;
+        period = 0x10000U;
     }
 
-    uint32_t timer_freq = tim_clk / (prescaler + 1U);
-    uint32_t arr = (timer_freq / frequency_hz) - 1U;
-    if (arr > 0xFFFFU)
+    *prescaler = psc;
+    *arr = period - 1U;
+    return HAL_OK;
+}
+
+// 1 つのタイマを指定周波数に設定する内部関数
+static HAL_StatusTypeDef MotorDriver_ConfigTimerFrequency(TIM_HandleTypeDef *htim, uint32_t frequency_hz)
+{
+    uint32_t prescaler;
+    uint32_t arr;
+
+    if (MotorDriver_CalcTimerDivider(MotorDriver_GetTimerClock(htim), frequency_hz, &prescaler, &arr) != HAL_OK)
     {
-        arr = 0xFFFFU;
+        return HAL_ERROR;
     }
 
     // タイマ設定の反映
@@ -90,6 +105,19 @@ static HAL_StatusTypeDef MotorDriver_ConfigTimerFrequency(TIM_HandleTypeDef *hti
     return HAL_OK;
 }
 
+// ARR から 1% あたりのカウント値を事前計算する内部関数
+static void MotorDriver_UpdateScale(MotorDriver *motor)
+{
+    motor->arr = __HAL_TIM_GET_AUTORELOAD(motor->htimA);
+    motor->scale_q16 = ((uint64_t)motor->arr << 16) / 100U;
+}
+
+// 速度（-99〜99）から CCR 値を求める内部関数（除算なし）
+static uint32_t MotorDriver_SpeedToCompare(const MotorDriver *motor, uint32_t abs_speed)
+{
+    return (uint32_t)(((uint64_t)abs_speed * motor->scale_q16) >> 16);
+}
+
 // 初期化関数
 void MotorDriver_Init(MotorDriver* motor, TIM_HandleTypeDef* htimA, uint32_t channelA,
                       TIM_HandleTypeDef* htimB, uint32_t channelB) {
@@ -97,6 +125,7 @@ void MotorDriver_Init(MotorDriver* motor, TIM_HandleTypeDef* htimA, uint32_t cha
     motor->channelA = channelA;
     motor->htimB = htimB;
     motor->channelB = channelB;
+    motor->decay_mode = MOTOR_DRIVER_COAST;
 
     // PWM開始
     HAL_TIM_PWM_Start(htimA, channelA);
@@ -107,30 +136,58 @@ void MotorDriver_Init(MotorDriver* motor, TIM_HandleTypeDef* htimA, uint32_t cha
     // 優先度: ユーザー定義変数 > MOTOR_DRIVER_DEFAULT_PWM_HZ マクロ
     MotorDriver_setPwmFrequency(motor, g_motor_driver_default_pwm_hz);
 #endif
+
+    MotorDriver_UpdateScale(motor);
 }
 
 // 速度設定関数
 void MotorDriver_setSpeed(MotorDriver *motor, int speed) {
-	int pwm_value;
+	uint32_t pwm_value;
     if (speed > 100) speed = 99;
     if (speed < -100) speed = -99;
 
     if (speed > 0) {
-        pwm_value = (speed * __HAL_TIM_GET_AUTORELOAD(motor->htimA)) / 100;
+        pwm_value = MotorDriver_SpeedToCompare(motor, (uint32_t)speed);
         __HAL_TIM_SET_COMPARE(motor->htimA, motor->channelA, pwm_value);
         __HAL_TIM_SET_COMPARE(motor->htimB, motor->channelB, 0);
     } else {
-        pwm_value = (-speed * __HAL_TIM_GET_AUTORELOAD(motor->htimA)) / 100;
+        pwm_value = MotorDriver_SpeedToCompare(motor, (uint32_t)(-speed));
+        __HAL_TIM_SET_COMPARE(motor->htimA, motor->channelA, 0);
+        __HAL_TIM_SET_COMPARE(motor->htimB, motor->channelB, pwm_value);
+    }
+}
+
+// Duty 設定関数（小数指定）
+void MotorDriver_setDuty(MotorDriver *motor, float duty) {
+    uint32_t pwm_value;
+
+    if (duty > 1.0f) duty = 1.0f;
+    if (duty < -1.0f) duty = -1.0f;
+
+    if (duty > 0.0f) {
+        pwm_value = (uint32_t)(duty * (float)motor->arr + 0.5f);
+        __HAL_TIM_SET_COMPARE(motor->htimA, motor->channelA, pwm_value);
+        __HAL_TIM_SET_COMPARE(motor->htimB, motor->channelB, 0);
+    } else if (duty < 0.0f) {
+        pwm_value = (uint32_t)(-duty * (float)motor->arr + 0.5f);
         __HAL_TIM_SET_COMPARE(motor->htimA, motor->channelA, 0);
         __HAL_TIM_SET_COMPARE(motor->htimB, motor->channelB, pwm_value);
+    } else if (motor->decay_mode == MOTOR_DRIVER_BRAKE) {
+        MotorDriver_Stop(motor);
+    } else {
+        __HAL_TIM_SET_COMPARE(motor->htimA, motor->channelA, 0);
+        __HAL_TIM_SET_COMPARE(motor->htimB, motor->channelB, 0);
     }
 }
 
+void MotorDriver_setDecayMode(MotorDriver *motor, MotorDriverDecayMode decay_mode) {
+    motor->decay_mode = decay_mode;
+}
+
 // ショートブレーキ（両ch をフル Duty に設定）
 void MotorDriver_Stop(MotorDriver *motor) {
-    uint32_t arr = __HAL_TIM_GET_AUTORELOAD(motor->htimA);
-    __HAL_TIM_SET_COMPARE(motor->htimA, motor->channelA, arr);
-    __HAL_TIM_SET_COMPARE(motor->htimB, motor->channelB, arr);
+    __HAL_TIM_SET_COMPARE(motor->htimA, motor->channelA, motor->arr);
+    __HAL_TIM_SET_COMPARE(motor->htimB, motor->channelB, motor->arr);
 }
 
 // MotorDriver で使用するタイマの PWM 周波数を設定する関数
@@ -146,5 +203,92 @@ HAL_StatusTypeDef MotorDriver_setPwmFrequency(MotorDriver *motor, uint32_t frequ
     }
 
     status = MotorDriver_ConfigTimerFrequency(motor->htimB, frequency_hz);
+    MotorDriver_UpdateScale(motor);
     return status;
 }
+
+// グループにタイマを重複なしで登録する内部関数
+static void MotorGroup_AddTimer(MotorGroup *group, TIM_HandleTypeDef *htim)
+{
+    uint8_t i;
+    for (i = 0; i < group->timer_count; i++) {
+        if (group->timers[i] == htim) {
+            return;
+        }
+    }
+    group->timers[group->timer_count++] = htim;
+}
+
+// 更新イベントを止める／再開する内部関数
+// UDIS を立てている間は CCR の書き込みがプリロードレジスタに留まり、途中の組み合わせが出力されない
+static void MotorGroup_HoldUpdate(MotorGroup *group)
+{
+    uint8_t i;
+    for (i = 0; i < group->timer_count; i++) {
+        group->timers[i]->Instance->CR1 |= TIM_CR1_UDIS;
+    }
+}
+
+static void MotorGroup_ReleaseUpdate(MotorGroup *group)
+{
+    uint8_t i;
+    for (i = 0; i < group->timer_count; i++) {
+        group->timers[i]->Instance->CR1 &= ~TIM_CR1_UDIS;
+    }
+}
+
+HAL_StatusTypeDef MotorGroup_Init(MotorGroup *group, MotorDriver *const *motors, uint8_t motor_count)
+{
+    uint32_t primask;
+    uint8_t i;
+
+    if (group == NULL || motors == NULL || motor_count == 0U || motor_count > MOTOR_GROUP_MAX_MOTORS) {
+        return HAL_ERROR;
+    }
+
+    group->motor_count = motor_count;
+    group->timer_count = 0;
+    for (i = 0; i < motor_count; i++) {
+        group->motors[i] = motors[i];
+        MotorDriver_UpdateScale(motors[i]);
+        MotorGroup_AddTimer(group, motors[i]->htimA);
+        MotorGroup_AddTimer(group, motors[i]->htimB);
+
+        // CCR プリロード有効化（書き込みは更新イベントで反映される）
+        __HAL_TIM_ENABLE_OCxPRELOAD(motors[i]->htimA, motors[i]->channelA);
+        __HAL_TIM_ENABLE_OCxPRELOAD(motors[i]->htimB, motors[i]->channelB);
+    }
+
+    // ARR プリロード有効化と、全タイマのカウンタ位相合わせ
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for (i = 0; i < group->timer_count; i++) {
+        group->timers[i]->Instance->CR1 |= TIM_CR1_ARPE;
+        __HAL_TIM_SET_COUNTER(group->timers[i], 0U);
+    }
+    __set_PRIMASK(primask);
+
+    return HAL_OK;
+}
+
+void MotorGroup_setSpeeds(MotorGroup *group, const int *speeds)
+{
+    uint8_t i;
+
+    MotorGroup_HoldUpdate(group);
+    for (i = 0; i < group->motor_count; i++) {
+        MotorDriver_setSpeed(group->motors[i], speeds[i]);
+    }
+    MotorGroup_ReleaseUpdate(group);
+}
+
+void MotorGroup_Stop(MotorGroup *group)
+{
+    uint8_t i;
+
+    MotorGroup_HoldUpdate(group);
+    for (i = 0; i < group->motor_count; i++) {
+        MotorDriver_Stop(group->motors[i]);
+    }
+    MotorGroup_ReleaseUpdate(group);
+}
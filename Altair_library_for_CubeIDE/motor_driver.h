@@ -14,13 +14,35 @@
 #define MOTOR_DRIVER_DEFAULT_PWM_HZ 980U
 #endif
 
+// MotorGroup で同時に更新できるモータ数の上限
+#ifndef MOTOR_GROUP_MAX_MOTORS
+#define MOTOR_GROUP_MAX_MOTORS 4
+#endif
+
+// 出力 0 のときの停止方法
+typedef enum {
+    MOTOR_DRIVER_COAST,  // フリーラン（両ch 0%）
+    MOTOR_DRIVER_BRAKE   // ショートブレーキ（両ch 100%）
+} MotorDriverDecayMode;
+
 typedef struct {
     TIM_HandleTypeDef* htimA;  // タイマーA
     uint32_t channelA;         // タイマーチャンネルA
     TIM_HandleTypeDef* htimB;  // タイマーB
     uint32_t channelB;         // タイマーチャンネルB
+    uint32_t arr;              // ARR のキャッシュ
+    uint64_t scale_q16;        // 1% あたりのカウント値（Q16 固定小数点、ARR から事前計算。32bit タイマの ARR でもあふれないよう 64bit）
+    MotorDriverDecayMode decay_mode; // MotorDriver_setDuty で 0 を指定したときの停止方法
 } MotorDriver;
 
+// 複数モータの PWM を同じ PWM 周期で一斉に切り替えるためのグループ
+typedef struct {
+    MotorDriver* motors[MOTOR_GROUP_MAX_MOTORS];
+    uint8_t motor_count;
+    TIM_HandleTypeDef* timers[MOTOR_GROUP_MAX_MOTORS * 2];  // 重複を除いたタイマ一覧
+    uint8_t timer_count;
+} MotorGroup;
+
 // モータードライバを初期化する関数
 void MotorDriver_Init(MotorDriver* motor, TIM_HandleTypeDef* htimA, uint32_t channelA,
                       TIM_HandleTypeDef* htimB, uint32_t channelB);
@@ -28,10 +50,33 @@ void MotorDriver_Init(MotorDriver* motor, TIM_HandleTypeDef* htimA, uint32_t cha
 // モーターの速度を設定する関数（-100〜100）
 void MotorDriver_setSpeed(MotorDriver* motor, int speed);
 
+// モーターの Duty を小数で設定する関数（-1.0〜1.0、ARR の分解能で出力）
+void MotorDriver_setDuty(MotorDriver* motor, float duty);
+
+// MotorDriver_setDuty で 0 を指定したときの停止方法を設定する関数
+void MotorDriver_setDecayMode(MotorDriver* motor, MotorDriverDecayMode decay_mode);
+
 // モーターをブレーキ停止する関数（両ch High = ショートブレーキ）
 void MotorDriver_Stop(MotorDriver* motor);
 
 // PWM 周波数を設定する関数（例: frequency_hz = 980）
 HAL_StatusTypeDef MotorDriver_setPwmFrequency(MotorDriver* motor, uint32_t frequency_hz);
 
+// タイマのカウンタに入るクロック [Hz] を返す関数（APB の分周を考慮）
+uint32_t MotorDriver_GetTimerClock(TIM_HandleTypeDef* htim);
+
+// タイマクロックと周波数から、ARR が 16bit に収まる最小のプリスケーラと ARR を求める関数
+HAL_StatusTypeDef MotorDriver_CalcTimerDivider(uint32_t tim_clk, uint32_t frequency_hz, uint32_t* prescaler, uint32_t* arr);
+
+// モータグループを初期化する関数
+// 全チャンネルの CCR プリロードと ARR プリロードを有効にし、タイマのカウンタを揃える
+HAL_StatusTypeDef MotorGroup_Init(MotorGroup* group, MotorDriver* const* motors, uint8_t motor_count);
+
+// 全モータの速度を設定する関数（-100〜100、speeds[i] が motors[i] に対応）
+// 書き込みは次の更新イベントで全チャンネル同時に反映される
+void MotorGroup_setSpeeds(MotorGroup* group, const int* speeds);
+
+// 全モータを同時にブレーキ停止する関数
+void MotorGroup_Stop(MotorGroup* group);
+
 #endif /* MOTOR_DRIVER_H */
@@ -0,0 +1,81 @@
+#include "motor_output.h"
+
+#define MOTOR_OUTPUT_ZERO_THRESHOLD 1e-3f
+
+void MotorOutput_Init(MotorOutput *output)
+{
+    MotorOutputConfig config = {0.0f, 0.0f, 0.0f, 0.95f};
+
+    output->duty = 0.0f;
+    MotorOutput_setConfig(output, &config);
+}
+
+void MotorOutput_setConfig(MotorOutput *output, const MotorOutputConfig *config)
+{
+    output->config = *config;
+    output->deadband_gain = (config->max_duty > 0.0f) ? (config->max_duty - config->deadband) / config->max_duty : 0.0f;
+}
+
+// 不感帯補償（ごく小さい指令は 0 のまま）
+static float MotorOutput_CompensateDeadband(const MotorOutput *output, float u)
+{
+    if (output->config.deadband <= 0.0f)
+    {
+        return u;
+    }
+    if (u > MOTOR_OUTPUT_ZERO_THRESHOLD)
+    {
+        return output->config.deadband + u * output->deadband_gain;
+    }
+    else if (u < -MOTOR_OUTPUT_ZERO_THRESHOLD)
+    {
+        return -output->config.deadband + u * output->deadband_gain;
+    }
+    return 0.0f;
+}
+
+float MotorOutput_update(MotorOutput *output, float control, float target_rps, float dt)
+{
+    return MotorOutput_updateLimited(output, control, target_rps, dt, output->config.max_duty);
+}
+
+float MotorOutput_updateLimited(MotorOutput *output, float control, float target_rps, float dt, float limit)
+{
+    const MotorOutputConfig *config = &output->config;
+    float u;
+    float max_step;
+    float step;
+    float top;
+
+    if (limit > config->max_duty) limit = config->max_duty;
+    if (limit < 0.0f) limit = 0.0f;
+
+    u = control + MotorOutput_getFeedforward(output, target_rps);
+    if (u > limit) u = limit;
+    if (u < -limit) u = -limit;
+    u = MotorOutput_CompensateDeadband(output, u);
+
+    // スルーレート制限（周期が揺れても変化率 [duty / s] が slew_rate を超えない）
+    max_step = (config->slew_rate > 0.0f) ? config->slew_rate * dt : config->max_duty * 2.0f;
+    step = u - output->duty;
+    if (step > max_step) step = max_step;
+    if (step < -max_step) step = -max_step;
+    output->duty += step;
+
+    // 上限を下げた周期は、スルーレートを待たずに上限まで下げる
+    top = MotorOutput_CompensateDeadband(output, limit);
+    if (output->duty > top) output->duty = top;
+    if (output->duty < -top) output->duty = -top;
+
+    return output->duty;
+}
+
+float MotorOutput_getFeedforward(const MotorOutput *output, float target_rps)
+{
+    return output->config.kv * target_rps;
+}
+
+void MotorOutput_reset(MotorOutput *output)
+{
+    output->duty = 0.0f;
+}
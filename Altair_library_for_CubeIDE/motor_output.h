@@ -0,0 +1,37 @@
+#ifndef MOTOR_OUTPUT_H
+#define MOTOR_OUTPUT_H
+
+// PID 出力とモータドライバの間に入れる出力整形段
+//   - 逆起電力フィードフォワード（目標 RPS × kV）
+//   - 静止摩擦の不感帯補償
+//   - Duty 変化率（スルーレート）制限（1 回に動かせる量は、MotorOutput_update に渡す実測の周期 dt から決める）
+// 出力は -max_duty〜max_duty の Duty（MotorDriver_setDuty にそのまま渡せる）
+
+typedef struct
+{
+    float kv;        // フィードフォワードゲイン [duty / rps]（0 で無効）
+    float deadband;  // 静止摩擦を超えるのに必要な最小 Duty（0 で無効）
+    float slew_rate; // Duty の最大変化率 [duty / s]（0 で無効）
+    float max_duty;  // Duty の上限
+} MotorOutputConfig;
+
+typedef struct
+{
+    MotorOutputConfig config;
+    float duty;          // 前回出力した Duty
+    float deadband_gain; // [0, max_duty] を [deadband, max_duty] に写像する傾き
+} MotorOutput;
+
+void MotorOutput_Init(MotorOutput *output);
+void MotorOutput_setConfig(MotorOutput *output, const MotorOutputConfig *config);
+// dt: 前回の呼び出しからの経過時間 [s]（制御ループで実測した値）
+float MotorOutput_update(MotorOutput *output, float control, float target_rps, float dt);
+// limit: この周期の Duty の上限（安全監視で絞るときなど。max_duty より大きければ max_duty）
+// PID の出力制限を -limit - ff〜limit - ff（ff はフィードフォワードの合計）にしておくと、
+// ここで上限に張り付くのと PID の飽和が一致し、アンチワインドアップが実際の飽和で効く
+float MotorOutput_updateLimited(MotorOutput *output, float control, float target_rps, float dt, float limit);
+// 目標回転数に対するフィードフォワード [duty]
+float MotorOutput_getFeedforward(const MotorOutput *output, float target_rps);
+void MotorOutput_reset(MotorOutput *output);
+
+#endif /* MOTOR_OUTPUT_H */
@@ -0,0 +1,42 @@
+#ifndef MSG_SCHEMA_H_
+#define MSG_SCHEMA_H_
+
+#include "msg_core.h"
+
+// ライブラリのメッセージ定義（CubeIDE / mbed / Arduino と PC 側で同一内容）
+// フィールドを追加するときは、ここで定義の最後に足してバージョンを上げるだけで、全ポートの pack / unpack が変わる
+// メッセージ ID は 0x00〜0x7F をライブラリ、0x80〜0xFF を利用者のメッセージに使う
+
+// MDD のコマンドID（SkenMdd / CanMdd 共通）
+typedef enum MddCommandId {
+    MOTOR_RPS_COMMAND_MODE = 0,
+    MOTOR_PWM_COMMAND_MODE,
+    MECANUM_MODE,
+    OMNI3_MODE,
+    OMNI4_MODE,
+    M1_PID_GAIN_CONFIG,
+    M2_PID_GAIN_CONFIG,
+    M3_PID_GAIN_CONFIG,
+    M4_PID_GAIN_CONFIG,
+    ROBOT_DIAMETER_CONFIG,
+    PID_RESET_COMMAND,
+    MOTOR_COMMAND_MODE_SELECT,
+    ENCODER_RESOLUTION_CONFIG
+} MddCommandId;
+
+// 利用者のメッセージ ID の始まり
+#define MSG_ID_USER 0x80
+
+// マスタ → MDD：コマンド（SkenMdd の MDD_FRAME_COBS）
+#define MDD_COMMAND_FIELDS(FIELD, ARRAY) \
+    FIELD(uint8_t, seq)                  \
+    FIELD(uint8_t, command)              \
+    ARRAY(float, data, 4)
+MSG_DEFINE(MddCommand, 0x10, 1, MDD_COMMAND_FIELDS)
+
+// MDD → マスタ：受け取ったコマンドの seq
+#define MDD_REPLY_FIELDS(FIELD, ARRAY) \
+    FIELD(uint8_t, seq)
+MSG_DEFINE(MddReply, 0x11, 1, MDD_REPLY_FIELDS)
+
+#endif /* MSG_SCHEMA_H_ */
@@ -2,32 +2,27 @@
 
 void Pid_Init(Pid *pid)
 {
-    pid->integral_error = 0;
-    pid->before_error = 0;
-    pid->kp = 0;
-    pid->ki = 0;
-    pid->kd = 0;
-    pid->d_error = 0;
+    PidCore_Init(&pid->core);
     pid->p_control = 0;
     pid->i_control = 0;
     pid->d_control = 0;
-    pid->time_constant = 0;
     pid->integral_limit = 0;
     pid->output_invert = 1;
 }
 
+// time_constant は微分フィルタの時定数 [ms]
 void Pid_setGain(Pid *pid, double p_gain, double i_gain, double d_gain, double time_constant)
 {
-    pid->kp = p_gain;
-    pid->ki = i_gain;
-    pid->kd = d_gain;
-    pid->time_constant = (time_constant > 0) ? time_constant : 0;
+    PidCore_setGain(&pid->core, (float)p_gain, (float)i_gain, (float)d_gain,
+                    (time_constant > 0) ? (float)(time_constant / 1000.0) : 0.0f);
+    // 積分誤差の上限を I 項の上限に換算
+    pid->core.i_limit = (float)(pid->integral_limit * i_gain);
 }
 
 void Pid_setGainWithLimit(Pid *pid, double p_gain, double i_gain, double d_gain, double time_constant, double integral_limit)
 {
-    Pid_setGain(pid, p_gain, i_gain, d_gain, time_constant);
     pid->integral_limit = (integral_limit > 0.0) ? integral_limit : 0.0;
+    Pid_setGain(pid, p_gain, i_gain, d_gain, time_constant);
 }
 
 void Pid_setInvert(Pid *pid, int invert)
@@ -42,58 +37,42 @@ void Pid_setInvert(Pid *pid, int invert)
     }
 }
 
-double Pid_control(Pid *pid, double target, double now, int control_period)
+// 出力（反転前）の上下限。飽和中は積分を止めて I 項を戻す（アンチワインドアップ）
+void Pid_setOutputLimit(Pid *pid, double output_min, double output_max)
 {
-    return Pid_controlError(pid, target - now, control_period);
+    PidCore_setOutputLimit(&pid->core, (float)output_min, (float)output_max);
 }
 
-double Pid_controlError(Pid *pid, double error, int control_period)
+// 2 自由度 PID の目標値重み（P 項: p_weight, D 項: d_weight）。既定は 1, 0
+void Pid_setSetpointWeight(Pid *pid, double p_weight, double d_weight)
 {
-    pid->p_control = error * pid->kp;
-
-    if (control_period > 0)
-    {
-        pid->integral_error += error * (control_period / 1000.0);
-    }
-
-    if (pid->integral_limit > 0.0)
-    {
-        if (pid->integral_error > pid->integral_limit)
-        {
-            pid->integral_error = pid->integral_limit;
-        }
-        else if (pid->integral_error < -pid->integral_limit)
-        {
-            pid->integral_error = -pid->integral_limit;
-        }
-    }
-
-    pid->i_control = pid->integral_error * pid->ki;
+    PidCore_setSetpointWeight(&pid->core, (float)p_weight, (float)d_weight);
+}
 
-    if (pid->time_constant != 0)
-    {
-        double alpha = pid->time_constant / (pid->time_constant + control_period);
-        pid->d_error = pid->before_error * alpha + (1 - alpha) * error;
-    }
-    else
-    {
-        pid->d_error = error;
-    }
+static double Pid_output(Pid *pid, float output)
+{
+    pid->p_control = pid->core.p_term;
+    pid->i_control = pid->core.i_term;
+    pid->d_control = pid->core.d_term;
+    return output * pid->output_invert;
+}
 
-    if (control_period != 0)
-    {
-        pid->d_control = ((pid->d_error - pid->before_error) / (control_period / 1000.0)) * pid->kd;
-    }
+// control_period は制御周期 [ms]（小数可）
+double Pid_control(Pid *pid, double target, double now, double control_period)
+{
+    float dt = (control_period > 0) ? (float)(control_period / 1000.0) : 0.0f;
+    return Pid_output(pid, PidCore_update(&pid->core, (float)target, (float)now, dt));
+}
 
-    pid->before_error = error;
-    return (pid->p_control + pid->i_control + pid->d_control) * pid->output_invert;
+double Pid_controlError(Pid *pid, double error, double control_period)
+{
+    float dt = (control_period > 0) ? (float)(control_period / 1000.0) : 0.0f;
+    return Pid_output(pid, PidCore_updateError(&pid->core, (float)error, dt));
 }
 
 void Pid_reset(Pid *pid)
 {
-    pid->integral_error = 0;
-    pid->before_error = 0;
-    pid->d_error = 0;
+    PidCore_reset(&pid->core);
 }
 
 double Pid_getControlValue(Pid *pid, ControlType control_type)
@@ -1,6 +1,8 @@
 #ifndef PID_H_
 #define PID_H_
 
+#include "pid_core.h"
+
 typedef enum
 {
     P,
@@ -10,17 +12,11 @@ typedef enum
 
 typedef struct
 {
-    double integral_error;
-    double before_error;
-    double kp;
-    double ki;
-    double kd;
-    double d_error;
+    PidCore core;           // PID 演算コア（pid_core.h）
     double p_control;
     double i_control;
     double d_control;
-    double time_constant;
-    double integral_limit;
+    double integral_limit;  // 積分誤差の絶対値上限（0で無制限）
     int output_invert;
 } Pid;
 
@@ -28,8 +24,10 @@ void Pid_Init(Pid *pid);
 void Pid_setGain(Pid *pid, double p_gain, double i_gain, double d_gain, double time_constant);
 void Pid_setGainWithLimit(Pid *pid, double p_gain, double i_gain, double d_gain, double time_constant, double integral_limit);
 void Pid_setInvert(Pid *pid, int invert);
-double Pid_control(Pid *pid, double target, double now, int control_period);
-double Pid_controlError(Pid *pid, double error, int control_period);
+void Pid_setOutputLimit(Pid *pid, double output_min, double output_max);
+void Pid_setSetpointWeight(Pid *pid, double p_weight, double d_weight);
+double Pid_control(Pid *pid, double target, double now, double control_period);
+double Pid_controlError(Pid *pid, double error, double control_period);
 void Pid_reset(Pid *pid);
 double Pid_getControlValue(Pid *pid, ControlType control_type);
 
@@ -0,0 +1,146 @@
+#ifndef PID_CORE_H_
+#define PID_CORE_H_
+
+// C / C++ 共通の PID 演算コア（ヘッダのみ、動的確保なし）
+//   - 2 自由度 PID：P 項は b*r - y、D 項は c*r - y に作用（b=1, c=0 が既定＝微分先行型）
+//   - D 項は一次遅れフィルタ付き（時定数 tf [s]）
+//   - アンチワインドアップ：出力飽和中に飽和方向へ積分しない条件付き積分 + バックカリキュレーション
+//   - 制御周期 dt [s] は毎回渡す（ms 未満の周期も可）
+// CubeIDE の pid.c、mbed / Arduino の PIDController.h はこのコアを使う（3 ポートで同一内容）
+
+#include <float.h>
+
+typedef struct
+{
+    float kp;
+    float ki;
+    float kd;
+    float tf;               // D 項フィルタの時定数 [s]（0 でフィルタなし）
+    float b;                // P 項の目標値重み
+    float c;                // D 項の目標値重み
+    float out_min;          // 出力下限
+    float out_max;          // 出力上限
+    float kt;               // バックカリキュレーションのゲイン [1/s]（0 で無効）
+    float i_limit;          // I 項の絶対値上限（0 で無制限）
+
+    float p_term;           // 直前の P 項
+    float i_term;           // I 項（出力と同じ単位で保持するため、ゲイン変更で出力が跳ねない）
+    float d_term;           // 直前の D 項（フィルタ後）
+    float prev_d_input;     // 前回の c*r - y
+    unsigned char initialized;
+} PidCore;
+
+static inline void PidCore_reset(PidCore *pid)
+{
+    pid->p_term = 0.0f;
+    pid->i_term = 0.0f;
+    pid->d_term = 0.0f;
+    pid->prev_d_input = 0.0f;
+    pid->initialized = 0;
+}
+
+static inline void PidCore_setGain(PidCore *pid, float kp, float ki, float kd, float tf)
+{
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->tf = (tf > 0.0f) ? tf : 0.0f;
+    // バックカリキュレーションの既定値は 1/Ti（= ki/kp）
+    pid->kt = (kp > 0.0f) ? ki / kp : ki;
+}
+
+static inline void PidCore_Init(PidCore *pid)
+{
+    pid->kp = 0.0f;
+    pid->ki = 0.0f;
+    pid->kd = 0.0f;
+    pid->tf = 0.0f;
+    pid->b = 1.0f;
+    pid->c = 0.0f;
+    pid->out_min = -FLT_MAX;
+    pid->out_max = FLT_MAX;
+    pid->kt = 0.0f;
+    pid->i_limit = 0.0f;
+    PidCore_reset(pid);
+}
+
+static inline void PidCore_setOutputLimit(PidCore *pid, float out_min, float out_max)
+{
+    pid->out_min = out_min;
+    pid->out_max = out_max;
+}
+
+static inline void PidCore_setSetpointWeight(PidCore *pid, float b, float c)
+{
+    pid->b = b;
+    pid->c = c;
+}
+
+// error: 積分に使う誤差、p_input: P 項の入力、d_input: D 項の入力
+static inline float PidCore_step(PidCore *pid, float error, float p_input, float d_input, float dt)
+{
+    float v;
+    float u;
+    float back;
+
+    if (!pid->initialized)
+    {
+        // 初回は微分の基準値だけを取る（起動時の微分キックを防ぐ）
+        pid->prev_d_input = d_input;
+        pid->initialized = 1;
+    }
+
+    pid->p_term = pid->kp * p_input;
+
+    if (dt > 0.0f)
+    {
+        // 後退差分による一次遅れ付き微分
+        float denom = pid->tf + dt;
+        pid->d_term = (pid->tf / denom) * pid->d_term + (pid->kd / denom) * (d_input - pid->prev_d_input);
+    }
+    pid->prev_d_input = d_input;
+
+    v = pid->p_term + pid->i_term + pid->d_term;
+    u = v;
+    if (u > pid->out_max) u = pid->out_max;
+    if (u < pid->out_min) u = pid->out_min;
+
+    if (dt > 0.0f)
+    {
+        // 条件付き積分：飽和中に飽和を深める向きの誤差は積分しない
+        int winding_up = (v > pid->out_max && error > 0.0f) || (v < pid->out_min && error < 0.0f);
+        if (!winding_up)
+        {
+            pid->i_term += pid->ki * error * dt;
+        }
+        // バックカリキュレーション：飽和量に応じて I 項を戻す
+        // kt*dt が 2 を超えると戻し過ぎて発散するので、1 周期で戻すのは飽和量の全部まで（kt*dt を 1 で頭打ち）
+        back = pid->kt * dt;
+        if (back > 1.0f) back = 1.0f;
+        pid->i_term += back * (u - v);
+
+        if (pid->i_limit > 0.0f)
+        {
+            if (pid->i_term > pid->i_limit) pid->i_term = pid->i_limit;
+            if (pid->i_term < -pid->i_limit) pid->i_term = -pid->i_limit;
+        }
+    }
+
+    return u;
+}
+
+// 目標値と測定値から計算する（2 自由度、微分先行型）
+static inline float PidCore_update(PidCore *pid, float setpoint, float measurement, float dt)
+{
+    return PidCore_step(pid, setpoint - measurement,
+                        pid->b * setpoint - measurement,
+                        pid->c * setpoint - measurement, dt);
+}
+
+// 誤差だけが分かっている場合（P・D 項とも誤差に作用する）
+static inline float PidCore_updateError(PidCore *pid, float error, float dt)
+{
+    return PidCore_step(pid, error, error, error, dt);
+}
+
+#endif /* PID_CORE_H_ */
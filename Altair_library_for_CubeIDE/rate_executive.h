@@ -0,0 +1,327 @@
+#ifndef RATE_EXECUTIVE_H_
+#define RATE_EXECUTIVE_H_
+
+// レート単調（周期の短いタスクほど優先）のマルチレート・エグゼクティブ（ヘッダのみ、動的確保なし）
+//   - 周期割り込み（SysTick など）から RateExecutive_tick を呼ぶと、周期が来たタスクが実行待ちになる
+//   - main ループから RateExecutive_dispatch を呼ぶと、実行待ちのうち最も優先度の高いタスクを 1 つ実行する
+//   - tick の直後に RateExecutive_preempt も呼ぶと、優先度が上位 levels 個のタスクは
+//     main ループで実行中の低優先度タスクに割り込んで実行される（スタック 1 本のプリエンプティブ）
+//   - clock（DWT->CYCCNT など）を渡すと、タスクごとの実行時間と CPU 使用率を計る
+//     割り込まれている間の時間は、割り込んだタスクの方に数える
+//   - RateExecutive_simulate は実行時間の見積もりからスケジュールを模擬する（ホストの gcc でも動く）
+// タスク間のデータの受け渡しは snapshot.h を使う
+// CubeIDE / mbed で同一内容（mbed ではスレッド版の MultiRateExecutive.h から使う）
+
+#include <stdint.h>
+
+#ifndef RATE_EXECUTIVE_MAX_TASKS
+#define RATE_EXECUTIVE_MAX_TASKS 8
+#endif
+
+// 割り込み禁止区間（Cortex-M は PRIMASK、ホストでは何もしない）
+#if defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_BASE__) || defined(__ARM_ARCH_8M_MAIN__)
+static inline uint32_t RateExecutive_lock(void)
+{
+    uint32_t primask;
+    __asm volatile("mrs %0, primask\n\tcpsid i" : "=r"(primask) : : "memory");
+    return primask;
+}
+
+static inline void RateExecutive_unlock(uint32_t primask)
+{
+    __asm volatile("msr primask, %0" : : "r"(primask) : "memory");
+}
+#else
+static inline uint32_t RateExecutive_lock(void)
+{
+    return 0;
+}
+
+static inline void RateExecutive_unlock(uint32_t primask)
+{
+    (void)primask;
+}
+#endif
+
+typedef void (*RateTaskFunc)(void *arg);
+typedef uint32_t (*RateClockFunc)(void);
+
+typedef struct
+{
+    const char *name;
+    RateTaskFunc func;
+    void *arg;
+    uint32_t period;            // 周期 [tick]
+    uint32_t countdown;         // 次に実行待ちになるまでの tick 数
+    volatile uint8_t pending;   // 実行待ち
+    uint32_t runs;              // 実行回数
+    uint32_t overruns;          // 前の周期の分を実行する前に次の周期が来た回数
+    uint32_t busy;              // 今の計測窓での実行時間の合計 [clock]
+    uint32_t last_exec;         // 直前の実行時間 [clock]
+    uint32_t max_exec;          // 最大実行時間 [clock]
+    float utilization;          // 直前の計測窓での CPU 使用率（0〜1）
+} RateTask;
+
+typedef struct
+{
+    RateTask tasks[RATE_EXECUTIVE_MAX_TASKS];  // 追加した順（番号は変わらない）
+    uint8_t order[RATE_EXECUTIVE_MAX_TASKS];   // 優先度順のタスク番号（周期の短い順）
+    int count;
+    RateClockFunc clock;        // 実行時間の計測用（NULL で計測しない）
+    uint32_t window;            // CPU 使用率を更新する間隔 [clock]
+    uint32_t window_start;
+    uint32_t executed;          // 終了したタスクの実行時間の累計 [clock]（割り込まれた分の差し引き用）
+    volatile int running;       // 実行中のタスクの優先順位（-1 は無し、0 が最優先）
+    float total_utilization;    // 全タスクの CPU 使用率の合計
+} RateExecutive;
+
+// シミュレーション結果（タスクごと）
+typedef struct
+{
+    float utilization;          // 実行時間 / 周期
+    uint32_t worst_response;    // 実行待ちになってから終わるまでの最大時間 [clock]
+    uint32_t misses;            // 次の周期までに終わらなかった回数
+} RateSimResult;
+
+// clock: 時刻 [clock] を返す関数、window: CPU 使用率の計測窓 [clock]
+static inline void RateExecutive_Init(RateExecutive *ex, RateClockFunc clock, uint32_t window)
+{
+    ex->count = 0;
+    ex->clock = clock;
+    ex->window = window;
+    ex->window_start = clock ? clock() : 0;
+    ex->executed = 0;
+    ex->running = -1;
+    ex->total_utilization = 0.0f;
+}
+
+// タスクを追加してタスク番号を返す（いっぱいなら -1）。周期は tick 単位
+static inline int RateExecutive_addTask(RateExecutive *ex, const char *name, RateTaskFunc func, void *arg, uint32_t period)
+{
+    if (ex->count >= RATE_EXECUTIVE_MAX_TASKS || period == 0)
+    {
+        return -1;
+    }
+    int index = ex->count;
+    RateTask *task = &ex->tasks[index];
+    task->name = name;
+    task->func = func;
+    task->arg = arg;
+    task->period = period;
+    task->countdown = period;
+    task->pending = 0;
+    task->runs = 0;
+    task->overruns = 0;
+    task->busy = 0;
+    task->last_exec = 0;
+    task->max_exec = 0;
+    task->utilization = 0.0f;
+
+    // 周期の短い順に並べる（同じ周期なら先に追加した方が優先）
+    int rank = index;
+    while (rank > 0 && ex->tasks[ex->order[rank - 1]].period > period)
+    {
+        ex->order[rank] = ex->order[rank - 1];
+        rank--;
+    }
+    ex->order[rank] = (uint8_t)index;
+    ex->count++;
+    return index;
+}
+
+// 周期割り込みから 1 tick ごとに呼ぶ
+static inline void RateExecutive_tick(RateExecutive *ex)
+{
+    for (int i = 0; i < ex->count; i++)
+    {
+        RateTask *task = &ex->tasks[i];
+        if (--task->countdown == 0)
+        {
+            task->countdown = task->period;
+            if (task->pending)
+            {
+                task->overruns++;
+            }
+            task->pending = 1;
+        }
+    }
+}
+
+// 実行の開始・終了の記録（dispatch と mbed のスレッド版で共通）
+// begin の返り値を finish に渡す。elapsed は開始から終了までの時間（割り込まれた時間を含む）
+static inline uint32_t RateExecutive_begin(RateExecutive *ex)
+{
+    return ex->executed;
+}
+
+static inline void RateExecutive_finish(RateExecutive *ex, RateTask *task, uint32_t elapsed, uint32_t mark)
+{
+    uint32_t key = RateExecutive_lock();
+    // 途中で割り込んだタスクの実行時間を差し引く
+    uint32_t exec = elapsed - (ex->executed - mark);
+    ex->executed += exec;
+    task->runs++;
+    task->busy += exec;
+    task->last_exec = exec;
+    if (exec > task->max_exec)
+    {
+        task->max_exec = exec;
+    }
+
+    // 計測窓ごとに CPU 使用率を更新する
+    if (ex->clock)
+    {
+        uint32_t now = ex->clock();
+        uint32_t span = now - ex->window_start;
+        if (span >= ex->window)
+        {
+            float total = 0.0f;
+            for (int i = 0; i < ex->count; i++)
+            {
+                ex->tasks[i].utilization = (float)ex->tasks[i].busy / (float)span;
+                ex->tasks[i].busy = 0;
+                total += ex->tasks[i].utilization;
+            }
+            ex->total_utilization = total;
+            ex->window_start = now;
+        }
+    }
+    RateExecutive_unlock(key);
+}
+
+// 優先順位が limit より上の実行待ちタスクを 1 つ実行する（実行したら 1）
+static inline int RateExecutive_runNext(RateExecutive *ex, int limit)
+{
+    uint32_t key = RateExecutive_lock();
+    int preempted = ex->running;
+    if (preempted >= 0 && preempted < limit)
+    {
+        limit = preempted;  // 実行中のタスクより上だけ
+    }
+    int rank = 0;
+    while (rank < limit && !ex->tasks[ex->order[rank]].pending)
+    {
+        rank++;
+    }
+    if (rank >= limit)
+    {
+        RateExecutive_unlock(key);
+        return 0;
+    }
+    RateTask *task = &ex->tasks[ex->order[rank]];
+    task->pending = 0;
+    ex->running = rank;
+    uint32_t mark = RateExecutive_begin(ex);
+    RateExecutive_unlock(key);
+
+    uint32_t start = ex->clock ? ex->clock() : 0;
+    task->func(task->arg);
+    uint32_t elapsed = ex->clock ? ex->clock() - start : 0;
+
+    RateExecutive_finish(ex, task, elapsed, mark);
+    ex->running = preempted;
+    return 1;
+}
+
+// main ループから呼ぶ。実行待ちのうち最も優先度の高いタスクを 1 つ実行する（何もなければ 0）
+static inline int RateExecutive_dispatch(RateExecutive *ex)
+{
+    return RateExecutive_runNext(ex, ex->count);
+}
+
+// 周期割り込みで tick の後に呼ぶ。優先度が上位 levels 個のタスクを、実行中のタスクに割り込んで実行する
+static inline void RateExecutive_preempt(RateExecutive *ex, int levels)
+{
+    while (RateExecutive_runNext(ex, levels))
+    {
+    }
+}
+
+// 実行時間の見積もり exec[i]（タスク番号順、[clock]）から ticks tick 分のスケジュールを模擬する
+// clock_per_tick: 1 tick の長さ [clock]、levels: 割り込みで実行するタスクの数
+//   （RateExecutive_preempt と同じ。タスク数を渡すと完全なプリエンプティブ＝mbed のスレッド版、0 で main ループだけ）
+// 戻り値は CPU 使用率の合計。1 を超えると、どの設定でも間に合わない
+static inline float RateExecutive_simulate(const RateExecutive *ex, const uint32_t *exec, uint32_t clock_per_tick,
+                                           uint32_t ticks, int levels, RateSimResult *result)
+{
+    uint32_t remaining[RATE_EXECUTIVE_MAX_TASKS];
+    uint32_t release[RATE_EXECUTIVE_MAX_TASKS];
+    uint32_t countdown[RATE_EXECUTIVE_MAX_TASKS];
+    float total = 0.0f;
+
+    for (int i = 0; i < ex->count; i++)
+    {
+        remaining[i] = 0;
+        release[i] = 0;
+        countdown[i] = ex->tasks[i].period;
+        result[i].utilization = (float)exec[i] / ((float)ex->tasks[i].period * clock_per_tick);
+        result[i].worst_response = 0;
+        result[i].misses = 0;
+        total += result[i].utilization;
+    }
+
+    int current = -1;  // main ループで実行中のタスクの優先順位（割り込みでない方）
+    for (uint32_t t = 0; t < ticks; t++)
+    {
+        uint32_t now = t * clock_per_tick;
+        for (int i = 0; i < ex->count; i++)
+        {
+            if (--countdown[i] == 0)
+            {
+                countdown[i] = ex->tasks[i].period;
+                if (remaining[i] > 0)
+                {
+                    result[i].misses++;  // 前の周期の分が終わっていない（この分は捨てる）
+                }
+                else
+                {
+                    remaining[i] = exec[i];
+                    release[i] = now;
+                }
+            }
+        }
+
+        uint32_t budget = clock_per_tick;
+        while (budget > 0)
+        {
+            // 割り込みで動くタスクは常に、それ以外は main ループが空いているときだけ選べる
+            int rank = -1;
+            for (int r = 0; r < ex->count; r++)
+            {
+                if (remaining[ex->order[r]] > 0 && (r < levels || current < 0 || r == current))
+                {
+                    rank = r;
+                    break;
+                }
+            }
+            if (rank < 0)
+            {
+                break;
+            }
+            int i = ex->order[rank];
+            if (rank >= levels)
+            {
+                current = rank;
+            }
+            uint32_t run = (remaining[i] < budget) ? remaining[i] : budget;
+            remaining[i] -= run;
+            budget -= run;
+            if (remaining[i] == 0)
+            {
+                uint32_t response = now + (clock_per_tick - budget) - release[i];
+                if (response > result[i].worst_response)
+                {
+                    result[i].worst_response = response;
+                }
+                if (rank == current)
+                {
+                    current = -1;
+                }
+            }
+        }
+    }
+    return total;
+}
+
+#endif /* RATE_EXECUTIVE_H_ */
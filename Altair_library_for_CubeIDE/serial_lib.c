@@ -10,36 +10,41 @@ void Serial_SendData(USART_HandleTypeDef *huart, int16_t *data, uint8_t data_cou
     if (data_count > SERIAL_MAX_DATA_COUNT) {
         data_count = SERIAL_MAX_DATA_COUNT;
     }
-    // スタック上の固定バッファ（ヘッダ2バイト + データ最大32バイト）
-    uint8_t buffer[2 + SERIAL_MAX_DATA_COUNT * 2];
-    uint8_t buffer_size = 2 + data_count * 2;
-
-    buffer[0] = SERIAL_HEADER1;
-    buffer[1] = SERIAL_HEADER2;
-
-    for (uint8_t i = 0; i < data_count; i++) {
-        buffer[2 + i * 2] = (uint8_t)((data[i] >> 8) & 0xFF);
-        buffer[3 + i * 2] = (uint8_t)(data[i] & 0xFF);
-    }
+    // スタック上の固定バッファ（データ最大32バイト + フレームの4バイト）
+    uint8_t buffer[FRAME_ENCODED_SIZE(SERIAL_MAX_DATA_COUNT * 2)];
+    uint8_t *payload = Frame_payload(buffer);
+    uint8_t *end = MsgCore_putArray_int16_t(payload, data, data_count);
 
+    uint16_t buffer_size = Frame_encode(buffer, (uint16_t)(end - payload));
     HAL_USART_Transmit(huart, buffer, buffer_size, HAL_MAX_DELAY);
 }
 
 // 可変長データの受信関数（固定バッファ使用、mallocなし）
+// 区切りの 0x00 まで 1 バイトずつ受信する。途中から受信した・壊れていた・データ数が違うフレームは 0 を返す（次の呼び出しで同期する）
 uint8_t Serial_ReceiveData(USART_HandleTypeDef *huart, int16_t *data, uint8_t data_count) {
     if (data_count > SERIAL_MAX_DATA_COUNT) {
         data_count = SERIAL_MAX_DATA_COUNT;
     }
-    uint8_t buffer[2 + SERIAL_MAX_DATA_COUNT * 2];
-    uint8_t buffer_size = 2 + data_count * 2;
+    uint8_t buffer[FRAME_ENCODED_SIZE(SERIAL_MAX_DATA_COUNT * 2)];
+    FrameReceiver receiver;
+    uint8_t byte;
 
-    if (HAL_USART_Receive(huart, buffer, buffer_size, HAL_MAX_DELAY) == HAL_OK) {
-        if (buffer[0] == SERIAL_HEADER1 && buffer[1] == SERIAL_HEADER2) {
-            for (uint8_t i = 0; i < data_count; i++) {
-                data[i] = (int16_t)((buffer[2 + i * 2] << 8) | buffer[3 + i * 2]);
-            }
-            return 1; // 正常受信
+    FrameReceiver_Init(&receiver, buffer, sizeof(buffer));
+    for (;;) {
+        if (HAL_USART_Receive(huart, &byte, 1, HAL_MAX_DELAY) != HAL_OK) {
+            return 0; // エラー
+        }
+        if (FrameReceiver_push(&receiver, byte)) {
+            break;
         }
+        if (byte == 0 && receiver.errors != 0) {
+            return 0; // 壊れたフレーム
+        }
+    }
+
+    if (receiver.payload_length != data_count * 2) {
+        return 0; // データ数が違う
     }
-    return 0; // エラー
+    MsgCore_getArray_int16_t(receiver.payload, data, data_count);
+    return 1; // 正常受信
 }
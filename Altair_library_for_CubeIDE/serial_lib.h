@@ -2,10 +2,11 @@
 #define SERIAL_LIB_H
 
 #include "main.h"
+#include "frame_core.h"
+#include "msg_core.h"
 
-// シリアルヘッダーの定義
-#define SERIAL_HEADER1 0xA5
-#define SERIAL_HEADER2 0xA5
+// int16_t の配列を frame_core のフレーム（COBS + CRC-16、区切り 0x00）で送受信する
+// ペイロードは int16_t をリトルエンディアンで並べたもの（msg_core.h）
 
 // 1回の送受信で扱える最大データ数（int16_t単位）
 #define SERIAL_MAX_DATA_COUNT 16
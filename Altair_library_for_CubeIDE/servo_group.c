@@ -0,0 +1,168 @@
+#include "servo_group.h"
+#include "motor_driver.h"
+
+// グループにタイマを重複なしで登録する内部関数
+static void ServoGroup_AddTimer(ServoGroup *group, TIM_HandleTypeDef *htim)
+{
+    uint8_t i;
+    for (i = 0; i < group->timer_count; i++)
+    {
+        if (group->timers[i] == htim)
+        {
+            return;
+        }
+    }
+    group->timers[group->timer_count++] = htim;
+}
+
+// 全チャンネルの CCR に現在のパルス幅を書き込む内部関数（1 カウント = 1us）
+// UDIS を立てている間は CCR の書き込みがプリロードレジスタに留まり、途中の組み合わせが出力されない
+static void ServoGroup_Write(ServoGroup *group)
+{
+    uint8_t i;
+
+    for (i = 0; i < group->timer_count; i++)
+    {
+        group->timers[i]->Instance->CR1 |= TIM_CR1_UDIS;
+    }
+    for (i = 0; i < group->servo_count; i++)
+    {
+        ServoChannel *servo = &group->servos[i];
+        __HAL_TIM_SET_COMPARE(servo->htim, servo->channel, ServoMotion_pulse(&servo->motion));
+    }
+    for (i = 0; i < group->timer_count; i++)
+    {
+        group->timers[i]->Instance->CR1 &= ~TIM_CR1_UDIS;
+    }
+}
+
+void ServoGroup_Init(ServoGroup *group)
+{
+    group->servo_count = 0;
+    group->timer_count = 0;
+}
+
+int ServoGroup_add(ServoGroup *group, TIM_HandleTypeDef *htim, uint32_t channel,
+                   const ServoCalibration *calibration, float angle)
+{
+    if (group->servo_count >= SERVO_GROUP_MAX_SERVOS)
+    {
+        return -1;
+    }
+    int index = group->servo_count++;
+    ServoChannel *servo = &group->servos[index];
+    servo->htim = htim;
+    servo->channel = channel;
+    ServoMotion_Init(&servo->motion, calibration, angle);
+    ServoGroup_AddTimer(group, htim);
+    return index;
+}
+
+HAL_StatusTypeDef ServoGroup_Start(ServoGroup *group)
+{
+    uint32_t primask;
+    uint8_t i;
+
+    for (i = 0; i < group->timer_count; i++)
+    {
+        TIM_HandleTypeDef *htim = group->timers[i];
+        uint32_t tim_clk = MotorDriver_GetTimerClock(htim);
+        if (tim_clk < 1000000U)
+        {
+            return HAL_ERROR;
+        }
+        // 1 カウント 1us、20ms 周期
+        uint32_t prescaler = tim_clk / 1000000U - 1U;
+        if (prescaler > 0xFFFFU)
+        {
+            return HAL_ERROR;
+        }
+        __HAL_TIM_DISABLE(htim);
+        __HAL_TIM_SET_PRESCALER(htim, prescaler);
+        __HAL_TIM_SET_AUTORELOAD(htim, SERVO_GROUP_FRAME_US - 1U);
+        htim->Instance->CR1 |= TIM_CR1_ARPE;
+        htim->Instance->EGR = TIM_EGR_UG;  // プリスケーラをすぐ反映する
+        htim->Init.Prescaler = prescaler;
+        htim->Init.Period = SERVO_GROUP_FRAME_US - 1U;
+    }
+
+    for (i = 0; i < group->servo_count; i++)
+    {
+        ServoChannel *servo = &group->servos[i];
+        // CCR プリロード有効化（書き込みは更新イベントで反映される）
+        __HAL_TIM_ENABLE_OCxPRELOAD(servo->htim, servo->channel);
+        __HAL_TIM_SET_COMPARE(servo->htim, servo->channel, ServoMotion_pulse(&servo->motion));
+        if (HAL_TIM_PWM_Start(servo->htim, servo->channel) != HAL_OK)
+        {
+            return HAL_ERROR;
+        }
+    }
+
+    // 全タイマのカウンタ位相合わせ（全チャンネルのパルスが同じ時刻に立ち上がる）
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for (i = 0; i < group->timer_count; i++)
+    {
+        __HAL_TIM_SET_COUNTER(group->timers[i], 0U);
+    }
+    __set_PRIMASK(primask);
+
+    return HAL_OK;
+}
+
+void ServoGroup_setCalibration(ServoGroup *group, int index, const ServoCalibration *calibration)
+{
+    if (index >= 0 && index < group->servo_count)
+    {
+        ServoMotion_setCalibration(&group->servos[index].motion, calibration);
+    }
+}
+
+void ServoGroup_setTarget(ServoGroup *group, int index, float angle)
+{
+    if (index >= 0 && index < group->servo_count)
+    {
+        ServoMotion_setTarget(&group->servos[index].motion, angle);
+    }
+}
+
+void ServoGroup_setTargets(ServoGroup *group, const float *angles)
+{
+    uint8_t i;
+    for (i = 0; i < group->servo_count; i++)
+    {
+        ServoMotion_setTarget(&group->servos[i].motion, angles[i]);
+    }
+}
+
+void ServoGroup_update(ServoGroup *group, float dt)
+{
+    uint8_t i;
+    for (i = 0; i < group->servo_count; i++)
+    {
+        ServoMotion_update(&group->servos[i].motion, dt);
+    }
+    ServoGroup_Write(group);
+}
+
+float ServoGroup_getAngle(const ServoGroup *group, int index)
+{
+    if (index >= 0 && index < group->servo_count)
+    {
+        return group->servos[index].motion.position;
+    }
+    return 0.0f;
+}
+
+int ServoGroup_isSettled(const ServoGroup *group)
+{
+    uint8_t i;
+    for (i = 0; i < group->servo_count; i++)
+    {
+        if (!ServoMotion_isSettled(&group->servos[i].motion))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,62 @@
+#ifndef SERVO_GROUP_H
+#define SERVO_GROUP_H
+
+#include "stm32f4xx_hal.h"
+#include "servo_motion.h"
+
+// 1 グループで扱えるサーボ数の上限
+#ifndef SERVO_GROUP_MAX_SERVOS
+#define SERVO_GROUP_MAX_SERVOS 16
+#endif
+
+// サーボの PWM 周期 [us]（50Hz）
+#ifndef SERVO_GROUP_FRAME_US
+#define SERVO_GROUP_FRAME_US 20000U
+#endif
+
+typedef struct {
+    TIM_HandleTypeDef* htim;  // タイマー
+    uint32_t channel;         // タイマーチャンネル
+    ServoMotion motion;       // 校正と補間
+} ServoChannel;
+
+// 複数のサーボを同じ PWM 周期で一斉に動かすためのグループ
+// タイマは 1 カウント 1us、周期 20ms に設定し直すので、モータなど他の用途と共用しない
+typedef struct {
+    ServoChannel servos[SERVO_GROUP_MAX_SERVOS];
+    uint8_t servo_count;
+    TIM_HandleTypeDef* timers[SERVO_GROUP_MAX_SERVOS];  // 重複を除いたタイマ一覧
+    uint8_t timer_count;
+} ServoGroup;
+
+// グループを空にする関数
+void ServoGroup_Init(ServoGroup* group);
+
+// サーボを追加してサーボ番号を返す関数（いっぱいなら -1）
+// angle: 初期角 [deg]（ServoGroup_Start で最初に出力する角度）
+int ServoGroup_add(ServoGroup* group, TIM_HandleTypeDef* htim, uint32_t channel,
+                   const ServoCalibration* calibration, float angle);
+
+// 全タイマを 1us / 20ms に設定してカウンタを揃え、初期角で PWM を開始する関数
+HAL_StatusTypeDef ServoGroup_Start(ServoGroup* group);
+
+// 校正を設定し直す関数（現在の角度はそのまま）
+void ServoGroup_setCalibration(ServoGroup* group, int index, const ServoCalibration* calibration);
+
+// 目標角を設定する関数（ServoGroup_update のたびに速度・加速度の制限内で近づく）
+void ServoGroup_setTarget(ServoGroup* group, int index, float angle);
+
+// 全サーボの目標角を設定する関数（angles[i] がサーボ i に対応）
+void ServoGroup_setTargets(ServoGroup* group, const float* angles);
+
+// 全サーボを 1 周期分補間して出力する関数（dt: 呼ぶ周期 [s]）
+// 書き込みは次の更新イベントで全チャンネル同時に反映される
+void ServoGroup_update(ServoGroup* group, float dt);
+
+// 現在の指令角 [deg] を返す関数
+float ServoGroup_getAngle(const ServoGroup* group, int index);
+
+// 全サーボが目標角に着いたら 1 を返す関数
+int ServoGroup_isSettled(const ServoGroup* group);
+
+#endif /* SERVO_GROUP_H */
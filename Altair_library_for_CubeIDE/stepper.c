@@ -0,0 +1,369 @@
+#include "stepper.h"
+#include "motor_driver.h"
+#include <math.h>
+
+// パルスを出さない周期の CCR（PWM mode 2 で CNT が届かない値。ARR は 0xFFFE 以下にする）
+#define STEPPER_NO_PULSE 0xFFFFU
+
+// 周期 [カウント] の ARR / CCR をプリロードに書く内部関数（パルスは周期の最後の pulse_ticks カウント）
+static void Stepper_WritePeriod(Stepper *stepper, float period)
+{
+    uint32_t ticks = (uint32_t)(period + 0.5f);
+
+    __HAL_TIM_SET_AUTORELOAD(stepper->htim, ticks - 1U);
+    __HAL_TIM_SET_COMPARE(stepper->htim, stepper->channel, ticks - stepper->pulse_ticks);
+}
+
+// index 番目（1 から）のステップの周期を、前のステップの周期から求める内部関数（割り算なし）
+// v² を 1 ステップごとに 2a 変える p / √(1 ∓ 2q) を 2 次まで展開したもの
+static float Stepper_NextPeriod(Stepper *stepper, uint32_t index)
+{
+    float p = stepper->period;
+    float q;
+
+    if (index <= stepper->accel_steps)
+    {
+        q = -stepper->multiplier * p * p;
+        p *= 1.0f + q + 1.5f * q * q;
+        if (p < stepper->min_period)
+        {
+            p = stepper->min_period;
+        }
+    }
+    else if (index + stepper->accel_steps >= stepper->total + 2U)
+    {
+        q = stepper->multiplier * p * p;
+        p *= 1.0f + q + 1.5f * q * q;
+        if (p > stepper->start_period)
+        {
+            p = stepper->start_period;
+        }
+    }
+    stepper->period = p;
+    return p;
+}
+
+// タイマを止めて、出力を Low にする内部関数
+static void Stepper_Halt(Stepper *stepper)
+{
+    // CCxE が立っていると __HAL_TIM_DISABLE では止まらないので、CEN を直接落とす
+    stepper->htim->Instance->CR1 &= ~TIM_CR1_CEN;
+    __HAL_TIM_DISABLE_IT(stepper->htim, TIM_IT_UPDATE);
+    __HAL_TIM_SET_COMPARE(stepper->htim, stepper->channel, STEPPER_NO_PULSE);
+    __HAL_TIM_GENERATE_EVENT(stepper->htim, TIM_EVENTSOURCE_UPDATE);  // CCR を反映し、カウンタを 0 に戻す（出力 Low）
+    __HAL_TIM_CLEAR_FLAG(stepper->htim, TIM_FLAG_UPDATE);
+    stepper->running = 0;
+}
+
+// 移動を設定し、最初の 2 周期分をタイマに書いておく内部関数（カウンタはまだ動かさない）
+static HAL_StatusTypeDef Stepper_Prepare(Stepper *stepper, int32_t steps, float start_velocity, float max_velocity,
+                                         float acceleration)
+{
+    uint32_t tim_clk;
+    uint32_t prescaler;
+    uint32_t arr;
+    float first_velocity;
+    float tick_hz;
+
+    if (stepper->running)
+    {
+        Stepper_Halt(stepper);
+    }
+    stepper->total = 0;
+    stepper->done = 0;
+    if (steps == 0)
+    {
+        return HAL_OK;
+    }
+    if (!(max_velocity > 0.0f))   // NaN も弾く
+    {
+        return HAL_ERROR;
+    }
+
+    // 1 ステップ目の速度（Eiderman：v1 = √(v0² + 2a)）
+    if (acceleration > 0.0f && start_velocity < max_velocity)
+    {
+        first_velocity = sqrtf(start_velocity * start_velocity + 2.0f * acceleration);
+        if (first_velocity > max_velocity)
+        {
+            first_velocity = max_velocity;
+        }
+    }
+    else
+    {
+        first_velocity = max_velocity;
+        acceleration = 0.0f;
+    }
+
+    // 最も遅い 1 ステップ目の周期が 16 ビットに収まるプリスケーラ
+    tim_clk = MotorDriver_GetTimerClock(stepper->htim);
+    if (MotorDriver_CalcTimerDivider(tim_clk, (first_velocity < 1.0f) ? 1U : (uint32_t)first_velocity,
+                                     &prescaler, &arr) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    stepper->tick_hz = tim_clk / (prescaler + 1U);
+    tick_hz = (float)stepper->tick_hz;
+    stepper->pulse_ticks = (uint32_t)(((uint64_t)stepper->tick_hz * STEPPER_PULSE_NS + 999999999ULL) / 1000000000ULL);
+    if (stepper->pulse_ticks == 0U)
+    {
+        stepper->pulse_ticks = 1U;
+    }
+
+    stepper->start_period = tick_hz / first_velocity;
+    if (stepper->start_period > 65535.0f)
+    {
+        stepper->start_period = 65535.0f;
+    }
+    // High と Low に最低パルス幅ずつ
+    stepper->min_period = tick_hz / max_velocity;
+    if (stepper->min_period < (float)(stepper->pulse_ticks * 2U))
+    {
+        stepper->min_period = (float)(stepper->pulse_ticks * 2U);
+    }
+    if (stepper->min_period > stepper->start_period)
+    {
+        stepper->min_period = stepper->start_period;
+    }
+    stepper->multiplier = acceleration / (tick_hz * tick_hz);
+
+    stepper->direction = (steps < 0) ? -1 : 1;
+    stepper->total = (uint32_t)((steps < 0) ? -steps : steps);
+    if (acceleration > 0.0f)
+    {
+        // 最高速度までの加速に使うステップ数（足りなければ半分ずつ加速・減速する三角形）
+        float ramp = (max_velocity * max_velocity - first_velocity * first_velocity) / (2.0f * acceleration);
+        stepper->accel_steps = 1U + (uint32_t)(ramp + 0.5f);
+        if (stepper->accel_steps > stepper->total / 2U)
+        {
+            stepper->accel_steps = stepper->total / 2U;
+        }
+    }
+    else
+    {
+        stepper->accel_steps = 0;
+    }
+
+    GpioBundle_write(&stepper->dir, (stepper->direction > 0) ? stepper->dir.mask : 0U);
+
+    // 1 周期目をすぐに反映し、2 周期目をプリロードに入れておく
+    stepper->htim->Instance->CR1 &= ~TIM_CR1_CEN;
+    __HAL_TIM_SET_PRESCALER(stepper->htim, prescaler);
+    stepper->period = stepper->start_period;
+    Stepper_WritePeriod(stepper, stepper->period);
+    __HAL_TIM_GENERATE_EVENT(stepper->htim, TIM_EVENTSOURCE_UPDATE);
+    __HAL_TIM_CLEAR_FLAG(stepper->htim, TIM_FLAG_UPDATE);
+    if (stepper->total >= 2U)
+    {
+        Stepper_WritePeriod(stepper, Stepper_NextPeriod(stepper, 2U));
+    }
+    else
+    {
+        __HAL_TIM_SET_COMPARE(stepper->htim, stepper->channel, STEPPER_NO_PULSE);
+    }
+
+    stepper->running = 1;
+    __HAL_TIM_ENABLE_IT(stepper->htim, TIM_IT_UPDATE);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef Stepper_Init(Stepper *stepper, TIM_HandleTypeDef *htim, uint32_t channel,
+                               GPIO_TypeDef *dir_port, uint16_t dir_pin)
+{
+    TIM_OC_InitTypeDef oc = {0};
+
+    if (stepper == NULL || htim == NULL || dir_port == NULL)
+    {
+        return HAL_ERROR;
+    }
+
+    stepper->htim = htim;
+    stepper->channel = channel;
+    stepper->position = 0;
+    stepper->direction = 1;
+    stepper->running = 0;
+    stepper->total = 0;
+    stepper->done = 0;
+    stepper->accel_steps = 0;
+    stepper->tick_hz = 0;
+    stepper->pulse_ticks = 1;
+    stepper->period = 0.0f;
+    stepper->start_period = 0.0f;
+    stepper->min_period = 0.0f;
+    stepper->multiplier = 0.0f;
+
+    if (GpioBundle_Init(&stepper->dir, dir_port, dir_pin, GPIO_LIB_MODE_OUTPUT) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    // PWM mode 2：CNT >= CCR の間 High（周期の最後にパルス）
+    oc.OCMode = TIM_OCMODE_PWM2;
+    oc.Pulse = STEPPER_NO_PULSE;
+    oc.OCPolarity = TIM_OCPOLARITY_HIGH;
+    oc.OCFastMode = TIM_OCFAST_DISABLE;
+    if (HAL_TIM_PWM_ConfigChannel(htim, &oc, channel) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    // ARR / CCR プリロード有効化（書き込みは更新イベントで反映される）
+    __HAL_TIM_ENABLE_OCxPRELOAD(htim, channel);
+    htim->Instance->CR1 |= TIM_CR1_ARPE;
+    if (HAL_TIM_PWM_Start(htim, channel) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    Stepper_Halt(stepper);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef Stepper_move(Stepper *stepper, int32_t steps, float start_velocity, float max_velocity,
+                               float acceleration)
+{
+    if (Stepper_Prepare(stepper, steps, start_velocity, max_velocity, acceleration) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+    if (stepper->total > 0U)
+    {
+        stepper->htim->Instance->CR1 |= TIM_CR1_CEN;
+    }
+    return HAL_OK;
+}
+
+void Stepper_Stop(Stepper *stepper)
+{
+    Stepper_Halt(stepper);
+}
+
+void Stepper_Interrupt(Stepper *stepper)
+{
+    uint32_t next;
+
+    if (!stepper->running)
+    {
+        return;
+    }
+
+    // 更新イベント = 1 周期（1 ステップ）が終わった
+    stepper->position += stepper->direction;
+    stepper->done++;
+    if (stepper->done >= stepper->total)
+    {
+        Stepper_Halt(stepper);
+        return;
+    }
+
+    // 今始まった周期の次の周期をプリロードに書く
+    next = stepper->done + 2U;
+    if (next > stepper->total)
+    {
+        __HAL_TIM_SET_COMPARE(stepper->htim, stepper->channel, STEPPER_NO_PULSE);
+    }
+    else
+    {
+        Stepper_WritePeriod(stepper, Stepper_NextPeriod(stepper, next));
+    }
+}
+
+HAL_StatusTypeDef StepperGroup_Init(StepperGroup *group, Stepper *const *axes, uint8_t axis_count)
+{
+    uint8_t i;
+
+    if (group == NULL || axes == NULL || axis_count == 0U || axis_count > STEPPER_GROUP_MAX_AXES)
+    {
+        return HAL_ERROR;
+    }
+
+    group->axis_count = axis_count;
+    for (i = 0; i < axis_count; i++)
+    {
+        group->axes[i] = axes[i];
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef StepperGroup_move(StepperGroup *group, const int32_t *steps, float start_velocity,
+                                    float max_velocity, float acceleration)
+{
+    uint32_t longest = 0;
+    uint32_t primask;
+    uint8_t i;
+
+    for (i = 0; i < group->axis_count; i++)
+    {
+        uint32_t n = (uint32_t)((steps[i] < 0) ? -steps[i] : steps[i]);
+        if (n > longest)
+        {
+            longest = n;
+        }
+    }
+    if (longest == 0U)
+    {
+        return HAL_OK;
+    }
+
+    // 各軸の速度・加速度をステップ数の比で縮めると、加速・等速・減速の時間が全軸で同じになる
+    for (i = 0; i < group->axis_count; i++)
+    {
+        uint32_t n = (uint32_t)((steps[i] < 0) ? -steps[i] : steps[i]);
+        float ratio = (float)n / (float)longest;
+        if (Stepper_Prepare(group->axes[i], steps[i], start_velocity * ratio, max_velocity * ratio,
+                            acceleration * ratio) != HAL_OK)
+        {
+            StepperGroup_Stop(group);
+            return HAL_ERROR;
+        }
+    }
+
+    // 全軸のカウンタを同時に動かす
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for (i = 0; i < group->axis_count; i++)
+    {
+        if (group->axes[i]->total > 0U)
+        {
+            group->axes[i]->htim->Instance->CR1 |= TIM_CR1_CEN;
+        }
+    }
+    __set_PRIMASK(primask);
+    return HAL_OK;
+}
+
+void StepperGroup_Stop(StepperGroup *group)
+{
+    uint8_t i;
+
+    for (i = 0; i < group->axis_count; i++)
+    {
+        Stepper_Halt(group->axes[i]);
+    }
+}
+
+void StepperGroup_Interrupt(StepperGroup *group, TIM_HandleTypeDef *htim)
+{
+    uint8_t i;
+
+    for (i = 0; i < group->axis_count; i++)
+    {
+        if (group->axes[i]->htim == htim)
+        {
+            Stepper_Interrupt(group->axes[i]);
+            return;
+        }
+    }
+}
+
+uint8_t StepperGroup_isBusy(const StepperGroup *group)
+{
+    uint8_t i;
+
+    for (i = 0; i < group->axis_count; i++)
+    {
+        if (group->axes[i]->running)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
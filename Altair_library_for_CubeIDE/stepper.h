@@ -0,0 +1,99 @@
+#ifndef STEPPER_H_
+#define STEPPER_H_
+
+#include "stm32f4xx_hal.h"
+#include "gpio_lib.h"
+
+// タイマの PWM 出力で STEP パルスを出すステッピングモータドライバ（A4988 / DRV8825 などの STEP / DIR 入力用）
+//   - 1 ステップ = タイマの 1 周期。パルスはタイマが出すので、ステップの間隔は割り込みの遅れで揺れない
+//   - 周期ごとの更新割り込みで次の周期（ARR）を書く。ARR / CCR はプリロードするので、書き込みは 1 周期後に反映される
+//   - 台形加減速は Eiderman の方法で 1 ステップごとに周期を掛け算だけで更新する（p ← p(1 + q + 1.5q²)、q = ∓a p² / F²）
+//   - PWM mode 2 で周期の最後にパルスを出すので、DIR を変えてから最初のパルスまでに 1 周期空く
+//   - StepperGroup で複数軸を同時に始め、同時に終わらせる（各軸の速度・加速度をステップ数の比で縮める）
+// プリスケーラは MotorDriver_CalcTimerDivider（MotorDriver_setPwmFrequency と同じ計算）で、最も遅い周期が 16 ビットに収まるように決める
+
+// STEP パルスの幅 [ns]（DRV8825 は 1.9us 以上）
+#ifndef STEPPER_PULSE_NS
+#define STEPPER_PULSE_NS 2000U
+#endif
+
+// StepperGroup の軸数の上限
+#ifndef STEPPER_GROUP_MAX_AXES
+#define STEPPER_GROUP_MAX_AXES 4
+#endif
+
+typedef struct
+{
+    TIM_HandleTypeDef *htim;     // STEP を出すタイマ
+    uint32_t channel;            // STEP を出すチャンネル
+    GpioBundle dir;              // DIR のピン
+    volatile int32_t position;   // 現在位置 [step]
+    int8_t direction;            // 1：正転（DIR High）、-1：逆転
+    volatile uint8_t running;    // 動作中なら 1
+    uint32_t total;              // 今回の移動のステップ数
+    volatile uint32_t done;      // 出し終えたステップ数
+    uint32_t accel_steps;        // 加速（減速）にかけるステップ数
+    uint32_t tick_hz;            // タイマのカウント周波数 [Hz]
+    uint32_t pulse_ticks;        // パルス幅 [カウント]
+    float period;                // 最後に計算した周期 [カウント]
+    float start_period;          // 最初と最後の周期 [カウント]
+    float min_period;            // 最高速度の周期 [カウント]
+    float multiplier;            // a / F²
+} Stepper;
+
+// 複数軸を同時に動かすためのグループ
+typedef struct
+{
+    Stepper *axes[STEPPER_GROUP_MAX_AXES];
+    uint8_t axis_count;
+} StepperGroup;
+
+// 初期化する関数（CubeMX でチャンネルを PWM Generation CHx、タイマの更新割り込みを有効にしておく）
+// DIR のピンは出力に初期化する
+HAL_StatusTypeDef Stepper_Init(Stepper *stepper, TIM_HandleTypeDef *htim, uint32_t channel,
+                               GPIO_TypeDef *dir_port, uint16_t dir_pin);
+
+// steps ステップ（負なら逆転）動かし始める関数（速度は [step/s]、加速度は [step/s^2]）
+// start_velocity から max_velocity まで acceleration で加速し、最後は start_velocity まで減速して止まる
+// acceleration が 0 なら max_velocity の一定速度で動かす
+HAL_StatusTypeDef Stepper_move(Stepper *stepper, int32_t steps, float start_velocity, float max_velocity,
+                               float acceleration);
+
+// すぐに止める関数（減速しない）
+void Stepper_Stop(Stepper *stepper);
+
+// タイマの更新割り込みから呼ぶ関数（HAL_TIM_PeriodElapsedCallback で htim が一致したとき）
+void Stepper_Interrupt(Stepper *stepper);
+
+static inline int32_t Stepper_getPosition(const Stepper *stepper)
+{
+    return stepper->position;
+}
+
+static inline void Stepper_setPosition(Stepper *stepper, int32_t position)
+{
+    stepper->position = position;
+}
+
+static inline uint8_t Stepper_isBusy(const Stepper *stepper)
+{
+    return stepper->running;
+}
+
+// グループを初期化する関数（各軸は Stepper_Init 済みであること。タイマは軸ごとに別にする）
+HAL_StatusTypeDef StepperGroup_Init(StepperGroup *group, Stepper *const *axes, uint8_t axis_count);
+
+// 全軸を同時に動かし始める関数（steps[i] が axes[i] のステップ数）
+// 速度・加速度はステップ数の最も多い軸の値で、他の軸はステップ数の比で縮めるので、全軸が同時に加速し同時に止まる
+HAL_StatusTypeDef StepperGroup_move(StepperGroup *group, const int32_t *steps, float start_velocity,
+                                    float max_velocity, float acceleration);
+
+void StepperGroup_Stop(StepperGroup *group);
+
+// タイマの更新割り込みから呼ぶ関数（htim に対応する軸を進める）
+void StepperGroup_Interrupt(StepperGroup *group, TIM_HandleTypeDef *htim);
+
+// どれかの軸が動作中なら 1
+uint8_t StepperGroup_isBusy(const StepperGroup *group);
+
+#endif /* STEPPER_H_ */
@@ -0,0 +1,65 @@
+#include "timebase.h"
+#include "motor_driver.h"
+
+static uint32_t Timebase_dummy_counter = 0;   // 初期化前に読んだときの読み先
+
+Timebase timebase = {{0, 0, 0}, &Timebase_dummy_counter};
+
+HAL_StatusTypeDef Timebase_Init(TIM_HandleTypeDef *htim)
+{
+    uint32_t primask;
+    volatile uint32_t *counter;
+    uint32_t counts_per_us;
+
+    if (htim == NULL)
+    {
+        // DWT のサイクルカウンタを有効化
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        counter = &DWT->CYCCNT;
+        counts_per_us = HAL_RCC_GetHCLKFreq() / 1000000U;
+    }
+    else
+    {
+        // 1 カウント 1us で回す（32 ビットタイマのみ）
+        uint32_t tim_clk = MotorDriver_GetTimerClock(htim);
+        if (!IS_TIM_32B_COUNTER_INSTANCE(htim->Instance) || tim_clk < 1000000U || tim_clk / 1000000U - 1U > 0xFFFFU)
+        {
+            return HAL_ERROR;
+        }
+        __HAL_TIM_DISABLE(htim);
+        __HAL_TIM_SET_PRESCALER(htim, tim_clk / 1000000U - 1U);
+        __HAL_TIM_SET_AUTORELOAD(htim, 0xFFFFFFFFU);
+        htim->Instance->EGR = TIM_EGR_UG;  // プリスケーラをすぐ反映する
+        htim->Init.Prescaler = tim_clk / 1000000U - 1U;
+        htim->Init.Period = 0xFFFFFFFFU;
+        __HAL_TIM_ENABLE(htim);
+        counter = &htim->Instance->CNT;
+        counts_per_us = 1;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    TimebaseCore_update(&timebase.core, *timebase.counter);  // 今までのカウンタの分を進めておく
+    timebase.counter = counter;
+    TimebaseCore_Init(&timebase.core, counts_per_us, *counter);
+    __set_PRIMASK(primask);
+    return HAL_OK;
+}
+
+void Timebase_Begin(void)
+{
+    if (timebase.core.counts_per_us == 0)
+    {
+        Timebase_Init(NULL);
+    }
+}
+
+#ifndef TIMEBASE_DISABLE_TICK_HOOK
+// HAL の 1ms 刻み（uwTick）を進めるついでに時刻を進める（DWT は 168MHz で約 25 秒で 1 周する）
+void HAL_IncTick(void)
+{
+    uwTick += (uint32_t)uwTickFreq;
+    Timebase_tick();
+}
+#endif
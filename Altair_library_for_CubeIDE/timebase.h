@@ -0,0 +1,64 @@
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include "stm32f4xx_hal.h"
+#include "timebase_core.h"
+
+// 全モジュール共通の単調増加の時刻 [us]（64 ビット、桁あふれなし）
+// エンコーダの速度計算、通信のタイムアウトなど、時間を計るところはすべてこれを使う
+//   - Timebase_Init(NULL)：DWT->CYCCNT（CPU クロック）を数える。タイマを使わないが、スリープ（__WFI）中は止まる
+//   - Timebase_Init(&htim5)：1MHz で回る 32 ビットタイマ（TIM2 / TIM5）を数える。スリープ中も進む
+// 初期化していないときは、Encoder_Init などが DWT で始める
+// カウンタが 1 周する前に 1 回は読まないと時刻が遅れるので、timebase.c が HAL_IncTick（__weak）を置き換え、
+// HAL の 1ms 刻みの割り込み（SysTick、または HAL の時刻の元にしたタイマ）のたびに読んでおく
+//   自分で HAL_IncTick を書く場合は TIMEBASE_DISABLE_TICK_HOOK を定義し、その中から Timebase_tick を呼ぶ
+
+typedef struct
+{
+    TimebaseCore core;
+    volatile uint32_t *counter;   // DWT->CYCCNT か TIMx->CNT
+} Timebase;
+
+extern Timebase timebase;
+
+// 時刻の元になるカウンタを設定して数え始める関数（切り替えても時刻は続きから進む）
+// htim: 32 ビットタイマ（NULL なら DWT->CYCCNT）
+HAL_StatusTypeDef Timebase_Init(TIM_HandleTypeDef *htim);
+
+// まだ始めていなければ DWT で始める関数
+void Timebase_Begin(void);
+
+// 今の時刻 [us]
+static inline uint64_t Timebase_nowUs(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint64_t now;
+
+    __disable_irq();
+    now = TimebaseCore_update(&timebase.core, *timebase.counter);
+    __set_PRIMASK(primask);
+    return now;
+}
+
+// 時刻を進めておく関数（カウンタが 1 周するより短い周期の割り込みから呼ぶ）
+static inline void Timebase_tick(void)
+{
+    (void)Timebase_nowUs();
+}
+
+// 今の時刻 [us] の下位 32 ビット（差を取れば約 71 分まで正しい）
+static inline uint32_t Timebase_micros(void)
+{
+    return (uint32_t)Timebase_nowUs();
+}
+
+// *last_us からの経過時間 [s] を返し、*last_us を今の時刻にする
+static inline float Timebase_elapsed(uint64_t *last_us)
+{
+    uint64_t now = Timebase_nowUs();
+    float elapsed = (float)(now - *last_us) * 1e-6f;
+    *last_us = now;
+    return elapsed;
+}
+
+#endif /* TIMEBASE_H_ */
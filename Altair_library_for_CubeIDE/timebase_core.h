@@ -0,0 +1,50 @@
+#ifndef TIMEBASE_CORE_H_
+#define TIMEBASE_CORE_H_
+
+// 32 ビットのフリーランカウンタを、桁あふれしない 64 ビットの時刻 [us] に拡張する（ヘッダのみ）
+//   - 読むたびに前回からの差分（32 ビットの引き算なので、カウンタが 1 周を越えなければ桁あふれしても正しい）を us に直して足す
+//   - us に直す割り算は 32 ビット 1 回だけ（1 カウント 1us なら割り算なし）。余りのカウントは次回に持ち越すので誤差は積もらない
+//   - カウンタが 1 周する前に 1 回は読むこと（168MHz の DWT->CYCCNT で約 25 秒、1MHz の 32 ビットタイマで約 71 分）
+//   - 割り込みと同時に読む場合は、呼ぶ側で割り込みを止める
+// CubeIDE（timebase.h）/ Arduino（Timebase.h）で同一内容
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t last_count;      // 前回 us に直したところまでのカウント
+    uint32_t counts_per_us;   // 1us あたりのカウント（0 なら未初期化）
+    uint64_t now_us;          // 今の時刻 [us]
+} TimebaseCore;
+
+// count: 今のカウンタの値（ここを 0 とせず、now_us から続ける）
+static inline void TimebaseCore_Init(TimebaseCore *timebase, uint32_t counts_per_us, uint32_t count)
+{
+    timebase->last_count = count;
+    timebase->counts_per_us = counts_per_us;
+}
+
+// 今のカウンタの値から時刻 [us] を求める
+static inline uint64_t TimebaseCore_update(TimebaseCore *timebase, uint32_t count)
+{
+    uint32_t elapsed = count - timebase->last_count;
+    uint32_t us;
+
+    if (timebase->counts_per_us == 1)
+    {
+        us = elapsed;
+    }
+    else if (timebase->counts_per_us != 0)
+    {
+        us = elapsed / timebase->counts_per_us;
+    }
+    else
+    {
+        return timebase->now_us;
+    }
+    timebase->last_count += us * timebase->counts_per_us;
+    timebase->now_us += us;
+    return timebase->now_us;
+}
+
+#endif /* TIMEBASE_CORE_H_ */
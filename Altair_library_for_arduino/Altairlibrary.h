@@ -5,15 +5,24 @@
 #define ALTAIRLIBRARY_H
 
 #include <Arduino.h>
+#include "Timebase.h"
+#include "hal_policy.h"
 #include "Encoder.h"
 #include "MotorDriver.h"
 #include "PIDController.h"
+#include "pid_autotune.h"
+#include "GainSchedule.h"
+#include "MotionProfile.h"
+#include "safety_monitor.h"
 #include "TwoWheelKinematics.h"
 #include "Kinematics.h"
 
 // #include "RobotControl.h"
+#include "StaticRobotControl.h"
 
 #include "InverseKinematics.h"
+#include "PathFollower.h"
+#include "msg_schema.h"
 #include "mdd.h"
 
 #endif // ALTAIRLIBRARY_H
@@ -2,25 +2,15 @@
 #define ENCODER_H
 
 #include <Arduino.h>
+#include "hal_policy.h"
 
-class Encoder {
+// A/B 相エンコーダ（両相の CHANGE 割り込み、4 逓倍）
+// 解読と回転数の計算は hal_core.h の HalEncoder（getCount / getRPS / reset）で、ピンの読み出しは AltairHal
+// counts_per_rev: 1 回転あたりのカウント（既定は ENCODER_DEFAULT_COUNTS_PER_REV = 8192）
+class Encoder : public HalEncoder<AltairHal> {
 public:
-    Encoder(uint8_t pinA, uint8_t pinB);
-
-    int32_t getCount();
-    float getRPS();
-    void reset();
-
-private:
-    void counterArise();
-    void counterAfall();
-    void counterBrise();
-    void counterBfall();
-
-    volatile int32_t encoder_count;
-    int32_t last_count;
-    uint8_t pinA, pinB;
-    unsigned long last_time;
+    Encoder(uint8_t pinA, uint8_t pinB, float counts_per_rev = ENCODER_DEFAULT_COUNTS_PER_REV)
+        : HalEncoder<AltairHal>(pinA, pinB, counts_per_rev) {}
 };
 
 #endif // ENCODER_H
@@ -2,46 +2,116 @@
 #define KINEMATICS_H
 
 #include <cmath>
+#include "twist_limit.h"
 
 enum KinematicsMode {
     Mecanum,
     Omni3,
-    Omni4
+    Omni4,
+    TwoWheel   // 差動二輪（wheel_speeds[0] が右、[1] が左。R はタイヤ間距離の半分、vy は無視）
 };
 
+// 車輪の目標値の単位（mbed 版と同じ）
+enum ControlMode {
+    RPS_MODE,
+    MMPS_MODE // mm/s
+};
+
+// calculate が実際に出した機体速度（車輪の飽和で縮めた後。単位は calculate に渡した値と同じ）
+// Kinematics には残さず返り値で渡す（mbed 版と同じ）
+struct AppliedTwist {
+    double vx;
+    double vy;
+    double omega;
+    bool saturated;   // どれかの車輪が上限に掛かって縮めた
+};
+
+// 車輪の上限 [rad/s] を設定すると、calculate は上限を超えないように機体速度を縮めてから各車輪の速度を出し、
+// 縮めた後の機体速度を返す
 class Kinematics {
 public:
     Kinematics(KinematicsMode mode, double R, double rw)
         : mode(mode), R(R), rw(rw) {}
 
-    void calculate(double vx, double vy, double omega, double* wheel_speeds) {
+    AppliedTwist calculate(double vx, double vy, double omega, double* wheel_speeds) {
+        // 各車輪の速度を並進成分と回転成分に分けて計算する
+        float translation[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float rotation[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float w = (1.0 / rw) * R * omega;
+        int count = 4;
+
         switch (mode) {
             case Mecanum:
-                wheel_speeds[0] = (1.0 / rw) * (vx - vy - R * omega);  // 左前
-                wheel_speeds[1] = (1.0 / rw) * (vx + vy + R * omega);  // 右前
-                wheel_speeds[2] = (1.0 / rw) * (vx - vy + R * omega);  // 右後
-                wheel_speeds[3] = (1.0 / rw) * (vx + vy - R * omega);  // 左後
+                translation[0] = (1.0 / rw) * (vx - vy);  // 左前
+                translation[1] = (1.0 / rw) * (vx + vy);  // 右前
+                translation[2] = (1.0 / rw) * (vx - vy);  // 右後
+                translation[3] = (1.0 / rw) * (vx + vy);  // 左後
+                rotation[0] = -w;
+                rotation[1] = w;
+                rotation[2] = w;
+                rotation[3] = -w;
                 break;
 
             case Omni3:
-                wheel_speeds[0] = (1.0 / rw) * (vx + R * omega);  // 前
-                wheel_speeds[1] = (1.0 / rw) * (-vx / 2.0 + (std::sqrt(3) / 2.0) * vy + R * omega);  // 左後
-                wheel_speeds[2] = (1.0 / rw) * (-vx / 2.0 - (std::sqrt(3) / 2.0) * vy + R * omega);  // 右後
+                translation[0] = (1.0 / rw) * vx;  // 前
+                translation[1] = (1.0 / rw) * (-vx / 2.0 + (std::sqrt(3) / 2.0) * vy);  // 左後
+                translation[2] = (1.0 / rw) * (-vx / 2.0 - (std::sqrt(3) / 2.0) * vy);  // 右後
+                rotation[0] = rotation[1] = rotation[2] = w;
+                count = 3;
                 break;
 
             case Omni4:
-                wheel_speeds[0] = (1.0 / rw) * (-std::sqrt(2)/2.0 * vx + std::sqrt(2)/2.0 * vy + R * omega);  // 左前
-                wheel_speeds[1] = (1.0 / rw) * (std::sqrt(2)/2.0 * vx + std::sqrt(2)/2.0 * vy + R * omega);   // 右前
-                wheel_speeds[2] = (1.0 / rw) * (std::sqrt(2)/2.0 * vx - std::sqrt(2)/2.0 * vy + R * omega);   // 右後
-                wheel_speeds[3] = (1.0 / rw) * (-std::sqrt(2)/2.0 * vx - std::sqrt(2)/2.0 * vy + R * omega);  // 左後
+                translation[0] = (1.0 / rw) * (-std::sqrt(2)/2.0 * vx + std::sqrt(2)/2.0 * vy);  // 左前
+                translation[1] = (1.0 / rw) * (std::sqrt(2)/2.0 * vx + std::sqrt(2)/2.0 * vy);   // 右前
+                translation[2] = (1.0 / rw) * (std::sqrt(2)/2.0 * vx - std::sqrt(2)/2.0 * vy);   // 右後
+                translation[3] = (1.0 / rw) * (-std::sqrt(2)/2.0 * vx - std::sqrt(2)/2.0 * vy);  // 左後
+                rotation[0] = rotation[1] = rotation[2] = rotation[3] = w;
                 break;
+
+            case TwoWheel:
+                translation[0] = translation[1] = (1.0 / rw) * vx;
+                rotation[0] = w;
+                rotation[1] = -w;
+                vy = 0.0;
+                count = 2;
+                break;
+        }
+
+        // 車輪の飽和を解いて、全車輪が上限に収まる機体速度にする
+        float wheel[4];
+        float st, sr;
+        TwistLimit_solve(translation, rotation, wheel_limit, count, limit_policy, wheel, &st, &sr);
+        for (int i = 0; i < count; i++) {
+            wheel_speeds[i] = wheel[i];
         }
+        return {vx * st, vy * st, omega * sr, st < 1.0f || sr < 1.0f};
+    }
+
+    // 全車輪に同じ上限 [rad/s] を設定する（0 で制限なし）
+    void setWheelLimit(double limit) {
+        for (int i = 0; i < 4; i++) {
+            wheel_limit[i] = limit;
+        }
+    }
+
+    // 車輪ごとの上限 [rad/s] を設定する（limits は車輪数分）
+    void setWheelLimits(const double* limits, int count) {
+        for (int i = 0; i < 4; i++) {
+            wheel_limit[i] = (i < count) ? limits[i] : 0.0f;
+        }
+    }
+
+    // 飽和時の方針（TWIST_LIMIT_UNIFORM / TWIST_LIMIT_ROTATION_FIRST / TWIST_LIMIT_TRANSLATION_FIRST）
+    void setLimitPolicy(TwistLimitPolicy policy) {
+        limit_policy = policy;
     }
 
 private:
     KinematicsMode mode;
     double R;  // ロボットの旋回半径
     double rw; // オムニホイールの半径
+    float wheel_limit[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    TwistLimitPolicy limit_policy = TWIST_LIMIT_UNIFORM;
 };
 
 #endif // KINEMATICS_H
@@ -2,22 +2,35 @@
 #define MOTOR_DRIVER_H
 
 #include <Arduino.h>
+#include "hal_policy.h"
 
-class MotorDriver
+// PWM 2 本で正転・逆転するモータドライバ（analogWrite、Duty の上限 250/255）
+// 出力は hal_core.h の HalMotorDriver（setDuty / setDecayMode / stop / brake）で、ピンへの書き込みは AltairHal
+class MotorDriver : public HalMotorDriver<AltairHal>
 {
 public:
-    MotorDriver(int pin1, int pin2);
+    MotorDriver(int pin1, int pin2) : HalMotorDriver<AltairHal>(pin1, pin2, 0, maxPWM / 255.0f) {}
 
-    void setSpeed(int speed);
-    void brake();
-    void stop();
+    // 速度を -250〜250 で設定する（0 はフリーランで停止）
+    void setSpeed(int speed)
+    {
+        if (speed > maxPWM)
+            speed = maxPWM;
+        if (speed < -maxPWM)
+            speed = -maxPWM;
 
-private:
-    int pin1, pin2;
-    const int maxPWM = 250;
+        if (speed == 0)
+        {
+            stop();
+        }
+        else
+        {
+            setDuty(speed / 255.0f);
+        }
+    }
 
-    void forward(int speed);
-    void reverse(int speed);
+private:
+    static const int maxPWM = 250;
 };
 
 #endif // MOTOR_DRIVER_H
@@ -0,0 +1,100 @@
+#ifndef MOTOR_OUTPUT_H
+#define MOTOR_OUTPUT_H
+
+// PID 出力とモータドライバの間に入れる出力整形段
+//   - 逆起電力フィードフォワード（目標 RPS × kV）
+//   - 静止摩擦の不感帯補償
+//   - Duty 変化率（スルーレート）制限（1 回に動かせる量は、update に渡す実測の周期 dt から決める）
+// 出力は -max_duty〜max_duty の Duty（小数）
+struct MotorOutputConfig {
+    float kv;          // フィードフォワードゲイン [duty / 目標値の単位]（0 で無効）
+    float deadband;    // 静止摩擦を超えるのに必要な最小 Duty（0 で無効）
+    float slew_rate;   // Duty の最大変化率 [duty / s]（0 で無効）
+    float max_duty;    // Duty の上限
+};
+
+class MotorOutput {
+public:
+    explicit MotorOutput(const MotorOutputConfig& config = {0.0f, 0.0f, 0.0f, 0.95f})
+        : duty(0.0f) {
+        setConfig(config);
+    }
+
+    void setConfig(const MotorOutputConfig& new_config) {
+        config = new_config;
+        // [0, max_duty] を [deadband, max_duty] に写像する傾き
+        deadband_gain = (config.max_duty > 0.0f) ? (config.max_duty - config.deadband) / config.max_duty : 0.0f;
+    }
+
+    // control: PID 出力（Duty 換算）、target: フィードフォワード用の目標値（RPS_MODE なら rps）
+    // dt: 前回の update からの経過時間 [s]（制御ループで実測した値）
+    float update(float control, float target, float dt) {
+        return update(control, target, dt, config.max_duty);
+    }
+
+    // limit: この周期の Duty の上限（安全監視で絞るときなど。max_duty より大きければ max_duty）
+    // PID の出力制限を -limit - ff〜limit - ff（ff はフィードフォワードの合計）にしておくと、
+    // ここで上限に張り付くのと PID の飽和が一致し、アンチワインドアップが実際の飽和で効く
+    float update(float control, float target, float dt, float limit) {
+        if (limit > config.max_duty) limit = config.max_duty;
+        if (limit < 0.0f) limit = 0.0f;
+
+        float u = control + getFeedforward(target);
+        if (u > limit) u = limit;
+        if (u < -limit) u = -limit;
+        u = compensateDeadband(u);
+
+        // スルーレート制限（周期が揺れても変化率 [duty / s] が slew_rate を超えない）
+        float max_step = (config.slew_rate > 0.0f) ? config.slew_rate * dt : config.max_duty * 2.0f;
+        float step = u - duty;
+        if (step > max_step) step = max_step;
+        if (step < -max_step) step = -max_step;
+        duty += step;
+
+        // 上限を下げた周期は、スルーレートを待たずに上限まで下げる
+        float top = compensateDeadband(limit);
+        if (duty > top) duty = top;
+        if (duty < -top) duty = -top;
+
+        return duty;
+    }
+
+    // 目標値に対するフィードフォワード [duty]
+    float getFeedforward(float target) const {
+        return config.kv * target;
+    }
+
+    float getMaxDuty() const {
+        return config.max_duty;
+    }
+
+    float getDuty() const {
+        return duty;
+    }
+
+    void reset() {
+        duty = 0.0f;
+    }
+
+private:
+    static constexpr float ZERO_THRESHOLD = 1e-3f;
+
+    MotorOutputConfig config;
+    float duty;          // 前回出力した Duty
+    float deadband_gain;
+
+    // 不感帯補償（ごく小さい指令は 0 のまま）
+    float compensateDeadband(float u) const {
+        if (config.deadband <= 0.0f) {
+            return u;
+        }
+        if (u > ZERO_THRESHOLD) {
+            return config.deadband + u * deadband_gain;
+        } else if (u < -ZERO_THRESHOLD) {
+            return -config.deadband + u * deadband_gain;
+        }
+        return 0.0f;
+    }
+};
+
+#endif // MOTOR_OUTPUT_H
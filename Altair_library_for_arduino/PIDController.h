@@ -1,36 +1,54 @@
 #ifndef PID_CONTROLLER_H_
 #define PID_CONTROLLER_H_
 
+#include "pid_core.h"
+
+// PID 演算は pid_core.h（CubeIDE / mbed と共通）で行う
 class PIDController {
 public:
+    // time_constant: 微分フィルタの時定数 [s]、dt: サンプリング時間 [s]
     PIDController(float Kp, float Ki, float Kd, float time_constant, float dt)
-        : Kp(Kp), Ki(Ki), Kd(Kd), time_constant(time_constant), dt(dt),
-          prev_error(0), integral(0), prev_output(0) {}
+        : dt(dt) {
+        PidCore_Init(&core);
+        PidCore_setGain(&core, Kp, Ki, Kd, time_constant);
+    }
 
+    // PID計算メソッド
     float compute(float setpoint, float measured_value) {
-        float error = setpoint - measured_value;
-        integral += error * dt;
-        float derivative = (error - prev_error) / dt;
-        float output = Kp * error + Ki * integral + Kd * derivative;
-        output = (prev_output * time_constant + output) / (time_constant + dt);
-        prev_error = error;
-        prev_output = output;
-        return output;
+        return PidCore_update(&core, setpoint, measured_value, dt);
+    }
+
+    // 周期が一定でない場合は実測の経過時間 [s] を渡す
+    float compute(float setpoint, float measured_value, float elapsed) {
+        return PidCore_update(&core, setpoint, measured_value, elapsed);
+    }
+
+    void setGains(float Kp, float Ki, float Kd, float time_constant) {
+        PidCore_setGain(&core, Kp, Ki, Kd, time_constant);
+    }
+
+    // 微分フィルタの時定数はそのままでゲインだけ変更する（オートチューン結果の反映など）
+    void setGains(float Kp, float Ki, float Kd) {
+        PidCore_setGain(&core, Kp, Ki, Kd, core.tf);
+    }
+
+    // 出力の上下限（アクチュエータの飽和）。飽和中は積分を止めて I 項を戻す
+    void setOutputLimits(float output_min, float output_max) {
+        PidCore_setOutputLimit(&core, output_min, output_max);
+    }
+
+    // 2 自由度 PID の目標値重み（P 項: b, D 項: c）。既定は b=1, c=0（微分先行型）
+    void setSetpointWeights(float b, float c) {
+        PidCore_setSetpointWeight(&core, b, c);
     }
 
     void reset() {
-        prev_error = 0;
-        integral = 0;
-        prev_output = 0;
+        PidCore_reset(&core);
     }
 
 private:
-    float Kp, Ki, Kd;
-    float time_constant;
-    float dt;
-    float prev_error;
-    float integral;
-    float prev_output;
+    PidCore core;            // PID 演算コア
+    float dt;                // サンプリング時間
 };
 
 #endif // PID_CONTROLLER_H_
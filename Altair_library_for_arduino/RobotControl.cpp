@@ -1,42 +1,233 @@
 #include "RobotControl.h"
 
 RobotControl::RobotControl(RobotMode mode, double wheel_radius_mm, double turning_radius_mm)
-    : mode(mode), wheel_radius_mm(wheel_radius_mm), turning_radius_mm(turning_radius_mm) {
+    : mode(mode), wheel_radius_mm(wheel_radius_mm), turning_radius_mm(turning_radius_mm), battery_voltage(0.0f),
+      kinematics((mode == Mecanum_Mode) ? Mecanum : (mode == Omni3_Mode) ? Omni3 : (mode == Omni4_Mode) ? Omni4 : TwoWheel,
+                 turning_radius_mm, wheel_radius_mm),
+      two_wheel(nullptr), autotune_motor(-1), last_time(0) {
+    if (mode == TwoWheel_Mode) {
+        two_wheel = new TwoWheelKinematics(wheel_radius_mm * 2.0, turning_radius_mm * 2.0);
+    }
     for (int i = 0; i < 4; i++) {
         motors[i] = nullptr;
         encoders[i] = nullptr;
         pids[i] = nullptr;
+        schedules[i] = nullptr;
         target_speeds[i] = 0.0;
         current_speeds[i] = 0.0;
+        duties[i] = 0.0f;
     }
+    SafetyConfig safety_config = {};
+    SafetyMonitor_Init(&safety, &safety_config);
+}
+
+RobotControl::~RobotControl() {
+    noInterrupts();  // エンコーダの割り込みを外してから解放する
+    for (int i = 0; i < 4; i++) {
+        delete encoders[i];
+    }
+    interrupts();
+    for (int i = 0; i < 4; i++) {
+        delete motors[i];
+        delete pids[i];
+    }
+    delete two_wheel;
 }
 
 void RobotControl::configureMotor(int motor_index, int pin1, int pin2) {
     if (motor_index >= 0 && motor_index < 4) {
+        delete motors[motor_index];  // 設定し直すときは前のものを解放する
         motors[motor_index] = new MotorDriver(pin1, pin2);
     }
 }
 
 void RobotControl::configureEncoder(int motor_index, int pinA, int pinB) {
     if (motor_index >= 0 && motor_index < 4) {
+        // 前のものは A/B 相の割り込みを外してから解放する（片方だけ外れた状態で割り込みが入らないよう、割り込み禁止で行う）
+        noInterrupts();
+        delete encoders[motor_index];
+        encoders[motor_index] = nullptr;
+        interrupts();
         encoders[motor_index] = new Encoder(pinA, pinB);
     }
 }
 
 void RobotControl::setPIDGains(int motor_index, float kp, float ki, float kd, float time_constant) {
     if (motor_index >= 0 && motor_index < 4) {
-        pids[motor_index] = new PIDController(kp, ki, kd, time_constant, 0.01);
+        // 2 回目からは作り直さずにゲインだけ変える（制御中でも積分が途切れない）
+        // 出力制限は startControl が毎周期、出力段の Duty の上限から決める
+        if (pids[motor_index]) {
+            pids[motor_index]->setGains(kp, ki, kd, time_constant);
+        } else {
+            pids[motor_index] = new PIDController(kp, ki, kd, time_constant, 0.01);
+        }
+    }
+}
+
+void RobotControl::setOutputConfig(int motor_index, const MotorOutputConfig& config) {
+    if (motor_index >= 0 && motor_index < 4) {
+        outputs[motor_index].setConfig(config);
+    }
+}
+
+void RobotControl::setDecayMode(int motor_index, DecayMode decay_mode) {
+    if (motor_index >= 0 && motor_index < 4 && motors[motor_index]) {
+        motors[motor_index]->setDecayMode(decay_mode);
     }
 }
 
 void RobotControl::startControl(double vx_mm_s, double vy_mm_s, double omega_deg_s) {
     double wheel_speeds[4];  // ローカル変数として宣言
-    calculateWheelSpeeds(vx_mm_s, vy_mm_s, omega_deg_s, wheel_speeds);
+
+    // 周期は loop() の中身で揺れるので、前回の呼び出しからの実測の経過時間を dt にする
+    // （最初の 1 回や 100ms 以上空いたときは 10ms とする。StaticRobotControl と同じ）
+    float dt = Timebase::elapsed(last_time);
+    if (dt <= 0.0f || dt > 0.1f) {
+        dt = 0.01f;
+    }
+
+    // 差動二輪は左右のエンコーダから自己位置を更新する
+    if (two_wheel && encoders[0] && encoders[1]) {
+        two_wheel->updateOdometry(*encoders[0], *encoders[1]);
+    }
+
+    // 目標の時点で車輪が飽和するなら、運動学で出せる速度に縮めた目標にしておく
+    AppliedTwist applied = calculateWheelSpeeds(vx_mm_s, vy_mm_s, omega_deg_s, wheel_speeds);
+    profile.setTarget(applied.vx, applied.vy, applied.omega * 180.0 / M_PI);
+
+    // 速度プロファイルを 1 周期進め、途中の速度で飽和した場合は縮めた速度にプロファイルを合わせる
+    profile.setPeriod(dt);
+    profile.update();
+    applied = calculateWheelSpeeds(profile.getVx(), profile.getVy(), profile.getOmega(), wheel_speeds);
+    if (applied.saturated) {
+        profile.limitVelocity(applied.vx, applied.vy, applied.omega * 180.0 / M_PI);
+    }
+
+    // 安全監視を先に進め、この周期の Duty の上限（倍率 × max_duty）を決める（ブレーキ中はオートチューンも打ち切る）
+    // 拘束の判定には、今の速度を生んだ前の周期の Duty を使う
     for (int i = 0; i < 4; i++) {
-        setWheelSpeed(i, wheel_speeds[i]);
+        target_speeds[i] = wheel_speeds[i];
+        if (!motors[i] || !pids[i]) {
+            continue;  // 使わない車輪
+        }
+        current_speeds[i] = encoders[i] ? encoders[i]->getRPS() : 0.0;
+        if (i != autotune_motor) {
+            SafetyMonitor_checkMotor(&safety, i, duties[i], target_speeds[i], current_speeds[i], dt);
+        }
+    }
+    float scale = SafetyMonitor_update(&safety, dt);
+    if (safety.state == SAFETY_BRAKE) {
+        autotune_motor = -1;
+        profile.reset(0.0f, 0.0f, 0.0f);  // 再開するときは静止から加速させる
+    }
+    for (int i = 0; i < 4; i++) {
+        if (!motors[i] || !pids[i]) {
+            continue;
+        }
+        if (safety.state == SAFETY_BRAKE) {
+            duties[i] = 0.0f;
+            motors[i]->brake();
+        } else {
+            duties[i] = computeWheelDuty(i, dt, outputs[i].getMaxDuty() * scale);
+            motors[i]->setDuty(duties[i]);
+        }
+    }
+}
+
+// 機体速度 [mm/s, deg/s] から各車輪の目標回転数 [rps] を求める
+AppliedTwist RobotControl::calculateWheelSpeeds(double vx_mm_s, double vy_mm_s, double omega_deg_s, double* wheel_speeds) {
+    for (int i = 0; i < 4; i++) {
+        wheel_speeds[i] = 0.0;  // 使わない車輪は 0
+    }
+    AppliedTwist applied = kinematics.calculate(vx_mm_s, vy_mm_s, omega_deg_s * M_PI / 180.0, wheel_speeds);
+    for (int i = 0; i < 4; i++) {
+        wheel_speeds[i] /= 2.0 * M_PI;  // rad/s → rps
+    }
+    return applied;
+}
+
+
+void RobotControl::setGainSchedule(int motor_index, const GainSchedule* schedule) {
+    if (motor_index >= 0 && motor_index < 4) {
+        schedules[motor_index] = schedule;
     }
 }
 
+void RobotControl::setBatteryVoltage(float voltage) {
+    battery_voltage = voltage;
+}
+
+void RobotControl::setMotionLimits(const MotionProfileConfig& config) {
+    profile.setConfig(config);
+}
+
+void RobotControl::setWheelSpeedLimit(double limit, TwistLimitPolicy policy) {
+    kinematics.setWheelLimit(limit * 2.0 * M_PI);  // rps → rad/s
+    kinematics.setLimitPolicy(policy);
+}
+
+void RobotControl::startAutotune(int motor_index, const PidAutotuneConfig& config) {
+    if (motor_index < 0 || motor_index >= 4 || !motors[motor_index] || !encoders[motor_index]) {
+        return;
+    }
+    if (!PidAutotune_Init(&autotune, &config)) {
+        return;  // 試験できない設定（getAutotuneResult は false を返す）
+    }
+    PidAutotune_start(&autotune);
+    autotune_motor = motor_index;
+}
+
+bool RobotControl::isAutotuneRunning() {
+    return autotune_motor >= 0;
+}
+
+bool RobotControl::getAutotuneResult(PidAutotuneResult& result) {
+    if (autotune_motor >= 0 || autotune.state != PID_AUTOTUNE_DONE) {
+        return false;
+    }
+    result = autotune.result;
+    return true;
+}
+
+void RobotControl::setSafetyConfig(const SafetyConfig& config) {
+    safety.config = config;
+}
+
+void RobotControl::feedCommand() {
+    SafetyMonitor_feed(&safety);
+    if (safety.state == SAFETY_BRAKE && SafetyMonitor_isRecoverable(&safety)) {
+        resetSafety();
+    }
+}
+
+void RobotControl::emergencyStop() {
+    SafetyMonitor_trip(&safety, SAFETY_FAULT_EMERGENCY);
+    stopControl();  // 次の startControl を待たずにブレーキをかける
+}
+
+void RobotControl::resetSafety() {
+    SafetyMonitor_reset(&safety);
+    profile.reset(0.0f, 0.0f, 0.0f);
+    for (int i = 0; i < 4; i++) {
+        if (pids[i]) {
+            pids[i]->reset();  // ブレーキ中にたまった積分を捨てる
+        }
+        outputs[i].reset();
+    }
+}
+
+SafetyState RobotControl::getSafetyState() {
+    return safety.state;
+}
+
+uint8_t RobotControl::getSafetyFaults() {
+    return safety.faults;
+}
+
+float RobotControl::getSafetyLatency() {
+    return safety.max_latency;
+}
+
 void RobotControl::stopControl() {
     for (int i = 0; i < 4; i++) {
         if (motors[i]) {
@@ -54,6 +245,19 @@ double RobotControl::getMotorOutput(int motor_index) {
 }
 
 
+Position RobotControl::getPosition() {
+    if (!two_wheel) {
+        return {0.0f, 0.0f, 0.0f};
+    }
+    return two_wheel->getPosition();
+}
+
+void RobotControl::resetPosition(float x_mm, float y_mm, float theta_deg) {
+    if (two_wheel) {
+        two_wheel->resetOdometry(x_mm, y_mm, theta_deg);
+    }
+}
+
 double RobotControl::getTargetRPS(int motor_index) {
     if (motor_index >= 0 && motor_index < 4) {
         return target_speeds[motor_index];
@@ -62,10 +266,31 @@ double RobotControl::getTargetRPS(int motor_index) {
 }
 
 // ここに新しく追加した関数
-void RobotControl::setWheelSpeed(int motor_index, double target_rps) {
-    if (motor_index >= 0 && motor_index < 4 && motors[motor_index] && pids[motor_index]) {
-        double current_rps = encoders[motor_index]->getRPS();
-        double pid_output = pids[motor_index]->compute(target_rps, current_rps);
-        motors[motor_index]->setSpeed(pid_output);
+float RobotControl::computeWheelDuty(int motor_index, float dt, float limit) {
+    double target_rps = target_speeds[motor_index];
+    double current_rps = current_speeds[motor_index];
+    if (motor_index == autotune_motor) {
+        float duty = PidAutotune_update(&autotune, current_rps, dt);
+        if (!PidAutotune_isRunning(&autotune)) {
+            if (autotune.state == PID_AUTOTUNE_DONE) {
+                pids[motor_index]->setGains(autotune.result.kp, autotune.result.ki, autotune.result.kd);
+                pids[motor_index]->reset();
+            }
+            autotune_motor = -1;
+        }
+        if (duty > limit) duty = limit;
+        if (duty < -limit) duty = -limit;
+        return duty;
+    }
+    double feedforward = 0.0;
+    if (schedules[motor_index]) {
+        GainSchedulePoint gains = schedules[motor_index]->lookup(target_rps, battery_voltage);
+        pids[motor_index]->setGains(gains.kp, gains.ki, gains.kd);
+        feedforward = gains.ff;
     }
+    // PID 出力は Duty として扱う。PID が飽和するのを、出力段で Duty が上限に張り付くところに合わせる（フィードフォワードの分を除く）
+    float offset = static_cast<float>(feedforward) + outputs[motor_index].getFeedforward(target_rps);
+    pids[motor_index]->setOutputLimits(-limit - offset, limit - offset);
+    double pid_output = pids[motor_index]->compute(target_rps, current_rps, dt) + feedforward;
+    return outputs[motor_index].update(pid_output, target_rps, dt, limit);
 }
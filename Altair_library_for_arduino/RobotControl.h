@@ -2,27 +2,74 @@
 #define ROBOT_CONTROL_H
 
 #include "MotorDriver.h"
+#include "Kinematics.h"
+#include "TwoWheelKinematics.h"
+#include "MotorOutput.h"
 #include "Encoder.h"
 #include "PIDController.h"
+#include "pid_autotune.h"
+#include "GainSchedule.h"
+#include "MotionProfile.h"
+#include "safety_monitor.h"
+#include "Timebase.h"
 
 enum RobotMode {
     Omni4_Mode,
     Omni3_Mode,
-    Mecanum_Mode
+    Mecanum_Mode,
+    TwoWheel_Mode   // 差動二輪（motor 0 が右、motor 1 が左。turning_radius_mm はタイヤ間距離の半分）
 };
 
+// 設定を実行時に行う（new で確保する）版。設定がコンパイル時に決まるなら StaticRobotControl.h の方が軽い
 class RobotControl {
 public:
     RobotControl(RobotMode mode, double wheel_radius_mm, double turning_radius_mm);
+    ~RobotControl();
+    RobotControl(const RobotControl&) = delete;
+    RobotControl& operator=(const RobotControl&) = delete;
 
     void configureMotor(int motor_index, int pin1, int pin2);
     void configureEncoder(int motor_index, int pinA, int pinB);
     void setPIDGains(int motor_index, float kp, float ki, float kd, float time_constant);
+    void setOutputConfig(int motor_index, const MotorOutputConfig& config);
+    void setDecayMode(int motor_index, DecayMode decay_mode);
+    // 目標回転数に応じて PID ゲインとフィードフォワードを切り替える（nullptr で固定ゲインに戻す）
+    void setGainSchedule(int motor_index, const GainSchedule* schedule);
+    // ゲインスケジュールの電圧補正に使う電池電圧 [V]
+    void setBatteryVoltage(float voltage);
+    // 機体速度の加速度・躍度制限（既定は制限なし＝startControl の値をそのまま使う）
+    void setMotionLimits(const MotionProfileConfig& config);
+    // 車輪の目標値の上限（RPS_MODE なら rps、MMPS_MODE なら mm/s。0 で制限なし）
+    // 超える車輪があると、policy に従って機体速度を縮める（既定は全体を比率を保ったまま縮める）
+    void setWheelSpeedLimit(double limit, TwistLimitPolicy policy = TWIST_LIMIT_UNIFORM);
     void startControl(double vx_mm_s, double vy_mm_s, double omega_deg_s);
     void stopControl();
     double getMotorOutput(int motor_index);
+
+    // 安全監視（指令の途絶・拘束・暴走で止める。既定はすべて監視しない。速度の単位は rps）
+    // startControl は指令がなくても毎周期呼ぶので、上位機から指令を受け取ったときに feedCommand を呼ぶ
+    void setSafetyConfig(const SafetyConfig& config);
+    // 指令を受け取ったことを知らせる（指令の途絶・停止要求で止まっていたなら再開する）
+    void feedCommand();
+    // すぐにブレーキをかける（resetSafety まで再開しない）
+    void emergencyStop();
+    void resetSafety();
+    SafetyState getSafetyState();
+    uint8_t getSafetyFaults();
+    // 異常が始まってからブレーキまでの時間の最大値 [s]
+    float getSafetyLatency();
+
+    // リレー帰還オートチューン：startControl を呼ぶたびに 1 周期分試験し、終了後に PID ゲインへ反映する
+    void startAutotune(int motor_index, const PidAutotuneConfig& config);
+    bool isAutotuneRunning();
+    bool getAutotuneResult(PidAutotuneResult& result);
     double getTargetRPS(int motor_index);
-    void calculateWheelSpeeds(double vx_mm_s, double vy_mm_s, double omega_deg_s, double* wheel_speeds);
+
+    // 差動二輪の自己位置（TwoWheel_Mode で motor 0, 1 のエンコーダを設定したとき、startControl ごとに更新）
+    Position getPosition();
+    void resetPosition(float x_mm = 0.0f, float y_mm = 0.0f, float theta_deg = 0.0f);
+    // 各車輪の目標 [rps] を出し、車輪の飽和で縮めた後の機体速度（omega は rad/s）を返す
+    AppliedTwist calculateWheelSpeeds(double vx_mm_s, double vy_mm_s, double omega_deg_s, double* wheel_speeds);
 
 private:
     RobotMode mode;
@@ -31,11 +78,24 @@ private:
     MotorDriver* motors[4];
     Encoder* encoders[4];
     PIDController* pids[4];
+    MotorOutput outputs[4];
+    const GainSchedule* schedules[4];
+    float battery_voltage;
+    MotionProfile profile;
+    Kinematics kinematics;
+    TwoWheelKinematics* two_wheel;
+    PidAutotune autotune;
+    int autotune_motor;
     double target_speeds[4];
     double current_speeds[4];
+    float duties[4];  // 直前に出力した Duty（拘束の判定用）
+    uint64_t last_time;  // 前回 startControl を呼んだ時刻 [us]
+    SafetyMonitor safety;
+
+    // 新しく追加する関数の宣言（target_speeds / current_speeds から出力する Duty を求める）
+    // dt: 前回の startControl からの経過時間 [s]、limit: この周期の Duty の上限
+    float computeWheelDuty(int motor_index, float dt, float limit);
 
-    // 新しく追加する関数の宣言
-    void setWheelSpeed(int motor_index, double target_rps);
 };
 
 #endif // ROBOT_CONTROL_H
@@ -0,0 +1,279 @@
+#ifndef STATIC_ROBOT_CONTROL_H
+#define STATIC_ROBOT_CONTROL_H
+
+#include <utility>
+#include "MotorDriver.h"
+#include "Kinematics.h"
+#include "TwoWheelKinematics.h"
+#include "MotorOutput.h"
+#include "Encoder.h"
+#include "PIDController.h"
+#include "GainSchedule.h"
+#include "MotionProfile.h"
+#include "safety_monitor.h"
+#include "Timebase.h"
+
+// 動的確保なしの RobotControl
+//   - モータ・エンコーダ・PID・運動学をすべてメンバとして持つ（new を使わない）
+//   - 設定は constexpr の robotConfig<N>() から .wheel<I>() で組み立て、全車輪を設定したかをコンパイル時に確認する
+//   - 車輪数と運動学の組み合わせ（Mecanum は 4 輪など）もコンパイル時に確認する
+//   - 制御は RobotControl と同じく startControl を 10ms ごとに呼ぶ（安全監視も RobotControl と同じ）
+//
+//   constexpr auto config = robotConfig<3>(30.0, 120.0)
+//       .wheel<0>({2, 3, 18, 19, 1.0f, 0.1f, 0.01f, 0.5f})   // {モーター1, モーター2, エンコーダA, エンコーダB, kp, ki, kd, 時定数}
+//       .wheel<1>({4, 5, 20, 21, 1.0f, 0.1f, 0.01f, 0.5f})
+//       .wheel<2>({6, 7, 22, 23, 1.0f, 0.1f, 0.01f, 0.5f});
+//   StaticRobotControl<Omni3, 3> robot(config);
+
+// 1 輪分の設定
+struct WheelConfig {
+    int motor_pin1;
+    int motor_pin2;
+    int encoder_pin_a;
+    int encoder_pin_b;
+    float kp;
+    float ki;
+    float kd;
+    float time_constant;  // 微分フィルタの時定数 [s]
+};
+
+// Configured は設定済みの車輪のビット（.wheel<I>() のたびに型が変わる）
+template <int NMotors, unsigned Configured = 0>
+struct RobotConfig {
+    double wheel_radius_mm;
+    double turning_radius_mm;  // 差動二輪はタイヤ間距離の半分
+    WheelConfig wheels[NMotors];
+
+    template <int I>
+    constexpr RobotConfig<NMotors, Configured | (1u << I)> wheel(const WheelConfig& config) const {
+        static_assert(I >= 0 && I < NMotors, "車輪番号が範囲外です");
+        static_assert((Configured & (1u << I)) == 0, "同じ車輪を 2 回設定しています");
+        RobotConfig<NMotors, Configured | (1u << I)> next = {wheel_radius_mm, turning_radius_mm, {}};
+        for (int i = 0; i < NMotors; i++) {
+            next.wheels[i] = (i == I) ? config : wheels[i];
+        }
+        return next;
+    }
+
+    static constexpr bool isComplete() {
+        return Configured == (1u << NMotors) - 1;
+    }
+};
+
+template <int NMotors>
+constexpr RobotConfig<NMotors> robotConfig(double wheel_radius_mm, double turning_radius_mm) {
+    static_assert(NMotors > 0 && NMotors <= 4, "車輪は 1〜4 輪です");
+    return {wheel_radius_mm, turning_radius_mm, {}};
+}
+
+// 運動学のモードごとの車輪数
+constexpr int wheelCount(KinematicsMode mode) {
+    return (mode == Omni3) ? 3 : (mode == TwoWheel) ? 2 : 4;
+}
+
+// Mode: Mecanum / Omni3 / Omni4 / TwoWheel、NMotors: 車輪数
+template <KinematicsMode Mode, int NMotors>
+class StaticRobotControl {
+    static_assert(NMotors == wheelCount(Mode), "車輪数が運動学と合っていません");
+
+public:
+    template <unsigned Configured>
+    explicit StaticRobotControl(const RobotConfig<NMotors, Configured>& config)
+        : StaticRobotControl(config, std::make_index_sequence<NMotors>()) {
+        static_assert(RobotConfig<NMotors, Configured>::isComplete(), "設定していない車輪があります");
+    }
+
+    // 実行中のゲイン変更（PID の内部状態はそのまま）
+    void setPIDGains(int motor_index, float kp, float ki, float kd, float time_constant) {
+        if (motor_index >= 0 && motor_index < NMotors) {
+            pids[motor_index].setGains(kp, ki, kd, time_constant);
+        }
+    }
+
+    void setOutputConfig(int motor_index, const MotorOutputConfig& config) {
+        if (motor_index >= 0 && motor_index < NMotors) {
+            outputs[motor_index].setConfig(config);
+        }
+    }
+
+    void setDecayMode(int motor_index, DecayMode decay_mode) {
+        if (motor_index >= 0 && motor_index < NMotors) {
+            motors[motor_index].setDecayMode(decay_mode);
+        }
+    }
+
+    // 目標回転数に応じて PID ゲインとフィードフォワードを切り替える（nullptr で固定ゲインに戻す）
+    void setGainSchedule(int motor_index, const GainSchedule* schedule) {
+        if (motor_index >= 0 && motor_index < NMotors) {
+            schedules[motor_index] = schedule;
+        }
+    }
+
+    // ゲインスケジュールの電圧補正に使う電池電圧 [V]
+    void setBatteryVoltage(float voltage) {
+        battery_voltage = voltage;
+    }
+
+    // 機体速度の加速度・躍度制限（既定は制限なし＝startControl の値をそのまま使う）
+    void setMotionLimits(const MotionProfileConfig& config) {
+        profile.setConfig(config);
+    }
+
+    // 車輪の目標回転数の上限 [rps]（0 で制限なし）
+    void setWheelSpeedLimit(double limit, TwistLimitPolicy policy = TWIST_LIMIT_UNIFORM) {
+        kinematics.setWheelLimit(limit * 2.0 * M_PI);  // rps → rad/s
+        kinematics.setLimitPolicy(policy);
+    }
+
+    // 10ms ごとに呼ぶ（RobotControl::startControl と同じく 1 周期分の制御を行う）
+    // 周期は実測して PID とプロファイルに渡す（最初の 1 回や 100ms 以上空いたときは 10ms とする）
+    void startControl(double vx_mm_s, double vy_mm_s, double omega_deg_s) {
+        double wheel_speeds[4];
+        float dt = Timebase::elapsed(last_time);
+        if (dt <= 0.0f || dt > 0.1f) {
+            dt = 0.01f;
+        }
+
+        if (Mode == TwoWheel) {
+            odometry.updateOdometry(encoders[0], encoders[1]);  // 右・左
+        }
+
+        // 目標の時点で車輪が飽和するなら、運動学で出せる速度に縮めた目標にしておく
+        AppliedTwist applied = kinematics.calculate(vx_mm_s, vy_mm_s, omega_deg_s * M_PI / 180.0, wheel_speeds);
+        profile.setTarget(applied.vx, applied.vy, applied.omega * 180.0 / M_PI);
+
+        profile.setPeriod(dt);
+        profile.update();
+        applied = kinematics.calculate(profile.getVx(), profile.getVy(), profile.getOmega() * M_PI / 180.0, wheel_speeds);
+        if (applied.saturated) {
+            profile.limitVelocity(applied.vx, applied.vy, applied.omega * 180.0 / M_PI);
+        }
+
+        // 安全監視を先に進め、この周期の Duty の上限（倍率 × max_duty）を決める
+        // 拘束の判定には、今の速度を生んだ前の周期の Duty を使う
+        double current_rps[NMotors];
+        for (int i = 0; i < NMotors; i++) {
+            target_speeds[i] = wheel_speeds[i] / (2.0 * M_PI);  // rad/s → rps
+            current_rps[i] = encoders[i].getRPS();
+            SafetyMonitor_checkMotor(&safety, i, duties[i], target_speeds[i], current_rps[i], dt);
+        }
+        float scale = SafetyMonitor_update(&safety, dt);
+        if (safety.state == SAFETY_BRAKE) {
+            profile.reset(0.0f, 0.0f, 0.0f);  // 再開するときは静止から加速させる
+        }
+
+        for (int i = 0; i < NMotors; i++) {
+            if (safety.state == SAFETY_BRAKE) {
+                duties[i] = 0.0f;
+                motors[i].brake();
+                continue;
+            }
+            double target = target_speeds[i];
+            double feedforward = 0.0;
+            if (schedules[i]) {
+                GainSchedulePoint gains = schedules[i]->lookup(target, battery_voltage);
+                pids[i].setGains(gains.kp, gains.ki, gains.kd);
+                feedforward = gains.ff;
+            }
+            // PID が飽和するのを、出力段で Duty が上限に張り付くところに合わせる（フィードフォワードの分を除く）
+            float limit = outputs[i].getMaxDuty() * scale;
+            float offset = static_cast<float>(feedforward) + outputs[i].getFeedforward(target);
+            pids[i].setOutputLimits(-limit - offset, limit - offset);
+            double pid_output = pids[i].compute(target, current_rps[i], dt) + feedforward;
+            duties[i] = outputs[i].update(pid_output, target, dt, limit);
+            motors[i].setDuty(duties[i]);
+        }
+    }
+
+    void stopControl() {
+        for (int i = 0; i < NMotors; i++) {
+            motors[i].brake();
+        }
+    }
+
+    // 安全監視（RobotControl と同じ。既定はすべて監視しない）
+    void setSafetyConfig(const SafetyConfig& config) {
+        safety.config = config;
+    }
+
+    // 上位機から指令を受け取ったときに呼ぶ（指令の途絶・停止要求で止まっていたなら再開する）
+    void feedCommand() {
+        SafetyMonitor_feed(&safety);
+        if (safety.state == SAFETY_BRAKE && SafetyMonitor_isRecoverable(&safety)) {
+            resetSafety();
+        }
+    }
+
+    void emergencyStop() {
+        SafetyMonitor_trip(&safety, SAFETY_FAULT_EMERGENCY);
+        stopControl();
+    }
+
+    void resetSafety() {
+        SafetyMonitor_reset(&safety);
+        profile.reset(0.0f, 0.0f, 0.0f);
+        for (int i = 0; i < NMotors; i++) {
+            pids[i].reset();
+            outputs[i].reset();
+        }
+    }
+
+    SafetyState getSafetyState() const {
+        return safety.state;
+    }
+
+    uint8_t getSafetyFaults() const {
+        return safety.faults;
+    }
+
+    float getSafetyLatency() const {
+        return safety.max_latency;
+    }
+
+    double getTargetRPS(int motor_index) const {
+        return (motor_index >= 0 && motor_index < NMotors) ? target_speeds[motor_index] : 0.0;
+    }
+
+    // 差動二輪の自己位置（TwoWheel 以外では常に原点）
+    Position getPosition() const {
+        return odometry.getPosition();
+    }
+
+    void resetPosition(float x_mm = 0.0f, float y_mm = 0.0f, float theta_deg = 0.0f) {
+        odometry.resetOdometry(x_mm, y_mm, theta_deg);
+    }
+
+private:
+    Kinematics kinematics;
+    TwoWheelKinematics odometry;
+    MotorDriver motors[NMotors];
+    Encoder encoders[NMotors];
+    PIDController pids[NMotors];
+    MotorOutput outputs[NMotors];
+    const GainSchedule* schedules[NMotors];
+    float battery_voltage;
+    MotionProfile profile;
+    double target_speeds[NMotors];
+    float duties[NMotors];
+    SafetyMonitor safety;
+    uint64_t last_time;   // 前回 startControl を呼んだ時刻 [us]
+
+    template <unsigned Configured, size_t... I>
+    StaticRobotControl(const RobotConfig<NMotors, Configured>& config, std::index_sequence<I...>)
+        : kinematics(Mode, config.turning_radius_mm, config.wheel_radius_mm),
+          odometry(config.wheel_radius_mm * 2.0, config.turning_radius_mm * 2.0),
+          motors{{config.wheels[I].motor_pin1, config.wheels[I].motor_pin2}...},
+          encoders{{static_cast<uint8_t>(config.wheels[I].encoder_pin_a), static_cast<uint8_t>(config.wheels[I].encoder_pin_b)}...},
+          pids{{config.wheels[I].kp, config.wheels[I].ki, config.wheels[I].kd, config.wheels[I].time_constant, 0.01f}...},
+          schedules{},
+          battery_voltage(0.0f),
+          target_speeds{},
+          duties{},
+          last_time(0) {
+        // PID の出力制限は startControl が毎周期、出力段の Duty の上限から決める
+        SafetyConfig safety_config = {};
+        SafetyMonitor_Init(&safety, &safety_config);
+    }
+};
+
+#endif // STATIC_ROBOT_CONTROL_H
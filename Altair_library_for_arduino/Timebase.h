@@ -0,0 +1,69 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <Arduino.h>
+#include "timebase_core.h"
+
+// 全モジュール共通の単調増加の時刻 [us]（64 ビット、桁あふれなし）
+// micros()（32 ビット、約 71 分で 1 周）を timebase_core.h で 64 ビットに拡張する
+// エンコーダの速度計算（hal_policy.h）、SkenMdd のタイムアウトなど、時間を計るところはすべてこれを使う
+// 読み出しの間は割り込みを止め、終わったら呼ぶ前の状態に戻す（safety_monitor.h と同じ）ので、
+// 割り込みを止めた区間や割り込みハンドラの中（エンコーダなど）から呼んでもよい
+//   - AVR：SREG を保存して cli()、ESP32：スピンロックのクリティカルセクション（2 コアの間も排他）、
+//     Cortex-M：PRIMASK を保存して cpsid i
+//   - それ以外のボードは noInterrupts / interrupts で止めるので、割り込みを止めた区間からは呼ばない
+struct Timebase {
+    // 今の時刻 [us]
+    static uint64_t nowUs() {
+        // 初回の呼び出しで作る静的変数の初期化を、割り込みを止める前に済ませる
+        TimebaseCore& timebase = core();
+#if defined(__AVR__)
+        uint8_t sreg = SREG;
+        cli();
+        uint64_t now = TimebaseCore_update(&timebase, ::micros());
+        SREG = sreg;
+#elif defined(ARDUINO_ARCH_ESP32)
+        portENTER_CRITICAL_SAFE(&lock());
+        uint64_t now = TimebaseCore_update(&timebase, ::micros());
+        portEXIT_CRITICAL_SAFE(&lock());
+#elif defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+        uint32_t primask;
+        __asm__ volatile("mrs %0, primask" : "=r"(primask));
+        __asm__ volatile("cpsid i" ::: "memory");
+        uint64_t now = TimebaseCore_update(&timebase, ::micros());
+        __asm__ volatile("msr primask, %0" : : "r"(primask) : "memory");
+#else
+        noInterrupts();
+        uint64_t now = TimebaseCore_update(&timebase, ::micros());
+        interrupts();
+#endif
+        return now;
+    }
+
+    // 今の時刻 [us] の下位 32 ビット（差を取れば約 71 分まで正しい）
+    static uint32_t micros() {
+        return static_cast<uint32_t>(nowUs());
+    }
+
+    // last_us からの経過時間 [s] を返し、last_us を今の時刻にする
+    static float elapsed(uint64_t& last_us) {
+        uint64_t now = nowUs();
+        float elapsed = static_cast<float>(now - last_us) * 1e-6f;
+        last_us = now;
+        return elapsed;
+    }
+
+private:
+    static TimebaseCore& core() {
+        static TimebaseCore timebase = {static_cast<uint32_t>(::micros()), 1, 0};
+        return timebase;
+    }
+#if defined(ARDUINO_ARCH_ESP32)
+    static portMUX_TYPE& lock() {
+        static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+        return mux;
+    }
+#endif
+};
+
+#endif // TIMEBASE_H
@@ -0,0 +1,96 @@
+#ifndef HAL_POLICY_H
+#define HAL_POLICY_H
+
+#include <Arduino.h>
+#include <functional>
+#include "hal_core.h"
+#include "Timebase.h"
+
+// hal_core.h のコアに渡す Arduino 用のポリシー
+//   - ArduinoHal：Arduino の API（digitalRead、analogWrite）をそのまま使う
+//   - ArduinoFastHal：入力だけ、ピンのポートの入力レジスタをマスクで直接読む（割り込み内の digitalRead を避ける）
+// PWM はどちらも analogWrite（8 ビット）。割り込みは attachInterrupt（CHANGE）で登録する
+// MotorDriver / Encoder は AltairHal（既定は ArduinoFastHal、ALTAIR_USE_ARDUINO_HAL を定義すると ArduinoHal）を使う
+
+struct ArduinoHal {
+    typedef int Pin;
+
+    class Input {
+    public:
+        explicit Input(int pin) : pin(pin) {
+            pinMode(pin, INPUT);
+        }
+        int read() const {
+            return digitalRead(pin) == HIGH ? 1 : 0;
+        }
+        // 割り込みに context（Encoder）を登録したまま解放しないよう、壊すときに外す
+        ~Input() {
+            detachInterrupt(digitalPinToInterrupt(pin));
+        }
+        void onChange(void (*handler)(void*), void* context) {
+            attachInterrupt(digitalPinToInterrupt(pin), std::bind(handler, context), CHANGE);
+        }
+
+    private:
+        int pin;
+    };
+
+    class Pwm {
+    public:
+        Pwm(int pin, uint32_t period_us) : pin(pin) {
+            (void)period_us;
+            pinMode(pin, OUTPUT);
+        }
+        void write(float duty) {
+            analogWrite(pin, static_cast<int>(duty * 255.0f + 0.5f));
+        }
+
+    private:
+        int pin;
+    };
+
+    static uint32_t micros() {
+        return Timebase::micros();
+    }
+};
+
+struct ArduinoFastHal {
+    typedef int Pin;
+
+    class Input {
+    public:
+        explicit Input(int pin)
+            : pin(pin), reg(portInputRegister(digitalPinToPort(pin))), mask(digitalPinToBitMask(pin)) {
+            pinMode(pin, INPUT);
+        }
+        int read() const {
+            return (*reg & mask) ? 1 : 0;
+        }
+        // 割り込みに context（Encoder）を登録したまま解放しないよう、壊すときに外す
+        ~Input() {
+            detachInterrupt(digitalPinToInterrupt(pin));
+        }
+        void onChange(void (*handler)(void*), void* context) {
+            attachInterrupt(digitalPinToInterrupt(pin), std::bind(handler, context), CHANGE);
+        }
+
+    private:
+        int pin;
+        decltype(portInputRegister(0)) reg;   // ボードによって 8 / 32 ビット
+        decltype(digitalPinToBitMask(0)) mask;
+    };
+
+    typedef ArduinoHal::Pwm Pwm;
+
+    static uint32_t micros() {
+        return Timebase::micros();
+    }
+};
+
+#ifdef ALTAIR_USE_ARDUINO_HAL
+typedef ArduinoHal AltairHal;
+#else
+typedef ArduinoFastHal AltairHal;
+#endif
+
+#endif // HAL_POLICY_H
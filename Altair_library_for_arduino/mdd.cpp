@@ -11,25 +11,29 @@ void SkenMdd::init(void)
 
 bool SkenMdd::tcp(uint8_t id, const float (&command_data)[4], unsigned int resend_time, unsigned int max_wait_time)
 {
-    uint8_t receive_data = -1;
-    unsigned int send_time = 0;
-    unsigned int start_time = millis();
+    MddAck ack;
+    bool acked = false;
+    uint64_t start_time = Timebase::nowUs();
+    uint64_t send_time = start_time;
+    MddAck_Init(&ack);
+    sendData(id, command_data);
     do
     {
-        if ((millis() - start_time) > max_wait_time)
+        uint64_t now = Timebase::nowUs();
+        if (now - start_time > max_wait_time * 1000ULL)
         {
             return false;
         }
-        if ((millis() - send_time) > resend_time)
+        if (now - send_time > resend_time * 1000ULL)
         {
             sendData(id, command_data);
-            send_time = millis();
+            send_time = now;
         }
         if (serial.available() > 0)
         {
-            receive_data = serial.read();
+            acked = MddAck_push(&ack, (uint8_t)serial.read(), seq);
         }
-    } while (receive_data != seq);
+    } while (!acked);
     return true;
 }
 
@@ -40,35 +44,7 @@ void SkenMdd::udp(uint8_t id, const float (&command_data)[4])
 
 void SkenMdd::sendData(uint8_t id, const float (&command_data)[4])
 {
-    uint8_t send_data[21] = {};
-    send_data[0] = 0xA5;
-    send_data[1] = 0xA5;
-    send_data[2] = ++seq;
-    send_data[3] = id;
-    setFloatData(command_data, send_data);
-    send_data[20] = calcChecksum(send_data);
-    serial.write(send_data, 21);
-}
-
-void SkenMdd::setFloatData(const float (&command_data)[4], uint8_t (&send_data)[21])
-{
-    ConvertIntFloat cif;
-    for (int i = 0; i < 4; i++)
-    {
-        cif.float_val = command_data[i];
-        for (int j = 0; j < 4; j++)
-        {
-            send_data[4 + (i * 4) + j] = cif.uint8_val[j];
-        }
-    }
-}
-
-uint8_t SkenMdd::calcChecksum(const uint8_t (&send_data)[21])
-{
-    uint8_t checksum = 0;
-    for (int i = 2; i < 20; i++)
-    {
-        checksum += send_data[i];
-    }
-    return checksum;
+    uint8_t send_data[MDD_FRAME_SIZE];
+    MddFrame_pack(send_data, ++seq, id, command_data);
+    serial.write(send_data, sizeof(send_data));
 }
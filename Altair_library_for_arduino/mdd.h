@@ -2,6 +2,8 @@
 #define MDD_H
 
 #include <Arduino.h>
+#include "mdd_frame.h"
+#include "Timebase.h"
 
 // float と uint8_t 配列の変換に使用するユニオン
 union ConvertIntFloat
@@ -10,23 +12,6 @@ union ConvertIntFloat
     uint8_t uint8_val[4];
 };
 
-enum MddCommandId
-{
-    MOTOR_RPS_COMMAND_MODE = 0,
-    MOTOR_PWM_COMMAND_MODE,
-    MECANUM_MODE,
-    OMNI3_MODE,
-    OMNI4_MODE,
-    M1_PID_GAIN_CONFIG,
-    M2_PID_GAIN_CONFIG,
-    M3_PID_GAIN_CONFIG,
-    M4_PID_GAIN_CONFIG,
-    ROBOT_DIAMETER_CONFIG,
-    PID_RESET_COMMAND,
-    MOTOR_COMMAND_MODE_SELECT,
-    ENCODER_RESOLUTION_CONFIG
-};
-
 class SkenMdd
 {
 public:
@@ -39,8 +24,6 @@ private:
     HardwareSerial &serial;
     uint8_t seq;
     void sendData(uint8_t id, const float (&command_data)[4]);
-    void setFloatData(const float (&command_data)[4], uint8_t (&send_data)[21]);
-    uint8_t calcChecksum(const uint8_t (&send_data)[21]);
 };
 
 #endif
@@ -0,0 +1,97 @@
+#ifndef TWIST_LIMIT_H_
+#define TWIST_LIMIT_H_
+
+// 車輪の飽和を考慮した機体速度（twist）の正規化（ヘッダのみ、動的確保なし）
+// 各車輪の速度を「並進成分 + 回転成分」に分けて渡すと、全車輪が上限に収まる倍率を返す
+//   - TWIST_LIMIT_UNIFORM           ：並進・回転を同じ倍率で縮める（進む向きと曲率を保つ）
+//   - TWIST_LIMIT_ROTATION_FIRST    ：回転を優先して残し、余った分で並進を出す
+//   - TWIST_LIMIT_TRANSLATION_FIRST ：並進を優先して残し、余った分で回転を出す
+// どの方針でも並進の vx : vy の比は変わらないので、並進の向きは保たれる
+// 各ポートの運動学（CubeIDE kinematics.c、mbed / Arduino Kinematics.h）から使う（3 ポートで同一内容）
+
+typedef enum
+{
+    TWIST_LIMIT_UNIFORM,
+    TWIST_LIMIT_ROTATION_FIRST,
+    TWIST_LIMIT_TRANSLATION_FIRST
+} TwistLimitPolicy;
+
+// |fixed[i] + s * scaled[i]| <= limits[i] を全車輪で満たす最大の s（0〜1）
+// limits[i] が 0 以下の車輪は制限なし
+static inline float TwistLimit_maxScale(const float *fixed, const float *scaled, const float *limits, int count)
+{
+    float scale = 1.0f;
+    for (int i = 0; i < count; i++)
+    {
+        float limit = limits[i];
+        if (limit <= 0.0f)
+        {
+            continue;
+        }
+        float base = fixed ? fixed[i] : 0.0f;
+        float v = base + scale * scaled[i];
+        if (v > limit || v < -limit)
+        {
+            if (scaled[i] == 0.0f)
+            {
+                return 0.0f;  // 固定分だけで上限を超えている
+            }
+            scale = ((v > limit) ? limit - base : -limit - base) / scaled[i];
+            if (scale <= 0.0f)
+            {
+                return 0.0f;
+            }
+        }
+    }
+    return scale;
+}
+
+// translation[i], rotation[i]：車輪 i の速度の並進成分・回転成分
+// wheel[i]：作業用（count 個）。戻ったときには正規化後の車輪速度が入る
+// *translation_scale, *rotation_scale：並進・回転にかけた倍率（0〜1）
+static inline void TwistLimit_solve(const float *translation, const float *rotation, const float *limits, int count,
+                                    TwistLimitPolicy policy, float *wheel,
+                                    float *translation_scale, float *rotation_scale)
+{
+    float st = 1.0f;
+    float sr = 1.0f;
+
+    switch (policy)
+    {
+    case TWIST_LIMIT_ROTATION_FIRST:
+        sr = TwistLimit_maxScale(0, rotation, limits, count);
+        for (int i = 0; i < count; i++)
+        {
+            wheel[i] = sr * rotation[i];
+        }
+        st = TwistLimit_maxScale(wheel, translation, limits, count);
+        break;
+
+    case TWIST_LIMIT_TRANSLATION_FIRST:
+        st = TwistLimit_maxScale(0, translation, limits, count);
+        for (int i = 0; i < count; i++)
+        {
+            wheel[i] = st * translation[i];
+        }
+        sr = TwistLimit_maxScale(wheel, rotation, limits, count);
+        break;
+
+    case TWIST_LIMIT_UNIFORM:
+    default:
+        for (int i = 0; i < count; i++)
+        {
+            wheel[i] = translation[i] + rotation[i];
+        }
+        st = sr = TwistLimit_maxScale(0, wheel, limits, count);
+        break;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        wheel[i] = st * translation[i] + sr * rotation[i];
+    }
+    *translation_scale = st;
+    *rotation_scale = sr;
+}
+
+#endif // TWIST_LIMIT_H_
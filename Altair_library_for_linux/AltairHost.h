@@ -0,0 +1,18 @@
+// AltairHost.h
+// 全てのライブラリをインクルードする（Linux の PC 側）
+#ifndef ALTAIR_HOST_H
+#define ALTAIR_HOST_H
+
+#include "Timebase.h"
+#include "frame_core.h"
+#include "msg_schema.h"
+#include "LatencyHistogram.h"
+#include "SerialPort.h"
+#include "PtyPair.h"
+#include "EventLoop.h"
+#include "FrameLink.h"
+#include "ArrayLink.h"
+#include "MddHost.h"
+#include "MddDevice.h"
+
+#endif // ALTAIR_HOST_H
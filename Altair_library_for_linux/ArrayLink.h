@@ -0,0 +1,79 @@
+#ifndef ARRAY_LINK_H
+#define ARRAY_LINK_H
+
+#include <stdint.h>
+#include <functional>
+#include "msg_core.h"
+#include "FrameLink.h"
+
+// 数値の配列だけを載せたフレーム（ペイロードはリトルエンディアンの値を並べたもの）の送受信
+//   AltairSerialHost：mbed の AltairSerial（float）の相手
+//   SerialLibHost   ：CubeIDE の serial_lib（int16_t）の相手
+// 受け取った配列はフレームのペイロードからメンバの配列へ 1 回で読み、その配列を渡す（次に受け取るまで有効）
+// 長さが型の倍数でないフレームは捨てる（getRejected で数える）
+
+inline uint8_t* ArrayLink_put(uint8_t* p, const float* values, uint16_t count) {
+    return MsgCore_putArray_float(p, values, count);
+}
+
+inline uint8_t* ArrayLink_put(uint8_t* p, const int16_t* values, uint16_t count) {
+    return MsgCore_putArray_int16_t(p, values, count);
+}
+
+inline const uint8_t* ArrayLink_get(const uint8_t* p, float* values, uint16_t count) {
+    return MsgCore_getArray_float(p, values, count);
+}
+
+inline const uint8_t* ArrayLink_get(const uint8_t* p, int16_t* values, uint16_t count) {
+    return MsgCore_getArray_int16_t(p, values, count);
+}
+
+template <class T>
+class ArrayLink {
+public:
+    // 1 フレームで送受信できる最大の個数
+    static const int MAX_COUNT = FRAME_MAX_PAYLOAD / sizeof(T);
+
+    typedef std::function<void(const T* values, int count)> Handler;
+
+    ArrayLink(EventLoop& loop, SerialPort& port) : link(loop, port), rejected(0) {
+        link.onFrame([this](const uint8_t* payload, uint16_t length) {
+            if (length % sizeof(T) != 0) {
+                rejected++;
+                return;
+            }
+            int count = static_cast<int>(length / sizeof(T));
+            ArrayLink_get(payload, values, static_cast<uint16_t>(count));
+            if (handler) {
+                handler(values, count);
+            }
+        });
+    }
+
+    // 配列を受け取るたびに呼ぶ処理
+    void onReceive(Handler h) { handler = std::move(h); }
+
+    // count 個を送る（MAX_COUNT より多ければ false）
+    bool send(const T* data, int count) {
+        if (count < 0 || count > MAX_COUNT) {
+            return false;
+        }
+        uint8_t* payload = link.payload();
+        uint8_t* end = ArrayLink_put(payload, data, static_cast<uint16_t>(count));
+        return link.send(static_cast<uint16_t>(end - payload));
+    }
+
+    FrameLink& getLink() { return link; }
+    uint32_t getRejected() const { return rejected; }
+
+private:
+    FrameLink link;
+    Handler handler;
+    T values[MAX_COUNT];
+    uint32_t rejected;
+};
+
+typedef ArrayLink<float> AltairSerialHost;
+typedef ArrayLink<int16_t> SerialLibHost;
+
+#endif // ARRAY_LINK_H
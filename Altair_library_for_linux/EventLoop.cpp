@@ -0,0 +1,131 @@
+#include "EventLoop.h"
+
+#include <errno.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+EventLoop::EventLoop() :
+    epoll_fd(epoll_create1(EPOLL_CLOEXEC)), running(false), missed(0), dispatch_depth(0)
+{
+}
+
+EventLoop::~EventLoop()
+{
+    if (epoll_fd >= 0) {
+        ::close(epoll_fd);
+    }
+}
+
+bool EventLoop::add(int fd, uint32_t events, Handler handler)
+{
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    auto it = entries.find(fd);
+    if (it != entries.end() && !it->second.removed) {
+        return false;  // 登録済み
+    }
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        return false;
+    }
+    Entry& entry = entries[fd];
+    entry.handler = std::move(handler);
+    entry.removed = false;
+    return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events)
+{
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+void EventLoop::remove(int fd)
+{
+    auto it = entries.find(fd);
+    if (it == entries.end() || it->second.removed) {
+        return;
+    }
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    if (dispatch_depth > 0) {
+        // 処理中の Handler を壊さないよう、消すのは今回のイベントを処理し終えてから
+        it->second.removed = true;
+        removed_fds.push_back(fd);
+    } else {
+        entries.erase(it);
+    }
+}
+
+int EventLoop::addTimer(uint64_t period_us, std::function<void()> func)
+{
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        return -1;
+    }
+    struct itimerspec spec = {};
+    spec.it_interval.tv_sec = static_cast<time_t>(period_us / 1000000ULL);
+    spec.it_interval.tv_nsec = static_cast<long>(period_us % 1000000ULL) * 1000L;
+    spec.it_value = spec.it_interval;
+    if (period_us == 0 || timerfd_settime(timer_fd, 0, &spec, nullptr) < 0) {
+        ::close(timer_fd);
+        return -1;
+    }
+    bool added = add(timer_fd, EPOLLIN, [this, timer_fd, func](uint32_t) {
+        uint64_t expirations = 0;
+        if (::read(timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations) || expirations == 0) {
+            return;
+        }
+        missed += expirations - 1;
+        func();
+    });
+    if (!added) {
+        ::close(timer_fd);
+        return -1;
+    }
+    return timer_fd;
+}
+
+void EventLoop::removeTimer(int timer_fd)
+{
+    remove(timer_fd);
+    ::close(timer_fd);
+}
+
+int EventLoop::runOnce(int timeout_ms)
+{
+    struct epoll_event events[MAX_EVENTS];
+    int count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+    if (count < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    dispatch_depth++;
+    for (int i = 0; i < count; i++) {
+        auto it = entries.find(events[i].data.fd);
+        if (it != entries.end() && !it->second.removed) {
+            it->second.handler(events[i].events);
+        }
+    }
+    if (--dispatch_depth > 0) {
+        return count;  // Handler の中から呼ばれた（MddHost::tcp など）。消すのは外側で
+    }
+    for (int fd : removed_fds) {
+        auto it = entries.find(fd);
+        if (it != entries.end() && it->second.removed) {
+            entries.erase(it);
+        }
+    }
+    removed_fds.clear();
+    return count;
+}
+
+void EventLoop::run()
+{
+    running = true;
+    while (running) {
+        if (runOnce(-1) < 0) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// epoll で複数の fd（シリアルポート・タイマ）を 1 つのスレッドで待つ
+//   - fd ごとに処理（Handler）を登録し、読める・書けるようになったら呼ぶ
+//   - 周期処理は addTimer（timerfd）で登録する。sleep で回すより周期がずれない
+//   - 1 回の epoll_wait で最大 MAX_EVENTS 個の fd をまとめて処理する
+// 登録した処理の中から add / remove / stop / runOnce を呼んでよい（自分自身の remove も可）
+class EventLoop {
+public:
+    typedef std::function<void(uint32_t events)> Handler;
+
+    static const int MAX_EVENTS = 32;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // fd を登録する。events は EPOLLIN / EPOLLOUT など
+    bool add(int fd, uint32_t events, Handler handler);
+
+    // 待つイベントを変える（送信バッファが空になったら EPOLLOUT を外す、など）
+    bool modify(int fd, uint32_t events);
+
+    void remove(int fd);
+
+    // period_us ごとに func を呼ぶタイマを登録し、その fd を返す（失敗すれば -1。removeTimer で止める）
+    // 処理が遅れて何周期か過ぎていた場合も、1 回だけ呼ぶ（missed に飛ばした回数を数える）
+    int addTimer(uint64_t period_us, std::function<void()> func);
+
+    void removeTimer(int timer_fd);
+
+    // イベントを 1 回待って処理する（timeout_ms：-1 で来るまで待つ）。処理した fd の数を返す
+    int runOnce(int timeout_ms);
+
+    // stop が呼ばれるまで runOnce を繰り返す
+    void run();
+
+    void stop() { running = false; }
+
+    // タイマの周期に間に合わず飛ばした回数
+    uint64_t getMissed() const { return missed; }
+
+private:
+    struct Entry {
+        Handler handler;
+        bool removed;
+    };
+
+    int epoll_fd;
+    bool running;
+    uint64_t missed;
+    std::unordered_map<int, Entry> entries;
+    std::vector<int> removed_fds;
+    int dispatch_depth;  // Handler の中から runOnce を呼んだときの深さ
+};
+
+#endif // EVENT_LOOP_H
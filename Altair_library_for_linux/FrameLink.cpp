@@ -0,0 +1,125 @@
+#include "FrameLink.h"
+
+#include <string.h>
+
+FrameLink::FrameLink(EventLoop& loop, SerialPort& port) :
+    loop(loop), port(port), bytes_received(0), bytes_sent(0), reads(0), dropped(0),
+    writing(false), reading(false), closed(false)
+{
+    // 区切りは入れないので、区切りを除いたフレームの最大長まで
+    FrameReceiver_Init(&receiver, rx_frame, sizeof(rx_frame) - 1);
+    loop.add(port.getFd(), EPOLLIN, [this](uint32_t events) { handleEvents(events); });
+}
+
+FrameLink::~FrameLink()
+{
+    loop.remove(port.getFd());
+}
+
+bool FrameLink::send(uint16_t length)
+{
+    uint16_t size = Frame_encode(tx_frame, length);
+    if (size == 0 || closed) {
+        return false;
+    }
+    if (!port.write(tx_frame, size)) {
+        dropped++;
+        return false;
+    }
+    bytes_sent += size;
+    updateEvents();
+    return true;
+}
+
+bool FrameLink::send(const uint8_t* data, uint16_t length)
+{
+    if (length > FRAME_MAX_PAYLOAD) {
+        return false;
+    }
+    memcpy(payload(), data, length);
+    return send(length);
+}
+
+void FrameLink::handleEvents(uint32_t events)
+{
+    if (events & EPOLLOUT) {
+        port.flush();
+        updateEvents();
+    }
+    if (!(events & (EPOLLIN | EPOLLERR | EPOLLHUP)) || reading) {
+        return;
+    }
+    reading = true;
+    for (;;) {
+        ssize_t n = port.read(read_buffer, sizeof(read_buffer));
+        if (n <= 0) {
+            if (n < 0) {
+                closed = true;
+                loop.remove(port.getFd());
+            }
+            break;
+        }
+        reads++;
+        bytes_received += static_cast<uint64_t>(n);
+        consume(read_buffer, static_cast<size_t>(n));
+        if (static_cast<size_t>(n) < sizeof(read_buffer)) {
+            break;  // 読み切った
+        }
+    }
+    reading = false;
+}
+
+void FrameLink::consume(uint8_t* data, size_t length)
+{
+    while (length > 0) {
+        uint8_t* end = static_cast<uint8_t*>(memchr(data, 0, length));
+        if (end == nullptr) {
+            append(data, length);  // 続きは次の read
+            return;
+        }
+        size_t size = static_cast<size_t>(end - data);
+        if (receiver.length == 0 && !receiver.overflow) {
+            // フレーム全体がここにある：その場で復号する
+            if (size > 0) {
+                int16_t payload_length = Frame_decode(data, size > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(size));
+                if (payload_length < 0) {
+                    receiver.errors++;
+                } else {
+                    receiver.frames++;
+                    if (frame_handler) {
+                        frame_handler(Frame_payload(data), static_cast<uint16_t>(payload_length));
+                    }
+                }
+            }
+        } else {
+            append(data, size);
+            if (FrameReceiver_push(&receiver, 0) && frame_handler) {
+                frame_handler(receiver.payload, receiver.payload_length);
+            }
+        }
+        data = end + 1;
+        length -= size + 1;
+    }
+}
+
+// 区切りの前までを FrameReceiver に集める（FrameReceiver_push を 1 バイトずつ呼ぶのと同じ）
+void FrameLink::append(const uint8_t* data, size_t length)
+{
+    size_t room = receiver.capacity - receiver.length;
+    if (length > room) {
+        length = room;
+        receiver.overflow = 1;
+    }
+    memcpy(receiver.buffer + receiver.length, data, length);
+    receiver.length += static_cast<uint16_t>(length);
+}
+
+// 送信バッファが残っている間だけ EPOLLOUT を待つ
+void FrameLink::updateEvents()
+{
+    bool pending = port.getPending() > 0;
+    if (pending != writing && !closed) {
+        writing = pending;
+        loop.modify(port.getFd(), pending ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+    }
+}
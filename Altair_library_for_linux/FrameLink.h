@@ -0,0 +1,79 @@
+#ifndef FRAME_LINK_H
+#define FRAME_LINK_H
+
+#include <stdint.h>
+#include <functional>
+#include "frame_core.h"
+#include "EventLoop.h"
+#include "SerialPort.h"
+
+// frame_core のフレーム（COBS + CRC-16、区切り 0x00）を SerialPort で送受信する
+//   - 受信：読めるようになったら READ_SIZE バイトずつ読めるだけ読み、区切りの 0x00 を memchr で探す
+//     フレーム全体が読んだバッファの中にあれば、その場で復号してペイロードを渡す（コピーなし）
+//     read の境目をまたいだフレームだけ FrameReceiver のバッファに集める
+//   - 渡すペイロードは次に読むまで有効。msg_schema.h の Name_unpack で利用者の構造体へ直接読む
+//   - 送信：payload() に直接 pack して send(バイト数) で送る。書けなかった分は EPOLLOUT で続きを送る
+// フレームの処理の中で MddHost::tcp などから EventLoop::runOnce を呼ぶと、その間このリンクは受信しない
+class FrameLink {
+public:
+    typedef std::function<void(const uint8_t* payload, uint16_t length)> FrameHandler;
+
+    static const size_t READ_SIZE = 4096;
+
+    FrameLink(EventLoop& loop, SerialPort& port);
+    ~FrameLink();
+
+    FrameLink(const FrameLink&) = delete;
+    FrameLink& operator=(const FrameLink&) = delete;
+
+    // 正しいフレームを受け取るたびに呼ぶ処理
+    void onFrame(FrameHandler handler) { frame_handler = std::move(handler); }
+
+    // 送るフレームのペイロードを書く位置（FRAME_MAX_PAYLOAD バイトまで）
+    uint8_t* payload() { return Frame_payload(tx_frame); }
+
+    // payload() に書いた length バイトをフレームにして送る
+    bool send(uint16_t length);
+
+    // data をコピーして送る
+    bool send(const uint8_t* data, uint16_t length);
+
+    // msg_schema.h のメッセージを送る（例：link.sendMessage(Twist_pack, twist)）
+    template <class Msg>
+    bool sendMessage(uint16_t (*pack)(const Msg*, uint8_t*), const Msg& msg) {
+        return send(pack(&msg, payload()));
+    }
+
+    // 相手が閉じた・読み書きに失敗した
+    bool isClosed() const { return closed; }
+
+    uint32_t getFrames() const { return receiver.frames; }
+    uint32_t getErrors() const { return receiver.errors; }
+    uint64_t getBytesReceived() const { return bytes_received; }
+    uint64_t getBytesSent() const { return bytes_sent; }
+    uint64_t getReads() const { return reads; }  // read の回数（1 回でまとめて読めたバイト数の目安）
+    uint32_t getDropped() const { return dropped; }  // 送信バッファがいっぱいで送れなかったフレーム
+
+private:
+    EventLoop& loop;
+    SerialPort& port;
+    FrameHandler frame_handler;
+    FrameReceiver receiver;
+    uint8_t rx_frame[FRAME_ENCODED_SIZE(FRAME_MAX_PAYLOAD)];
+    uint8_t tx_frame[FRAME_ENCODED_SIZE(FRAME_MAX_PAYLOAD)];
+    uint8_t read_buffer[READ_SIZE];
+    uint64_t bytes_received;
+    uint64_t bytes_sent;
+    uint64_t reads;
+    uint32_t dropped;
+    bool writing;    // EPOLLOUT を待っている
+    bool reading;    // 受信の処理中（入れ子の runOnce から呼ばれたら読まない）
+    bool closed;
+
+    void handleEvents(uint32_t events);
+    void consume(uint8_t* data, size_t length);
+    void append(const uint8_t* data, size_t length);
+    void updateEvents();
+};
+
+#endif // FRAME_LINK_H
@@ -0,0 +1,127 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// 応答時間 [us] のヒストグラム（固定長、動的確保なし）
+//   - 16us までは 1us 刻み、それより上は 2 のべき乗ごとに 16 分割（幅は値の 1/16 以下、誤差 6% 以内）
+//   - 1 回の記録は配列の 1 要素を増やすだけなので、1 kHz の通信の中で毎回記録してよい
+//   - 約 9.5 時間（2^35 us）より長い値は最後の区間に入れる
+// パーセンタイルは区間の上端を返す（実際の値より小さく見積もらない）
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKETS = 16;
+    static const int EXPONENTS = 32;  // 2^4〜2^35 us
+    static const int BUCKETS = SUB_BUCKETS + EXPONENTS * SUB_BUCKETS;
+
+    LatencyHistogram() {
+        reset();
+    }
+
+    void reset() {
+        memset(buckets, 0, sizeof(buckets));
+        count = 0;
+        sum = 0;
+        min = UINT64_MAX;
+        max = 0;
+    }
+
+    // 応答時間 [us] を 1 つ記録する
+    void record(uint64_t us) {
+        buckets[bucketOf(us)]++;
+        count++;
+        sum += us;
+        if (us < min) {
+            min = us;
+        }
+        if (us > max) {
+            max = us;
+        }
+    }
+
+    // 別のヒストグラム（別のスレッドや別の通信路）を足し合わせる
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; i++) {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        sum += other.sum;
+        if (other.min < min) {
+            min = other.min;
+        }
+        if (other.max > max) {
+            max = other.max;
+        }
+    }
+
+    uint64_t getCount() const { return count; }
+    uint64_t getMin() const { return count ? min : 0; }
+    uint64_t getMax() const { return max; }
+    double getMean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+
+    // percent [%] の値 [us]（例：percentile(99.9)）
+    uint64_t percentile(double percent) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(count) + 0.5);
+        if (rank < 1) {
+            rank = 1;
+        }
+        if (rank > count) {
+            rank = count;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                uint64_t upper = upperOf(i);
+                return (upper < max) ? upper : max;
+            }
+        }
+        return max;
+    }
+
+    // 1 行にまとめて表示する（name: n=… mean=… p50=… p99=… p99.9=… max=… [us]）
+    void print(FILE* out, const char* name) const {
+        fprintf(out, "%s: n=%llu mean=%.1f p50=%llu p99=%llu p99.9=%llu max=%llu [us]\n", name,
+                static_cast<unsigned long long>(count), getMean(),
+                static_cast<unsigned long long>(percentile(50.0)),
+                static_cast<unsigned long long>(percentile(99.0)),
+                static_cast<unsigned long long>(percentile(99.9)),
+                static_cast<unsigned long long>(max));
+    }
+
+private:
+    uint64_t buckets[BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+
+    static int bucketOf(uint64_t us) {
+        if (us < SUB_BUCKETS) {
+            return static_cast<int>(us);
+        }
+        int exponent = 63 - __builtin_clzll(us);  // 4 以上
+        if (exponent >= 4 + EXPONENTS) {
+            return BUCKETS - 1;
+        }
+        int sub = static_cast<int>(us >> (exponent - 4)) & (SUB_BUCKETS - 1);
+        return SUB_BUCKETS + (exponent - 4) * SUB_BUCKETS + sub;
+    }
+
+    // 区間 index に入る最大の値
+    static uint64_t upperOf(int index) {
+        if (index < SUB_BUCKETS) {
+            return static_cast<uint64_t>(index);
+        }
+        int exponent = (index - SUB_BUCKETS) / SUB_BUCKETS + 4;
+        uint64_t sub = static_cast<uint64_t>((index - SUB_BUCKETS) % SUB_BUCKETS);
+        return ((SUB_BUCKETS + sub + 1) << (exponent - 4)) - 1;
+    }
+};
+
+#endif // LATENCY_HISTOGRAM_H
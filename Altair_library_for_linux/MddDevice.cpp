@@ -0,0 +1,125 @@
+#include "MddDevice.h"
+
+MddDevice::MddDevice(EventLoop& loop, SerialPort& port) :
+    loop(loop), port(port), commands(0), errors(0), mute(false)
+{
+#ifdef MDD_FRAME_COBS
+    FrameReceiver_Init(&receiver, rx_frame, sizeof(rx_frame));
+#else
+    length = 0;
+#endif
+    loop.add(port.getFd(), EPOLLIN, [this](uint32_t events) { handleEvents(events); });
+}
+
+MddDevice::~MddDevice()
+{
+    loop.remove(port.getFd());
+}
+
+void MddDevice::handleEvents(uint32_t events)
+{
+    if (events & EPOLLOUT) {
+        if (port.flush()) {
+            loop.modify(port.getFd(), EPOLLIN);
+        }
+    }
+    if (!(events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+        return;
+    }
+    for (;;) {
+        ssize_t n = port.read(read_buffer, sizeof(read_buffer));
+        if (n <= 0) {
+            if (n < 0) {
+                loop.remove(port.getFd());
+            }
+            break;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            push(read_buffer[i]);
+        }
+    }
+}
+
+#ifdef MDD_FRAME_COBS
+
+void MddDevice::push(uint8_t byte)
+{
+    MddCommand command;
+    uint32_t frame_errors = receiver.errors;
+    if (FrameReceiver_push(&receiver, byte)) {
+        if (MddCommand_unpack(&command, receiver.payload, receiver.payload_length)) {
+            reply(command.seq, command.command, command.data);
+        } else {
+            errors++;
+        }
+    }
+    errors += receiver.errors - frame_errors;
+}
+
+void MddDevice::reply(uint8_t seq, uint8_t id, const float* data)
+{
+    commands++;
+    if (command_handler) {
+        command_handler(id, data);
+    }
+    if (mute) {
+        return;
+    }
+    uint8_t frame[FRAME_ENCODED_SIZE(MddReply_SIZE)];
+    MddReply message;
+    message.seq = seq;
+    if (port.write(frame, Frame_encode(frame, MddReply_pack(&message, Frame_payload(frame)))) && port.getPending() > 0) {
+        loop.modify(port.getFd(), EPOLLIN | EPOLLOUT);
+    }
+}
+
+#else
+
+void MddDevice::push(uint8_t byte)
+{
+    // 0xA5 0xA5 を待つ
+    if (length < 2 && byte != MDD_FRAME_HEADER) {
+        length = 0;
+        return;
+    }
+    frame[length++] = byte;
+    if (length < MDD_FRAME_SIZE) {
+        return;
+    }
+    length = 0;
+    if (MddFrame_checksum(frame) != frame[MDD_FRAME_SIZE - 1]) {
+        errors++;
+        // 捨てたフレームの中の 0xA5 0xA5 から探し直す
+        for (int i = 1; i < MDD_FRAME_SIZE; i++) {
+            if (frame[i] == MDD_FRAME_HEADER && (i == MDD_FRAME_SIZE - 1 || frame[i + 1] == MDD_FRAME_HEADER)) {
+                uint8_t rest[MDD_FRAME_SIZE];
+                int count = MDD_FRAME_SIZE - i;
+                memcpy(rest, &frame[i], count);
+                for (int j = 0; j < count; j++) {
+                    push(rest[j]);
+                }
+                return;
+            }
+        }
+        return;
+    }
+    float data[4];
+    memcpy(data, &frame[4], sizeof(data));
+    reply(frame[2], frame[3], data);
+}
+
+void MddDevice::reply(uint8_t seq, uint8_t id, const float* data)
+{
+    commands++;
+    if (command_handler) {
+        command_handler(id, data);
+    }
+    if (mute) {
+        return;
+    }
+    if (port.write(&seq, 1) && port.getPending() > 0) {
+        loop.modify(port.getFd(), EPOLLIN | EPOLLOUT);
+    }
+}
+
+#endif // MDD_FRAME_COBS
@@ -0,0 +1,54 @@
+#ifndef MDD_DEVICE_H
+#define MDD_DEVICE_H
+
+#include <stdint.h>
+#include <functional>
+#include "mdd_frame.h"
+#include "EventLoop.h"
+#include "SerialPort.h"
+
+// MDD 側のシミュレーション（SkenMdd / MddHost の相手）
+//   - mdd_frame.h のフレームを受け取り、コマンドを onCommand の処理に渡して、seq を返す
+//   - 既定の 21 バイトの形式では 0xA5 0xA5 で同期し、チェックサムが合わないフレームは捨てて次の 0xA5 から探し直す
+//   - PtyPair の master 側につないで、実機なしで MddHost を試す
+class MddDevice {
+public:
+    typedef std::function<void(uint8_t id, const float* data)> CommandHandler;
+
+    MddDevice(EventLoop& loop, SerialPort& port);
+    ~MddDevice();
+
+    MddDevice(const MddDevice&) = delete;
+    MddDevice& operator=(const MddDevice&) = delete;
+
+    // コマンドを受け取るたびに呼ぶ処理（data は 4 個）
+    void onCommand(CommandHandler handler) { command_handler = std::move(handler); }
+
+    // 応答を返さない（応答が落ちたときの MddHost の再送を試す）
+    void setMute(bool mute) { this->mute = mute; }
+
+    uint32_t getCommands() const { return commands; }
+    uint32_t getErrors() const { return errors; }
+
+private:
+    EventLoop& loop;
+    SerialPort& port;
+    CommandHandler command_handler;
+    uint8_t read_buffer[4096];
+#ifdef MDD_FRAME_COBS
+    FrameReceiver receiver;
+    uint8_t rx_frame[FRAME_ENCODED_SIZE(MddCommand_SIZE)];
+#else
+    uint8_t frame[MDD_FRAME_SIZE];
+    int length;
+#endif
+    uint32_t commands;
+    uint32_t errors;
+    bool mute;
+
+    void handleEvents(uint32_t events);
+    void push(uint8_t byte);
+    void reply(uint8_t seq, uint8_t id, const float* data);
+};
+
+#endif // MDD_DEVICE_H
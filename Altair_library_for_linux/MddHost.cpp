@@ -0,0 +1,136 @@
+#include "MddHost.h"
+
+#include "Timebase.h"
+
+MddHost::MddHost(EventLoop& loop, SerialPort& port) :
+    loop(loop), port(port), seq(0), sent(0), acked(0), resent(0), lost(0), unexpected(0), dropped(0),
+    writing(false), reading(false)
+{
+    for (int i = 0; i < 256; i++) {
+        send_time[i] = 0;
+    }
+#ifdef MDD_FRAME_COBS
+    FrameReceiver_Init(&receiver, rx_frame, sizeof(rx_frame));
+#endif
+    loop.add(port.getFd(), EPOLLIN, [this](uint32_t events) { handleEvents(events); });
+}
+
+MddHost::~MddHost()
+{
+    loop.remove(port.getFd());
+}
+
+uint8_t MddHost::udp(uint8_t id, const float (&command_data)[4])
+{
+    sendData(id, command_data);
+    return seq;
+}
+
+bool MddHost::tcp(uint8_t id, const float (&command_data)[4], unsigned int resend_time, unsigned int max_wait_time)
+{
+    uint64_t start_time = Timebase::nowUs();
+    uint64_t resend_time_us = resend_time * 1000ULL;
+    uint64_t max_wait_time_us = max_wait_time * 1000ULL;
+    uint64_t send_at = start_time;
+    sendData(id, command_data);
+    while (send_time[seq] != 0) {
+        uint64_t now = Timebase::nowUs();
+        if (now - start_time > max_wait_time_us) {
+            send_time[seq] = 0;  // 最大待機時間を超えた場合、失敗を返す
+            return false;
+        }
+        if (now - send_at > resend_time_us) {
+            send_time[seq] = 0;
+            sendData(id, command_data);  // 再送信
+            resent++;
+            send_at = now;
+        }
+        // 次の再送か最大待機時間まで待つ
+        uint64_t deadline = start_time + max_wait_time_us;
+        if (send_at + resend_time_us < deadline) {
+            deadline = send_at + resend_time_us;
+        }
+        uint64_t wait_us = (deadline > now) ? deadline - now : 0;
+        loop.runOnce(static_cast<int>((wait_us + 999) / 1000));
+    }
+    return true;
+}
+
+void MddHost::sendData(uint8_t id, const float (&command_data)[4])
+{
+    uint8_t send_data[MDD_FRAME_SIZE];
+    MddFrame_pack(send_data, ++seq, id, command_data);
+    if (send_time[seq] != 0) {
+        lost++;
+    }
+    if (!port.write(send_data, sizeof(send_data))) {
+        send_time[seq] = 0;
+        dropped++;
+        return;
+    }
+    send_time[seq] = Timebase::nowUs();
+    sent++;
+    updateEvents();
+}
+
+void MddHost::handleEvents(uint32_t events)
+{
+    if (events & EPOLLOUT) {
+        port.flush();
+        updateEvents();
+    }
+    if (!(events & (EPOLLIN | EPOLLERR | EPOLLHUP)) || reading) {
+        return;
+    }
+    reading = true;
+    for (;;) {
+        ssize_t n = port.read(read_buffer, sizeof(read_buffer));
+        if (n <= 0) {
+            if (n < 0) {
+                loop.remove(port.getFd());
+            }
+            break;
+        }
+        // 読んだ分はすべて同じ時刻に届いたものとして扱う
+        uint64_t now = Timebase::nowUs();
+        for (ssize_t i = 0; i < n; i++) {
+#ifdef MDD_FRAME_COBS
+            MddReply reply;
+            if (FrameReceiver_push(&receiver, read_buffer[i])
+                && MddReply_unpack(&reply, receiver.payload, receiver.payload_length)) {
+                handleAck(reply.seq, now);
+            }
+#else
+            handleAck(read_buffer[i], now);
+#endif
+        }
+        if (static_cast<size_t>(n) < sizeof(read_buffer)) {
+            break;
+        }
+    }
+    reading = false;
+}
+
+void MddHost::handleAck(uint8_t ack_seq, uint64_t now)
+{
+    if (send_time[ack_seq] == 0) {
+        unexpected++;
+        return;
+    }
+    uint64_t latency_us = now - send_time[ack_seq];
+    send_time[ack_seq] = 0;
+    acked++;
+    latency.record(latency_us);
+    if (ack_handler) {
+        ack_handler(ack_seq, latency_us);
+    }
+}
+
+void MddHost::updateEvents()
+{
+    bool pending = port.getPending() > 0;
+    if (pending != writing) {
+        writing = pending;
+        loop.modify(port.getFd(), pending ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef MDD_HOST_H
+#define MDD_HOST_H
+
+#include <stdint.h>
+#include <functional>
+#include "mdd_frame.h"
+#include "EventLoop.h"
+#include "LatencyHistogram.h"
+#include "SerialPort.h"
+
+// PC から MDD を動かす（mbed / Arduino の SkenMdd と同じフレーム・同じ使い方）
+//   - フレームは mdd_frame.h（既定は 21 バイトの形式、MDD_FRAME_COBS を定義すると COBS + CRC-16）
+//   - 送ったコマンドの seq ごとに送信時刻を持ち、MDD が seq を返したら応答時間を LatencyHistogram に記録する
+//   - udp は送るだけで待たない（1 kHz で送り続ける用）。応答は EventLoop が受け取ったときに onAck の処理を呼ぶ
+//   - tcp は応答が来るまで EventLoop を回して待つ（その間も他の fd の処理は動く）
+// 再送は SkenMdd と同じく新しい seq で送る。古い seq の応答は遅れて届いても数えない（getUnexpected）
+class MddHost {
+public:
+    typedef std::function<void(uint8_t seq, uint64_t latency_us)> AckHandler;
+
+    MddHost(EventLoop& loop, SerialPort& port);
+    ~MddHost();
+
+    MddHost(const MddHost&) = delete;
+    MddHost& operator=(const MddHost&) = delete;
+
+    // 送って seq を返す
+    uint8_t udp(uint8_t id, const float (&command_data)[4]);
+
+    // 応答が来るまで待つ。resend_time [ms] ごとに再送し、max_wait_time [ms] を超えたら false
+    bool tcp(uint8_t id, const float (&command_data)[4], unsigned int resend_time, unsigned int max_wait_time);
+
+    // 応答を受け取るたびに呼ぶ処理
+    void onAck(AckHandler handler) { ack_handler = std::move(handler); }
+
+    // seq の応答を受け取った（または待つのをやめた）
+    bool isAcked(uint8_t seq) const { return send_time[seq] == 0; }
+
+    const LatencyHistogram& getLatency() const { return latency; }
+    void resetLatency() { latency.reset(); }
+
+    uint32_t getSent() const { return sent; }
+    uint32_t getAcked() const { return acked; }
+    uint32_t getResent() const { return resent; }
+    uint32_t getLost() const { return lost; }            // 応答が来ないうちに seq が一周した
+    uint32_t getUnexpected() const { return unexpected; }  // 待っていない seq の応答
+    uint32_t getDropped() const { return dropped; }      // 送信バッファがいっぱいで送れなかった
+
+private:
+    EventLoop& loop;
+    SerialPort& port;
+    AckHandler ack_handler;
+    LatencyHistogram latency;
+    uint64_t send_time[256];  // 応答待ちの seq の送信時刻 [us]（0 は待っていない）
+    uint8_t seq;
+    uint8_t read_buffer[256];
+#ifdef MDD_FRAME_COBS
+    FrameReceiver receiver;
+    uint8_t rx_frame[FRAME_ENCODED_SIZE(MddReply_SIZE)];
+#endif
+    uint32_t sent;
+    uint32_t acked;
+    uint32_t resent;
+    uint32_t lost;
+    uint32_t unexpected;
+    uint32_t dropped;
+    bool writing;
+    bool reading;
+
+    void sendData(uint8_t id, const float (&command_data)[4]);
+    void handleEvents(uint32_t events);
+    void handleAck(uint8_t ack_seq, uint64_t now);
+    void updateEvents();
+};
+
+#endif // MDD_HOST_H
@@ -0,0 +1,62 @@
+#include "PtyPair.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+PtyPair::PtyPair() :
+    master_fd(-1), slave_fd(-1)
+{
+    slave_path[0] = '\0';
+}
+
+PtyPair::~PtyPair()
+{
+    close();
+}
+
+bool PtyPair::open()
+{
+    close();
+    master_fd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master_fd < 0 || grantpt(master_fd) < 0 || unlockpt(master_fd) < 0
+        || ptsname_r(master_fd, slave_path, sizeof(slave_path)) != 0) {
+        close();
+        return false;
+    }
+    slave_fd = ::open(slave_path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slave_fd < 0) {
+        close();
+        return false;
+    }
+    // 行編集・エコーをなくす（SerialPort が開くときも raw にするが、開く前に届いたバイトを壊さないよう先にしておく）
+    struct termios tio;
+    if (tcgetattr(slave_fd, &tio) < 0) {
+        close();
+        return false;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slave_fd, TCSANOW, &tio);
+    return true;
+}
+
+void PtyPair::close()
+{
+    if (master_fd >= 0) {
+        ::close(master_fd);
+    }
+    if (slave_fd >= 0) {
+        ::close(slave_fd);
+    }
+    master_fd = -1;
+    slave_fd = -1;
+    slave_path[0] = '\0';
+}
+
+int PtyPair::takeMaster()
+{
+    int fd = master_fd;
+    master_fd = -1;
+    return fd;
+}
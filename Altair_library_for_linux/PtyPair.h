@@ -0,0 +1,34 @@
+#ifndef PTY_PAIR_H
+#define PTY_PAIR_H
+
+// 擬似端末（pty）の組。実機なしでホスト側とマイコン側（シミュレーション）をつなぐ
+//   - slave 側は /dev/pts/N のパスで開ける。ホスト側は実機と同じく SerialPort::open(getSlavePath(), baud) で開く
+//   - master 側はシミュレーションしたマイコンが SerialPort::attach(takeMaster(), baud) で使う
+//   - slave を 1 つ開いたまま持ち、raw にしておく（全部閉じると master の read がエラーになるため）
+// pty の速度設定は実際の転送速度に影響しない（カーネルの中でそのまま渡る）
+class PtyPair {
+public:
+    PtyPair();
+    ~PtyPair();
+
+    PtyPair(const PtyPair&) = delete;
+    PtyPair& operator=(const PtyPair&) = delete;
+
+    // pty を作る。失敗すれば false
+    bool open();
+
+    void close();
+
+    // slave 側のパス（/dev/pts/N）
+    const char* getSlavePath() const { return slave_path; }
+
+    // master の fd を渡す（以後は受け取った側が閉じる）
+    int takeMaster();
+
+private:
+    int master_fd;
+    int slave_fd;
+    char slave_path[64];
+};
+
+#endif // PTY_PAIR_H
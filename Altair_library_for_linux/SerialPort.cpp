@@ -0,0 +1,167 @@
+#include "SerialPort.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+SerialPort::SerialPort() :
+    fd(-1), baud(0), tx_start(0), tx_length(0)
+{
+}
+
+SerialPort::~SerialPort()
+{
+    close();
+}
+
+bool SerialPort::open(const char* path, int baud)
+{
+    close();
+    int new_fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (new_fd < 0) {
+        return false;
+    }
+    if (!attach(new_fd, baud)) {
+        return false;
+    }
+    tcflush(fd, TCIOFLUSH);  // 開く前に届いていた古いデータを捨てる
+    return true;
+}
+
+bool SerialPort::attach(int new_fd, int baud)
+{
+    close();
+    fd = new_fd;
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 || !configure(baud)) {
+        close();
+        return false;
+    }
+    this->baud = baud;
+    return true;
+}
+
+void SerialPort::close()
+{
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    fd = -1;
+    baud = 0;
+    tx_start = 0;
+    tx_length = 0;
+}
+
+ssize_t SerialPort::read(uint8_t* buffer, size_t size)
+{
+    for (;;) {
+        ssize_t n = ::read(fd, buffer, size);
+        if (n > 0) {
+            return n;
+        }
+        if (n == 0) {
+            return -1;  // 相手が閉じた
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+}
+
+bool SerialPort::write(const uint8_t* data, size_t size)
+{
+    if (tx_length + size > TX_BUFFER_SIZE) {
+        return false;
+    }
+    // 先に送るものがなければ直接書く（送信バッファへのコピーは書き残した分だけ）
+    if (tx_length == 0) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    return false;
+                }
+                break;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        if (size == 0) {
+            return true;
+        }
+        tx_start = 0;
+    }
+    // 後ろに入り切らなければ前に詰める
+    if (tx_start + tx_length + size > TX_BUFFER_SIZE) {
+        memmove(tx_buffer, tx_buffer + tx_start, tx_length);
+        tx_start = 0;
+    }
+    memcpy(tx_buffer + tx_start + tx_length, data, size);
+    tx_length += size;
+    return true;
+}
+
+bool SerialPort::flush()
+{
+    while (tx_length > 0) {
+        ssize_t n = ::write(fd, tx_buffer + tx_start, tx_length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        tx_start += static_cast<size_t>(n);
+        tx_length -= static_cast<size_t>(n);
+    }
+    tx_start = 0;
+    return true;
+}
+
+speed_t SerialPort::toSpeed(int baud)
+{
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 500000: return B500000;
+        case 576000: return B576000;
+        case 921600: return B921600;
+        case 1000000: return B1000000;
+        case 1152000: return B1152000;
+        case 1500000: return B1500000;
+        case 2000000: return B2000000;
+        case 2500000: return B2500000;
+        case 3000000: return B3000000;
+        case 3500000: return B3500000;
+        case 4000000: return B4000000;
+        default: return B0;
+    }
+}
+
+bool SerialPort::configure(int baud)
+{
+    speed_t speed = toSpeed(baud);
+    struct termios tio;
+    if (speed == B0 || tcgetattr(fd, &tio) < 0) {
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    // VMIN = 0 だと、データがないときの read が O_NONBLOCK でも 0（相手が閉じた）を返すので 1 にする（EAGAIN になる）
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
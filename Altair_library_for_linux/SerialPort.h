@@ -0,0 +1,61 @@
+#ifndef SERIAL_PORT_H
+#define SERIAL_PORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <termios.h>
+
+// Linux のシリアルポート（/dev/ttyACM0 など）をノンブロッキングで読み書きする
+//   - termios を raw（8N1、エコー・改行変換・フロー制御なし）にして開く
+//   - read は読めるだけ読んで、なければすぐ 0 を返す（EventLoop で読めるようになったときに呼ぶ）
+//   - write は書けなかった分を送信バッファ（固定長）にためる。残りは flush で送る
+// pty（PtyPair）の fd も attach で同じように使える
+class SerialPort {
+public:
+    static const size_t TX_BUFFER_SIZE = 65536;
+
+    SerialPort();
+    ~SerialPort();
+
+    SerialPort(const SerialPort&) = delete;
+    SerialPort& operator=(const SerialPort&) = delete;
+
+    // path を開く。baud は 9600〜4000000 の標準の値（それ以外・開けなければ false）
+    bool open(const char* path, int baud);
+
+    // 開いている fd を raw・ノンブロッキングにして使う（close で fd も閉じる）
+    bool attach(int fd, int baud);
+
+    void close();
+
+    bool isOpen() const { return fd >= 0; }
+    int getFd() const { return fd; }
+    int getBaud() const { return baud; }
+
+    // 読めるだけ読み、読んだバイト数を返す（なければ 0、切断・エラーは -1）
+    ssize_t read(uint8_t* buffer, size_t size);
+
+    // 書けるだけ書き、残りは送信バッファにためる（送信バッファに入り切らなければ何も送らず false）
+    bool write(const uint8_t* data, size_t size);
+
+    // 送信バッファを書けるだけ書く。全部送れたら true
+    bool flush();
+
+    // 送信バッファに残っているバイト数
+    size_t getPending() const { return tx_length; }
+
+    // baud [bps] を termios の速度に変える（標準の値でなければ B0）
+    static speed_t toSpeed(int baud);
+
+private:
+    int fd;
+    int baud;
+    uint8_t tx_buffer[TX_BUFFER_SIZE];
+    size_t tx_start;
+    size_t tx_length;
+
+    bool configure(int baud);
+};
+
+#endif // SERIAL_PORT_H
@@ -0,0 +1,33 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+#include <time.h>
+
+// 全モジュール共通の単調増加の時刻 [us]（64 ビット、桁あふれなし）
+// Linux の CLOCK_MONOTONIC を読む（時刻合わせで戻ったり飛んだりしない）
+// mbed 版の Timebase と同じ名前・同じ関数なので、マイコン側と同じ書き方で時間を計れる
+// MddHost のタイムアウトと応答時間、LatencyHistogram に入れる時間はすべてこれで計る
+struct Timebase {
+    // 今の時刻 [us]
+    static uint64_t nowUs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000ULL;
+    }
+
+    // 今の時刻 [us] の下位 32 ビット（差を取れば約 71 分まで正しい）
+    static uint32_t micros() {
+        return static_cast<uint32_t>(nowUs());
+    }
+
+    // last_us からの経過時間 [s] を返し、last_us を今の時刻にする
+    static float elapsed(uint64_t& last_us) {
+        uint64_t now = nowUs();
+        float elapsed = static_cast<float>(now - last_us) * 1e-6f;
+        last_us = now;
+        return elapsed;
+    }
+};
+
+#endif // TIMEBASE_H
@@ -0,0 +1,214 @@
+// GainSchedule（mbed 版 GainSchedule.h）の補間を、表を端から線形に探す素直な計算と比べて確かめる
+//   - 表：等間隔（O(1) の添字計算）・不等間隔（二分探索）・間隔がわずかに揺れる等間隔（許容 1e-4 の内側で等間隔と判定される）
+//   - 範囲：表の外側（端の値で止める）、ちょうどブレークポイント、その前後 1 ulp を含む乱数の目標回転数
+//   - 符号：負の回転数はゲインが同じで、フィードフォワードだけ符号が反転する
+//   - 電池電圧：nominal_voltage / battery_voltage でゲインとフィードフォワードを補正、電圧 0 は補正なし
+//   - 連続性：目標回転数を細かく動かしたとき、値が区分線形の傾きで決まる量より大きく跳ばない
+//
+// 使い方：gain_schedule_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+
+#include "GainSchedule.h"
+
+namespace {
+
+const int SAMPLES = 100000;
+const float TOLERANCE = 1e-5f;   // 値の相対誤差（表の値の大きさ比）
+
+// 表は constexpr で書けること自体も確かめる（記述子ごとフラッシュに置ける）
+constexpr GainSchedulePoint uniform_table[] = {
+    {0.0f, 0.020f, 2.0f, 0.0000f, 0.00f},
+    {2.0f, 0.025f, 2.5f, 0.0001f, 0.08f},
+    {4.0f, 0.030f, 3.5f, 0.0001f, 0.15f},
+    {6.0f, 0.045f, 5.0f, 0.0002f, 0.21f},
+    {8.0f, 0.050f, 6.0f, 0.0002f, 0.28f},
+    {10.0f, 0.050f, 6.5f, 0.0003f, 0.36f},
+};
+constexpr GainSchedulePoint uneven_table[] = {
+    {0.5f, 0.010f, 1.0f, 0.0000f, 0.02f},
+    {1.0f, 0.015f, 1.5f, 0.0000f, 0.05f},
+    {3.0f, 0.030f, 4.0f, 0.0001f, 0.12f},
+    {3.5f, 0.031f, 4.5f, 0.0001f, 0.14f},
+    {9.0f, 0.060f, 8.0f, 0.0004f, 0.40f},
+};
+constexpr GainSchedule uniform_schedule(uniform_table);
+constexpr GainSchedule uneven_schedule(uneven_table);
+constexpr GainSchedule voltage_schedule(uniform_table, 12.0f);
+
+// 等間隔の表を 1e-4 未満だけ揺らしたもの（等間隔と判定されるが、添字の計算だけでは区間がずれうる）
+GainSchedulePoint jitter_table[64];
+
+// 素直な参照：区間を端から探し、倍精度で補間する
+GainSchedulePoint reference(const GainSchedulePoint* points, int count, double rps, double scale)
+{
+    double x = fabs(rps);
+    double v[4];
+    if (x <= points[0].rps) {
+        const GainSchedulePoint& p = points[0];
+        v[0] = p.kp; v[1] = p.ki; v[2] = p.kd; v[3] = p.ff;
+    } else if (x >= points[count - 1].rps) {
+        const GainSchedulePoint& p = points[count - 1];
+        v[0] = p.kp; v[1] = p.ki; v[2] = p.kd; v[3] = p.ff;
+    } else {
+        int i = 0;
+        while (!(x >= points[i].rps && x < points[i + 1].rps)) {
+            i++;
+        }
+        const GainSchedulePoint& a = points[i];
+        const GainSchedulePoint& b = points[i + 1];
+        double t = (x - a.rps) / (static_cast<double>(b.rps) - a.rps);
+        v[0] = a.kp + (static_cast<double>(b.kp) - a.kp) * t;
+        v[1] = a.ki + (static_cast<double>(b.ki) - a.ki) * t;
+        v[2] = a.kd + (static_cast<double>(b.kd) - a.kd) * t;
+        v[3] = a.ff + (static_cast<double>(b.ff) - a.ff) * t;
+    }
+    GainSchedulePoint result;
+    result.rps = static_cast<float>(rps);
+    result.kp = static_cast<float>(v[0] * scale);
+    result.ki = static_cast<float>(v[1] * scale);
+    result.kd = static_cast<float>(v[2] * scale);
+    result.ff = static_cast<float>((rps < 0.0 ? -v[3] : v[3]) * scale);
+    return result;
+}
+
+// 表の各列の最大値（相対誤差の基準）
+GainSchedulePoint columnMax(const GainSchedulePoint* points, int count)
+{
+    GainSchedulePoint m = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < count; i++) {
+        m.kp = fmaxf(m.kp, fabsf(points[i].kp));
+        m.ki = fmaxf(m.ki, fabsf(points[i].ki));
+        m.kd = fmaxf(m.kd, fabsf(points[i].kd));
+        m.ff = fmaxf(m.ff, fabsf(points[i].ff));
+    }
+    return m;
+}
+
+// 参照との差のうち最大のもの（各列の最大値で割る）
+float worstError(const GainSchedulePoint& got, const GainSchedulePoint& want, const GainSchedulePoint& scale)
+{
+    float e = 0.0f;
+    e = fmaxf(e, fabsf(got.kp - want.kp) / fmaxf(scale.kp, 1e-12f));
+    e = fmaxf(e, fabsf(got.ki - want.ki) / fmaxf(scale.ki, 1e-12f));
+    e = fmaxf(e, fabsf(got.kd - want.kd) / fmaxf(scale.kd, 1e-12f));
+    e = fmaxf(e, fabsf(got.ff - want.ff) / fmaxf(scale.ff, 1e-12f));
+    return e;
+}
+
+int failures = 0;
+
+void check(bool ok, const char* what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+// 乱数の目標回転数と、ブレークポイントちょうど・前後 1 ulp で参照と比べる
+void compare(const char* name, const GainSchedule& schedule, const GainSchedulePoint* points, int count,
+             bool uniform, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    float range = points[count - 1].rps * 1.2f;
+    std::uniform_real_distribution<float> rps(-range, range);
+    GainSchedulePoint scale = columnMax(points, count);
+    float worst = 0.0f;
+    float worst_rps = 0.0f;
+    char what[160];
+
+    auto one = [&](float x) {
+        float e = worstError(schedule.lookup(x), reference(points, count, x, 1.0), scale);
+        if (e > worst) {
+            worst = e;
+            worst_rps = x;
+        }
+    };
+    for (int n = 0; n < SAMPLES; n++) {
+        one(rps(random));
+    }
+    for (int i = 0; i < count; i++) {
+        float x = points[i].rps;
+        one(x);
+        one(nextafterf(x, -INFINITY));
+        one(nextafterf(x, INFINITY));
+        one(-x);
+    }
+
+    printf("%s: %d points, %s, worst error %.1e at %.6f rps\n", name, count,
+           schedule.isUniform() ? "uniform (index)" : "uneven (binary search)", worst, worst_rps);
+    snprintf(what, sizeof(what), "%s: detected as %s", name, uniform ? "uniform" : "uneven");
+    check(schedule.isUniform() == uniform && schedule.size() == count, what);
+    snprintf(what, sizeof(what), "%s: matches linear interpolation within %.0e (clamped outside, ff sign follows rps)",
+             name, TOLERANCE);
+    check(worst <= TOLERANCE, what);
+}
+
+// 目標回転数を細かく動かし、隣どうしの差が傾き × 刻みを大きく超えないか（区間の取り違えで跳ばないか）
+void continuity(const char* name, const GainSchedule& schedule, const GainSchedulePoint* points, int count)
+{
+    float slope = 0.0f;  // kp・ff の傾きの最大 [1/rps]
+    for (int i = 0; i + 1 < count; i++) {
+        float dx = points[i + 1].rps - points[i].rps;
+        slope = fmaxf(slope, fabsf(points[i + 1].kp - points[i].kp) / dx);
+        slope = fmaxf(slope, fabsf(points[i + 1].ff - points[i].ff) / dx);
+    }
+    const float d = 1e-4f;
+    float worst = 0.0f;
+    GainSchedulePoint prev = schedule.lookup(0.0f);
+    for (float x = d; x <= points[count - 1].rps + 1.0f; x += d) {
+        GainSchedulePoint now = schedule.lookup(x);
+        worst = fmaxf(worst, fmaxf(fabsf(now.kp - prev.kp), fabsf(now.ff - prev.ff)));
+        prev = now;
+    }
+    char what[160];
+    snprintf(what, sizeof(what), "%s: largest step %.2e per %.0e rps (slope bound %.2e)", name, worst, d,
+             slope * d * 1.5f);
+    check(worst <= slope * d * 1.5f, what);
+}
+
+}  // namespace
+
+int main()
+{
+    const int uniform_count = sizeof(uniform_table) / sizeof(uniform_table[0]);
+    const int uneven_count = sizeof(uneven_table) / sizeof(uneven_table[0]);
+    const int jitter_count = sizeof(jitter_table) / sizeof(jitter_table[0]);
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> jitter(-0.45e-4f, 0.45e-4f);
+    for (int i = 0; i < jitter_count; i++) {
+        // 隣との間隔の揺れは 0.25 × 0.9e-4 まで（等間隔の判定の許容 1e-4 の内側）
+        float x = 0.25f * (static_cast<float>(i) + 0.5f * jitter(random));
+        jitter_table[i] = {i == 0 ? 0.0f : x, 0.01f + 0.001f * i, 1.0f + 0.1f * (i % 7), 0.0001f * (i % 3),
+                           0.02f * i};
+    }
+    GainSchedule jitter_schedule(jitter_table);
+
+    compare("uniform", uniform_schedule, uniform_table, uniform_count, true, 1);
+    compare("uneven", uneven_schedule, uneven_table, uneven_count, false, 2);
+    compare("jittered", jitter_schedule, jitter_table, jitter_count, true, 3);
+    continuity("uniform", uniform_schedule, uniform_table, uniform_count);
+    continuity("uneven", uneven_schedule, uneven_table, uneven_count);
+    continuity("jittered", jitter_schedule, jitter_table, jitter_count);
+
+    printf("voltage\n");
+    GainSchedulePoint got = voltage_schedule.lookup(-5.0f, 10.0f);
+    GainSchedulePoint want = reference(uniform_table, uniform_count, -5.0, 12.0 / 10.0);
+    float e = worstError(got, want, columnMax(uniform_table, uniform_count));
+    check(e <= TOLERANCE, "nominal 12 V at 10 V: gains and ff scaled by 1.2");
+    got = voltage_schedule.lookup(-5.0f, 0.0f);
+    want = reference(uniform_table, uniform_count, -5.0, 1.0);
+    e = worstError(got, want, columnMax(uniform_table, uniform_count));
+    check(e <= TOLERANCE, "battery voltage 0: not scaled");
+    got = uniform_schedule.lookup(5.0f, 10.0f);
+    want = reference(uniform_table, uniform_count, 5.0, 1.0);
+    e = worstError(got, want, columnMax(uniform_table, uniform_count));
+    check(e <= TOLERANCE, "no nominal voltage: not scaled");
+
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
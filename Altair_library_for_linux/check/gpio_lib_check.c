@@ -0,0 +1,194 @@
+// CubeIDE 版 gpio_lib.c を、モックのレジスタ（mock/stm32f4xx_hal.h）の上で確かめる
+//   - channel: GpioLib_InitPwm が TIM_CHANNEL_1〜4 の CCR1〜CCR4 を選び、それ以外（TIM_CHANNEL_5 / 6 の値、
+//              TIM_CHANNEL_ALL、4 の倍数でない値）は HAL_ERROR で、タイマのレジスタも GpioLib も書き換えないか
+//   - duty   : GpioLib_WriteDuty が ARR × Duty / 100 から 1 カウント以内、GpioLib_WriteDutyPermille が
+//              floor(ARR × Duty / 1000) か 1 カウント上で、1000‰ はちょうど ARR か（ARR 99〜1000000）
+//   - bundle : GpioBundle_write の全 65536 通りの値で、バンドルのピンだけが値の通りになり、外のピンはそのままか。
+//              set / reset / toggle / read と、1 ピンの GpioLib_Write / Toggle / Read
+//
+// 使い方：gpio_lib_check（失敗があれば終了コード 1）
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gpio_lib.h"
+
+static TIM_HandleTypeDef htim1 = {TIM1, {0, 0, 0, 0, 0, 0}, {NULL, NULL, NULL, NULL, NULL, NULL, NULL}};
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+static void checkChannel(void)
+{
+    static const struct {
+        uint32_t channel;
+        volatile uint32_t *ccr;
+        const char *name;
+    } valid[] = {
+        {TIM_CHANNEL_1, &TIM1->CCR1, "TIM_CHANNEL_1"},
+        {TIM_CHANNEL_2, &TIM1->CCR2, "TIM_CHANNEL_2"},
+        {TIM_CHANNEL_3, &TIM1->CCR3, "TIM_CHANNEL_3"},
+        {TIM_CHANNEL_4, &TIM1->CCR4, "TIM_CHANNEL_4"},
+    };
+    // G4 などの TIM_CHANNEL_5 / 6 は 0x10 / 0x14
+    static const struct {
+        uint32_t channel;
+        const char *name;
+    } invalid[] = {
+        {0x00000010U, "TIM_CHANNEL_5 (0x10)"},
+        {0x00000014U, "TIM_CHANNEL_6 (0x14)"},
+        {TIM_CHANNEL_ALL, "TIM_CHANNEL_ALL"},
+        {0x00000002U, "0x02"},
+    };
+    size_t i;
+    char what[128];
+
+    printf("channel\n");
+    for (i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+        GpioLib pwm;
+        int ok;
+        Mock_reset();
+        TIM1->ARR = 999U;
+        *valid[i].ccr = 123U;
+        snprintf(what, sizeof(what), "%s: accepted, CCR%u cleared, 50%% writes CCR%u = 499", valid[i].name,
+                 (unsigned)(i + 1), (unsigned)(i + 1));
+        if (GpioLib_InitPwm(&pwm, GPIOA, GPIO_PIN_8, &htim1, valid[i].channel) != HAL_OK) {
+            check(0, what);
+            continue;
+        }
+        ok = pwm.ccr == valid[i].ccr && *valid[i].ccr == 0U && (TIM1->CCER & (1U << valid[i].channel)) != 0U;
+        GpioLib_WriteDuty(&pwm, 50.0f);
+        ok = ok && *valid[i].ccr == 499U;
+        check(ok, what);
+    }
+    for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        GpioLib pwm;
+        GpioLib before;
+        TIM_TypeDef registers;
+        Mock_reset();
+        TIM1->ARR = 999U;
+        memset(&pwm, 0x5A, sizeof(pwm));
+        memcpy(&before, &pwm, sizeof(pwm));
+        memcpy(&registers, (const void *)TIM1, sizeof(registers));
+        snprintf(what, sizeof(what), "%s: HAL_ERROR, timer and GpioLib untouched", invalid[i].name);
+        check(GpioLib_InitPwm(&pwm, GPIOA, GPIO_PIN_8, &htim1, invalid[i].channel) == HAL_ERROR
+                  && memcmp(&registers, (const void *)TIM1, sizeof(registers)) == 0
+                  && memcmp(&before, &pwm, sizeof(pwm)) == 0,
+              what);
+    }
+}
+
+static void checkDuty(void)
+{
+    static const uint32_t arrs[] = {99U, 999U, 4199U, 65535U, 99999U, 1000000U};
+    size_t a;
+
+    printf("duty\n");
+    for (a = 0; a < sizeof(arrs) / sizeof(arrs[0]); a++) {
+        GpioLib pwm;
+        uint32_t d;
+        int percent_ok = 1;
+        int permille_ok = 1;
+        int rounded_up = 0;
+        char what[128];
+
+        Mock_reset();
+        TIM1->ARR = arrs[a];
+        GpioLib_InitPwm(&pwm, GPIOA, GPIO_PIN_8, &htim1, TIM_CHANNEL_1);
+        for (d = 0; d <= 1000U; d++) {
+            double exact = (double)arrs[a] * (double)d / 1000.0;
+            uint32_t floor_count = (uint32_t)((uint64_t)arrs[a] * d / 1000U);
+            double got;
+
+            GpioLib_WriteDuty(&pwm, (float)d / 10.0f);
+            got = (double)TIM1->CCR1;
+            if (got < exact - 1.0 || got > exact + 1.0) {
+                percent_ok = 0;
+            }
+            GpioLib_WriteDutyPermille(&pwm, d);
+            if (TIM1->CCR1 != floor_count && TIM1->CCR1 != floor_count + 1U) {
+                permille_ok = 0;
+            }
+            rounded_up += (TIM1->CCR1 == floor_count + 1U);
+        }
+        GpioLib_WriteDutyPermille(&pwm, 1000U);
+        permille_ok = permille_ok && TIM1->CCR1 == arrs[a];
+        GpioLib_WriteDutyPermille(&pwm, 5000U);
+        permille_ok = permille_ok && TIM1->CCR1 == arrs[a];
+        snprintf(what, sizeof(what),
+                 "arr %lu: percent within 1 count, permille floor or +1 (%d of 1001 +1), 1000 = arr",
+                 (unsigned long)arrs[a], rounded_up);
+        check(percent_ok && permille_ok, what);
+    }
+}
+
+static void checkBundle(void)
+{
+    const uint16_t mask = GPIO_PIN_2 | GPIO_PIN_3 | GPIO_PIN_4 | GPIO_PIN_9 | GPIO_PIN_10 | GPIO_PIN_15;
+    const uint16_t outside = 0xA5A5U;
+    GpioBundle bundle;
+    GpioLib led;
+    uint32_t value;
+    int write_ok = 1;
+    int ok;
+
+    printf("bundle\n");
+    Mock_reset();
+    check(GpioBundle_Init(&bundle, GPIOB, mask, GPIO_LIB_MODE_OUTPUT) == HAL_OK
+              && GpioBundle_Init(&bundle, GPIOB, 0U, GPIO_LIB_MODE_OUTPUT) == HAL_ERROR,
+          "init, empty bundle rejected");
+    GpioBundle_Init(&bundle, GPIOB, mask, GPIO_LIB_MODE_OUTPUT);
+    GPIOB->ODR = outside;
+    for (value = 0; value <= 0xFFFFU; value++) {
+        uint32_t expected;
+        uint32_t before = GPIOB->ODR;
+        GpioBundle_write(&bundle, (uint16_t)value);
+        MockGpio_apply(GPIOB);
+        expected = (before & ~(uint32_t)mask) | (value & mask);
+        if (GPIOB->ODR != expected || GpioBundle_read(&bundle) != (value & mask)) {
+            write_ok = 0;
+        }
+    }
+    check(write_ok, "write / read: all 65536 values, pins outside the bundle untouched");
+
+    GpioBundle_write(&bundle, 0U);
+    MockGpio_apply(GPIOB);
+    GpioBundle_set(&bundle, GPIO_PIN_3 | GPIO_PIN_15 | GPIO_PIN_0);
+    MockGpio_apply(GPIOB);
+    ok = GpioBundle_read(&bundle) == (GPIO_PIN_3 | GPIO_PIN_15) && (GPIOB->ODR & GPIO_PIN_0) == (outside & GPIO_PIN_0);
+    GpioBundle_reset(&bundle, GPIO_PIN_3 | GPIO_PIN_5);
+    MockGpio_apply(GPIOB);
+    ok = ok && GpioBundle_read(&bundle) == GPIO_PIN_15 && (GPIOB->ODR & GPIO_PIN_5) == (outside & GPIO_PIN_5);
+    GpioBundle_toggle(&bundle, GPIO_PIN_2 | GPIO_PIN_15 | GPIO_PIN_7);
+    MockGpio_apply(GPIOB);
+    ok = ok && GpioBundle_read(&bundle) == GPIO_PIN_2 && (GPIOB->ODR & GPIO_PIN_7) == (outside & GPIO_PIN_7);
+    check(ok, "set / reset / toggle: only the given pins inside the bundle change");
+
+    GpioLib_Init(&led, GPIOC, GPIO_PIN_13, GPIO_LIB_MODE_OUTPUT);
+    GPIOC->ODR = 0x00FFU;
+    GpioLib_Write(&led, GPIO_PIN_SET);
+    MockGpio_apply(GPIOC);
+    ok = GPIOC->ODR == (0x00FFU | GPIO_PIN_13) && GpioLib_Read(&led) == GPIO_PIN_SET;
+    GpioLib_Toggle(&led);
+    MockGpio_apply(GPIOC);
+    ok = ok && GPIOC->ODR == 0x00FFU && GpioLib_Read(&led) == GPIO_PIN_RESET;
+    GpioLib_Toggle(&led);
+    MockGpio_apply(GPIOC);
+    ok = ok && GPIOC->ODR == (0x00FFU | GPIO_PIN_13);
+    check(ok, "GpioLib_Write / Toggle / Read: one pin, others untouched");
+}
+
+int main(void)
+{
+    checkChannel();
+    checkDuty();
+    checkBundle();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+// CubeIDE 版 gpio_wave.c を、モックのタイマ・DMA・GPIO（mock/stm32f4xx_hal.h）の上で確かめる
+//   - rate   : setSampleRate のプリスケーラと ARR（MotorDriver_CalcTimerDivider と同じ計算）、
+//              タイマクロックの半分を超える周波数・sample_hz * 2 が桁あふれする周波数を弾くか
+//   - reject : GpioWaveStepper_move が最高速度 0 以下を弾き、GpioWave_Stream がすぐ終わるか
+//   - stepper: GpioWaveStepper_fill を GpioWave_Stream で流し、更新イベントごとに STEP / DIR のピンを読んで
+//              ステップ数・DIR・最短のステップ間隔・移動時間（台形の速度の理論値との差）を確かめる
+//              （減速は残りのステップ数を整数で見るので、最後の数ステップは理論値より少し速い。差は 2% まで許す）
+//
+// 使い方：gpio_wave_check（失敗があれば終了コード 1）
+// DMA のアドレスを 32 ビットで渡すので、-no-pie でビルドする
+
+#include <math.h>
+#include <stdio.h>
+
+#include "gpio_wave.h"
+#include "motor_driver.h"
+
+#define STEP_PIN GPIO_PIN_0
+#define DIR_PIN  GPIO_PIN_1
+#define BUFFER_LENGTH 256U
+
+static DMA_HandleTypeDef hdma_tim1_up;
+static TIM_HandleTypeDef htim1 = {TIM1, {0}, {&hdma_tim1_up}};
+static GpioWave wave;
+static uint32_t stream_buffer[BUFFER_LENGTH];
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+static void setUp(void)
+{
+    Mock_reset();
+    GpioWave_Init(&wave, &htim1, GPIOB, STEP_PIN | DIR_PIN, stream_buffer, BUFFER_LENGTH);
+}
+
+static void checkRate(void)
+{
+    static const uint32_t rates[] = {100000U, 1000U, 84000000U};
+    static const uint32_t rejected[] = {0U, 84000001U, 0x80000001U};
+    size_t i;
+    char what[96];
+
+    printf("rate (timer clock 168 MHz)\n");
+    setUp();
+    for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        uint32_t prescaler = 0;
+        uint32_t arr = 0;
+        int ok = GpioWave_setSampleRate(&wave, rates[i]) == HAL_OK;
+        MotorDriver_CalcTimerDivider(168000000U, rates[i], &prescaler, &arr);
+        ok = ok && TIM1->PSC == prescaler && TIM1->ARR == arr && wave.sample_hz == rates[i];
+        snprintf(what, sizeof(what), "%lu Hz: psc %lu, arr %lu", (unsigned long)rates[i], (unsigned long)TIM1->PSC,
+                 (unsigned long)TIM1->ARR);
+        check(ok, what);
+    }
+    for (i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++) {
+        snprintf(what, sizeof(what), "%lu Hz rejected", (unsigned long)rejected[i]);
+        check(GpioWave_setSampleRate(&wave, rejected[i]) == HAL_ERROR, what);
+    }
+}
+
+static void checkReject(void)
+{
+    static const float velocities[] = {0.0f, -100.0f, NAN};
+    GpioWaveStepper stepper;
+    size_t i;
+    char what[96];
+
+    printf("reject\n");
+    for (i = 0; i < sizeof(velocities) / sizeof(velocities[0]); i++) {
+        uint32_t ticks = 0;
+        int ok;
+
+        setUp();
+        GpioWave_setSampleRate(&wave, 100000U);
+        GpioWaveStepper_Init(&stepper, STEP_PIN, DIR_PIN);
+        ok = GpioWaveStepper_move(&stepper, 100, 0.0f, velocities[i], 1000.0f, wave.sample_hz) == HAL_ERROR;
+        GpioWave_Stream(&wave, GpioWaveStepper_fill, &stepper);
+        while (GpioWave_isBusy(&wave) && ticks < 100000U) {
+            MockTim_tick(&htim1);
+            ticks++;
+        }
+        ok = ok && !GpioWave_isBusy(&wave) && (GPIOB->ODR & STEP_PIN) == 0U;
+        snprintf(what, sizeof(what), "max velocity %g: HAL_ERROR, stream ends after %lu samples",
+                 (double)velocities[i], (unsigned long)ticks);
+        check(ok, what);
+    }
+}
+
+// 台形（三角形）の速度で steps ステップ動くのにかかる時間 [s]
+static double idealDuration(double steps, double v0, double vmax, double accel)
+{
+    double ramp = (vmax * vmax - v0 * v0) / (2.0 * accel);   // 加速に使うステップ数
+    if (2.0 * ramp > steps) {
+        double peak = sqrt(v0 * v0 + accel * steps);
+        return 2.0 * (peak - v0) / accel;
+    }
+    return 2.0 * (vmax - v0) / accel + (steps - 2.0 * ramp) / vmax;
+}
+
+static void checkStepper(int32_t steps, float start_velocity, float max_velocity, float acceleration)
+{
+    GpioWaveStepper stepper;
+    uint32_t sample = 0;
+    uint32_t edges = 0;
+    uint32_t last_edge = 0;
+    uint32_t min_interval = 0xFFFFFFFFU;
+    uint32_t dir_wrong = 0;
+    uint32_t previous = 0;
+    uint32_t dir_expected = (steps > 0) ? DIR_PIN : 0U;
+    uint32_t count = (uint32_t)((steps < 0) ? -steps : steps);
+    double ideal;
+    double duration;
+    double shortest;
+    char what[128];
+
+    setUp();
+    GPIOB->ODR = (steps > 0) ? 0U : DIR_PIN;   // DIR は逆から始める
+    GpioWave_setSampleRate(&wave, 100000U);
+    GpioWaveStepper_Init(&stepper, STEP_PIN, DIR_PIN);
+    GpioWaveStepper_move(&stepper, steps, start_velocity, max_velocity, acceleration, wave.sample_hz);
+    GpioWave_Stream(&wave, GpioWaveStepper_fill, &stepper);
+    while (GpioWave_isBusy(&wave) && sample < 10000000U) {
+        uint32_t odr;
+        MockTim_tick(&htim1);
+        sample++;
+        odr = GPIOB->ODR;
+        if ((odr & STEP_PIN) != 0U && (previous & STEP_PIN) == 0U) {
+            if ((odr & DIR_PIN) != dir_expected) {
+                dir_wrong++;
+            }
+            if (edges > 0U && sample - last_edge < min_interval) {
+                min_interval = sample - last_edge;
+            }
+            edges++;
+            last_edge = sample;
+        }
+        previous = odr;
+    }
+
+    ideal = idealDuration((double)count, (double)start_velocity, (double)max_velocity, (double)acceleration);
+    duration = (double)last_edge / (double)wave.sample_hz;
+    shortest = (double)wave.sample_hz / (double)max_velocity;   // 最高速度のステップ間隔 [サンプル]
+    printf("  %ld steps, %.0f -> %.0f step/s, %.0f step/s^2: %lu edges, %.4f s (ideal %.4f s), "
+           "shortest interval %lu samples (%.1f at max velocity)\n",
+           (long)steps, (double)start_velocity, (double)max_velocity, (double)acceleration, (unsigned long)edges,
+           duration, ideal, (unsigned long)min_interval, shortest);
+    snprintf(what, sizeof(what), "%ld steps: every step out, DIR set before the first", (long)steps);
+    check(edges == count && dir_wrong == 0U && !GpioWave_isBusy(&wave) && (GPIOB->ODR & STEP_PIN) == 0U, what);
+    snprintf(what, sizeof(what), "%ld steps: no interval shorter than max velocity, duration within 2%%",
+             (long)steps);
+    check((double)min_interval >= floor(shortest) && min_interval >= 2U && fabs(duration - ideal) <= ideal * 0.02,
+          what);
+}
+
+int main(void)
+{
+    checkRate();
+    checkReject();
+    printf("stepper (100 kHz samples, %u-sample buffer)\n", BUFFER_LENGTH);
+    checkStepper(2000, 0.0f, 8000.0f, 40000.0f);
+    checkStepper(-300, 500.0f, 8000.0f, 40000.0f);
+    checkStepper(5000, 0.0f, 50000.0f, 2000000.0f);
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+#include "stm32f4xx_hal.h"
+
+#include <string.h>
+
+TIM_TypeDef mock_tim[15];
+GPIO_TypeDef mock_gpio[3];
+
+uint32_t mock_pclk1_hz;
+uint32_t mock_pclk2_hz;
+uint32_t mock_apb1_divider;
+uint32_t mock_apb2_divider;
+
+// 各チャンネルが今出している CCR（プリロードありのとき）
+static uint32_t mock_active_ccr[15][4];
+static uint32_t mock_active_arr[15];
+static uint32_t mock_active_psc[15];
+static uint32_t mock_compare_writes;
+static uint32_t mock_update_after_writes;
+
+static size_t Mock_index(const TIM_TypeDef *tim)
+{
+    return (size_t)(tim - mock_tim);
+}
+
+static int Mock_preloaded(const TIM_TypeDef *tim, uint32_t channel)
+{
+    uint32_t index = channel >> 2;
+    uint32_t ccmr = (index < 2U) ? tim->CCMR1 : tim->CCMR2;
+    return (ccmr & ((index % 2U == 0U) ? TIM_CCMR1_OC1PE : TIM_CCMR1_OC2PE)) != 0U;
+}
+
+void Mock_reset(void)
+{
+    memset((void *)mock_tim, 0, sizeof(mock_tim));
+    memset((void *)mock_gpio, 0, sizeof(mock_gpio));
+    memset(mock_active_ccr, 0, sizeof(mock_active_ccr));
+    memset(mock_active_arr, 0, sizeof(mock_active_arr));
+    memset(mock_active_psc, 0, sizeof(mock_active_psc));
+    mock_compare_writes = 0;
+    mock_update_after_writes = 0;
+    mock_pclk1_hz = 42000000U;
+    mock_pclk2_hz = 84000000U;
+    mock_apb1_divider = RCC_HCLK_DIV4;
+    mock_apb2_divider = RCC_HCLK_DIV2;
+}
+
+void MockTim_setCompare(TIM_HandleTypeDef *htim, uint32_t channel, uint32_t value)
+{
+    (&htim->Instance->CCR1)[channel >> 2] = value;
+    mock_compare_writes++;
+    if (mock_update_after_writes != 0U && mock_compare_writes == mock_update_after_writes) {
+        MockTim_updateAll();
+    }
+}
+
+void MockTim_enablePreload(TIM_HandleTypeDef *htim, uint32_t channel)
+{
+    uint32_t index = channel >> 2;
+    volatile uint32_t *ccmr = (index < 2U) ? &htim->Instance->CCMR1 : &htim->Instance->CCMR2;
+    *ccmr |= (index % 2U == 0U) ? TIM_CCMR1_OC1PE : TIM_CCMR1_OC2PE;
+}
+
+void MockTim_update(TIM_TypeDef *tim)
+{
+    uint32_t i;
+    if ((tim->CR1 & TIM_CR1_UDIS) != 0U) {
+        return;
+    }
+    for (i = 0; i < 4U; i++) {
+        mock_active_ccr[Mock_index(tim)][i] = (&tim->CCR1)[i];
+    }
+    mock_active_arr[Mock_index(tim)] = tim->ARR;
+    mock_active_psc[Mock_index(tim)] = tim->PSC;
+    tim->CNT = 0U;
+    tim->SR |= TIM_FLAG_UPDATE;
+}
+
+void MockTim_generateEvent(TIM_HandleTypeDef *htim, uint32_t event)
+{
+    if ((event & TIM_EGR_UG) != 0U) {
+        MockTim_update(htim->Instance);
+    }
+}
+
+uint32_t MockTim_autoReload(TIM_TypeDef *tim)
+{
+    return ((tim->CR1 & TIM_CR1_ARPE) != 0U) ? mock_active_arr[Mock_index(tim)] : tim->ARR;
+}
+
+uint32_t MockTim_prescaler(TIM_TypeDef *tim)
+{
+    return mock_active_psc[Mock_index(tim)];
+}
+
+void MockTim_updateAll(void)
+{
+    size_t i;
+    for (i = 1; i < sizeof(mock_tim) / sizeof(mock_tim[0]); i++) {
+        MockTim_update(&mock_tim[i]);
+    }
+}
+
+uint32_t MockTim_output(TIM_TypeDef *tim, uint32_t channel)
+{
+    if (!Mock_preloaded(tim, channel)) {
+        return (&tim->CCR1)[channel >> 2];
+    }
+    return mock_active_ccr[Mock_index(tim)][channel >> 2];
+}
+
+void MockTim_updateAfterWrites(uint32_t count)
+{
+    mock_compare_writes = 0;
+    mock_update_after_writes = count;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t channel)
+{
+    htim->Instance->CCER |= 1U << channel;
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *config, uint32_t channel)
+{
+    uint32_t index = channel >> 2;
+    volatile uint32_t *ccmr = (index < 2U) ? &htim->Instance->CCMR1 : &htim->Instance->CCMR2;
+    uint32_t shift = (index % 2U == 0U) ? 0U : 8U;
+
+    *ccmr = (*ccmr & ~(TIM_CCMR1_OC1M << shift)) | ((config->OCMode & TIM_CCMR1_OC1M) << shift);
+    (&htim->Instance->CCR1)[index] = config->Pulse;
+    return HAL_OK;
+}
+
+void HAL_RCC_GetClockConfig(RCC_ClkInitTypeDef *config, uint32_t *flash_latency)
+{
+    memset(config, 0, sizeof(*config));
+    config->APB1CLKDivider = mock_apb1_divider;
+    config->APB2CLKDivider = mock_apb2_divider;
+    *flash_latency = 5U;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return mock_pclk1_hz;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void)
+{
+    return mock_pclk2_hz;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init)
+{
+    uint32_t pin;
+    for (pin = 0; pin < 16U; pin++) {
+        if ((init->Pin & (1U << pin)) != 0U) {
+            port->MODER = (port->MODER & ~(3U << (pin * 2U))) | ((init->Mode & 3U) << (pin * 2U));
+        }
+    }
+}
+
+void MockGpio_apply(GPIO_TypeDef *port)
+{
+    uint32_t bsrr = port->BSRR;
+    // 同じピンの set と reset が両方立っていたら set が勝つ
+    port->ODR = (port->ODR & ~(bsrr >> 16)) | (bsrr & 0xFFFFU);
+    port->IDR = port->ODR;
+    port->BSRR = 0U;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->active = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t src, uint32_t dst, uint32_t count)
+{
+    if (hdma->active || count == 0U) {
+        return HAL_BUSY;
+    }
+    hdma->src = src;
+    hdma->dst = dst;
+    hdma->count = count;
+    hdma->index = 0;
+    hdma->active = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma)
+{
+    hdma->active = 0;
+    return HAL_OK;
+}
+
+// 1 ワード転送する（転送先が GPIO の BSRR なら ODR に反映する）
+static void MockDma_transfer(DMA_HandleTypeDef *hdma)
+{
+    size_t i;
+    const volatile uint32_t *src = (const volatile uint32_t *)(uintptr_t)hdma->src;
+    volatile uint32_t *dst = (volatile uint32_t *)(uintptr_t)hdma->dst;
+
+    *dst = src[(hdma->Init.MemInc == DMA_MINC_ENABLE) ? hdma->index : 0U];
+    for (i = 0; i < sizeof(mock_gpio) / sizeof(mock_gpio[0]); i++) {
+        if (dst == &mock_gpio[i].BSRR) {
+            MockGpio_apply(&mock_gpio[i]);
+        }
+    }
+    hdma->index++;
+    if (hdma->index == hdma->count / 2U && hdma->XferHalfCpltCallback != NULL) {
+        hdma->XferHalfCpltCallback(hdma);
+    }
+    if (hdma->index == hdma->count) {
+        hdma->index = 0;
+        if (hdma->Init.Mode != DMA_CIRCULAR) {
+            hdma->active = 0;
+        }
+        if (hdma->XferCpltCallback != NULL) {
+            hdma->XferCpltCallback(hdma);
+        }
+    }
+}
+
+int MockTim_tick(TIM_HandleTypeDef *htim)
+{
+    DMA_HandleTypeDef *hdma = htim->hdma[TIM_DMA_ID_UPDATE];
+
+    if ((htim->Instance->CR1 & TIM_CR1_CEN) == 0U) {
+        return 0;
+    }
+    MockTim_update(htim->Instance);
+    if ((htim->Instance->DIER & TIM_DMA_UPDATE) != 0U && hdma != NULL && hdma->active) {
+        MockDma_transfer(hdma);
+    }
+    return 1;
+}
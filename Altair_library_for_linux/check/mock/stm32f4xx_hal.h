@@ -0,0 +1,280 @@
+#ifndef MOCK_STM32F4XX_HAL_H
+#define MOCK_STM32F4XX_HAL_H
+
+// ホストで CubeIDE 版のソースを確かめるための stm32f4xx_hal.h（レジスタは構造体の変数）
+//   - TIM1〜TIM14 は mock_tim[] の要素。レジスタの並びは STM32F4 と同じ
+//   - CCR の書き込みは __HAL_TIM_SET_COMPARE から MockTim_setCompare を通る（書き込みの途中で更新イベントを起こせる）
+//   - プリロードを有効にしたチャンネルの出力は、更新イベント（MockTim_update）で CCR を写した値。UDIS が立っていれば写さない
+//     PSC は常に、ARR は ARPE が立っていれば、同じく更新イベントで写した値を使う（MockTim_prescaler / MockTim_autoReload）
+//   - __HAL_TIM_GENERATE_EVENT の UG はその場で更新イベントを起こす
+//   - クロックは mock_pclk1_hz / mock_pclk2_hz と APB の分周（既定は 168MHz の F4 と同じ、タイマクロック 84MHz / 168MHz）
+//   - GPIOA〜GPIOC は mock_gpio[] の要素。BSRR への書き込みは MockGpio_apply で ODR に反映する（DMA の転送では自動で反映）
+//   - DMA は MockTim_tick（タイマの更新イベント 1 回）で 1 回転送する。アドレスは 32 ビットで渡すので、
+//     転送元・転送先は静的変数に置き、-no-pie でビルドする（ホストでもアドレスが 4GB 未満になる）
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+// ---- TIM ----
+
+typedef struct {
+    volatile uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR;
+    volatile uint32_t CCR1, CCR2, CCR3, CCR4, BDTR, DCR, DMAR, OR;
+} TIM_TypeDef;
+
+typedef struct {
+    uint32_t Prescaler;
+    uint32_t CounterMode;
+    uint32_t Period;
+    uint32_t ClockDivision;
+    uint32_t RepetitionCounter;
+    uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+// ---- DMA ----
+
+#define DMA_MEMORY_TO_PERIPH 0x00000040U
+#define DMA_PINC_DISABLE     0x00000000U
+#define DMA_MINC_ENABLE      0x00000400U
+#define DMA_PDATAALIGN_WORD  0x00001000U
+#define DMA_MDATAALIGN_WORD  0x00004000U
+#define DMA_NORMAL           0x00000000U
+#define DMA_CIRCULAR         0x00000100U
+#define DMA_PRIORITY_VERY_HIGH 0x00030000U
+#define DMA_FIFOMODE_DISABLE 0x00000000U
+
+typedef struct {
+    uint32_t Channel;
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+    uint32_t FIFOMode;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_InitTypeDef Init;
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    // モックの転送の状態
+    uint32_t src;
+    uint32_t dst;
+    uint32_t count;
+    uint32_t index;
+    uint8_t active;
+} DMA_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t src, uint32_t dst, uint32_t count);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+
+typedef struct {
+    TIM_TypeDef *Instance;
+    TIM_Base_InitTypeDef Init;
+    DMA_HandleTypeDef *hdma[7];
+} TIM_HandleTypeDef;
+
+#define TIM_DMA_ID_UPDATE 0U
+#define TIM_DMA_UPDATE    0x0100U   // DIER の UDE
+
+#define TIM_CHANNEL_1 0x00000000U
+#define TIM_CHANNEL_2 0x00000004U
+#define TIM_CHANNEL_3 0x00000008U
+#define TIM_CHANNEL_4 0x0000000CU
+#define TIM_CHANNEL_ALL 0x0000003CU
+
+#define TIM_CR1_CEN   0x0001U
+#define TIM_CR1_UDIS  0x0002U
+#define TIM_CR1_ARPE  0x0080U
+#define TIM_EGR_UG    0x0001U
+#define TIM_CCMR1_OC1PE 0x0008U
+#define TIM_CCMR1_OC2PE 0x0800U
+#define TIM_CCMR1_OC1M  0x0070U
+
+#define TIM_IT_UPDATE   0x0001U   // DIER の UIE
+#define TIM_FLAG_UPDATE 0x0001U   // SR の UIF
+#define TIM_EVENTSOURCE_UPDATE TIM_EGR_UG
+
+#define TIM_OCMODE_PWM1     0x0060U
+#define TIM_OCMODE_PWM2     0x0070U
+#define TIM_OCPOLARITY_HIGH 0x0000U
+#define TIM_OCFAST_DISABLE  0x0000U
+
+typedef struct {
+    uint32_t OCMode;
+    uint32_t Pulse;
+    uint32_t OCPolarity;
+    uint32_t OCNPolarity;
+    uint32_t OCFastMode;
+    uint32_t OCIdleState;
+    uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+extern TIM_TypeDef mock_tim[15];
+#define TIM1  (&mock_tim[1])
+#define TIM2  (&mock_tim[2])
+#define TIM3  (&mock_tim[3])
+#define TIM4  (&mock_tim[4])
+#define TIM5  (&mock_tim[5])
+#define TIM6  (&mock_tim[6])
+#define TIM7  (&mock_tim[7])
+#define TIM8  (&mock_tim[8])
+#define TIM9  (&mock_tim[9])
+#define TIM10 (&mock_tim[10])
+#define TIM11 (&mock_tim[11])
+#define TIM12 (&mock_tim[12])
+#define TIM13 (&mock_tim[13])
+#define TIM14 (&mock_tim[14])
+
+void MockTim_setCompare(TIM_HandleTypeDef *htim, uint32_t channel, uint32_t value);
+void MockTim_enablePreload(TIM_HandleTypeDef *htim, uint32_t channel);
+void MockTim_generateEvent(TIM_HandleTypeDef *htim, uint32_t event);
+
+#define __HAL_TIM_SET_COMPARE(h, ch, v) MockTim_setCompare((h), (ch), (uint32_t)(v))
+#define __HAL_TIM_GET_COMPARE(h, ch) ((&(h)->Instance->CCR1)[(ch) >> 2])
+#define __HAL_TIM_GET_AUTORELOAD(h) ((h)->Instance->ARR)
+#define __HAL_TIM_SET_AUTORELOAD(h, v) do { (h)->Instance->ARR = (v); (h)->Init.Period = (v); } while (0)
+#define __HAL_TIM_SET_PRESCALER(h, v) ((h)->Instance->PSC = (v))
+#define __HAL_TIM_SET_COUNTER(h, v) ((h)->Instance->CNT = (v))
+#define __HAL_TIM_ENABLE(h) ((h)->Instance->CR1 |= TIM_CR1_CEN)
+#define __HAL_TIM_DISABLE(h) ((h)->Instance->CR1 &= ~TIM_CR1_CEN)
+#define __HAL_TIM_ENABLE_OCxPRELOAD(h, ch) MockTim_enablePreload((h), (ch))
+#define __HAL_TIM_ENABLE_DMA(h, d) ((h)->Instance->DIER |= (d))
+#define __HAL_TIM_DISABLE_DMA(h, d) ((h)->Instance->DIER &= ~(d))
+#define __HAL_TIM_ENABLE_IT(h, it) ((h)->Instance->DIER |= (it))
+#define __HAL_TIM_DISABLE_IT(h, it) ((h)->Instance->DIER &= ~(it))
+#define __HAL_TIM_CLEAR_FLAG(h, f) ((h)->Instance->SR = ~(f))
+#define __HAL_TIM_GENERATE_EVENT(h, ev) MockTim_generateEvent((h), (ev))
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t channel);
+// OCxM を CCMR に、Pulse を CCR に書く
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *config, uint32_t channel);
+
+// ---- GPIO ----
+
+typedef struct {
+    volatile uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2];
+} GPIO_TypeDef;
+
+typedef struct {
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+    uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+#define GPIO_PIN_0  0x0001U
+#define GPIO_PIN_1  0x0002U
+#define GPIO_PIN_2  0x0004U
+#define GPIO_PIN_3  0x0008U
+#define GPIO_PIN_4  0x0010U
+#define GPIO_PIN_5  0x0020U
+#define GPIO_PIN_6  0x0040U
+#define GPIO_PIN_7  0x0080U
+#define GPIO_PIN_8  0x0100U
+#define GPIO_PIN_9  0x0200U
+#define GPIO_PIN_10 0x0400U
+#define GPIO_PIN_11 0x0800U
+#define GPIO_PIN_12 0x1000U
+#define GPIO_PIN_13 0x2000U
+#define GPIO_PIN_14 0x4000U
+#define GPIO_PIN_15 0x8000U
+
+#define GPIO_MODE_INPUT     0x00000000U
+#define GPIO_MODE_OUTPUT_PP 0x00000001U
+#define GPIO_NOPULL   0x00000000U
+#define GPIO_PULLUP   0x00000001U
+#define GPIO_PULLDOWN 0x00000002U
+#define GPIO_SPEED_FREQ_HIGH 0x00000002U
+
+extern GPIO_TypeDef mock_gpio[3];
+#define GPIOA (&mock_gpio[0])
+#define GPIOB (&mock_gpio[1])
+#define GPIOC (&mock_gpio[2])
+
+// 出力に初期化したピンを MODER に記録する
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init);
+
+// ---- RCC ----
+
+#define RCC_HCLK_DIV1 0x00000000U
+#define RCC_HCLK_DIV2 0x00001000U
+#define RCC_HCLK_DIV4 0x00001400U
+
+typedef struct {
+    uint32_t ClockType;
+    uint32_t SYSCLKSource;
+    uint32_t AHBCLKDivider;
+    uint32_t APB1CLKDivider;
+    uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+extern uint32_t mock_pclk1_hz;
+extern uint32_t mock_pclk2_hz;
+extern uint32_t mock_apb1_divider;
+extern uint32_t mock_apb2_divider;
+
+void HAL_RCC_GetClockConfig(RCC_ClkInitTypeDef *config, uint32_t *flash_latency);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+
+// ---- 割り込み禁止（ホストでは何もしない） ----
+
+static inline uint32_t __get_PRIMASK(void) { return 0U; }
+static inline void __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void __disable_irq(void) {}
+
+// ---- モックの操作 ----
+
+// 全レジスタと記録を 0 に戻す（クロックは既定値）
+void Mock_reset(void);
+
+// 更新イベント（カウンタのオーバーフロー）。UDIS が立っていれば何もしない
+// CCR（プリロードあり）・ARR（ARPE）・PSC を写し、カウンタを 0 に戻して SR の UIF を立てる
+void MockTim_update(TIM_TypeDef *tim);
+void MockTim_updateAll(void);
+
+// チャンネルが今出している CCR（プリロードなしなら CCR そのもの、ありなら最後の更新イベントで写した値）
+uint32_t MockTim_output(TIM_TypeDef *tim, uint32_t channel);
+
+// 今の周期の ARR（ARPE が立っていなければ ARR そのもの）と PSC（最後の更新イベントで写した値）
+uint32_t MockTim_autoReload(TIM_TypeDef *tim);
+uint32_t MockTim_prescaler(TIM_TypeDef *tim);
+
+// CCR を count 回書いたところで、全タイマに更新イベントを起こす（0 で起こさない）
+void MockTim_updateAfterWrites(uint32_t count);
+
+// カウンタが動いていれば（CEN）更新イベントを 1 回起こし、DIER の UDE が立っていれば hdma[TIM_DMA_ID_UPDATE] で 1 回転送する
+// 転送の半分・全部が終わったところで XferHalfCpltCallback / XferCpltCallback を呼ぶ。更新イベントを起こしたら 1
+int MockTim_tick(TIM_HandleTypeDef *htim);
+
+// BSRR に書かれた値を ODR に反映して BSRR を 0 に戻す
+void MockGpio_apply(GPIO_TypeDef *port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_STM32F4XX_HAL_H
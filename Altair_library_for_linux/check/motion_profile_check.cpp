@@ -0,0 +1,219 @@
+// MotionProfile（mbed 版 MotionProfile.h）の出力が、加速度・躍度・並進加速度の合成の上限を守るかを、
+// 出力した速度の差分から確かめる（周期 1 / 10 / 50 ms）
+//   - 加速度：(v[k] - v[k-1]) / dt、躍度：その差分 / dt。どちらも軸ごとの上限（と 1e-3 の相対誤差）以内
+//     速度は float なので、差分には速度の丸め（1 ulp）の分の誤差が乗る。その分は差し引いてから上限と比べる
+//   - 並進加速度の合成 |(ax, ay)| が max_linear_accel 以内
+//   - 目標に着き、着いた後は動かない。一定速度からの目標の変更では行き過ぎず、
+//     並進が 1 軸だけのステップは、着くまでの時間が連続時間の S 字の最短時間に 1% と 3 周期を足した以内
+//     （並進の 2 軸が同時に動くと合成の上限を分け合うので、軸ごとの S 字は最短時間にならない。時間は表示だけ）
+//   - 目標：静止からのステップ、反転、加速中の目標の変更（乱数）。加速中に近い目標へ変えると、躍度制限のままでは
+//     止まり切れないので行き過ぎてから戻る（行き過ぎは確かめず、上限だけ確かめる）
+//
+// 使い方：motion_profile_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+
+#include "MotionProfile.h"
+
+namespace {
+
+const float TOLERANCE = 1e-3f;  // 上限の相対誤差（float の丸め）
+
+struct Bounds {
+    float accel[3];
+    float jerk[3];
+    float linear;
+};
+
+// 1 つの目標に向かう区間の集計
+struct Run {
+    float worst_accel = 0.0f;   // 上限に対する比の最大
+    float worst_jerk = 0.0f;
+    float worst_linear = 0.0f;
+    bool overshoot = false;
+    bool moved_after = false;
+    bool reached = true;
+    float time = 0.0f;          // 全軸が目標に着くまで [s]
+    float ideal = 0.0f;         // 連続時間の最短時間 [s]
+};
+
+int failures = 0;
+
+void check(bool ok, const char* what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+// 速度 v の float の 1 ulp
+float ulp(float v)
+{
+    v = fabsf(v);
+    return nextafterf(v, INFINITY) - v;
+}
+
+// 静止から速度差 dv を加速度 a・躍度 j の S 字で変えるのにかかる最短時間
+float sCurveTime(float dv, float a, float j)
+{
+    dv = fabsf(dv);
+    if (dv == 0.0f) {
+        return 0.0f;
+    }
+    if (j <= 0.0f) {
+        return dv / a;
+    }
+    if (dv <= a * a / j) {
+        return 2.0f * sqrtf(dv / j);   // 最大加速度に届かない
+    }
+    return dv / a + a / j;
+}
+
+// 1 周期分の差分の加速度・躍度を集計する（速度の丸めの分は差し引く）
+void measure(const float v[3], float dt, const Bounds& bounds, float v_prev[3], float a_prev[3], Run& run)
+{
+    float a[3];
+    for (int i = 0; i < 3; i++) {
+        float rounding = ulp(fmaxf(fabsf(v[i]), fabsf(v_prev[i])));
+        a[i] = (v[i] - v_prev[i]) / dt;
+        float j = (a[i] - a_prev[i]) / dt;
+        run.worst_accel = fmaxf(run.worst_accel, (fabsf(a[i]) - rounding / dt) / bounds.accel[i]);
+        run.worst_jerk = fmaxf(run.worst_jerk, (fabsf(j) - 2.0f * rounding / (dt * dt)) / bounds.jerk[i]);
+        v_prev[i] = v[i];
+        a_prev[i] = a[i];
+    }
+    float rounding = ulp(fmaxf(fabsf(v[0]), fabsf(v[1])));
+    run.worst_linear = fmaxf(run.worst_linear, (hypotf(a[0], a[1]) - 2.0f * rounding / dt) / bounds.linear);
+}
+
+// profile を target に向けて回し、差分の加速度・躍度を集計する
+// v_prev / a_prev：直前の周期の速度と加速度（区間をまたいで差分を続ける）
+// steady：一定速度（加速度 0）から始める。行き過ぎと、着くまでの時間も確かめる
+void drive(MotionProfile& profile, const float target[3], float dt, const Bounds& bounds, float v_prev[3],
+           float a_prev[3], bool steady, Run& run)
+{
+    float start[3] = {profile.getVx(), profile.getVy(), profile.getOmega()};
+    profile.setTarget(target[0], target[1], target[2]);
+    if (steady) {
+        for (int i = 0; i < 3; i++) {
+            float t = sCurveTime(target[i] - start[i], bounds.accel[i], bounds.jerk[i]);
+            run.ideal = fmaxf(run.ideal, t);
+        }
+    }
+    const int periods = static_cast<int>(10.0f / dt);
+    bool settled = false;
+    for (int k = 0; k < periods; k++) {
+        profile.update();
+        float v[3] = {profile.getVx(), profile.getVy(), profile.getOmega()};
+        for (int i = 0; i < 3; i++) {
+            // 行き過ぎ：出発点から見て目標の向こう側
+            if (steady && (target[i] - start[i]) * (v[i] - target[i]) > 0.0f) {
+                run.overshoot = true;
+            }
+            if (settled && v[i] != v_prev[i]) {
+                run.moved_after = true;
+            }
+        }
+        measure(v, dt, bounds, v_prev, a_prev, run);
+        if (!settled && profile.isSettled()) {
+            settled = true;
+            run.time = static_cast<float>(k + 1) * dt;
+        }
+    }
+    run.reached = run.reached && settled;
+}
+
+// timed：着くまでの時間も確かめる
+void report(const char* name, float dt, const Run& run, bool steady, bool timed)
+{
+    char what[200];
+    printf("%s, dt %.0f ms: accel %.3f, jerk %.3f, linear %.3f of the limit", name, dt * 1e3f, run.worst_accel,
+           run.worst_jerk, run.worst_linear);
+    if (steady) {
+        printf(", settled in %.3f s (ideal %.3f s)", run.time, run.ideal);
+    }
+    printf("\n");
+    snprintf(what, sizeof(what), "%s, dt %.0f ms: accel, jerk and linear accel within limits", name, dt * 1e3f);
+    check(run.worst_accel <= 1.0f + TOLERANCE && run.worst_jerk <= 1.0f + TOLERANCE
+              && run.worst_linear <= 1.0f + TOLERANCE,
+          what);
+    if (steady) {
+        snprintf(what, sizeof(what), "%s, dt %.0f ms: reaches the target without overshoot and stays", name,
+                 dt * 1e3f);
+        check(run.reached && !run.overshoot && !run.moved_after, what);
+    } else {
+        snprintf(what, sizeof(what), "%s, dt %.0f ms: reaches the last target and stays", name, dt * 1e3f);
+        check(run.reached && !run.moved_after, what);
+    }
+    if (timed) {
+        snprintf(what, sizeof(what), "%s, dt %.0f ms: settles within the S-curve time + 1%% + 3 periods", name,
+                 dt * 1e3f);
+        check(run.time <= run.ideal * 1.01f + 3.0f * dt + 1e-6f, what);
+    }
+}
+
+}  // namespace
+
+int main()
+{
+    const Bounds bounds = {{2000.0f, 2000.0f, 360.0f}, {20000.0f, 20000.0f, 3600.0f}, 2500.0f};
+    const MotionProfileConfig config = {{bounds.accel[0], bounds.accel[1], bounds.accel[2]},
+                                        {bounds.jerk[0], bounds.jerk[1], bounds.jerk[2]},
+                                        bounds.linear};
+    const float periods[] = {0.001f, 0.01f, 0.05f};
+
+    for (float dt : periods) {
+        // 静止からのステップ（並進は合成の上限にかかる向き）
+        {
+            MotionProfile profile(dt, config);
+            float v_prev[3] = {0.0f, 0.0f, 0.0f};
+            float a_prev[3] = {0.0f, 0.0f, 0.0f};
+            Run run;
+            const float target[3] = {1000.0f, 0.0f, 180.0f};
+            drive(profile, target, dt, bounds, v_prev, a_prev, true, run);
+            report("step", dt, run, true, true);
+        }
+        // 反転
+        {
+            MotionProfile profile(dt, config);
+            profile.reset(800.0f, -300.0f, 90.0f);
+            float v_prev[3] = {800.0f, -300.0f, 90.0f};
+            float a_prev[3] = {0.0f, 0.0f, 0.0f};
+            Run run;
+            const float target[3] = {-800.0f, 300.0f, -90.0f};
+            drive(profile, target, dt, bounds, v_prev, a_prev, true, run);
+            report("reverse", dt, run, true, false);
+        }
+        // 加速中に目標を変える（乱数の目標を、乱数の周期数だけ追いかけてから次へ）
+        {
+            MotionProfile profile(dt, config);
+            std::mt19937 random(static_cast<unsigned int>(dt * 1e4f));
+            std::uniform_real_distribution<float> speed(-1500.0f, 1500.0f);
+            std::uniform_real_distribution<float> rotation(-270.0f, 270.0f);
+            std::uniform_int_distribution<int> hold(1, static_cast<int>(0.5f / dt) + 1);
+            float v_prev[3] = {0.0f, 0.0f, 0.0f};
+            float a_prev[3] = {0.0f, 0.0f, 0.0f};
+            Run total;
+            for (int n = 0; n < 300; n++) {
+                const float target[3] = {speed(random), speed(random), rotation(random)};
+                profile.setTarget(target[0], target[1], target[2]);
+                int count = hold(random);
+                for (int k = 0; k < count; k++) {
+                    profile.update();
+                    const float v[3] = {profile.getVx(), profile.getVy(), profile.getOmega()};
+                    measure(v, dt, bounds, v_prev, a_prev, total);
+                }
+            }
+            // 最後の目標には着くまで回す
+            const float last[3] = {0.0f, 0.0f, 0.0f};
+            drive(profile, last, dt, bounds, v_prev, a_prev, false, total);
+            report("random", dt, total, false, false);
+        }
+    }
+
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
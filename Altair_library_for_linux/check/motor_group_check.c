@@ -0,0 +1,154 @@
+// CubeIDE 版 motor_driver.c を、モックのタイマレジスタ（mock/stm32f4xx_hal.h）の上で確かめる
+//   - scale: ARR（16bit / 32bit タイマ）ごとに、速度から求めた CCR が ARR × 速度 / 100 と合うか
+//   - freq : setPwmFrequency(980) が 84MHz のタイマクロックから求めるプリスケーラと ARR
+//   - group: 書き込みの途中で更新イベントが来ても、MotorGroup_setSpeeds では古い組と新しい組の混ざった出力にならないか
+//            （比べるため、MotorDriver_setSpeed を順に呼んだときに混ざることも表示する）
+//   - stop : MotorGroup_Stop で全チャンネルが ARR（ショートブレーキ）になるか
+//
+// 使い方：motor_group_check（失敗があれば終了コード 1）
+
+#include <stdio.h>
+
+#include "motor_driver.h"
+
+static TIM_HandleTypeDef htim3 = {TIM3, {0, 0, 0, 0, 0, 0}, {NULL, NULL, NULL, NULL, NULL, NULL, NULL}};
+static TIM_HandleTypeDef htim4 = {TIM4, {0, 0, 0, 0, 0, 0}, {NULL, NULL, NULL, NULL, NULL, NULL, NULL}};
+static TIM_HandleTypeDef htim5 = {TIM5, {0, 0, 0, 0, 0, 0}, {NULL, NULL, NULL, NULL, NULL, NULL, NULL}};
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+static void checkScale(void)
+{
+    static const uint32_t arrs[] = {999U, 0xFFFFU, 99999U, 0xFFFFFFFFU};
+    static const int speeds[] = {1, 50, 99, -99};
+    size_t a, s;
+
+    printf("scale\n");
+    for (a = 0; a < sizeof(arrs) / sizeof(arrs[0]); a++) {
+        MotorDriver motor;
+        int ok = 1;
+        char what[96];
+
+        Mock_reset();
+        TIM5->ARR = arrs[a];
+        MotorDriver_Init(&motor, &htim5, TIM_CHANNEL_1, &htim5, TIM_CHANNEL_2);
+        for (s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++) {
+            int speed = speeds[s];
+            uint64_t expected = (uint64_t)arrs[a] * (uint64_t)(speed > 0 ? speed : -speed) / 100U;
+            uint32_t ccr;
+            MotorDriver_setSpeed(&motor, speed);
+            ccr = (speed > 0) ? TIM5->CCR1 : TIM5->CCR2;
+            if (ccr + 1U < expected || ccr > expected) {
+                printf("       arr %lu speed %d: ccr %lu, expected %llu\n", (unsigned long)arrs[a], speed,
+                       (unsigned long)ccr, (unsigned long long)expected);
+                ok = 0;
+            }
+        }
+        snprintf(what, sizeof(what), "arr %lu", (unsigned long)arrs[a]);
+        check(ok, what);
+    }
+}
+
+static void checkFrequency(void)
+{
+    MotorDriver motor;
+
+    printf("freq\n");
+    Mock_reset();
+    MotorDriver_Init(&motor, &htim3, TIM_CHANNEL_1, &htim3, TIM_CHANNEL_2);
+    check(MotorDriver_setPwmFrequency(&motor, 980U) == HAL_OK, "980 Hz accepted");
+    check(TIM3->PSC == 1U && TIM3->ARR == 42856U && motor.arr == 42856U, "psc 1, arr 42856 at 84 MHz");
+    check(MotorDriver_setPwmFrequency(&motor, 0U) == HAL_ERROR, "0 Hz rejected");
+}
+
+// 4 チャンネルの出力が、全部 before か全部 after か（混ざっていれば 0）
+static int outputsConsistent(const uint32_t *before, const uint32_t *after)
+{
+    uint32_t out[4];
+    int all_before = 1;
+    int all_after = 1;
+    int i;
+
+    out[0] = MockTim_output(TIM3, TIM_CHANNEL_1);
+    out[1] = MockTim_output(TIM3, TIM_CHANNEL_2);
+    out[2] = MockTim_output(TIM4, TIM_CHANNEL_1);
+    out[3] = MockTim_output(TIM4, TIM_CHANNEL_2);
+    for (i = 0; i < 4; i++) {
+        all_before = all_before && out[i] == before[i];
+        all_after = all_after && out[i] == after[i];
+    }
+    return all_before || all_after;
+}
+
+static void checkGroup(void)
+{
+    static const int before_speeds[2] = {50, 50};
+    static const int after_speeds[2] = {-50, -50};
+    MotorDriver left, right;
+    MotorDriver *motors[2] = {&left, &right};
+    MotorGroup group;
+    uint32_t before[4], after[4];
+    uint32_t writes;
+    int group_torn = 0;
+    int plain_torn = 0;
+    char what[96];
+
+    printf("group\n");
+    Mock_reset();
+    TIM3->ARR = 999U;
+    TIM4->ARR = 999U;
+    MotorDriver_Init(&left, &htim3, TIM_CHANNEL_1, &htim3, TIM_CHANNEL_2);
+    MotorDriver_Init(&right, &htim4, TIM_CHANNEL_1, &htim4, TIM_CHANNEL_2);
+    check(MotorGroup_Init(&group, motors, 2) == HAL_OK, "init");
+    check((TIM3->CR1 & TIM_CR1_ARPE) != 0U && (TIM4->CCMR1 & TIM_CCMR1_OC2PE) != 0U, "ARR / CCR preload enabled");
+
+    before[0] = 499U; before[1] = 0U; before[2] = 499U; before[3] = 0U;
+    after[0] = 0U; after[1] = 499U; after[2] = 0U; after[3] = 499U;
+
+    // 1 回の切り替えは CCR 4 回の書き込み。何回目の書き込みの直後に更新イベントが来ても混ざらないこと
+    for (writes = 1; writes <= 4U; writes++) {
+        MotorGroup_setSpeeds(&group, before_speeds);
+        MockTim_updateAll();
+        MockTim_updateAfterWrites(writes);
+        MotorGroup_setSpeeds(&group, after_speeds);
+        group_torn += !outputsConsistent(before, after);
+        MockTim_updateAfterWrites(0);
+        MockTim_updateAll();
+        group_torn += !outputsConsistent(after, after);
+
+        MotorDriver_setSpeed(&left, before_speeds[0]);
+        MotorDriver_setSpeed(&right, before_speeds[1]);
+        MockTim_updateAll();
+        MockTim_updateAfterWrites(writes);
+        MotorDriver_setSpeed(&left, after_speeds[0]);
+        MotorDriver_setSpeed(&right, after_speeds[1]);
+        plain_torn += !outputsConsistent(before, after);
+        MockTim_updateAfterWrites(0);
+    }
+    snprintf(what, sizeof(what), "MotorGroup_setSpeeds: %d of 4 update timings torn", group_torn);
+    check(group_torn == 0, what);
+    printf("       (MotorDriver_setSpeed one by one: %d of 4 torn)\n", plain_torn);
+
+    MotorGroup_Stop(&group);
+    MockTim_updateAll();
+    printf("stop\n");
+    check(MockTim_output(TIM3, TIM_CHANNEL_1) == 999U && MockTim_output(TIM3, TIM_CHANNEL_2) == 999U
+              && MockTim_output(TIM4, TIM_CHANNEL_1) == 999U && MockTim_output(TIM4, TIM_CHANNEL_2) == 999U,
+          "all channels at arr");
+}
+
+int main(void)
+{
+    checkScale();
+    checkFrequency();
+    checkGroup();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+// MotorOutput（mbed 版）を、sil/MotorModel.h のモータで閉ループにして確かめる
+//   - 制御：PidCore（RobotControl と同じく出力 ±1）→ MotorOutput → 2 本の PWM の Duty
+//   - 周期：5〜15ms の一様乱数で揺らし（ループの中身やスレッドの切り替えで揺れる場合）、PID と MotorOutput には実測の dt を渡す
+//   - 指令：0 → +8 rps → −8 rps → 0 rps を 0.5 秒ずつ
+//   - 採点：目標との差の二乗平均 [rps]、巻線電流の最大値 [A]、Duty の変化率の最大値 [duty / s]
+// 出力整形段の設定ごとに同じ乱数の周期で回し、次を確かめる
+//   - フィードフォワードで追従誤差が小さくなる
+//   - スルーレート制限で電流の最大値が下がり、周期が揺れても変化率が slew_rate を超えない
+//     （比べるため、決まった 10ms を dt に渡したときの変化率も表示する）
+//
+// 使い方：motor_output_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+
+#include "pid_core.h"
+#include "MotorOutput.h"
+#include "MotorModel.h"
+
+namespace {
+
+const float PLANT_STEP = 100e-6f;     // モータを積分する刻み [s]
+const float PERIOD_MIN = 0.005f;      // 制御周期の範囲 [s]
+const float PERIOD_MAX = 0.015f;
+const float NOMINAL_PERIOD = 0.01f;
+const float SEGMENT = 0.5f;           // 指令 1 つの長さ [s]
+const float TARGETS[] = {0.0f, 8.0f, -8.0f, 0.0f};
+const float SLEW_RATE = 20.0f;
+const unsigned int SEED = 1;
+
+struct Case {
+    const char* name;
+    MotorOutputConfig config;
+    bool nominal_dt;   // MotorOutput に実測ではなく決まった 10ms を渡す
+};
+
+struct Score {
+    float rms_error;
+    float peak_current;
+    float max_rate;
+};
+
+// 静止摩擦が Duty 2% ほどになるモータ（不感帯補償が効くように既定値より摩擦を大きくする）
+SimMotorConfig plantConfig()
+{
+    SimMotorConfig config = SimMotor_defaultConfig();
+    config.coulomb = 0.02f;
+    return config;
+}
+
+Score run(const Case& test)
+{
+    MotorModel motor(plantConfig());
+    PidCore pid;
+    PidCore_Init(&pid);
+    PidCore_setGain(&pid, 0.05f, 1.0f, 0.0f, 0.0f);
+    PidCore_setOutputLimit(&pid, -1.0f, 1.0f);
+    MotorOutput output(test.config);
+
+    std::mt19937 random(SEED);
+    std::uniform_real_distribution<float> period(PERIOD_MIN, PERIOD_MAX);
+
+    const float counts_per_rev = motor.getConfig().counts_per_rev;
+    const float duration = SEGMENT * static_cast<float>(sizeof(TARGETS) / sizeof(TARGETS[0]));
+    double last_count = 0.0;
+    float duty = 0.0f;
+    float time = 0.0f;
+    double error_sum = 0.0;
+    double error_time = 0.0;
+    Score score = {0.0f, 0.0f, 0.0f};
+
+    while (time < duration) {
+        // 制御周期の分だけ、前回の Duty のままモータを進める
+        float dt = period(random);
+        int steps = static_cast<int>(lroundf(dt / PLANT_STEP));
+        float target = TARGETS[static_cast<int>(time / SEGMENT)];
+        for (int s = 0; s < steps; s++) {
+            motor.step(duty > 0.0f ? duty : 0.0f, duty < 0.0f ? -duty : 0.0f, 0.0f, PLANT_STEP);
+            score.peak_current = fmaxf(score.peak_current, fabsf(motor.getCurrent()));
+            float error = target - motor.getOmega() / (2.0f * static_cast<float>(M_PI));
+            error_sum += static_cast<double>(error * error * PLANT_STEP);
+            error_time += static_cast<double>(PLANT_STEP);
+        }
+        time += static_cast<float>(steps) * PLANT_STEP;
+        target = TARGETS[static_cast<int>(fminf(time / SEGMENT, duration / SEGMENT - 1.0f))];
+
+        // エンコーダ（量子化したカウント）から実測の周期で回転数を出す
+        double count = floor(motor.getAngle() / (2.0 * M_PI) * counts_per_rev);
+        float rps = static_cast<float>(count - last_count) / counts_per_rev / dt;
+        last_count = count;
+
+        float control = PidCore_update(&pid, target, rps, dt);
+        float next = output.update(control, target, test.nominal_dt ? NOMINAL_PERIOD : dt);
+        score.max_rate = fmaxf(score.max_rate, fabsf(next - duty) / dt);
+        duty = next;
+    }
+    score.rms_error = static_cast<float>(sqrt(error_sum / error_time));
+    return score;
+}
+
+}  // namespace
+
+int main()
+{
+    const float kv = 0.08f;
+    const Case cases[] = {
+        {"pid only",                 {0.0f, 0.0f, 0.0f, 0.95f}, false},
+        {"kv",                       {kv, 0.0f, 0.0f, 0.95f}, false},
+        {"kv + deadband",            {kv, 0.025f, 0.0f, 0.95f}, false},
+        {"kv + deadband + slew",     {kv, 0.025f, SLEW_RATE, 0.95f}, false},
+        {"slew, fixed 10ms dt",      {kv, 0.025f, SLEW_RATE, 0.95f}, true},
+    };
+    const int count = static_cast<int>(sizeof(cases) / sizeof(cases[0]));
+    Score scores[count];
+
+    printf("period %.0f-%.0f ms (measured dt), targets 0 / +8 / -8 / 0 rps, %.1f s each\n",
+           PERIOD_MIN * 1e3f, PERIOD_MAX * 1e3f, SEGMENT);
+    printf("  %-24s %10s %12s %14s\n", "output stage", "rms [rps]", "peak I [A]", "max rate [/s]");
+    for (int i = 0; i < count; i++) {
+        scores[i] = run(cases[i]);
+        printf("  %-24s %10.3f %12.2f %14.1f\n", cases[i].name, scores[i].rms_error, scores[i].peak_current,
+               scores[i].max_rate);
+    }
+
+    int failures = 0;
+    auto check = [&failures](bool ok, const char* what) {
+        if (!ok) {
+            failures++;
+        }
+        printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+    };
+    check(scores[1].rms_error < scores[0].rms_error, "feedforward lowers the tracking error");
+    check(scores[3].peak_current < scores[2].peak_current, "slew limit lowers the peak current");
+    check(scores[3].max_rate <= SLEW_RATE * 1.001f, "slew rate holds with a jittery period");
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
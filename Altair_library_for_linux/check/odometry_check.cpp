@@ -0,0 +1,218 @@
+// 差動二輪のオドメトリ（mbed 版 TwoWheelKinematics の updateOdometry）を、真の軌跡から作ったエンコーダのカウントで確かめる
+//   - 真の軌跡：(v, ω) の指令を 0.1ms 刻みで倍精度の円弧として積分し、左右の車輪の移動量からカウントを作る
+//     （8192 カウント / 回転、直径 100mm、車輪の間隔 400mm。カウントは整数に切り捨て）
+//   - オドメトリの周期：1 / 10 / 100 ms。周期ごとにカウントを渡し、そのときの真の位置・姿勢と比べる
+//   - 軌跡：1m の正方形（その場で 90 度旋回）、半径 500mm の円を 1 周、8 の字（左右の円を 1 周ずつ）、
+//     半径 20m のゆるい曲線（1 周期の旋回角が小さい）、カウントが int32_t の上限をまたぐ直進
+//     閉じた軌跡は、出発点に戻ったとき（閉合）の誤差も確かめる
+//     ω は周期の境目でしか変えない（周期の中で ω が変わると、円弧とみなす積分そのものの誤差が出る）
+//   - 運動学：calculateWheelSpeeds と calculateTwist が往復で元に戻る、直進（ω = 0）で NaN にならない
+//
+// 使い方：odometry_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <random>
+
+#include "TwoWheelKinematics.h"
+
+namespace {
+
+const double WHEEL_DIAMETER = 100.0;    // [mm]
+const double WHEEL_DISTANCE = 400.0;    // [mm]
+const double COUNTS_PER_REV = 8192.0;
+const double TRUTH_STEP = 1e-4;         // 真の軌跡を積分する刻み [s]
+const double POSITION_TOLERANCE = 1.0;  // 位置の誤差 [mm]
+const double ANGLE_TOLERANCE = 0.05;    // 姿勢の誤差 [deg]
+
+// 時刻 t [s] の指令（v [mm/s], ω [rad/s]）
+using Command = std::function<void(double t, double& v, double& omega)>;
+
+struct Trajectory {
+    const char* name;
+    double duration;   // [s]
+    bool closed;       // 出発点に戻る
+    int64_t offset;    // カウントの初期値
+    Command command;
+};
+
+// 1 つの軌跡・周期の集計
+struct Result {
+    double worst_position = 0.0;  // 真の位置との差の最大 [mm]
+    double worst_angle = 0.0;     // 真の姿勢との差の最大 [deg]
+    double closure_position = 0.0;
+    double closure_angle = 0.0;
+    bool finite = true;
+};
+
+int failures = 0;
+
+void check(bool ok, const char* what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+double wrapDeg(double a)
+{
+    a = fmod(a, 360.0);
+    if (a > 180.0) a -= 360.0;
+    if (a < -180.0) a += 360.0;
+    return a;
+}
+
+// カウント（int64_t で数えた値）を、エンコーダと同じく int32_t で折り返す
+int32_t wrapCount(int64_t count)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint64_t>(count)));
+}
+
+Result run(const Trajectory& trajectory, double period)
+{
+    TwoWheelKinematics kinematics(static_cast<float>(WHEEL_DIAMETER), static_cast<float>(WHEEL_DISTANCE), RPS_MODE,
+                                  static_cast<float>(COUNTS_PER_REV));
+    const double mm_per_count = M_PI * WHEEL_DIAMETER / COUNTS_PER_REV;
+    double x = 0.0, y = 0.0, theta = 0.0;  // 真の位置 [mm] と姿勢 [rad]
+    double right = 0.0, left = 0.0;        // 車輪の移動量 [mm]
+    const int steps = static_cast<int>(llround(period / TRUTH_STEP));
+    const int periods = static_cast<int>(llround(trajectory.duration / period));
+    Result result;
+
+    auto counts = [&](double distance) {
+        return wrapCount(trajectory.offset + static_cast<int64_t>(floor(distance / mm_per_count)));
+    };
+    kinematics.updateOdometry(counts(right), counts(left));
+    for (int k = 0; k < periods; k++) {
+        for (int s = 0; s < steps; s++) {
+            double t = (static_cast<double>(k) * steps + s + 0.5) * TRUTH_STEP;
+            double v, omega;
+            trajectory.command(t, v, omega);
+            double ds = v * TRUTH_STEP;
+            double dtheta = omega * TRUTH_STEP;
+            right += ds + dtheta * WHEEL_DISTANCE / 2.0;
+            left += ds - dtheta * WHEEL_DISTANCE / 2.0;
+            double chord = (fabs(dtheta) > 1e-12) ? ds * sin(dtheta / 2.0) / (dtheta / 2.0) : ds;
+            x += chord * cos(theta + dtheta / 2.0);
+            y += chord * sin(theta + dtheta / 2.0);
+            theta += dtheta;
+        }
+        kinematics.updateOdometry(counts(right), counts(left));
+        Position pose = kinematics.getPosition();
+        if (!std::isfinite(pose.x) || !std::isfinite(pose.y) || !std::isfinite(pose.theta)) {
+            result.finite = false;
+            return result;
+        }
+        double position = hypot(pose.x - x, pose.y - y);
+        double angle = fabs(wrapDeg(pose.theta - theta * 180.0 / M_PI));
+        result.worst_position = fmax(result.worst_position, position);
+        result.worst_angle = fmax(result.worst_angle, angle);
+        if (k == periods - 1) {
+            result.closure_position = hypot(pose.x, pose.y);
+            result.closure_angle = fabs(wrapDeg(pose.theta));
+        }
+    }
+    return result;
+}
+
+void report(const Trajectory& trajectory, double period, const Result& result)
+{
+    char what[200];
+    printf("%s, dt %.0f ms: worst %.3f mm / %.4f deg", trajectory.name, period * 1e3, result.worst_position,
+           result.worst_angle);
+    if (trajectory.closed) {
+        printf(", closure %.3f mm / %.4f deg", result.closure_position, result.closure_angle);
+    }
+    printf("\n");
+    snprintf(what, sizeof(what), "%s, dt %.0f ms: within %.1f mm and %.2f deg of the true pose", trajectory.name,
+             period * 1e3, POSITION_TOLERANCE, ANGLE_TOLERANCE);
+    check(result.finite && result.worst_position <= POSITION_TOLERANCE && result.worst_angle <= ANGLE_TOLERANCE,
+          what);
+    if (trajectory.closed) {
+        snprintf(what, sizeof(what), "%s, dt %.0f ms: closes within %.1f mm and %.2f deg", trajectory.name,
+                 period * 1e3, POSITION_TOLERANCE, ANGLE_TOLERANCE);
+        check(result.finite && result.closure_position <= POSITION_TOLERANCE
+                  && result.closure_angle <= ANGLE_TOLERANCE,
+              what);
+    }
+}
+
+// calculateWheelSpeeds → calculateTwist の往復と、直進での NaN
+void roundTrip(ControlMode mode, const char* name)
+{
+    TwoWheelKinematics kinematics(static_cast<float>(WHEEL_DIAMETER), static_cast<float>(WHEEL_DISTANCE), mode);
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> speed(-1500.0f, 1500.0f);
+    std::uniform_real_distribution<float> rotation(-6.0f, 6.0f);
+    float worst = 0.0f;
+    bool finite = true;
+    for (int n = 0; n < 10000; n++) {
+        float v = speed(random);
+        float omega = (n % 10 == 0) ? 0.0f : rotation(random);
+        float right, left, v2, omega2;
+        kinematics.calculateWheelSpeeds(v, omega, right, left);
+        kinematics.calculateTwist(right, left, v2, omega2);
+        finite = finite && std::isfinite(right) && std::isfinite(left);
+        worst = fmaxf(worst, fmaxf(fabsf(v2 - v) / 1500.0f, fabsf(omega2 - omega) / 6.0f));
+    }
+    char what[160];
+    snprintf(what, sizeof(what), "%s: wheel speeds and back round-trip within 1e-5 (worst %.1e), finite at omega 0",
+             name, worst);
+    check(finite && worst <= 1e-5f, what);
+}
+
+}  // namespace
+
+int main()
+{
+    // 1m の正方形：1 辺 2 s（500 mm/s）、角でその場で 90 度を 1 s
+    auto square = [](double t, double& v, double& omega) {
+        double phase = fmod(t, 3.0);
+        v = (phase < 2.0) ? 500.0 : 0.0;
+        omega = (phase < 2.0) ? 0.0 : M_PI / 2.0;
+    };
+    // 半径 500mm の円を 8 s で 1 周
+    auto circle = [](double t, double& v, double& omega) {
+        (void)t;
+        omega = 2.0 * M_PI / 8.0;
+        v = 500.0 * omega;
+    };
+    // 8 の字：半径 500mm の円を左回りに 5 s、右回りに 5 s
+    auto eight = [](double t, double& v, double& omega) {
+        omega = ((t < 5.0) ? 1.0 : -1.0) * 2.0 * M_PI / 5.0;
+        v = 500.0 * fabs(omega);
+    };
+    // 半径 20m のゆるい曲線
+    auto gentle = [](double t, double& v, double& omega) {
+        (void)t;
+        v = 1000.0;
+        omega = 1000.0 / 20000.0;
+    };
+    auto straight = [](double t, double& v, double& omega) {
+        (void)t;
+        v = 1000.0;
+        omega = 0.0;
+    };
+    const Trajectory trajectories[] = {
+        {"square", 12.0, true, 0, square},
+        {"circle", 8.0, true, 0, circle},
+        {"figure eight", 10.0, true, 0, eight},
+        {"gentle arc", 20.0, false, 0, gentle},
+        {"straight across int32 wrap", 5.0, false, INT32_MAX - 20000, straight},
+    };
+    const double periods[] = {0.001, 0.01, 0.1};
+
+    for (const Trajectory& trajectory : trajectories) {
+        for (double period : periods) {
+            report(trajectory, period, run(trajectory, period));
+        }
+    }
+    roundTrip(RPS_MODE, "rps mode");
+    roundTrip(MMPS_MODE, "mm/s mode");
+
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// PathFollower（mbed 版 PathFollower.h）を、速度に一次遅れのある機体で閉ループにして、経路からのずれを確かめる
+//   - 機体：機体座標の速度指令 (vx, vy, ω) に時定数 PLANT_TAU の一次遅れで追従し、1ms で自己位置を積分する。
+//     差動二輪は vy を 0 にする。自己位置はそのまま（誤差なしで）PathFollower に渡し、指令は 10ms ごと
+//   - 経路：2m の正方形、S 字（正弦波を 100mm 刻みの点にしたもの）、約 10000 点の往復（長い経路）
+//   - ずれ：各時刻の位置から経路（全区間を端から探した最寄り点）までの距離の最大、終わったときの終点までの距離
+//     差動二輪（Ramsete）は横にずれたまま終点の横を通り過ぎたところで終わるので、終点までの距離は経路からのずれと同じ幅で見る
+//   - 速度：指令の並進速度が、その時刻に追従している区間の最高速度を超えない
+//   - 近道：終わるまでの時間が、経路の長さを区間の最高速度で走る時間より短くない（途中の区間を飛ばさない）
+//   - 長い経路：往復の間隔（300mm）が先読み距離と同じでも隣の往復に移らずに最後まで追従できるか。
+//     1 周期の時間は短い経路とほぼ同じ（最寄り区間を前回から進めるだけ）になるはずだが、表示だけ
+//
+// 使い方：path_follower_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#include "PathFollower.h"
+
+namespace {
+
+const float CONTROL_DT = 0.01f;   // 指令の周期 [s]
+const float PLANT_STEP = 0.001f;  // 自己位置を積分する刻み [s]
+const float PLANT_TAU = 0.05f;    // 速度の一次遅れ [s]
+const float DEG = 3.14159265f / 180.0f;
+
+// 1 つの経路の集計
+struct Result {
+    bool finished = false;
+    float time = 0.0f;            // 終わるまで [s]
+    float shortest = 0.0f;        // 経路を区間の最高速度で走る時間 [s]
+    float worst_error = 0.0f;     // 経路からのずれの最大 [mm]
+    float final_error = 0.0f;     // 終点までの距離 [mm]
+    float worst_speed = 0.0f;     // 区間の最高速度に対する指令の速度の比の最大
+    int updates = 0;
+    double ns_per_update = 0.0;   // update 1 回あたり [ns]
+};
+
+int failures = 0;
+
+void check(bool ok, const char* what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+// 経路の全区間を端から探した、(x, y) から経路までの距離
+float pathDistance(const std::vector<PathPoint>& path, float x, float y)
+{
+    float best = INFINITY;
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        float ax = path[i].x, ay = path[i].y;
+        float dx = path[i + 1].x - ax, dy = path[i + 1].y - ay;
+        float len_sq = dx * dx + dy * dy;
+        float t = (len_sq > 0.0f) ? ((x - ax) * dx + (y - ay) * dy) / len_sq : 0.0f;
+        t = fminf(fmaxf(t, 0.0f), 1.0f);
+        best = fminf(best, hypotf(x - (ax + dx * t), y - (ay + dy * t)));
+    }
+    return best;
+}
+
+// 経路を最後まで（または time_limit まで）追従させる
+Result follow(const std::vector<PathPoint>& path, const PathFollowerConfig& config, PathFollowMode mode,
+              float start_theta, float time_limit)
+{
+    PathFollower follower(config, mode);
+    follower.setPath(path.data(), static_cast<int>(path.size()));
+    Position pose = {static_cast<float>(path[0].x), static_cast<float>(path[0].y), start_theta};
+    float vx = 0.0f, vy = 0.0f, omega = 0.0f;  // 機体の実際の速度（機体座標）
+    const int steps = static_cast<int>(lroundf(CONTROL_DT / PLANT_STEP));
+    const float alpha = PLANT_STEP / PLANT_TAU;
+    Result result;
+    std::chrono::nanoseconds elapsed(0);
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        result.shortest += hypotf(path[i + 1].x - path[i].x, path[i + 1].y - path[i].y) / path[i + 1].speed;
+    }
+
+    for (float time = 0.0f; time < time_limit; time += CONTROL_DT) {
+        auto begin = std::chrono::steady_clock::now();
+        PathCommand command = follower.update(pose);
+        elapsed += std::chrono::steady_clock::now() - begin;
+        result.updates++;
+        if (command.finished) {
+            result.finished = true;
+            result.time = time;
+            break;
+        }
+        int segment = follower.getSegment();
+        float limit = path[segment + 1].speed;
+        result.worst_speed = fmaxf(result.worst_speed, hypotf(command.vx, command.vy) / limit);
+        if (mode == RAMSETE_MODE) {
+            command.vy = 0.0f;
+        }
+        for (int s = 0; s < steps; s++) {
+            vx += (command.vx - vx) * alpha;
+            vy += (command.vy - vy) * alpha;
+            omega += (command.omega - omega) * alpha;
+            float c = cosf(pose.theta * DEG);
+            float sn = sinf(pose.theta * DEG);
+            pose.x += (c * vx - sn * vy) * PLANT_STEP;
+            pose.y += (sn * vx + c * vy) * PLANT_STEP;
+            pose.theta += omega * PLANT_STEP;
+        }
+        result.worst_error = fmaxf(result.worst_error, pathDistance(path, pose.x, pose.y));
+    }
+    result.final_error = hypotf(pose.x - path.back().x, pose.y - path.back().y);
+    result.ns_per_update = static_cast<double>(elapsed.count()) / result.updates;
+    return result;
+}
+
+void report(const char* name, const Result& result, float max_error, float max_final)
+{
+    char what[200];
+    printf("%s: finished in %.2f s (shortest %.2f s), worst error %.1f mm, final %.1f mm, speed %.3f of the segment limit, "
+           "%.0f ns per update\n",
+           name, result.time, result.shortest, result.worst_error, result.final_error, result.worst_speed, result.ns_per_update);
+    snprintf(what, sizeof(what), "%s: finished, within %.0f mm of the path and %.0f mm of the goal", name, max_error,
+             max_final);
+    check(result.finished && result.worst_error <= max_error && result.final_error <= max_final, what);
+    snprintf(what, sizeof(what), "%s: no shortcut (not faster than the path at the segment speeds)", name);
+    check(result.time >= result.shortest, what);
+    snprintf(what, sizeof(what), "%s: speed within the segment limit", name);
+    check(result.worst_speed <= 1.0f + 1e-3f, what);
+}
+
+std::vector<PathPoint> square()
+{
+    return {
+        {0, 0, 0, 800},
+        {2000, 0, 0, 800},
+        {2000, 2000, 9000, 600},
+        {0, 2000, 18000, 800},
+        {0, 0, 27000, 800},
+    };
+}
+
+// 振幅 500mm・波長 2000mm の正弦波を 100mm 刻みで 2 波長
+std::vector<PathPoint> sCurve()
+{
+    std::vector<PathPoint> path;
+    for (int i = 0; i <= 40; i++) {
+        float x = 100.0f * i;
+        float y = 500.0f * sinf(2.0f * 3.14159265f * x / 2000.0f);
+        path.push_back({static_cast<int16_t>(x), static_cast<int16_t>(lroundf(y)), 0, 800});
+    }
+    return path;
+}
+
+// 30m の直線を 50mm 刻みの点にし、300mm ずつずらして 16 往復（9616 点）
+std::vector<PathPoint> serpentine()
+{
+    std::vector<PathPoint> path;
+    for (int lane = 0; lane < 16; lane++) {
+        for (int i = 0; i <= 600; i++) {
+            int x = (lane % 2 == 0) ? 50 * i : 30000 - 50 * i;
+            path.push_back({static_cast<int16_t>(x), static_cast<int16_t>(300 * lane), 0, 1000});
+        }
+    }
+    return path;
+}
+
+}  // namespace
+
+int main()
+{
+    // 使い方（PathFollower.md）の設定
+    const PathFollowerConfig config = {300.0f, 1000.0f, 1000.0f, 3.0f, 180.0f, 10.0f, 10.0f, 0.7f};
+
+    report("pure pursuit / square", follow(square(), config, PURE_PURSUIT_MODE, 0.0f, 60.0f), 150.0f, 20.0f);
+    report("pure pursuit / s-curve", follow(sCurve(), config, PURE_PURSUIT_MODE, 0.0f, 60.0f), 100.0f, 20.0f);
+    // 差動二輪は経路の向きから出発する
+    float start = atan2f(static_cast<float>(sCurve()[1].y), 100.0f) / DEG;
+    report("ramsete / s-curve", follow(sCurve(), config, RAMSETE_MODE, start, 60.0f), 100.0f, 100.0f);
+
+    // 長い経路（ずれを測るのに全区間を探すので、数秒かかる）
+    std::vector<PathPoint> long_path = serpentine();
+    printf("serpentine: %zu points\n", long_path.size());
+    report("pure pursuit / serpentine", follow(long_path, config, PURE_PURSUIT_MODE, 0.0f, 1000.0f), 150.0f, 20.0f);
+
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
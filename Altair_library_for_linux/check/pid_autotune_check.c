@@ -0,0 +1,268 @@
+// PidAutotune（pid_autotune.h）を、一次遅れ＋むだ時間（FOPDT）のプラントで回して確かめる
+//   - プラント：tau * dy/dt = K * u(t - L) - y を 10us で積分。Duty はオートチューナと同じ 1ms 周期で出す
+//   - 同定：静的ゲイン K がプラントの値に合うか、Ku / Pu が FOPDT の限界ゲイン・周期（atan(ωτ) + ωL = π を解いた値）に合うか
+//     リレーの記述関数は基本波だけを見る近似で、むだ時間が時定数に比べて短いと振動が三角波に近くなり外れる。
+//     L/tau が ULTIMATE_MIN_RATIO 以上のプラントだけ幅（KU_TOLERANCE / PU_TOLERANCE）を確かめ、
+//     どのプラントでも Ku を大きく見積もらない（ZN のゲインが安定側に外れる）ことを確かめる
+//   - 閉ループ：求めた SIMC（PI）と ZN（PID）のゲインを PidCore に入れ、同じプラントで目標値のステップに追従させる
+//   - 失敗：試験できない設定、振動しない（ヒステリシスが振動より大きい）ときは PID_AUTOTUNE_FAILED で出力が 0
+//
+// 使い方：pid_autotune_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pid_autotune.h"
+#include "pid_core.h"
+
+#define PLANT_STEP 10e-6f      // プラントを積分する刻み [s]
+#define CONTROL_DT 0.001f      // 制御周期 [s]
+#define DELAY_MAX 4096         // むだ時間のバッファ（PLANT_STEP 刻み、40ms まで）
+#define K_TOLERANCE 0.02f      // 静的ゲインの相対誤差
+#define KU_TOLERANCE 0.30f     // 限界ゲインの相対誤差
+#define PU_TOLERANCE 0.15f     // 限界周期の相対誤差
+#define ULTIMATE_MIN_RATIO 0.15f  // Ku / Pu の幅を確かめる L/tau の下限
+#define PI 3.14159265358979323846
+
+typedef struct {
+    const char *name;
+    float k;          // [rps / duty]
+    float tau;        // [s]
+    float dead_time;  // [s]
+} Plant;
+
+// むだ時間つきの一次遅れ
+typedef struct {
+    const Plant *plant;
+    float y;
+    float inputs[DELAY_MAX];
+    int delay;
+    int head;
+} Sim;
+
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+static void Sim_Init(Sim *sim, const Plant *plant)
+{
+    int i;
+
+    sim->plant = plant;
+    sim->y = 0.0f;
+    sim->delay = (int)lroundf(plant->dead_time / PLANT_STEP);
+    sim->head = 0;
+    for (i = 0; i < DELAY_MAX; i++) {
+        sim->inputs[i] = 0.0f;
+    }
+}
+
+// Duty u を 1 制御周期出して、周期の終わりの測定値を返す
+static float Sim_run(Sim *sim, float u)
+{
+    int steps = (int)lroundf(CONTROL_DT / PLANT_STEP);
+    int s;
+
+    for (s = 0; s < steps; s++) {
+        float delayed;
+        sim->inputs[sim->head] = u;
+        delayed = sim->inputs[(sim->head + DELAY_MAX - sim->delay) % DELAY_MAX];
+        sim->head = (sim->head + 1) % DELAY_MAX;
+        sim->y += (sim->plant->k * delayed - sim->y) / sim->plant->tau * PLANT_STEP;
+    }
+    return sim->y;
+}
+
+// FOPDT の限界周波数（atan(ωτ) + ωL = π）を二分法で解き、Ku と Pu を返す
+static void ultimate(const Plant *plant, float *ku, float *pu)
+{
+    double lo = 1e-3;
+    double hi = PI / plant->dead_time;
+    int i;
+
+    for (i = 0; i < 100; i++) {
+        double mid = 0.5 * (lo + hi);
+        if (atan(mid * plant->tau) + mid * plant->dead_time < PI) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    *ku = (float)(sqrt(1.0 + lo * plant->tau * lo * plant->tau) / plant->k);
+    *pu = (float)(2.0 * PI / lo);
+}
+
+static float noise(float amplitude)
+{
+    return amplitude * (2.0f * (float)rand() / (float)RAND_MAX - 1.0f);
+}
+
+// オートチューナを最後まで回す。出力が step_duty ± relay_amplitude（終わった後は 0）を外れたら *bad_output を立てる
+static float tune(PidAutotune *tuner, const PidAutotuneConfig *config, const Plant *plant, float noise_amplitude,
+                  int *bad_output)
+{
+    Sim sim;
+    float y = 0.0f;
+    float time = 0.0f;
+
+    Sim_Init(&sim, plant);
+    PidAutotune_Init(tuner, config);
+    PidAutotune_start(tuner);
+    *bad_output = 0;
+    while (PidAutotune_isRunning(tuner) && time < config->step_time + config->timeout + 1.0f) {
+        float u = PidAutotune_update(tuner, y + noise(noise_amplitude), CONTROL_DT);
+        if (PidAutotune_isRunning(tuner)) {
+            *bad_output |= fabsf(u - config->step_duty) > config->relay_amplitude + 1e-6f;
+        } else {
+            *bad_output |= u != 0.0f;
+        }
+        y = Sim_run(&sim, u);
+        time += CONTROL_DT;
+    }
+    return time;
+}
+
+// 求めたゲインで目標値 target のステップに 3 秒追従させ、行き過ぎ量（目標値比）と 2% に収まった時刻を返す
+static void closedLoop(const PidAutotuneResult *result, const Plant *plant, float target, float *overshoot,
+                       float *settle, float *final_error)
+{
+    PidCore pid;
+    Sim sim;
+    float y = 0.0f;
+    float peak = 0.0f;
+    int k;
+
+    Sim_Init(&sim, plant);
+    PidCore_Init(&pid);
+    PidCore_setGain(&pid, result->kp, result->ki, result->kd, 0.002f);
+    PidCore_setOutputLimit(&pid, -1.0f, 1.0f);
+    *settle = -1.0f;
+    for (k = 0; k < 3000; k++) {
+        float u = PidCore_update(&pid, target, y, CONTROL_DT);
+        y = Sim_run(&sim, u);
+        if (y > peak) {
+            peak = y;
+        }
+        if (fabsf(y - target) > 0.02f * target) {
+            *settle = -1.0f;
+        } else if (*settle < 0.0f) {
+            *settle = (float)(k + 1) * CONTROL_DT;
+        }
+    }
+    *overshoot = (peak - target) / target;
+    *final_error = fabsf(y - target) / target;
+}
+
+static PidAutotuneConfig defaultConfig(void)
+{
+    PidAutotuneConfig config = {
+        0.3f,   // step_duty
+        0.1f,   // relay_amplitude
+        0.05f,  // hysteresis [rps]
+        1.0f,   // step_time
+        4,      // cycles
+        10.0f,  // timeout
+        0.0f,   // tau_c
+        PID_AUTOTUNE_RULE_SIMC
+    };
+    return config;
+}
+
+static void identify(const Plant *plant, float noise_amplitude)
+{
+    PidAutotuneConfig config = defaultConfig();
+    PidAutotune tuner;
+    PidAutotuneResult simc;
+    PidAutotuneResult zn;
+    float ku;
+    float pu;
+    float time;
+    float overshoot;
+    float settle;
+    float final_error;
+    int bad_output;
+    char what[160];
+
+    ultimate(plant, &ku, &pu);
+    printf("%s: K %.1f, tau %.0f ms, L %.0f ms (Ku %.3f, Pu %.1f ms), noise +-%.2f rps\n", plant->name, plant->k,
+           plant->tau * 1e3f, plant->dead_time * 1e3f, ku, pu * 1e3f, noise_amplitude);
+
+    time = tune(&tuner, &config, plant, noise_amplitude, &bad_output);
+    simc = tuner.result;
+    printf("  identified K %.2f, tau %.1f ms, L %.1f ms, Ku %.3f, Pu %.1f ms in %.2f s\n", simc.k, simc.tau * 1e3f,
+           simc.dead_time * 1e3f, simc.ku, simc.pu * 1e3f, time);
+    snprintf(what, sizeof(what), "%s: done, duty stays within step_duty +- relay_amplitude", plant->name);
+    check(tuner.state == PID_AUTOTUNE_DONE && !bad_output, what);
+    snprintf(what, sizeof(what), "%s: K within %.0f%%", plant->name, K_TOLERANCE * 100.0f);
+    check(fabsf(simc.k - plant->k) <= K_TOLERANCE * plant->k, what);
+    if (plant->dead_time >= ULTIMATE_MIN_RATIO * plant->tau) {
+        snprintf(what, sizeof(what), "%s: Ku within %.0f%%, Pu within %.0f%% of the FOPDT values", plant->name,
+                 KU_TOLERANCE * 100.0f, PU_TOLERANCE * 100.0f);
+        check(fabsf(simc.ku - ku) <= KU_TOLERANCE * ku && fabsf(simc.pu - pu) <= PU_TOLERANCE * pu, what);
+    }
+    snprintf(what, sizeof(what), "%s: Ku not overestimated", plant->name);
+    check(simc.ku <= ku, what);
+
+    config.rule = PID_AUTOTUNE_RULE_ZN;
+    tune(&tuner, &config, plant, noise_amplitude, &bad_output);
+    zn = tuner.result;
+
+    closedLoop(&simc, plant, 0.5f * plant->k * 0.5f, &overshoot, &settle, &final_error);
+    printf("  SIMC kp %.4f ki %.3f: overshoot %.1f%%, settles within 2%% at %.3f s\n", simc.kp, simc.ki,
+           overshoot * 100.0f, settle);
+    snprintf(what, sizeof(what), "%s: SIMC step overshoots < 10%% and settles within 0.5 s", plant->name);
+    check(settle >= 0.0f && settle <= 0.5f && overshoot < 0.10f, what);
+
+    closedLoop(&zn, plant, 0.5f * plant->k * 0.5f, &overshoot, &settle, &final_error);
+    printf("  ZN kp %.4f ki %.3f kd %.6f: overshoot %.1f%%, settles within 2%% at %.3f s\n", zn.kp, zn.ki, zn.kd,
+           overshoot * 100.0f, settle);
+    snprintf(what, sizeof(what), "%s: ZN step is stable (settles within 2%% inside 3 s)", plant->name);
+    check(tuner.state == PID_AUTOTUNE_DONE && settle >= 0.0f && final_error <= 0.02f, what);
+}
+
+int main(void)
+{
+    static const Plant plants[] = {
+        {"motor", 10.0f, 0.05f, 0.01f},
+        {"slow", 5.0f, 0.2f, 0.005f},
+        {"laggy", 20.0f, 0.02f, 0.02f},
+    };
+    PidAutotuneConfig config;
+    PidAutotune tuner;
+    size_t i;
+    float time;
+    int bad_output;
+
+    srand(1);
+    for (i = 0; i < sizeof(plants) / sizeof(plants[0]); i++) {
+        identify(&plants[i], 0.0f);
+    }
+    identify(&plants[0], 0.02f);
+
+    printf("fail\n");
+    config = defaultConfig();
+    config.cycles = 0;
+    check(!PidAutotune_Init(&tuner, &config) && tuner.state == PID_AUTOTUNE_FAILED, "cycles 0: rejected");
+    config = defaultConfig();
+    config.step_duty = 0.0f;
+    check(!PidAutotune_Init(&tuner, &config) && tuner.state == PID_AUTOTUNE_FAILED, "step_duty 0: rejected");
+    PidAutotune_start(&tuner);
+    check(tuner.state == PID_AUTOTUNE_FAILED && PidAutotune_update(&tuner, 1.0f, CONTROL_DT) == 0.0f,
+          "step_duty 0: start stays failed, duty 0");
+    config = defaultConfig();
+    config.hysteresis = 5.0f;  // 振幅 1 rps の振動では切り替わらない
+    config.timeout = 2.0f;
+    time = tune(&tuner, &config, &plants[0], 0.0f, &bad_output);
+    check(tuner.state == PID_AUTOTUNE_FAILED && !bad_output && time < config.step_time + config.timeout + 0.01f,
+          "no oscillation: failed at the timeout, duty 0");
+
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// PidCore（pid_core.h）のアンチワインドアップを、出力が飽和する一次遅れのプラントで確かめる
+//   - プラント：tau * dy/dt = K * u - y（K = 1、tau = 0.1 s）を 100us で積分。出力制限は ±1 なので y は 1 までしか届かない
+//   - 指令：届かない 3 を 2 秒（出力が上限に張り付く）→ 届く 0.5 を 2 秒
+//   - ゲインと周期の組み合わせごとに、バックカリキュレーションのゲイン kt*dt（既定の kt = ki/kp）が 2 を超える場合も含めて回し、
+//     I 項が有限で出力の幅の数倍に収まり続けるか、届く指令に戻したあとすぐ飽和から抜けるかを見る
+//     （最後の誤差は表示だけ。ki が小さい・周期に対して ki が大きい組み合わせは、ワインドアップと関係なく遅い・振動する）
+//
+// 使い方：pid_core_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdio.h>
+
+#include "pid_core.h"
+
+#define PLANT_STEP 100e-6f   // プラントを積分する刻み [s]
+#define PLANT_TAU 0.1f       // [s]
+#define PHASE_TIME 2.0f      // 指令 1 つの長さ [s]
+#define I_BOUND 10.0f        // I 項の絶対値の上限（出力の幅 2 の 5 倍）
+
+typedef struct {
+    float kp;
+    float ki;
+    float dt;
+} Case;
+
+typedef struct {
+    float max_i;        // I 項の絶対値の最大
+    int finite;         // I 項と出力がずっと有限
+    float release;      // 届く指令に変えてから出力が上限を離れるまで [s]
+    float final_error;  // 最後の誤差
+} Result;
+
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+static Result run(const Case *test)
+{
+    PidCore pid;
+    Result result = {0.0f, 1, -1.0f, 0.0f};
+    int steps_per_control = (int)lroundf(test->dt / PLANT_STEP);
+    int controls = (int)lroundf(PHASE_TIME / test->dt);
+    float y = 0.0f;
+    int phase;
+    int k;
+    int s;
+
+    PidCore_Init(&pid);
+    PidCore_setGain(&pid, test->kp, test->ki, 0.0f, 0.0f);
+    PidCore_setOutputLimit(&pid, -1.0f, 1.0f);
+
+    for (phase = 0; phase < 2; phase++) {
+        float target = (phase == 0) ? 3.0f : 0.5f;
+        for (k = 0; k < controls; k++) {
+            float u = PidCore_update(&pid, target, y, test->dt);
+            if (!isfinite(pid.i_term) || !isfinite(u)) {
+                result.finite = 0;
+                return result;
+            }
+            if (fabsf(pid.i_term) > result.max_i) {
+                result.max_i = fabsf(pid.i_term);
+            }
+            if (phase == 1 && result.release < 0.0f && u < 1.0f) {
+                result.release = (float)k * test->dt;
+            }
+            for (s = 0; s < steps_per_control; s++) {
+                y += (u - y) / PLANT_TAU * PLANT_STEP;
+            }
+        }
+        result.final_error = fabsf(target - y);
+    }
+    return result;
+}
+
+int main(void)
+{
+    static const Case cases[] = {
+        {0.5f, 5.0f, 0.001f},
+        {0.5f, 5.0f, 0.01f},
+        {0.5f, 5.0f, 0.05f},
+        {0.05f, 15.0f, 0.01f},    // ki/kp = 300：kt*dt = 3
+        {0.05f, 15.0f, 0.05f},    // kt*dt = 15
+        {0.01f, 10.0f, 0.01f},    // kt*dt = 10
+        {0.01f, 0.1f, 0.01f},
+        {1.0f, 0.5f, 0.01f},
+    };
+    size_t i;
+    char what[128];
+
+    printf("first-order plant (tau %.1f s), output limit +-1, target 3 then 0.5 for %.0f s each\n", PLANT_TAU,
+           PHASE_TIME);
+    printf("  %6s %6s %6s %7s | %8s %8s %8s\n", "kp", "ki", "dt", "kt*dt", "max |I|", "release", "error");
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const Case *test = &cases[i];
+        Result result = run(test);
+        float kt_dt = test->ki / test->kp * test->dt;
+
+        printf("  %6.2f %6.1f %6.3f %7.2f | %8.3f %8.3f %8.4f\n", test->kp, test->ki, test->dt, kt_dt, result.max_i,
+               result.release, result.final_error);
+        snprintf(what, sizeof(what), "kp %.2f ki %.1f dt %.0f ms (kt*dt %.2f): I term finite and within +-%.0f",
+                 test->kp, test->ki, test->dt * 1e3f, kt_dt, I_BOUND);
+        check(result.finite && result.max_i <= I_BOUND, what);
+        snprintf(what, sizeof(what), "kp %.2f ki %.1f dt %.0f ms: leaves saturation within 0.5 s of the target change",
+                 test->kp, test->ki, test->dt * 1e3f);
+        check(result.finite && result.release >= 0.0f && result.release <= 0.5f, what);
+    }
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+// ポート間で同一内容のヘッダ（frame_core.h、pid_core.h、hal_core.h など）が、コピーのどれかだけ直されて
+// ずれていないかを、バイト単位で比べて確かめる
+//   - SHARED の組：並べたポートのコピーがすべて同じ内容か。ずれていれば最初に違う行を表示する
+//   - PORT_SPECIFIC：同じ名前でもポートごとに中身が違うヘッダ（スレッドとピンの型、数学関数の書き方など）
+//   - どちらにも載っていないヘッダが 2 つ以上のポートにあれば失敗にする（新しい共有ヘッダの登録漏れ）
+// Arduino IDE と CubeIDE はライブラリのフォルダの外のソースを取り込めないので、共有ヘッダは 1 か所に
+// まとめず各ポートにコピーで置き、ずれはこのチェックで止める
+//
+// 使い方：port_sync_check [リポジトリのルート]（省略時はカレントディレクトリ。失敗があれば終了コード 1）
+
+#include <stdio.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const PORTS[] = {"mbed", "arduino", "CubeIDE", "linux"};
+
+struct Shared {
+    const char* name;
+    std::vector<const char*> ports;
+};
+
+const Shared SHARED[] = {
+    {"frame_core.h", {"mbed", "arduino", "CubeIDE", "linux"}},
+    {"msg_core.h", {"mbed", "arduino", "CubeIDE", "linux"}},
+    {"msg_schema.h", {"mbed", "arduino", "CubeIDE", "linux"}},
+    {"mdd_frame.h", {"mbed", "arduino", "linux"}},
+    {"pid_core.h", {"mbed", "arduino", "CubeIDE"}},
+    {"pid_autotune.h", {"mbed", "arduino", "CubeIDE"}},
+    {"safety_monitor.h", {"mbed", "arduino", "CubeIDE"}},
+    {"twist_limit.h", {"mbed", "arduino", "CubeIDE"}},
+    {"hal_core.h", {"mbed", "arduino"}},
+    {"MotorOutput.h", {"mbed", "arduino"}},
+    {"MotionProfile.h", {"mbed", "arduino"}},
+    {"GainSchedule.h", {"mbed", "arduino"}},
+    {"PathFollower.h", {"mbed", "arduino"}},
+    {"rate_executive.h", {"mbed", "CubeIDE"}},
+    {"servo_motion.h", {"mbed", "CubeIDE"}},
+    {"snapshot.h", {"mbed", "CubeIDE"}},
+    {"timebase_core.h", {"arduino", "CubeIDE"}},
+};
+
+const char* const PORT_SPECIFIC[] = {
+    "Altairlibrary.h", "InverseKinematics.h", "Kinematics.h", "MotorDriver.h", "PIDController.h",
+    "StaticRobotControl.h", "TwoWheelKinematics.h", "Timebase.h", "can_mdd.h", "encoder.h",
+    "hal_policy.h", "mdd.h",
+};
+
+int failures = 0;
+
+void check(bool ok, const char* what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+bool readFile(const fs::path& path, std::string& text)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+// 最初に違う行（1 始まり）
+int firstDifferentLine(const std::string& a, const std::string& b)
+{
+    int line = 1;
+    size_t i = 0;
+    while (i < a.size() && i < b.size() && a[i] == b[i]) {
+        if (a[i] == '\n') {
+            line++;
+        }
+        i++;
+    }
+    return line;
+}
+
+fs::path portDir(const fs::path& root, const char* port)
+{
+    return root / (std::string("Altair_library_for_") + port);
+}
+
+void checkShared(const fs::path& root, const Shared& shared)
+{
+    char what[256];
+    std::string first;
+    const char* first_port = shared.ports[0];
+    if (!readFile(portDir(root, first_port) / shared.name, first)) {
+        snprintf(what, sizeof(what), "%s: missing in %s", shared.name, first_port);
+        check(false, what);
+        return;
+    }
+    std::string drift;
+    for (size_t i = 1; i < shared.ports.size(); i++) {
+        std::string text;
+        char note[128];
+        if (!readFile(portDir(root, shared.ports[i]) / shared.name, text)) {
+            snprintf(note, sizeof(note), " (missing in %s)", shared.ports[i]);
+            drift += note;
+        } else if (text != first) {
+            snprintf(note, sizeof(note), " (%s differs from %s at line %d)", shared.ports[i], first_port,
+                     firstDifferentLine(first, text));
+            drift += note;
+        }
+    }
+    std::string ports;
+    for (const char* port : shared.ports) {
+        ports += ports.empty() ? port : std::string(" / ") + port;
+    }
+    snprintf(what, sizeof(what), "%s: identical in %s%s", shared.name, ports.c_str(), drift.c_str());
+    check(drift.empty(), what);
+}
+
+// 2 つ以上のポートにある同じ名前のヘッダが、SHARED か PORT_SPECIFIC のどちらかに載っているか
+void checkClassified(const fs::path& root)
+{
+    std::set<std::string> known(std::begin(PORT_SPECIFIC), std::end(PORT_SPECIFIC));
+    for (const Shared& shared : SHARED) {
+        known.insert(shared.name);
+    }
+    std::map<std::string, std::vector<std::string>> seen;
+    for (const char* port : PORTS) {
+        std::error_code error;
+        for (const fs::directory_entry& entry : fs::directory_iterator(portDir(root, port), error)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".h") {
+                seen[entry.path().filename().string()].push_back(port);
+            }
+        }
+    }
+    int unclassified = 0;
+    for (const auto& item : seen) {
+        if (item.second.size() >= 2 && known.count(item.first) == 0) {
+            printf("  unclassified: %s (%zu ports)\n", item.first.c_str(), item.second.size());
+            unclassified++;
+        }
+    }
+    char what[160];
+    snprintf(what, sizeof(what), "%zu header names, every name in 2 or more ports is listed as shared or port-specific",
+             seen.size());
+    check(unclassified == 0, what);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    fs::path root = (argc > 1) ? argv[1] : ".";
+    if (!fs::is_directory(portDir(root, "mbed"))) {
+        fprintf(stderr, "%s is not the repository root\n", root.string().c_str());
+        return 1;
+    }
+
+    printf("shared\n");
+    for (const Shared& shared : SHARED) {
+        checkShared(root, shared);
+    }
+    printf("classified\n");
+    checkClassified(root);
+
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+// 安全監視（safety_monitor.h）に異常を注入し、sil/MotorModel.h のモータで閉ループにして確かめる
+//   - 制御：SafetyMonitor_checkMotor → SafetyMonitor_update → PidCore（出力制限は ±倍率）→ モータ
+//   - 周期：5〜15ms の一様乱数で揺らし、安全監視と PID には実測の dt を渡す
+//   - 指令：8 rps を 1 秒回してから異常を注入し、ブレーキまでの時間をモータの時刻で計る
+//       timeout   ：指令（SafetyMonitor_feed）を止める（期限が切れた時刻から計る）
+//       stop      ：SafetyMonitor_trip(STOP_REQUEST)
+//       stall     ：エンコーダのカウントを止める（断線）
+//       runaway   ：エンコーダの極性を反転する
+//       emergency ：SafetyMonitor_trip(EMERGENCY)
+//   - 採点：乱数の種を変えて繰り返した最大値が、最も長い周期で見積もった SafetyMonitor_latencyBound に収まるか
+//     （比べるため、決まった 10ms で見積もった値も表示する）
+// 最後に、別スレッドからの trip と制御ループの update / reset を競わせ、要求が消えないことを確かめる
+// 同じく別スレッドからの feed と update を競わせ、feed の回数が消えないことを確かめる
+//
+// 使い方：safety_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include "safety_monitor.h"
+#include "pid_core.h"
+#include "MotorModel.h"
+
+namespace {
+
+const float PLANT_STEP = 100e-6f;     // モータを積分する刻み [s]
+const float PERIOD_MIN = 0.005f;      // 制御周期の範囲 [s]
+const float PERIOD_MAX = 0.015f;
+const float NOMINAL_PERIOD = 0.01f;
+const float TARGET = 8.0f;            // [rps]
+const float INJECT_TIME = 1.0f;       // 異常を注入する時刻 [s]
+const float END_TIME = 3.0f;
+const int SEEDS = 50;
+
+enum Fault {
+    FAULT_TIMEOUT,
+    FAULT_STOP,
+    FAULT_STALL,
+    FAULT_RUNAWAY,
+    FAULT_EMERGENCY
+};
+
+struct Case {
+    const char* name;
+    Fault fault;
+    uint8_t expected;     // faults に立つはずのビット
+    SafetyConfig config;  // その異常の監視だけを有効にする
+};
+
+struct Result {
+    bool braked;
+    uint8_t faults;
+    float latency;          // 注入（指令の途絶は期限切れ）からブレーキまで [s]（モータの時刻）
+    float monitor_latency;  // 安全監視が記録した反応時間 [s]
+};
+
+Result run(const Case& test, unsigned int seed)
+{
+    MotorModel motor;
+    PidCore pid;
+    PidCore_Init(&pid);
+    PidCore_setGain(&pid, 0.05f, 1.0f, 0.0f, 0.0f);
+    SafetyMonitor safety;
+    SafetyMonitor_Init(&safety, &test.config);
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> period(PERIOD_MIN, PERIOD_MAX);
+
+    const float counts_per_rev = motor.getConfig().counts_per_rev;
+    double last_count = 0.0;
+    double frozen_count = 0.0;
+    bool injected = false;
+    float duty = 0.0f;
+    float time = 0.0f;
+    float start = 0.0f;
+
+    while (time < END_TIME) {
+        // 制御周期の分だけ、前回の Duty のままモータを進める
+        float dt = period(random);
+        int steps = static_cast<int>(lroundf(dt / PLANT_STEP));
+        for (int s = 0; s < steps; s++) {
+            if (safety.state == SAFETY_BRAKE) {
+                motor.step(1.0f, 1.0f, 0.0f, PLANT_STEP);
+            } else {
+                motor.step(duty > 0.0f ? duty : 0.0f, duty < 0.0f ? -duty : 0.0f, 0.0f, PLANT_STEP);
+            }
+        }
+        time += static_cast<float>(steps) * PLANT_STEP;
+
+        // エンコーダ（量子化したカウント）から実測の周期で回転数を出す
+        double count = floor(motor.getAngle() / (2.0 * M_PI) * counts_per_rev);
+        if (injected && test.fault == FAULT_STALL) {
+            count = frozen_count;
+        } else if (injected && test.fault == FAULT_RUNAWAY) {
+            count = 2.0 * frozen_count - count;
+        }
+        float rps = static_cast<float>(count - last_count) / counts_per_rev / dt;
+        last_count = count;
+
+        if (!injected || test.fault != FAULT_TIMEOUT) {
+            SafetyMonitor_feed(&safety);
+        }
+        SafetyMonitor_checkMotor(&safety, 0, duty, TARGET, rps, dt);
+        float scale = SafetyMonitor_update(&safety, dt);
+        if (safety.state == SAFETY_BRAKE) {
+            Result result = {true, safety.faults, time - start, safety.latency};
+            return result;
+        }
+        PidCore_setOutputLimit(&pid, -scale, scale);
+        duty = PidCore_update(&pid, TARGET, rps, dt);
+
+        // 周期の切れ目で注入する（次の周期の測定から異常が見える）
+        if (!injected && time >= INJECT_TIME) {
+            injected = true;
+            frozen_count = count;
+            start = time;
+            if (test.fault == FAULT_TIMEOUT) {
+                start += test.config.command_timeout;
+            } else if (test.fault == FAULT_STOP) {
+                SafetyMonitor_trip(&safety, SAFETY_FAULT_STOP_REQUEST);
+            } else if (test.fault == FAULT_EMERGENCY) {
+                SafetyMonitor_trip(&safety, SAFETY_FAULT_EMERGENCY);
+            }
+        }
+    }
+    Result result = {false, safety.faults, 0.0f, 0.0f};
+    return result;
+}
+
+// 2 本のスレッドがそれぞれ自分のビットで trip し、制御ループが取り込んで reset するまで待つのを繰り返す
+// 取り込まれないまま消えた要求があれば、その trip は待ち切れずに数える
+int lostRequests(int rounds)
+{
+    SafetyConfig config = {};
+    SafetyMonitor safety;
+    SafetyMonitor_Init(&safety, &config);
+    const uint8_t bits[2] = {SAFETY_FAULT_STOP_REQUEST, SAFETY_FAULT_EMERGENCY};
+    std::atomic<int> seen[2];
+    std::atomic<int> lost(0);
+    std::atomic<int> finished(0);
+    seen[0] = 0;
+    seen[1] = 0;
+
+    auto writer = [&](int index) {
+        for (int i = 0; i < rounds && lost.load() < 10; i++) {  // 10 回消えれば十分なので打ち切る
+            SafetyMonitor_trip(&safety, bits[index]);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+            while (seen[index].load() <= i) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    lost++;
+                    seen[index] = i + 1;  // 数えたので次へ進む
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+        finished++;
+    };
+    std::thread first(writer, 0);
+    std::thread second(writer, 1);
+    while (finished.load() < 2) {
+        SafetyMonitor_update(&safety, NOMINAL_PERIOD);
+        for (int i = 0; i < 2; i++) {
+            if (safety.faults & bits[i]) {
+                seen[i]++;
+            }
+        }
+        std::this_thread::yield();  // 止まったのを知らせてから reset するまでの間に、次の trip が入る場合を作る
+        SafetyMonitor_reset(&safety);
+    }
+    first.join();
+    second.join();
+    return lost.load();
+}
+
+// 2 本のスレッドが feed を rounds 回ずつ呼ぶ間、制御ループは update を回し続ける
+// 終わったときの feed の回数が 2 × rounds に足りなければ、その分が消えた
+int lostFeeds(int rounds)
+{
+    SafetyConfig config = {};
+    SafetyMonitor safety;
+    SafetyMonitor_Init(&safety, &config);
+    std::atomic<int> finished(0);
+
+    auto feeder = [&]() {
+        for (int i = 0; i < rounds; i++) {
+            SafetyMonitor_feed(&safety);
+        }
+        finished++;
+    };
+    std::thread first(feeder);
+    std::thread second(feeder);
+    while (finished.load() < 2) {
+        SafetyMonitor_update(&safety, NOMINAL_PERIOD);
+    }
+    first.join();
+    second.join();
+    return 2 * rounds - static_cast<int>(safety.feeds);
+}
+
+}  // namespace
+
+int main()
+{
+    const Case cases[] = {
+        {"timeout",   FAULT_TIMEOUT,   SAFETY_FAULT_COMMAND_TIMEOUT, {0.1f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.2f}},
+        {"stop",      FAULT_STOP,      SAFETY_FAULT_STOP_REQUEST,    {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.2f}},
+        {"stall",     FAULT_STALL,     SAFETY_FAULT_STALL,           {0.0f, 0.3f, 0.5f, 0.1f, 0.0f, 0.0f, 0.0f}},
+        {"runaway",   FAULT_RUNAWAY,   SAFETY_FAULT_RUNAWAY,         {0.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.05f, 0.0f}},
+        {"emergency", FAULT_EMERGENCY, SAFETY_FAULT_EMERGENCY,       {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}},
+    };
+    int failures = 0;
+    auto check = [&failures](bool ok, const char* what) {
+        if (!ok) {
+            failures++;
+        }
+        printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+    };
+
+    printf("period %.0f-%.0f ms (measured dt), %d seeds, latency in ms\n", PERIOD_MIN * 1e3f, PERIOD_MAX * 1e3f, SEEDS);
+    printf("  %-10s %12s %12s %10s %10s\n", "fault", "bound 10ms", "bound 15ms", "monitor", "measured");
+    for (const Case& test : cases) {
+        SafetyMonitor bound_monitor;
+        SafetyMonitor_Init(&bound_monitor, &test.config);
+        float bound = SafetyMonitor_latencyBound(&bound_monitor, PERIOD_MAX);
+        float nominal_bound = SafetyMonitor_latencyBound(&bound_monitor, NOMINAL_PERIOD);
+        bool braked = true;
+        bool right_fault = true;
+        float worst = 0.0f;
+        float worst_monitor = 0.0f;
+        for (int seed = 1; seed <= SEEDS; seed++) {
+            Result result = run(test, static_cast<unsigned int>(seed));
+            braked = braked && result.braked;
+            right_fault = right_fault && result.faults == test.expected;
+            worst = fmaxf(worst, result.latency);
+            worst_monitor = fmaxf(worst_monitor, result.monitor_latency);
+        }
+        printf("  %-10s %12.1f %12.1f %10.1f %10.1f\n", test.name, nominal_bound * 1e3f, bound * 1e3f,
+               worst_monitor * 1e3f, worst * 1e3f);
+        char what[96];
+        snprintf(what, sizeof(what), "%s: braked with only its own fault", test.name);
+        check(braked && right_fault, what);
+        snprintf(what, sizeof(what), "%s: within the bound at the longest period", test.name);
+        check(worst <= bound + PLANT_STEP && worst_monitor <= bound + PLANT_STEP, what);
+    }
+
+    const int rounds = 20000;
+    int lost = lostRequests(rounds);
+    printf("trip from 2 threads while update / reset, %d each: %d lost\n", rounds, lost);
+    check(lost == 0, "no request lost");
+    const int feeds = 1000000;
+    lost = lostFeeds(feeds);
+    printf("feed from 2 threads while update, %d each: %d lost\n", feeds, lost);
+    check(lost == 0, "no feed lost");
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
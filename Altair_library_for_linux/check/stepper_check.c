@@ -0,0 +1,331 @@
+// CubeIDE 版 stepper.c を、モックのタイマ（mock/stm32f4xx_hal.h）の上で時刻を進めて確かめる
+//   - 時刻は 168 MHz の基準カウントで数える。カウンタが動いている軸は、今の周期の ARR と PSC（更新イベントで写した値）から
+//     次の更新イベントの時刻を出し、最も早いものから順に起こす
+//   - 周期が終わるとき、CCR（写した値）が ARR 以下ならその周期にパルスが出ている（PWM mode 2：CNT >= CCR の間 High）。
+//     立ち上がりは周期の始まり + CCR カウント、幅は ARR + 1 - CCR カウント
+//   - 更新割り込みは、更新イベントから遅れ（latency）の後に走る。走る前に次の更新イベントが来れば、UIF は 1 つにまとまる
+//     （実機と同じく、割り込みが 1 回消える）。割り込みの中で止まった軸は、途中で切られたパルスも数える
+//   - single : Stepper_move のステップ数・位置・DIR・パルス幅・最短のステップ間隔・移動時間（台形の速度の理論値との差）
+//   - fast   : 100k step/s を超える速さで同じことを確かめ、割り込みの遅れが最短の周期より長いとステップ数が狂うのを見る
+//   - group  : StepperGroup_move の全軸のステップ数と、最後のパルスの時刻の差（最も遅い軸の最後の 1 ステップの周期まで許す）
+//   - reject : 最高速度 0 以下（NaN も）を弾くか
+//
+// 使い方：stepper_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdio.h>
+
+#include "stepper.h"
+#include "motor_driver.h"
+
+#define BASE_HZ 168000000U     // 時刻の基準 [Hz]（APB2 のタイマクロック）
+#define MAX_AXES 3U
+
+typedef struct {
+    Stepper stepper;
+    TIM_HandleTypeDef htim;
+    GPIO_TypeDef *dir_port;    // 軸ごとに別のポート（BSRR は書いた順に 1 つずつしか残らないため）
+    uint64_t period_start;     // 今の周期が始まった時刻 [基準カウント]
+    uint64_t period_end;       // 次の更新イベントの時刻
+    uint64_t isr_time;         // 更新割り込みが走る時刻（isr_pending のとき）
+    int isr_pending;
+    uint32_t merged;           // 走る前に次の更新イベントが来て、まとまった割り込みの数
+    uint32_t edges;            // 出たパルスの数
+    uint32_t dir_wrong;        // DIR が違う向きのときに出たパルスの数
+    uint32_t runts;            // 止めたときに途中で切られたパルスの数
+    uint64_t min_width;        // 最も短いパルス幅 [基準カウント]
+    uint64_t min_interval;     // 最も短い立ち上がりの間隔 [基準カウント]
+    uint64_t last_edge;        // 最後の立ち上がりの時刻
+    uint64_t end;              // 最後のパルスが終わった時刻
+} Axis;
+
+static Axis axes[MAX_AXES];
+static StepperGroup group;
+static int failures;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        failures++;
+    }
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+}
+
+// タイマの 1 カウントが何基準カウントか
+static uint64_t Axis_scale(Axis *axis)
+{
+    return (uint64_t)(MockTim_prescaler(axis->htim.Instance) + 1U) * (BASE_HZ / MotorDriver_GetTimerClock(&axis->htim));
+}
+
+static void Axis_schedule(Axis *axis)
+{
+    axis->period_end = axis->period_start + (uint64_t)(MockTim_autoReload(axis->htim.Instance) + 1U) * Axis_scale(axis);
+}
+
+// 周期の始まりから elapsed カウントまでに出たパルスを記録する（ccr / arr はその周期に写っていた値）
+static void Axis_record(Axis *axis, uint32_t ccr, uint32_t arr, uint32_t elapsed, uint64_t scale)
+{
+    uint64_t edge;
+
+    if (ccr > arr || ccr >= elapsed) {
+        return;
+    }
+    edge = axis->period_start + (uint64_t)ccr * scale;
+    if (axis->edges > 0U && edge - axis->last_edge < axis->min_interval) {
+        axis->min_interval = edge - axis->last_edge;
+    }
+    if ((uint64_t)(elapsed - ccr) * scale < axis->min_width) {
+        axis->min_width = (uint64_t)(elapsed - ccr) * scale;
+    }
+    if ((axis->dir_port->ODR & GPIO_PIN_0) != ((axis->stepper.direction > 0) ? GPIO_PIN_0 : 0U)) {
+        axis->dir_wrong++;
+    }
+    axis->edges++;
+    axis->last_edge = edge;
+    axis->end = axis->period_start + (uint64_t)elapsed * scale;
+}
+
+static void setUp(uint32_t count, TIM_TypeDef *const *timers)
+{
+    static GPIO_TypeDef *const ports[MAX_AXES] = {GPIOA, GPIOB, GPIOC};
+    Stepper *list[MAX_AXES];
+    uint32_t i;
+
+    Mock_reset();
+    for (i = 0; i < count; i++) {
+        Axis *axis = &axes[i];
+        axis->htim.Instance = timers[i];
+        axis->dir_port = ports[i];
+        Stepper_Init(&axis->stepper, &axis->htim, TIM_CHANNEL_1, axis->dir_port, GPIO_PIN_0);
+        list[i] = &axis->stepper;
+    }
+    StepperGroup_Init(&group, list, (uint8_t)count);
+}
+
+// 動き始めた軸の記録を 0 にする（move の後に呼ぶ）
+static void start(uint32_t count)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        Axis *axis = &axes[i];
+        MockGpio_apply(axis->dir_port);   // DIR
+        axis->period_start = 0;
+        axis->isr_pending = 0;
+        axis->merged = 0;
+        axis->edges = 0;
+        axis->dir_wrong = 0;
+        axis->runts = 0;
+        axis->min_width = UINT64_MAX;
+        axis->min_interval = UINT64_MAX;
+        axis->last_edge = 0;
+        axis->end = 0;
+        Axis_schedule(axis);
+    }
+}
+
+// 全軸が止まるまで時刻を進める。割り込みは更新イベントから latency 基準カウント遅れて走る
+static void run(uint32_t count, uint64_t latency, int use_group)
+{
+    for (;;) {
+        Axis *next = NULL;
+        uint64_t time = UINT64_MAX;
+        int is_isr = 0;
+        uint32_t i;
+
+        for (i = 0; i < count; i++) {
+            Axis *axis = &axes[i];
+            if ((axis->htim.Instance->CR1 & TIM_CR1_CEN) != 0U && axis->period_end < time) {
+                next = axis;
+                time = axis->period_end;
+                is_isr = 0;
+            }
+            if (axis->isr_pending && axis->isr_time < time) {
+                next = axis;
+                time = axis->isr_time;
+                is_isr = 1;
+            }
+        }
+        if (next == NULL) {
+            return;
+        }
+
+        if (!is_isr) {
+            // 周期が終わった。パルスを記録してから、プリロードを写す
+            uint32_t arr = MockTim_autoReload(next->htim.Instance);
+            Axis_record(next, MockTim_output(next->htim.Instance, next->stepper.channel), arr, arr + 1U,
+                        Axis_scale(next));
+            MockTim_update(next->htim.Instance);
+            next->period_start = time;
+            Axis_schedule(next);
+            if ((next->htim.Instance->DIER & TIM_IT_UPDATE) != 0U) {
+                if (next->isr_pending) {
+                    next->merged++;
+                } else {
+                    next->isr_pending = 1;
+                    next->isr_time = time + latency;
+                }
+            }
+        } else {
+            // HAL_TIM_IRQHandler と同じく、UIF と UIE が立っていればフラグを落としてからコールバックを呼ぶ
+            // 止めると写した値が変わるので、今の周期の CCR / ARR を先に読んでおく
+            uint64_t scale = Axis_scale(next);
+            uint32_t ccr = MockTim_output(next->htim.Instance, next->stepper.channel);
+            uint32_t arr = MockTim_autoReload(next->htim.Instance);
+            int was_running = (next->htim.Instance->CR1 & TIM_CR1_CEN) != 0U;
+
+            next->isr_pending = 0;
+            if ((next->htim.Instance->SR & TIM_FLAG_UPDATE) == 0U || (next->htim.Instance->DIER & TIM_IT_UPDATE) == 0U) {
+                continue;
+            }
+            next->htim.Instance->SR = ~TIM_FLAG_UPDATE;
+            if (use_group) {
+                StepperGroup_Interrupt(&group, &next->htim);
+            } else {
+                Stepper_Interrupt(&next->stepper);
+            }
+            if (was_running && (next->htim.Instance->CR1 & TIM_CR1_CEN) == 0U) {
+                // 周期の途中で止まった。そこまでに立ち上がっていたパルスは切られている
+                uint32_t edges = next->edges;
+                Axis_record(next, ccr, arr, (uint32_t)((time - next->period_start) / scale), scale);
+                next->runts += next->edges - edges;
+            }
+        }
+    }
+}
+
+// 台形（三角形）の速度で steps ステップ動くのにかかる時間 [s]
+static double idealDuration(double steps, double v0, double vmax, double accel)
+{
+    double ramp = (vmax * vmax - v0 * v0) / (2.0 * accel);   // 加速に使うステップ数
+    if (2.0 * ramp > steps) {
+        double peak = sqrt(v0 * v0 + accel * steps);
+        return 2.0 * (peak - v0) / accel;
+    }
+    return 2.0 * (vmax - v0) / accel + (steps - 2.0 * ramp) / vmax;
+}
+
+// 1 軸の移動を確かめる。latency は割り込みの遅れ [ns]
+static void checkSingle(TIM_TypeDef *timer, int32_t steps, float start_velocity, float max_velocity, float acceleration,
+                        uint32_t latency_ns)
+{
+    Axis *axis = &axes[0];
+    uint32_t count = (uint32_t)((steps < 0) ? -steps : steps);
+    double ideal;
+    double duration;
+    double peak;
+    double width;
+    char what[128];
+
+    setUp(1U, &timer);
+    Stepper_move(&axis->stepper, steps, start_velocity, max_velocity, acceleration);
+    start(1U);
+    run(1U, (uint64_t)latency_ns * (BASE_HZ / 1000000U) / 1000U, 0);
+
+    ideal = idealDuration((double)count, (double)start_velocity, (double)max_velocity, (double)acceleration);
+    duration = (double)axis->end / BASE_HZ;
+    peak = (axis->edges > 1U) ? (double)BASE_HZ / (double)axis->min_interval : 0.0;
+    width = (double)axis->min_width * 1e9 / BASE_HZ;
+    printf("  %ld steps, %.0f -> %.0f step/s, %.0f step/s^2, latency %.1f us: %lu edges, position %ld, "
+           "%.4f s (ideal %.4f s), peak %.0f step/s, width %.0f ns\n",
+           (long)steps, (double)start_velocity, (double)max_velocity, (double)acceleration, latency_ns * 1e-3,
+           (unsigned long)axis->edges, (long)Stepper_getPosition(&axis->stepper), duration, ideal, peak, width);
+    snprintf(what, sizeof(what), "%ld steps: every step out, position matches, DIR set before the first", (long)steps);
+    check(axis->edges == count && Stepper_getPosition(&axis->stepper) == steps && axis->dir_wrong == 0U &&
+              axis->runts == 0U && axis->merged == 0U && !Stepper_isBusy(&axis->stepper),
+          what);
+    snprintf(what, sizeof(what), "%ld steps: no interval shorter than max velocity, width >= %u ns, duration within 2%%",
+             (long)steps, STEPPER_PULSE_NS);
+    check(peak <= (double)max_velocity * 1.001 && width >= STEPPER_PULSE_NS && fabs(duration - ideal) <= ideal * 0.02,
+          what);
+}
+
+// 割り込みの遅れが最短の周期より長いときに、ステップ数と位置が狂うのを見る
+static void checkLate(TIM_TypeDef *timer, int32_t steps, float max_velocity, float acceleration, uint32_t latency_ns)
+{
+    Axis *axis = &axes[0];
+    char what[128];
+
+    setUp(1U, &timer);
+    Stepper_move(&axis->stepper, steps, 0.0f, max_velocity, acceleration);
+    start(1U);
+    run(1U, (uint64_t)latency_ns * (BASE_HZ / 1000000U) / 1000U, 0);
+    printf("  %ld steps at %.0f step/s (period %.1f us), latency %.1f us: %lu edges, position %ld, "
+           "%lu interrupts merged\n",
+           (long)steps, (double)max_velocity, 1e6 / (double)max_velocity, latency_ns * 1e-3,
+           (unsigned long)axis->edges, (long)Stepper_getPosition(&axis->stepper), (unsigned long)axis->merged);
+    snprintf(what, sizeof(what), "latency %.1f us over one period: lost interrupts show up as wrong edges",
+             latency_ns * 1e-3);
+    check(axis->merged > 0U && (axis->edges != (uint32_t)steps || Stepper_getPosition(&axis->stepper) != steps), what);
+}
+
+static void checkGroup(TIM_TypeDef *const *timers, const int32_t *steps, float max_velocity, float acceleration)
+{
+    uint64_t first = UINT64_MAX;
+    uint64_t last = 0;
+    double slowest = 0.0;   // 最後のステップの周期で最も長いもの [s]
+    int all = 1;
+    uint32_t i;
+    char what[128];
+
+    setUp(MAX_AXES, timers);
+    StepperGroup_move(&group, steps, 0.0f, max_velocity, acceleration);
+    start(MAX_AXES);
+    run(MAX_AXES, 1000U * (BASE_HZ / 1000000U) / 1000U, 1);
+
+    printf("  group %.0f step/s, %.0f step/s^2, latency 1.0 us\n", (double)max_velocity, (double)acceleration);
+    for (i = 0; i < MAX_AXES; i++) {
+        Axis *axis = &axes[i];
+        uint32_t count = (uint32_t)((steps[i] < 0) ? -steps[i] : steps[i]);
+        printf("    axis %lu: %ld steps, %lu edges, position %ld, last edge %.6f s, peak %.0f step/s\n",
+               (unsigned long)i, (long)steps[i], (unsigned long)axis->edges, (long)Stepper_getPosition(&axis->stepper),
+               (double)axis->last_edge / BASE_HZ, (double)BASE_HZ / (double)axis->min_interval);
+        all = all && axis->edges == count && Stepper_getPosition(&axis->stepper) == steps[i] && axis->dir_wrong == 0U &&
+              axis->runts == 0U && axis->merged == 0U;
+        slowest = fmax(slowest, (double)axis->stepper.start_period / (double)axis->stepper.tick_hz);
+        first = (axis->last_edge < first) ? axis->last_edge : first;
+        last = (axis->last_edge > last) ? axis->last_edge : last;
+    }
+    check(all && !StepperGroup_isBusy(&group), "every axis: every step out, position matches");
+    snprintf(what, sizeof(what), "last edges %.1f us apart, within the slowest final step (%.1f us)",
+             (double)(last - first) * 1e6 / BASE_HZ, slowest * 1e6);
+    check((double)(last - first) / BASE_HZ <= slowest, what);
+}
+
+static void checkReject(void)
+{
+    static const float velocities[] = {0.0f, -100.0f, NAN};
+    TIM_TypeDef *timer = TIM3;
+    size_t i;
+    char what[96];
+
+    for (i = 0; i < sizeof(velocities) / sizeof(velocities[0]); i++) {
+        int ok;
+
+        setUp(1U, &timer);
+        ok = Stepper_move(&axes[0].stepper, 100, 0.0f, velocities[i], 1000.0f) == HAL_ERROR;
+        ok = ok && !Stepper_isBusy(&axes[0].stepper) && (TIM3->CR1 & TIM_CR1_CEN) == 0U;
+        snprintf(what, sizeof(what), "max velocity %g: HAL_ERROR, timer stopped", (double)velocities[i]);
+        check(ok, what);
+    }
+}
+
+int main(void)
+{
+    static TIM_TypeDef *const group_timers[MAX_AXES] = {TIM1, TIM3, TIM8};
+    static const int32_t group_steps[MAX_AXES] = {20000, -7000, 1200};
+
+    printf("single (TIM3, timer clock 84 MHz)\n");
+    checkSingle(TIM3, 3200, 0.0f, 20000.0f, 50000.0f, 1000U);
+    checkSingle(TIM3, -500, 1000.0f, 8000.0f, 40000.0f, 1000U);
+    printf("fast (TIM1, timer clock 168 MHz)\n");
+    checkSingle(TIM1, 20000, 0.0f, 150000.0f, 5000000.0f, 1000U);
+    checkSingle(TIM1, 20000, 0.0f, 150000.0f, 5000000.0f, 6000U);
+    checkLate(TIM1, 20000, 150000.0f, 5000000.0f, 8000U);
+    printf("group (TIM1, TIM3, TIM8)\n");
+    checkGroup(group_timers, group_steps, 120000.0f, 4000000.0f);
+    printf("reject\n");
+    checkReject();
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
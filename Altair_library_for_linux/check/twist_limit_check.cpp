@@ -0,0 +1,209 @@
+// 車輪の飽和での機体速度の縮め方（twist_limit.h と mbed 版 Kinematics の calc）を、乱数の指令で確かめる
+//   - 運動学：Mecanum・Omni3・Omni4・TwoWheelKinematics（RPS_MODE）
+//   - 指令：vx, vy は ±1500 mm/s、ω は ±360 deg/s（差動二輪は vy = 0）。車輪ごとの上限は 1〜10 rps の乱数
+//   - 方針：TWIST_LIMIT_UNIFORM / ROTATION_FIRST / TRANSLATION_FIRST のそれぞれで、次を全部の指令で確かめる
+//       limit    ：全車輪が上限以内
+//       parallel ：並進（vx, vy）は指令と同じ向きで、倍率は 0〜1。ω は同じ符号で大きさは指令以下。
+//                  UNIFORM は並進と ω を同じ倍率で縮める（機体速度のベクトルごと平行）
+//       wheels   ：車輪の目標値が、返した機体速度を上限なしの calc に渡した値と同じ
+//       tight    ：後から決める側（UNIFORM は両方、ROTATION_FIRST は並進、TRANSLATION_FIRST は回転）を縮めたときは、
+//                  どれかの車輪がちょうど上限にいる（縮め過ぎない）。先に決める側は単独で収まる分まで縮める
+//       priority ：ROTATION_FIRST は回転だけで上限に収まるなら ω を縮めない（TRANSLATION_FIRST は並進を）
+//
+// 使い方：twist_limit_check（失敗があれば終了コード 1）
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+
+#include "Kinematics.h"
+#include "TwoWheelKinematics.h"
+
+namespace {
+
+const int TWISTS = 20000;
+const double WHEEL_RADIUS = 50.0;     // [mm]
+const double TURNING_RADIUS = 200.0;  // [mm]（差動二輪は車輪の間隔 400mm）
+const double TOLERANCE = 1e-4;        // 上限・向きの相対誤差（車輪の計算は float）
+
+struct Twist {
+    double vx;
+    double vy;
+    double omega;
+};
+
+// 失敗した数と、いちばん外れた量
+struct Tally {
+    int limit = 0;
+    int parallel = 0;
+    int wheels = 0;
+    int tight = 0;
+    int priority = 0;
+    int saturated = 0;
+    double worst_over = 0.0;    // 上限を超えた割合
+    double worst_angle = 0.0;   // 並進の向きのずれ [rad]
+};
+
+// 運動学を同じ形で作る（limited は上限あり、free は上限なし）
+template <class K>
+struct Pair {
+    K limited;
+    K free;
+    int wheels;
+    bool holonomic;
+};
+
+Pair<Mecanum> makeMecanum()
+{
+    return {Mecanum(WHEEL_RADIUS, TURNING_RADIUS, RPS_MODE), Mecanum(WHEEL_RADIUS, TURNING_RADIUS, RPS_MODE), 4, true};
+}
+
+Pair<Omni3> makeOmni3()
+{
+    return {Omni3(WHEEL_RADIUS, TURNING_RADIUS, RPS_MODE), Omni3(WHEEL_RADIUS, TURNING_RADIUS, RPS_MODE), 3, true};
+}
+
+Pair<Omni4> makeOmni4()
+{
+    return {Omni4(WHEEL_RADIUS, TURNING_RADIUS, RPS_MODE), Omni4(WHEEL_RADIUS, TURNING_RADIUS, RPS_MODE), 4, true};
+}
+
+Pair<TwoWheelKinematics> makeTwoWheel()
+{
+    const float diameter = static_cast<float>(WHEEL_RADIUS * 2.0);
+    const float distance = static_cast<float>(TURNING_RADIUS * 2.0);
+    return {TwoWheelKinematics(diameter, distance), TwoWheelKinematics(diameter, distance), 2, false};
+}
+
+// 指令のうち、並進か回転の片方だけで全車輪が上限に収まるか
+bool fits(Kinematics& free, const Twist& twist, const double* limits, int wheels)
+{
+    MotorControlData data = {};
+    free.calc(twist.vx, twist.vy, twist.omega, data);
+    for (int i = 0; i < wheels; i++) {
+        if (fabs(data.motor_data[i].target_value) > limits[i] * (1.0 + TOLERANCE)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class K>
+Tally sweep(Pair<K> pair, TwistLimitPolicy policy, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> velocity(-1500.0, 1500.0);
+    std::uniform_real_distribution<double> rotation(-360.0, 360.0);
+    std::uniform_real_distribution<double> limit(1.0, 10.0);
+    Tally tally;
+
+    pair.limited.setLimitPolicy(policy);
+    for (int n = 0; n < TWISTS; n++) {
+        Twist command = {velocity(random), pair.holonomic ? velocity(random) : 0.0, rotation(random)};
+        double limits[4];
+        for (int i = 0; i < pair.wheels; i++) {
+            limits[i] = limit(random);
+        }
+        pair.limited.setWheelLimits(limits, pair.wheels);
+
+        MotorControlData data = {};
+        AppliedTwist applied = pair.limited.calc(command.vx, command.vy, command.omega, data);
+        tally.saturated += applied.saturated ? 1 : 0;
+
+        // limit
+        bool over = false;
+        bool at_limit = false;
+        for (int i = 0; i < pair.wheels; i++) {
+            double ratio = fabs(data.motor_data[i].target_value) / limits[i];
+            tally.worst_over = fmax(tally.worst_over, ratio - 1.0);
+            over = over || ratio > 1.0 + TOLERANCE;
+            at_limit = at_limit || ratio > 1.0 - TOLERANCE;
+        }
+        tally.limit += over ? 1 : 0;
+
+        // parallel：並進の向きと倍率、ω の符号と大きさ
+        double speed = hypot(command.vx, command.vy);
+        double applied_speed = hypot(applied.vx_mm_s, applied.vy_mm_s);
+        double st = (speed > 0.0) ? applied_speed / speed : 1.0;
+        double sr = (command.omega != 0.0) ? applied.omega_deg_s / command.omega : 1.0;
+        double angle = 0.0;
+        if (speed > 0.0 && applied_speed > 0.0) {
+            double cross = command.vx * applied.vy_mm_s - command.vy * applied.vx_mm_s;
+            double dot = command.vx * applied.vx_mm_s + command.vy * applied.vy_mm_s;
+            angle = fabs(atan2(cross, dot));
+        }
+        tally.worst_angle = fmax(tally.worst_angle, angle);
+        bool parallel = angle <= TOLERANCE && st <= 1.0 + TOLERANCE && sr >= 0.0 && sr <= 1.0 + TOLERANCE;
+        if (policy == TWIST_LIMIT_UNIFORM && speed > 0.0 && command.omega != 0.0) {
+            parallel = parallel && fabs(st - sr) <= TOLERANCE;
+        }
+        tally.parallel += parallel ? 0 : 1;
+
+        // tight：後から決める側を縮めたなら、どれかの車輪が上限にいる
+        bool shrunk = (policy == TWIST_LIMIT_UNIFORM) ? applied.saturated
+                      : (policy == TWIST_LIMIT_ROTATION_FIRST) ? st < 1.0 - TOLERANCE
+                                                               : sr < 1.0 - TOLERANCE;
+        tally.tight += (shrunk && !at_limit) ? 1 : 0;
+
+        // wheels：返した機体速度を上限なしで計算し直す
+        MotorControlData check = {};
+        pair.free.calc(applied.vx_mm_s, applied.vy_mm_s, applied.omega_deg_s, check);
+        bool same = true;
+        for (int i = 0; i < pair.wheels; i++) {
+            double expected = check.motor_data[i].target_value;
+            same = same && fabs(data.motor_data[i].target_value - expected) <= TOLERANCE * fmax(1.0, fabs(expected));
+        }
+        tally.wheels += same ? 0 : 1;
+
+        // priority：優先する側だけで収まるなら、その側は縮めない
+        if (policy == TWIST_LIMIT_ROTATION_FIRST && fits(pair.free, {0.0, 0.0, command.omega}, limits, pair.wheels)) {
+            tally.priority += (fabs(sr - 1.0) <= TOLERANCE) ? 0 : 1;
+        } else if (policy == TWIST_LIMIT_TRANSLATION_FIRST
+                   && fits(pair.free, {command.vx, command.vy, 0.0}, limits, pair.wheels)) {
+            tally.priority += (fabs(st - 1.0) <= TOLERANCE) ? 0 : 1;
+        }
+    }
+    return tally;
+}
+
+}  // namespace
+
+int main()
+{
+    const struct {
+        TwistLimitPolicy policy;
+        const char* name;
+    } policies[] = {
+        {TWIST_LIMIT_UNIFORM, "uniform"},
+        {TWIST_LIMIT_ROTATION_FIRST, "rotation"},
+        {TWIST_LIMIT_TRANSLATION_FIRST, "translation"},
+    };
+    int failures = 0;
+    auto check = [&failures](bool ok, const char* what) {
+        if (!ok) {
+            failures++;
+        }
+        printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+    };
+    auto report = [&](const char* kinematics, const char* policy, const Tally& tally) {
+        char what[160];
+        printf("%s / %s: %d of %d saturated, worst over limit %.1e, worst angle %.1e rad\n", kinematics, policy,
+               tally.saturated, TWISTS, tally.worst_over > 0.0 ? tally.worst_over : 0.0, tally.worst_angle);
+        snprintf(what, sizeof(what), "limit %d, parallel %d, wheels %d, tight %d, priority %d failed", tally.limit,
+                 tally.parallel, tally.wheels, tally.tight, tally.priority);
+        check(tally.limit == 0 && tally.parallel == 0 && tally.wheels == 0 && tally.tight == 0 && tally.priority == 0
+                  && tally.saturated > 0,
+              what);
+    };
+
+    printf("%d random twists per case, wheel limits 1-10 rps\n", TWISTS);
+    unsigned int seed = 1;
+    for (const auto& p : policies) {
+        report("mecanum", p.name, sweep(makeMecanum(), p.policy, seed++));
+        report("omni3", p.name, sweep(makeOmni3(), p.policy, seed++));
+        report("omni4", p.name, sweep(makeOmni4(), p.policy, seed++));
+        report("two-wheel", p.name, sweep(makeTwoWheel(), p.policy, seed++));
+    }
+    printf("%s (%d failed)\n", failures == 0 ? "OK" : "NG", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#ifndef MDD_FRAME_H
+#define MDD_FRAME_H
+
+#include <stdint.h>
+#include <string.h>
+#include "frame_core.h"
+#include "msg_schema.h"
+
+// SkenMdd の UART フレーム（mbed / Arduino で同一内容）
+//
+// 既定（MDD の現行ファームウェアの形式、21 バイト）
+//   [0xA5][0xA5][seq][id][float × 4（リトルエンディアン）][チェックサム]
+//   チェックサムは seq からデータの最後までの 8 ビット和。MDD は受け取った seq を 1 バイトで返す
+//
+// MDD_FRAME_COBS を定義したとき（frame_core のフレーム、24 バイト）
+//   msg_schema.h の MddCommand（seq, コマンドID, float × 4）を COBS + CRC-16 で送る。MDD は MddReply（seq）で返す
+//   チェックサムより誤りを見落としにくく、途中から受信しても次の 0x00 で同期する。MDD 側も同じ形式に対応していること
+
+#ifdef MDD_FRAME_COBS
+
+#define MDD_FRAME_SIZE FRAME_ENCODED_SIZE(MddCommand_SIZE)
+
+// frame に 1 フレーム分を書き込む（data は 4 個）
+static inline void MddFrame_pack(uint8_t* frame, uint8_t seq, uint8_t id, const float* data) {
+    MddCommand command;
+    command.seq = seq;
+    command.command = id;
+    memcpy(command.data, data, sizeof(command.data));
+    Frame_encode(frame, MddCommand_pack(&command, Frame_payload(frame)));
+}
+
+// MDD の応答（seq）を 1 バイトずつ受け取る
+typedef struct {
+    FrameReceiver receiver;
+    uint8_t buffer[FRAME_ENCODED_SIZE(MddReply_SIZE)];
+} MddAck;
+
+static inline void MddAck_Init(MddAck* ack) {
+    FrameReceiver_Init(&ack->receiver, ack->buffer, sizeof(ack->buffer));
+}
+
+// seq の応答を受け取ったら 1
+static inline uint8_t MddAck_push(MddAck* ack, uint8_t byte, uint8_t seq) {
+    MddReply reply;
+    return FrameReceiver_push(&ack->receiver, byte)
+        && MddReply_unpack(&reply, ack->receiver.payload, ack->receiver.payload_length)
+        && reply.seq == seq;
+}
+
+#else
+
+#define MDD_FRAME_SIZE 21
+#define MDD_FRAME_HEADER 0xA5
+
+static inline uint8_t MddFrame_checksum(const uint8_t* frame) {
+    uint8_t checksum = 0;
+    for (int i = 2; i < MDD_FRAME_SIZE - 1; i++) {
+        checksum += frame[i];
+    }
+    return checksum;
+}
+
+// frame に 1 フレーム分を書き込む（data は 4 個）
+static inline void MddFrame_pack(uint8_t* frame, uint8_t seq, uint8_t id, const float* data) {
+    frame[0] = MDD_FRAME_HEADER;
+    frame[1] = MDD_FRAME_HEADER;
+    frame[2] = seq;
+    frame[3] = id;
+    memcpy(&frame[4], data, 4 * sizeof(float));
+    frame[MDD_FRAME_SIZE - 1] = MddFrame_checksum(frame);
+}
+
+// MDD の応答（seq の 1 バイト）
+typedef struct {
+    uint8_t unused;
+} MddAck;
+
+static inline void MddAck_Init(MddAck* ack) {
+    ack->unused = 0;
+}
+
+static inline uint8_t MddAck_push(MddAck* ack, uint8_t byte, uint8_t seq) {
+    (void)ack;
+    return byte == seq;
+}
+
+#endif // MDD_FRAME_COBS
+
+#endif // MDD_FRAME_H
@@ -0,0 +1,209 @@
+#ifndef MSG_CORE_H_
+#define MSG_CORE_H_
+
+// メッセージの定義から構造体・サイズ・pack / unpack を作る共通コア（ヘッダのみ、動的確保なし）
+//   - メッセージはフィールドの並びをマクロで書き、MSG_DEFINE に渡す（msg_schema.h を参照）
+//   - バイト列は [メッセージ ID][バージョン][フィールドを定義の順に、リトルエンディアンで]
+//   - pack / unpack はフレームのバッファ（Frame_payload / FrameReceiver の payload）を直接読み書きするので、途中のコピーがない
+//   - 1 バイトずつシフトで組み立てるので、CPU のエンディアンや構造体の詰め物に左右されない
+//   - サイズ（Name_SIZE）は定数なので、バッファの大きさに使える（FRAME_ENCODED_SIZE(Name_SIZE)）
+//
+// バージョン：フィールドは最後に追加するだけにして、追加したらバージョンを上げる
+//   unpack は自分のバージョン以上・自分のサイズ以上なら受け取り、知らない後ろのフィールドは無視する
+//   古いバージョン（短い）は受け取らない。意味を変えるときは新しい ID にする
+// CubeIDE / mbed / Arduino で同一内容
+
+#include <stdint.h>
+#include <string.h>
+
+// メッセージの先頭（ID とバージョン）のバイト数
+#define MSG_HEADER_SIZE 2
+
+// フィールドに使える型と、そのバイト数
+#define MSG_SIZE_uint8_t 1
+#define MSG_SIZE_int8_t 1
+#define MSG_SIZE_uint16_t 2
+#define MSG_SIZE_int16_t 2
+#define MSG_SIZE_uint32_t 4
+#define MSG_SIZE_int32_t 4
+#define MSG_SIZE_float 4
+
+static inline uint8_t *MsgCore_put_uint8_t(uint8_t *p, uint8_t value)
+{
+    p[0] = value;
+    return p + 1;
+}
+
+static inline uint8_t *MsgCore_put_uint16_t(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    return p + 2;
+}
+
+static inline uint8_t *MsgCore_put_uint32_t(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+static inline uint8_t *MsgCore_put_int8_t(uint8_t *p, int8_t value)
+{
+    return MsgCore_put_uint8_t(p, (uint8_t)value);
+}
+
+static inline uint8_t *MsgCore_put_int16_t(uint8_t *p, int16_t value)
+{
+    return MsgCore_put_uint16_t(p, (uint16_t)value);
+}
+
+static inline uint8_t *MsgCore_put_int32_t(uint8_t *p, int32_t value)
+{
+    return MsgCore_put_uint32_t(p, (uint32_t)value);
+}
+
+// float は IEEE 754 のビット列をそのまま送る
+static inline uint8_t *MsgCore_put_float(uint8_t *p, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return MsgCore_put_uint32_t(p, bits);
+}
+
+static inline const uint8_t *MsgCore_get_uint8_t(const uint8_t *p, uint8_t *value)
+{
+    *value = p[0];
+    return p + 1;
+}
+
+static inline const uint8_t *MsgCore_get_uint16_t(const uint8_t *p, uint16_t *value)
+{
+    *value = (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+    return p + 2;
+}
+
+static inline const uint8_t *MsgCore_get_uint32_t(const uint8_t *p, uint32_t *value)
+{
+    *value = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    return p + 4;
+}
+
+static inline const uint8_t *MsgCore_get_int8_t(const uint8_t *p, int8_t *value)
+{
+    *value = (int8_t)p[0];
+    return p + 1;
+}
+
+static inline const uint8_t *MsgCore_get_int16_t(const uint8_t *p, int16_t *value)
+{
+    uint16_t bits;
+    p = MsgCore_get_uint16_t(p, &bits);
+    *value = (int16_t)bits;
+    return p;
+}
+
+static inline const uint8_t *MsgCore_get_int32_t(const uint8_t *p, int32_t *value)
+{
+    uint32_t bits;
+    p = MsgCore_get_uint32_t(p, &bits);
+    *value = (int32_t)bits;
+    return p;
+}
+
+static inline const uint8_t *MsgCore_get_float(const uint8_t *p, float *value)
+{
+    uint32_t bits;
+    p = MsgCore_get_uint32_t(p, &bits);
+    memcpy(value, &bits, sizeof(bits));
+    return p;
+}
+
+// 配列の pack / unpack（MsgCore_putArray_型 / MsgCore_getArray_型）
+#define MSG_CORE_ARRAY(type)                                                                         \
+    static inline uint8_t *MsgCore_putArray_##type(uint8_t *p, const type *values, uint16_t count)     \
+    {                                                                                                \
+        uint16_t i;                                                                                  \
+        for (i = 0; i < count; i++)                                                                  \
+        {                                                                                            \
+            p = MsgCore_put_##type(p, values[i]);                                                    \
+        }                                                                                            \
+        return p;                                                                                    \
+    }                                                                                                \
+    static inline const uint8_t *MsgCore_getArray_##type(const uint8_t *p, type *values, uint16_t count) \
+    {                                                                                                \
+        uint16_t i;                                                                                  \
+        for (i = 0; i < count; i++)                                                                  \
+        {                                                                                            \
+            p = MsgCore_get_##type(p, &values[i]);                                                   \
+        }                                                                                            \
+        return p;                                                                                    \
+    }
+
+MSG_CORE_ARRAY(uint8_t)
+MSG_CORE_ARRAY(int8_t)
+MSG_CORE_ARRAY(uint16_t)
+MSG_CORE_ARRAY(int16_t)
+MSG_CORE_ARRAY(uint32_t)
+MSG_CORE_ARRAY(int32_t)
+MSG_CORE_ARRAY(float)
+
+// メッセージ ID（バイト列の先頭。受け取ったメッセージの振り分けに使う）
+static inline uint8_t Msg_id(const uint8_t *buffer, uint16_t length)
+{
+    return (length > 0) ? buffer[0] : 0;
+}
+
+// MSG_DEFINE に渡すフィールドの並びの中で使うマクロ
+//   FIELD(型, 名前)        1 個
+//   ARRAY(型, 名前, 個数)  固定長の配列
+#define MSG_STRUCT_FIELD(type, name) type name;
+#define MSG_STRUCT_ARRAY(type, name, count) type name[count];
+#define MSG_SIZE_FIELD(type, name) +MSG_SIZE_##type
+#define MSG_SIZE_ARRAY(type, name, count) +MSG_SIZE_##type * (count)
+#define MSG_PACK_FIELD(type, name) p = MsgCore_put_##type(p, msg->name);
+#define MSG_PACK_ARRAY(type, name, count) p = MsgCore_putArray_##type(p, msg->name, (count));
+#define MSG_UNPACK_FIELD(type, name) p = MsgCore_get_##type(p, &msg->name);
+#define MSG_UNPACK_ARRAY(type, name, count) p = MsgCore_getArray_##type(p, msg->name, (count));
+
+// メッセージを定義する
+//   Name         構造体 Name
+//   Name_ID      メッセージ ID
+//   Name_VERSION バージョン
+//   Name_SIZE    バイト数（先頭の 2 バイトを含む）
+//   Name_pack(msg, buffer)           buffer に Name_SIZE バイトを書き、バイト数を返す
+//   Name_unpack(msg, buffer, length) 受け取れれば 1（ID が違う・古い・短ければ 0）
+#define MSG_DEFINE(Name, msg_id, version, FIELDS)                                                 \
+    typedef struct                                                                               \
+    {                                                                                            \
+        FIELDS(MSG_STRUCT_FIELD, MSG_STRUCT_ARRAY)                                               \
+    } Name;                                                                                      \
+    enum                                                                                         \
+    {                                                                                            \
+        Name##_ID = (msg_id),                                                                    \
+        Name##_VERSION = (version),                                                              \
+        Name##_SIZE = MSG_HEADER_SIZE FIELDS(MSG_SIZE_FIELD, MSG_SIZE_ARRAY)                     \
+    };                                                                                           \
+    static inline uint16_t Name##_pack(const Name *msg, uint8_t *buffer)                          \
+    {                                                                                            \
+        uint8_t *p = buffer;                                                                     \
+        *p++ = (uint8_t)(msg_id);                                                                \
+        *p++ = (uint8_t)(version);                                                               \
+        FIELDS(MSG_PACK_FIELD, MSG_PACK_ARRAY)                                                   \
+        return (uint16_t)(p - buffer);                                                           \
+    }                                                                                            \
+    static inline uint8_t Name##_unpack(Name *msg, const uint8_t *buffer, uint16_t length)       \
+    {                                                                                            \
+        const uint8_t *p = buffer + MSG_HEADER_SIZE;                                             \
+        if (length < (uint16_t)(MSG_HEADER_SIZE FIELDS(MSG_SIZE_FIELD, MSG_SIZE_ARRAY))           \
+            || buffer[0] != (uint8_t)(msg_id) || buffer[1] < (uint8_t)(version))                 \
+        {                                                                                        \
+            return 0;                                                                            \
+        }                                                                                        \
+        FIELDS(MSG_UNPACK_FIELD, MSG_UNPACK_ARRAY)                                               \
+        return 1;                                                                                \
+    }
+
+#endif /* MSG_CORE_H_ */
@@ -0,0 +1,139 @@
+#ifndef MOTOR_MODEL_H
+#define MOTOR_MODEL_H
+
+#include <math.h>
+
+// DC モータ（ギヤのバックラッシュつき）の物理モデル。ピンやスレッドに依存しないので、いくつでも並列に動かせる
+//   - 2 本の PWM の Duty から端子電圧を決め、逆起電力・巻線抵抗・摩擦・慣性で回転数を積分する
+//       pin1 だけ Duty > 0：+Duty × 電源電圧、pin2 だけ：−、両方 1.0：ショートブレーキ、両方 0：フリーラン（電流なし）
+//   - backlash > 0 かつ load_inertia > 0 なら、モータ側（inertia）と出力側（load_inertia）の間に backlash [rad] の遊びを入れる
+//       遊びの端でぶつかると、運動量を保ったまま同じ速さになる（完全非弾性衝突）。離れている間、出力側は負荷トルクだけで動く
+//   - 回転数・角度は出力側（エンコーダ・車輪の側）
+// SIL の SimMotor と、ゲイン探索（sweep/）の 1 エピソードが使う
+struct SimMotorConfig {
+    float supply_voltage;   // 電源電圧 [V]
+    float resistance;       // 巻線抵抗 [Ω]
+    float kt;               // トルク定数 [N·m/A]（= 逆起電力定数 [V·s/rad]）
+    float inertia;          // 慣性モーメント（バックラッシュより手前、なければ負荷込み）[kg·m²]
+    float viscous;          // 粘性摩擦 [N·m·s/rad]
+    float coulomb;          // 動摩擦・静止摩擦 [N·m]
+    float counts_per_rev;   // エンコーダの 1 回転あたりのカウント（4 逓倍後）
+    float backlash;         // ギヤの遊び [rad]（0 でなし）
+    float load_inertia;     // バックラッシュより先の慣性モーメント [kg·m²]
+};
+
+// 既定値（12V、無負荷 約 12 rps、機械時定数 約 18ms のギヤードモータ相当、バックラッシュなし）
+inline SimMotorConfig SimMotor_defaultConfig()
+{
+    SimMotorConfig config;
+    config.supply_voltage = 12.0f;
+    config.resistance = 2.0f;
+    config.kt = 0.15f;
+    config.inertia = 2.0e-4f;
+    config.viscous = 1.0e-5f;
+    config.coulomb = 2.0e-3f;
+    config.counts_per_rev = 8192.0f;
+    config.backlash = 0.0f;
+    config.load_inertia = 0.0f;
+    return config;
+}
+
+class MotorModel {
+public:
+    explicit MotorModel(const SimMotorConfig& config = SimMotor_defaultConfig()) : config(config) {
+        reset();
+    }
+
+    void setConfig(const SimMotorConfig& new_config) {
+        config = new_config;
+    }
+
+    const SimMotorConfig& getConfig() const { return config; }
+
+    void reset() {
+        motor_omega = 0.0f;
+        load_omega = 0.0f;
+        motor_angle = 0.0;
+        load_angle = 0.0;
+        power = 0.0f;
+        current = 0.0f;
+    }
+
+    // dt [s] だけ進める。load：出力側にかかる負荷トルク [N·m]
+    void step(float duty1, float duty2, float load, float dt) {
+        // 端子電圧から電流とトルク
+        float torque = 0.0f;
+        float back_emf = config.kt * motor_omega;
+        power = 0.0f;
+        current = 0.0f;
+        if (duty1 >= 0.999f && duty2 >= 0.999f) {
+            current = -back_emf / config.resistance;   // ショートブレーキ
+            torque = config.kt * current;
+        } else if (duty1 > 0.0f || duty2 > 0.0f) {
+            float voltage = (duty1 - duty2) * config.supply_voltage;
+            current = (voltage - back_emf) / config.resistance;
+            torque = config.kt * current;
+            power = voltage * current;
+        }
+        torque -= config.viscous * motor_omega;
+
+        if (config.backlash <= 0.0f || config.load_inertia <= 0.0f) {
+            motor_omega = integrate(motor_omega, torque - load, config.inertia + config.load_inertia, dt);
+            motor_angle += static_cast<double>(motor_omega * dt);
+            load_omega = motor_omega;
+            load_angle = motor_angle;
+            return;
+        }
+
+        // 遊びの中では別々に動かし、端を越えたら出力側を端に戻して同じ速さにする
+        motor_omega = integrate(motor_omega, torque, config.inertia, dt);
+        load_omega += -load / config.load_inertia * dt;
+        motor_angle += static_cast<double>(motor_omega * dt);
+        load_angle += static_cast<double>(load_omega * dt);
+        double half = 0.5 * static_cast<double>(config.backlash);
+        double gap = motor_angle - load_angle;
+        if (gap > half || gap < -half) {
+            load_angle = motor_angle - (gap > 0.0 ? half : -half);
+            if ((gap > 0.0) == (motor_omega > load_omega)) {
+                float omega = (config.inertia * motor_omega + config.load_inertia * load_omega)
+                              / (config.inertia + config.load_inertia);
+                motor_omega = omega;
+                load_omega = omega;
+            }
+        }
+    }
+
+    // 出力側の回転数 [rad/s] と角度 [rad]
+    float getOmega() const { return load_omega; }
+    double getAngle() const { return load_angle; }
+
+    // モータ側の回転数 [rad/s]
+    float getMotorOmega() const { return motor_omega; }
+
+    // 直前の step で電源から取った電力 [W]（回生は負）
+    float getPower() const { return power; }
+
+    // 直前の step の巻線電流 [A]（PWM 1 周期の平均。フリーランでは 0）
+    float getCurrent() const { return current; }
+
+private:
+    SimMotorConfig config;
+    float motor_omega;
+    float load_omega;
+    double motor_angle;
+    double load_angle;
+    float power;
+    float current;
+
+    // 摩擦つきで回転数を積分する。止まっていて摩擦に勝てなければ止まったまま、摩擦で向きが変わるならそこで止める
+    float integrate(float omega, float torque, float inertia, float dt) const {
+        if (omega == 0.0f && fabsf(torque) <= config.coulomb) {
+            return 0.0f;
+        }
+        float direction = (omega != 0.0f) ? (omega > 0.0f ? 1.0f : -1.0f) : (torque > 0.0f ? 1.0f : -1.0f);
+        float next = omega + (torque - direction * config.coulomb) / inertia * dt;
+        return (omega != 0.0f && next * omega < 0.0f) ? 0.0f : next;
+    }
+};
+
+#endif // MOTOR_MODEL_H
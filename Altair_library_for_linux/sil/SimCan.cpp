@@ -0,0 +1,187 @@
+#include "SimCan.h"
+
+#include "SimClock.h"
+
+namespace {
+
+struct Binding {
+    SimCan* bus;
+    int rd_pin;
+    int td_pin;
+    int node;
+};
+
+std::mutex registry_mutex;
+std::vector<Binding> registry;
+
+// 何も送るものがないときに停止を確かめる間隔（実時間）
+const std::chrono::milliseconds IDLE_WAIT(1);
+
+}  // namespace
+
+SimCan::SimCan(const char* name, int bitrate) :
+    name(name), bitrate(bitrate), stats(), running(false)
+{
+}
+
+SimCan::~SimCan()
+{
+    stop();
+    std::lock_guard<std::mutex> guard(registry_mutex);
+    for (size_t i = 0; i < registry.size();) {
+        if (registry[i].bus == this) {
+            registry.erase(registry.begin() + static_cast<long>(i));
+        } else {
+            i++;
+        }
+    }
+}
+
+void SimCan::start()
+{
+    if (running) {
+        return;
+    }
+    running = true;
+    thread = std::thread(&SimCan::run, this);
+}
+
+void SimCan::stop()
+{
+    if (!running) {
+        return;
+    }
+    running = false;
+    tx_ready.notify_all();
+    thread.join();
+    rx_ready.notify_all();
+}
+
+void SimCan::setBitrate(int new_bitrate)
+{
+    if (new_bitrate > 0) {
+        bitrate = new_bitrate;
+    }
+}
+
+void SimCan::bind(int rd_pin, int td_pin)
+{
+    Node node = {};
+    node.rd_pin = rd_pin;
+    node.td_pin = td_pin;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        nodes.push_back(node);
+    }
+    std::lock_guard<std::mutex> guard(registry_mutex);
+    registry.push_back({this, rd_pin, td_pin, static_cast<int>(nodes.size()) - 1});
+}
+
+SimCan* SimCan::find(int rd_pin, int td_pin, int& node)
+{
+    std::lock_guard<std::mutex> guard(registry_mutex);
+    for (const Binding& binding : registry) {
+        if (binding.rd_pin == rd_pin && binding.td_pin == td_pin) {
+            node = binding.node;
+            return binding.bus;
+        }
+    }
+    return nullptr;
+}
+
+// 標準 ID のデータフレーム：SOF〜EOF の 44 ビット + データ、スタッフビットは対象の 34 + 8 × len ビットに最大 4 ビットごと 1 個
+uint64_t SimCan::frameTimeUs(uint8_t len) const
+{
+    uint64_t bits = 44 + 8ULL * len + (34 + 8ULL * len - 1) / 4 + 3;
+    uint64_t rate = static_cast<uint64_t>(bitrate);
+    return (bits * 1000000ULL + rate - 1) / rate;
+}
+
+bool SimCan::write(int node, const Frame& frame)
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    Node& self = nodes[static_cast<size_t>(node)];
+    for (int i = 0; i < TX_MAILBOXES; i++) {
+        if (!self.pending[i]) {
+            self.mailboxes[i] = frame;
+            self.pending[i] = true;
+            tx_ready.notify_all();
+            return true;
+        }
+    }
+    stats.tx_full++;
+    return false;
+}
+
+bool SimCan::read(int node, Frame& frame, uint64_t timeout_us)
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    Node& self = nodes[static_cast<size_t>(node)];
+    if (self.rx_fifo.empty() && timeout_us > 0) {
+        uint64_t real_deadline = SimClock::toRealNs(SimClock::nowUs() + timeout_us);
+        uint64_t real_now = SimClock::realNowNs();
+        if (real_deadline > real_now) {
+            rx_ready.wait_for(guard, std::chrono::nanoseconds(real_deadline - real_now),
+                              [&self, this]() { return !self.rx_fifo.empty() || !running; });
+        }
+    }
+    if (self.rx_fifo.empty()) {
+        return false;
+    }
+    frame = self.rx_fifo.front();
+    self.rx_fifo.pop_front();
+    return true;
+}
+
+SimCan::Stats SimCan::getStats()
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return stats;
+}
+
+// バス：調停して 1 フレームずつ送り、送り終わったら受信 FIFO に配る
+void SimCan::run()
+{
+    SimClock::setThreadTimerSlack();
+    std::unique_lock<std::mutex> guard(mutex);
+    while (running) {
+        int winner_node = -1;
+        int winner_box = -1;
+        for (size_t n = 0; n < nodes.size(); n++) {
+            for (int b = 0; b < TX_MAILBOXES; b++) {
+                if (nodes[n].pending[b]
+                    && (winner_node < 0 || nodes[n].mailboxes[b].id < nodes[winner_node].mailboxes[winner_box].id)) {
+                    winner_node = static_cast<int>(n);
+                    winner_box = b;
+                }
+            }
+        }
+        if (winner_node < 0) {
+            tx_ready.wait_for(guard, IDLE_WAIT);
+            continue;
+        }
+
+        // 送っている間、メールボックスは埋まったまま（送り終わりで空く）
+        Frame frame = nodes[winner_node].mailboxes[winner_box];
+        uint64_t duration = frameTimeUs(frame.len);
+        uint64_t end = SimClock::nowUs() + duration;
+        guard.unlock();
+        SimClock::sleepUntilUs(end);
+        guard.lock();
+
+        nodes[winner_node].pending[winner_box] = false;
+        stats.frames++;
+        stats.busy_us += duration;
+        for (size_t n = 0; n < nodes.size(); n++) {
+            if (static_cast<int>(n) == winner_node) {
+                continue;
+            }
+            if (nodes[n].rx_fifo.size() < RX_FIFO_SIZE) {
+                nodes[n].rx_fifo.push_back(frame);
+            } else {
+                stats.rx_overruns++;
+            }
+        }
+        rx_ready.notify_all();
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef SIM_CAN_H
+#define SIM_CAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// SIL の CAN バス（標準 ID のデータフレームだけ）
+//   - つないだノード（bxCAN 相当）はそれぞれ送信メールボックス 3 個と受信 FIFO 3 段を持つ。メールボックスが全部埋まっていれば write は失敗する
+//   - バスが空くたびに、全ノードのメールボックスから ID の一番小さいフレームを選び（調停）、1 フレームの時間をかけて送る
+//   - 送り終わったフレームは送ったノード以外の全ノードの受信 FIFO に入る。FIFO がいっぱいなら捨てる（オーバーラン）
+//   - 1 フレームの時間はビットスタッフィングが最大のときのビット数 / bitrate。時刻は SimClock（仮想の時刻）
+// mbed の CAN(rd, td) は、ピンからこのバスのノードを使う
+class SimCan {
+public:
+    static const int TX_MAILBOXES = 3;
+    static const size_t RX_FIFO_SIZE = 3;
+
+    struct Frame {
+        uint32_t id;
+        uint8_t data[8];
+        uint8_t len;
+    };
+
+    struct Stats {
+        uint64_t frames;       // 送り終わったフレームの数
+        uint64_t busy_us;      // バスが埋まっていた時間 [us]
+        uint64_t tx_full;      // メールボックスが埋まっていて write が失敗した回数
+        uint64_t rx_overruns;  // 受信 FIFO があふれて捨てたフレームの数
+    };
+
+    SimCan(const char* name, int bitrate);
+    ~SimCan();
+
+    SimCan(const SimCan&) = delete;
+    SimCan& operator=(const SimCan&) = delete;
+
+    // バスのスレッドを動かす（ノードは start の前に bind しておく）
+    void start();
+    void stop();
+
+    const char* getName() const { return name; }
+
+    void setBitrate(int bitrate);
+    int getBitrate() const { return bitrate; }
+
+    // ノードを 1 つ増やし、mbed の CAN(rd, td) がそれを使うようにする
+    void bind(int rd_pin, int td_pin);
+    static SimCan* find(int rd_pin, int td_pin, int& node);
+
+    // 空いているメールボックスに入れる（全部埋まっていれば false）
+    bool write(int node, const Frame& frame);
+
+    // 受信 FIFO から 1 フレーム読む。届いていなければ、最大 timeout_us [us]（仮想の時刻）待つ
+    bool read(int node, Frame& frame, uint64_t timeout_us);
+
+    // データ長 len のフレームを送る時間 [us]（フレーム間の 3 ビットを含む）
+    uint64_t frameTimeUs(uint8_t len) const;
+
+    Stats getStats();
+
+private:
+    struct Node {
+        int rd_pin;
+        int td_pin;
+        Frame mailboxes[TX_MAILBOXES];
+        bool pending[TX_MAILBOXES];
+        std::deque<Frame> rx_fifo;
+    };
+
+    const char* name;
+    std::atomic<int> bitrate;
+    std::vector<Node> nodes;
+    std::mutex mutex;
+    std::condition_variable tx_ready;
+    std::condition_variable rx_ready;
+    Stats stats;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    void run();
+};
+
+#endif // SIM_CAN_H
@@ -0,0 +1,67 @@
+#include "SimClock.h"
+
+#include <errno.h>
+#include <sys/prctl.h>
+#include <time.h>
+
+namespace {
+
+double scale = 1.0;
+
+// 仮想の時刻 START_US に当たる実時間 [ns]
+uint64_t epoch_ns = SimClock::realNowNs();
+
+}  // namespace
+
+void SimClock::setScale(double new_scale)
+{
+    // 今の仮想の時刻を保ったまま倍率を変える
+    uint64_t now = nowUs();
+    scale = (new_scale > 0.0) ? new_scale : 1.0;
+    epoch_ns = realNowNs() - static_cast<uint64_t>(static_cast<double>(now - START_US) * 1000.0 / scale);
+}
+
+double SimClock::getScale()
+{
+    return scale;
+}
+
+uint64_t SimClock::nowUs()
+{
+    return START_US + static_cast<uint64_t>(static_cast<double>(realNowNs() - epoch_ns) * scale / 1000.0);
+}
+
+uint64_t SimClock::realNowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t SimClock::toRealNs(uint64_t virtual_us)
+{
+    if (virtual_us <= START_US) {
+        return epoch_ns;
+    }
+    return epoch_ns + static_cast<uint64_t>(static_cast<double>(virtual_us - START_US) * 1000.0 / scale);
+}
+
+void SimClock::sleepUntilUs(uint64_t virtual_us)
+{
+    uint64_t real_ns = toRealNs(virtual_us);
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(real_ns / 1000000000ULL);
+    ts.tv_nsec = static_cast<long>(real_ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+void SimClock::sleepForUs(uint64_t us)
+{
+    sleepUntilUs(nowUs() + us);
+}
+
+void SimClock::setThreadTimerSlack()
+{
+    prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+}
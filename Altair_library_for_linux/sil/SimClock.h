@@ -0,0 +1,39 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+// SIL（ソフトウェア・イン・ザ・ループ）の時刻 [us]
+//   - 実時間（CLOCK_MONOTONIC）に倍率 scale を掛けた仮想の時刻。scale = 100 なら 10 分の動作が 6 秒で終わる
+//   - mbed の us ティッカー（Timebase）、Kernel::Clock、ThisThread::sleep_for、UART のバイトの間隔、物理モデルの時刻はすべてこれ
+//   - sleep は仮想の時刻で渡し、実時間では 1/scale だけ眠る
+//   - 起動直後でも「時刻 - 10ms」が負にならないよう、START_US（1 秒）から始める
+// 実時間で眠れる細かさ（約 50us）に scale を掛けたものが、仮想の時刻での分解能になる
+class SimClock {
+public:
+    static const uint64_t START_US = 1000000;
+
+    // 時間の進む倍率（スレッドを動かす前に呼ぶ）
+    static void setScale(double scale);
+    static double getScale();
+
+    // 今の仮想の時刻 [us]
+    static uint64_t nowUs();
+
+    // 仮想の時刻 virtual_us まで眠る（過ぎていればすぐ戻る）
+    static void sleepUntilUs(uint64_t virtual_us);
+
+    // 仮想の時間 us だけ眠る
+    static void sleepForUs(uint64_t us);
+
+    // 仮想の時刻 virtual_us を実時間（CLOCK_MONOTONIC [ns]）に直す
+    static uint64_t toRealNs(uint64_t virtual_us);
+
+    // 実時間（CLOCK_MONOTONIC [ns]）
+    static uint64_t realNowNs();
+
+    // 呼んだスレッドの sleep の遅れ（timer slack）を最小にする
+    static void setThreadTimerSlack();
+};
+
+#endif // SIM_CLOCK_H
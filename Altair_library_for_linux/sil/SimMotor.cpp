@@ -0,0 +1,106 @@
+#include "SimMotor.h"
+
+#include <math.h>
+#include <mutex>
+#include "SimClock.h"
+#include "SimPins.h"
+
+namespace {
+
+const double TWO_PI = 6.283185307179586;
+
+// カウントの下位 2 ビットから A/B 相（A が上位ビット）。A の立ち上がりで B が Low の向きを正転とする
+const uint8_t QUADRATURE[4] = {0x0, 0x2, 0x3, 0x1};
+
+}  // namespace
+
+SimMotor::SimMotor() :
+    counts_per_rev(8192.0f), pwm1(-1), pwm2(-1), enc_a(-1), enc_b(-1), count(0), load(0.0f), rps(0.0f)
+{
+}
+
+void SimMotor::attach(int new_pwm1, int new_pwm2, int new_enc_a, int new_enc_b, const SimMotorConfig& config)
+{
+    model.setConfig(config);
+    model.reset();
+    counts_per_rev = config.counts_per_rev;
+    pwm1 = new_pwm1;
+    pwm2 = new_pwm2;
+    enc_a = new_enc_a;
+    enc_b = new_enc_b;
+    setEncoderState();
+}
+
+void SimMotor::step(float dt)
+{
+    if (pwm1 < 0) {
+        return;
+    }
+    model.step(SimPins::getDuty(pwm1), SimPins::getDuty(pwm2), load, dt);
+    rps.store(static_cast<float>(model.getOmega() / TWO_PI), std::memory_order_relaxed);
+
+    // 1 カウントずつ A/B 相を変えて割り込みを起こす
+    int32_t target = static_cast<int32_t>(floor(model.getAngle() / TWO_PI * counts_per_rev));
+    while (count != target) {
+        count += (target > count) ? 1 : -1;
+        setEncoderState();
+    }
+}
+
+void SimMotor::setEncoderState()
+{
+    if (enc_a < 0) {
+        return;
+    }
+    uint8_t state = QUADRATURE[count & 3];
+    SimPins::setLevel(enc_a, (state >> 1) & 1);
+    SimPins::setLevel(enc_b, state & 1);
+}
+
+SimPlant::SimPlant(uint32_t step_us) :
+    step_us(step_us), running(false), steps(0)
+{
+}
+
+SimPlant::~SimPlant()
+{
+    stop();
+}
+
+void SimPlant::start()
+{
+    if (!running) {
+        running = true;
+        thread = std::thread(&SimPlant::run, this);
+    }
+}
+
+void SimPlant::stop()
+{
+    if (running) {
+        running = false;
+        thread.join();
+    }
+}
+
+void SimPlant::run()
+{
+    SimClock::setThreadTimerSlack();
+    uint64_t last = SimClock::nowUs();
+    while (running) {
+        uint64_t now = SimClock::nowUs();
+        lag.record(now - last);
+        {
+            std::lock_guard<std::recursive_mutex> guard(SimPins::lock());
+            while (now - last >= step_us) {
+                float dt = static_cast<float>(step_us) * 1e-6f;
+                for (int i = 0; i < MAX_MOTORS; i++) {
+                    motors[i].step(dt);
+                }
+                last += step_us;
+                steps++;
+            }
+        }
+        SimClock::sleepUntilUs(last + step_us);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef SIM_MOTOR_H
+#define SIM_MOTOR_H
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include "LatencyHistogram.h"
+#include "MotorModel.h"
+
+// SIL の DC モータとエンコーダ
+//   - MotorDriver の 2 本の PWM（SimPins の Duty）を MotorModel に渡して回転数を積分する
+//   - 角度の変化をエンコーダの A/B 相（4 逓倍のグレイコード）にして、1 カウントごとに InterruptIn の割り込みを起こす
+//   - 1 ステップは最大 step_us [us]（仮想の時刻）。遅れたときはステップの数を増やして追いつく
+// SimPlant がまとめて 1 本のスレッドで進める
+class SimMotor {
+public:
+    SimMotor();
+
+    // pwm1 / pwm2：MotorDriver のピン、enc_a / enc_b：Encoder のピン（エンコーダがなければ -1）
+    void attach(int pwm1, int pwm2, int enc_a, int enc_b, const SimMotorConfig& config);
+
+    // dt [s] だけ進める（SimPins のロックの中で呼ぶ）
+    void step(float dt);
+
+    // 負荷トルク [N·m]（外乱として加える）
+    void setLoad(float torque) { load = torque; }
+
+    float getRPS() const { return rps.load(std::memory_order_relaxed); }
+    int32_t getCount() const { return count; }
+    bool isAttached() const { return pwm1 >= 0; }
+
+private:
+    MotorModel model;
+    float counts_per_rev;
+    int pwm1;
+    int pwm2;
+    int enc_a;
+    int enc_b;
+    int32_t count;          // エンコーダに出したカウント
+    float load;
+    std::atomic<float> rps;
+
+    void setEncoderState();
+};
+
+// 複数のモータを 1 本のスレッドで進める
+class SimPlant {
+public:
+    static const int MAX_MOTORS = 8;
+
+    explicit SimPlant(uint32_t step_us = 100);
+    ~SimPlant();
+
+    SimMotor& motor(int index) { return motors[index]; }
+
+    void start();
+    void stop();
+
+    uint64_t getSteps() const { return steps; }
+
+    // ステップが仮想の時刻から遅れた時間 [us] の分布（倍率が高すぎると大きくなる。p99 が step_us の数倍までなら結果を信用してよい）
+    const LatencyHistogram& getLag() const { return lag; }
+
+private:
+    SimMotor motors[MAX_MOTORS];
+    uint32_t step_us;
+    std::atomic<bool> running;
+    std::thread thread;
+    uint64_t steps;
+    LatencyHistogram lag;
+
+    void run();
+};
+
+#endif // SIM_MOTOR_H
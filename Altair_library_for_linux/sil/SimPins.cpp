@@ -0,0 +1,54 @@
+#include "SimPins.h"
+
+SimPins::Pin& SimPins::at(int pin)
+{
+    static Pin pins[PIN_COUNT];
+    return pins[static_cast<unsigned>(pin) % PIN_COUNT];
+}
+
+std::recursive_mutex& SimPins::lock()
+{
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
+int SimPins::getLevel(int pin)
+{
+    return at(pin).level.load(std::memory_order_relaxed);
+}
+
+void SimPins::setLevel(int pin, int level)
+{
+    Pin& p = at(pin);
+    uint8_t value = level ? 1 : 0;
+    if (p.level.exchange(value, std::memory_order_relaxed) == value) {
+        return;
+    }
+    if (value && p.rise) {
+        p.rise();
+    } else if (!value && p.fall) {
+        p.fall();
+    }
+}
+
+float SimPins::getDuty(int pin)
+{
+    return at(pin).duty.load(std::memory_order_relaxed);
+}
+
+void SimPins::setDuty(int pin, float duty)
+{
+    at(pin).duty.store(duty, std::memory_order_relaxed);
+}
+
+void SimPins::setRise(int pin, std::function<void()> handler)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock());
+    at(pin).rise = std::move(handler);
+}
+
+void SimPins::setFall(int pin, std::function<void()> handler)
+{
+    std::lock_guard<std::recursive_mutex> guard(lock());
+    at(pin).fall = std::move(handler);
+}
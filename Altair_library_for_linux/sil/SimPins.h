@@ -0,0 +1,45 @@
+#ifndef SIM_PINS_H
+#define SIM_PINS_H
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+// SIL のピン（mbed の PinName ごとのレベル・Duty・割り込み）
+//   - PwmOut::write の Duty を物理モデル（SimMotor）が読み、InterruptIn の割り込みを物理モデルが起こす
+//   - 割り込みの処理は critical section（core_util_critical_section_enter）と同じロックの中で呼ぶ
+//     マイコンで割り込みを止めている間は割り込みが入らないのと同じ
+class SimPins {
+public:
+    static const int PIN_COUNT = 256;
+
+    // ピンのレベル（0 / 1）
+    static int getLevel(int pin);
+
+    // ピンのレベルを変え、変化したら InterruptIn の rise / fall を呼ぶ（lock() の中で呼ぶ）
+    static void setLevel(int pin, int level);
+
+    // PwmOut の Duty（0.0〜1.0）
+    static float getDuty(int pin);
+    static void setDuty(int pin, float duty);
+
+    // InterruptIn の rise / fall
+    static void setRise(int pin, std::function<void()> handler);
+    static void setFall(int pin, std::function<void()> handler);
+
+    // critical section のロック（同じスレッドで入れ子にしてよい）
+    static std::recursive_mutex& lock();
+
+private:
+    struct Pin {
+        std::atomic<uint8_t> level;
+        std::atomic<float> duty;
+        std::function<void()> rise;
+        std::function<void()> fall;
+    };
+
+    static Pin& at(int pin);
+};
+
+#endif // SIM_PINS_H
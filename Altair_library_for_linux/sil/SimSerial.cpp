@@ -0,0 +1,254 @@
+#include "SimSerial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+#include "SimClock.h"
+
+namespace {
+
+std::mutex registry_mutex;
+std::vector<SimSerial*> registry;
+
+// 何も起きないときに pty を見に行く間隔 [ns]（実時間）
+const uint64_t IDLE_POLL_NS = 200000;
+
+}  // namespace
+
+SimSerial::SimSerial(const char* name, int baud) :
+    name(name), baud(baud), fd(-1), tx_pin(-1), rx_pin(-1), rx_line_free_us(0), tx_line_free_us(0),
+    stats(), running(false)
+{
+}
+
+SimSerial::~SimSerial()
+{
+    stop();
+    std::lock_guard<std::mutex> guard(registry_mutex);
+    for (size_t i = 0; i < registry.size(); i++) {
+        if (registry[i] == this) {
+            registry.erase(registry.begin() + static_cast<long>(i));
+            break;
+        }
+    }
+}
+
+bool SimSerial::start()
+{
+    if (running) {
+        return true;
+    }
+    if (!pty.open()) {
+        return false;
+    }
+    fd = pty.takeMaster();
+    int flags = fcntl(fd, F_GETFL);
+    struct termios tio;
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 || tcgetattr(fd, &tio) < 0) {
+        return false;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+    running = true;
+    thread = std::thread(&SimSerial::run, this);
+    return true;
+}
+
+void SimSerial::stop()
+{
+    if (!running) {
+        return;
+    }
+    running = false;
+    thread.join();
+    ::close(fd);
+    fd = -1;
+    rx_ready.notify_all();
+    tx_space.notify_all();
+}
+
+void SimSerial::setBaud(int new_baud)
+{
+    if (new_baud > 0) {
+        baud = new_baud;
+    }
+}
+
+void SimSerial::bind(int tx, int rx)
+{
+    tx_pin = tx;
+    rx_pin = rx;
+    std::lock_guard<std::mutex> guard(registry_mutex);
+    registry.push_back(this);
+}
+
+SimSerial* SimSerial::find(int tx, int rx)
+{
+    std::lock_guard<std::mutex> guard(registry_mutex);
+    for (SimSerial* serial : registry) {
+        if (serial->tx_pin == tx && serial->rx_pin == rx) {
+            return serial;
+        }
+    }
+    return nullptr;
+}
+
+// 8N1 の 1 バイト（スタート 1 + データ 8 + ストップ 1）
+uint64_t SimSerial::byteTimeUs() const
+{
+    return (10000000ULL + static_cast<uint64_t>(baud) / 2) / static_cast<uint64_t>(baud);
+}
+
+size_t SimSerial::write(const uint8_t* data, size_t size)
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    uint64_t byte_time = byteTimeUs();
+    for (size_t i = 0; i < size; i++) {
+        if (tx_queue.size() >= TX_QUEUE_SIZE) {
+            stats.tx_blocked++;
+            tx_space.wait(guard, [this]() { return tx_queue.size() < TX_QUEUE_SIZE || !running; });
+            if (!running) {
+                return i;
+            }
+        }
+        uint64_t now = SimClock::nowUs();
+        uint64_t start = (tx_line_free_us > now) ? tx_line_free_us : now;
+        tx_line_free_us = start + byte_time;
+        tx_queue.push_back({data[i], tx_line_free_us});
+        stats.tx_bytes++;
+        stats.tx_busy_us += byte_time;
+        if (tx_queue.size() > stats.max_tx_queue) {
+            stats.max_tx_queue = tx_queue.size();
+        }
+    }
+    return size;
+}
+
+size_t SimSerial::read(uint8_t* data, size_t size, uint64_t timeout_us)
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    if (!waitByte(guard, timeout_us)) {
+        return 0;
+    }
+    uint64_t now = SimClock::nowUs();
+    size_t count = 0;
+    while (count < size && !rx_queue.empty() && rx_queue.front().time_us <= now) {
+        data[count++] = rx_queue.front().value;
+        rx_queue.pop_front();
+    }
+    return count;
+}
+
+bool SimSerial::readable()
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return !rx_queue.empty() && rx_queue.front().time_us <= SimClock::nowUs();
+}
+
+bool SimSerial::waitReadable(uint64_t timeout_us)
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    return waitByte(guard, timeout_us);
+}
+
+// 受信したバイトが届くまで待つ（mutex を持って呼ぶ）
+bool SimSerial::waitByte(std::unique_lock<std::mutex>& guard, uint64_t timeout_us)
+{
+    uint64_t deadline = (timeout_us == UINT64_MAX) ? UINT64_MAX : SimClock::nowUs() + timeout_us;
+    for (;;) {
+        uint64_t now = SimClock::nowUs();
+        if (!rx_queue.empty() && rx_queue.front().time_us <= now) {
+            return true;
+        }
+        if (now >= deadline || !running) {
+            return false;
+        }
+        // 次のバイトが届く時刻か、タイムアウトまで眠る
+        uint64_t wake = rx_queue.empty() ? deadline : rx_queue.front().time_us;
+        if (wake > deadline) {
+            wake = deadline;
+        }
+        if (wake == UINT64_MAX) {
+            rx_ready.wait(guard);
+        } else {
+            uint64_t real_ns = SimClock::toRealNs(wake);
+            uint64_t real_now = SimClock::realNowNs();
+            rx_ready.wait_for(guard, std::chrono::nanoseconds(real_ns > real_now ? real_ns - real_now : 0));
+        }
+    }
+}
+
+SimSerial::Stats SimSerial::getStats()
+{
+    std::lock_guard<std::mutex> guard(mutex);
+    return stats;
+}
+
+// pty との間でバイトを受け渡すスレッド
+void SimSerial::run()
+{
+    SimClock::setThreadTimerSlack();
+    uint8_t buffer[4096];
+    while (running) {
+        uint64_t now = SimClock::nowUs();
+        uint64_t next_tx = UINT64_MAX;
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+
+            // ホスト → マイコン：届いたバイトに、線を通り終わる時刻を付ける
+            ssize_t n;
+            uint64_t byte_time = byteTimeUs();
+            bool received = false;
+            while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+                for (ssize_t i = 0; i < n; i++) {
+                    uint64_t start = (rx_line_free_us > now) ? rx_line_free_us : now;
+                    rx_line_free_us = start + byte_time;
+                    rx_queue.push_back({buffer[i], rx_line_free_us});
+                }
+                stats.rx_bytes += static_cast<uint64_t>(n);
+                stats.rx_busy_us += static_cast<uint64_t>(n) * byte_time;
+                received = true;
+            }
+            if (received) {
+                rx_ready.notify_all();
+            }
+
+            // マイコン → ホスト：線に出し終わったバイトを pty に書く
+            size_t count = 0;
+            while (count < tx_queue.size() && count < sizeof(buffer) && tx_queue[count].time_us <= now) {
+                buffer[count] = tx_queue[count].value;
+                count++;
+            }
+            if (count > 0) {
+                ssize_t written = ::write(fd, buffer, count);
+                if (written > 0) {
+                    tx_queue.erase(tx_queue.begin(), tx_queue.begin() + written);
+                    tx_space.notify_all();
+                }
+            }
+            if (!tx_queue.empty()) {
+                next_tx = tx_queue.front().time_us;
+            }
+        }
+
+        // 次に送るバイトの時刻か、ホストからのバイトが来るまで待つ
+        uint64_t timeout_ns = IDLE_POLL_NS;
+        if (next_tx != UINT64_MAX) {
+            uint64_t real_next = SimClock::toRealNs(next_tx);
+            uint64_t real_now = SimClock::realNowNs();
+            timeout_ns = (real_next > real_now) ? real_next - real_now : 0;
+            if (timeout_ns > IDLE_POLL_NS) {
+                timeout_ns = IDLE_POLL_NS;
+            }
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        struct timespec timeout;
+        timeout.tv_sec = static_cast<time_t>(timeout_ns / 1000000000ULL);
+        timeout.tv_nsec = static_cast<long>(timeout_ns % 1000000000ULL);
+        ppoll(&pfd, 1, &timeout, nullptr);
+    }
+}
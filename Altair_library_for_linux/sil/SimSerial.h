@@ -0,0 +1,95 @@
+#ifndef SIM_SERIAL_H
+#define SIM_SERIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "PtyPair.h"
+
+// SIL の UART（マイコン側）。pty の master につなぎ、ホスト側は slave（/dev/pts/N）を開く
+//   - 1 バイトを 10 ビット（8N1）/ baud の時間で送受信する。ホストがまとめて書いても、マイコンには 1 バイトずつその間隔で届く
+//   - マイコンの送信も同じ間隔で pty に出す。送信バッファ（TX_QUEUE_SIZE）がいっぱいなら write は空くまで待つ
+//   - 時刻は SimClock（仮想の時刻）。倍率を上げると通信も同じ倍率で速くなる
+// mbed の BufferedSerial と CubeIDE の HAL_USART_Transmit / HAL_USART_Receive は、ピン / ハンドルからこの UART を使う
+class SimSerial {
+public:
+    static const size_t TX_QUEUE_SIZE = 256;  // mbed の BufferedSerial の送信バッファと同じ
+
+    struct Stats {
+        uint64_t tx_bytes;    // マイコン → ホスト
+        uint64_t rx_bytes;    // ホスト → マイコン
+        uint64_t tx_busy_us;  // 送信で線が埋まっていた時間 [us]
+        uint64_t rx_busy_us;
+        size_t max_tx_queue;  // 送信バッファにたまった最大のバイト数
+        uint64_t tx_blocked;  // 送信バッファがいっぱいで write が待った回数
+    };
+
+    SimSerial(const char* name, int baud);
+    ~SimSerial();
+
+    SimSerial(const SimSerial&) = delete;
+    SimSerial& operator=(const SimSerial&) = delete;
+
+    // pty を作って送受信のスレッドを動かす
+    bool start();
+    void stop();
+
+    const char* getName() const { return name; }
+    const char* getSlavePath() const { return pty.getSlavePath(); }
+
+    void setBaud(int baud);
+    int getBaud() const { return baud; }
+
+    // mbed の BufferedSerial(tx, rx) がこの UART を使うようにする
+    void bind(int tx_pin, int rx_pin);
+    static SimSerial* find(int tx_pin, int rx_pin);
+
+    // マイコン側の送信（送信バッファに入れて戻る）
+    size_t write(const uint8_t* data, size_t size);
+
+    // マイコン側の受信。1 バイト以上届くまで待ち、届いている分（size まで）を読む
+    // timeout_us [us]（仮想の時刻）で届かなければ 0。UINT64_MAX で届くまで待つ
+    size_t read(uint8_t* data, size_t size, uint64_t timeout_us = UINT64_MAX);
+
+    bool readable();
+
+    // 受信したバイトが届くまで、最大 timeout_us [us]（仮想の時刻）待つ
+    bool waitReadable(uint64_t timeout_us);
+
+    // 1 バイトを送受信する時間 [us]
+    uint64_t byteTimeUs() const;
+
+    Stats getStats();
+
+private:
+    struct Byte {
+        uint8_t value;
+        uint64_t time_us;  // 受信：マイコンに届く時刻、送信：線に出し終わる時刻
+    };
+
+    const char* name;
+    std::atomic<int> baud;
+    PtyPair pty;
+    int fd;
+    int tx_pin;
+    int rx_pin;
+    std::mutex mutex;
+    std::condition_variable rx_ready;
+    std::condition_variable tx_space;
+    std::deque<Byte> rx_queue;
+    std::deque<Byte> tx_queue;
+    uint64_t rx_line_free_us;  // 受信の線が空く時刻
+    uint64_t tx_line_free_us;
+    Stats stats;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    bool waitByte(std::unique_lock<std::mutex>& guard, uint64_t timeout_us);
+    void run();
+};
+
+#endif // SIM_SERIAL_H
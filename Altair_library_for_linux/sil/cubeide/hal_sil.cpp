@@ -0,0 +1,46 @@
+#include "main.h"
+
+#include "SimClock.h"
+#include "SimSerial.h"
+
+extern "C" HAL_StatusTypeDef HAL_USART_Transmit(USART_HandleTypeDef* husart, const uint8_t* pTxData, uint16_t Size, uint32_t Timeout)
+{
+    (void)Timeout;
+    SimSerial* serial = static_cast<SimSerial*>(husart->sim);
+    if (serial == nullptr) {
+        return HAL_ERROR;
+    }
+    return (serial->write(pTxData, Size) == Size) ? HAL_OK : HAL_ERROR;
+}
+
+extern "C" HAL_StatusTypeDef HAL_USART_Receive(USART_HandleTypeDef* husart, uint8_t* pRxData, uint16_t Size, uint32_t Timeout)
+{
+    SimSerial* serial = static_cast<SimSerial*>(husart->sim);
+    if (serial == nullptr) {
+        return HAL_ERROR;
+    }
+    uint64_t deadline = (Timeout == HAL_MAX_DELAY) ? UINT64_MAX : SimClock::nowUs() + static_cast<uint64_t>(Timeout) * 1000ULL;
+    uint16_t count = 0;
+    while (count < Size) {
+        uint64_t now = SimClock::nowUs();
+        if (deadline != UINT64_MAX && now >= deadline) {
+            return HAL_TIMEOUT;
+        }
+        size_t n = serial->read(pRxData + count, Size - count, (deadline == UINT64_MAX) ? UINT64_MAX : deadline - now);
+        if (n == 0 && deadline == UINT64_MAX) {
+            return HAL_ERROR;  // 止めた
+        }
+        count = static_cast<uint16_t>(count + n);
+    }
+    return HAL_OK;
+}
+
+extern "C" uint32_t HAL_GetTick(void)
+{
+    return static_cast<uint32_t>(SimClock::nowUs() / 1000ULL);
+}
+
+extern "C" void HAL_Delay(uint32_t Delay)
+{
+    SimClock::sleepForUs(static_cast<uint64_t>(Delay) * 1000ULL);
+}
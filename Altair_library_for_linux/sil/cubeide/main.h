@@ -0,0 +1,39 @@
+#ifndef SIL_MAIN_H
+#define SIL_MAIN_H
+
+/* SIL 用の main.h（CubeIDE 版の serial_lib / usart_lib を Linux でビルドするための最小限の HAL） */
+/* USART_HandleTypeDef の sim に SimSerial を入れておくと、HAL_USART_Transmit / HAL_USART_Receive がそれを使う */
+/* Timeout は ms（仮想の時刻）、HAL_MAX_DELAY で届くまで待つ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+typedef struct {
+    void *sim;  /* SimSerial* */
+} USART_HandleTypeDef;
+
+typedef USART_HandleTypeDef UART_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_USART_Transmit(USART_HandleTypeDef *husart, const uint8_t *pTxData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_USART_Receive(USART_HandleTypeDef *husart, uint8_t *pRxData, uint16_t Size, uint32_t Timeout);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIL_MAIN_H */
@@ -0,0 +1,7 @@
+#ifndef SIL_PERIPHERAL_PINS_H
+#define SIL_PERIPHERAL_PINS_H
+
+// SIL 用（PinMap_PWM は mbed.h で宣言している）
+#include "mbed.h"
+
+#endif // SIL_PERIPHERAL_PINS_H
@@ -0,0 +1,17 @@
+#ifndef SIL_GPIO_API_H
+#define SIL_GPIO_API_H
+
+// SIL 用（Stm32Hal の宣言を通すためだけのもの）
+#include "mbed.h"
+
+typedef struct {
+    uint32_t mask;
+    volatile uint32_t* reg_in;
+    volatile uint32_t* reg_set;
+    volatile uint32_t* reg_clr;
+    PinName pin;
+} gpio_t;
+
+void gpio_init_in(gpio_t* obj, PinName pin);
+
+#endif // SIL_GPIO_API_H
@@ -0,0 +1,339 @@
+#ifndef SIL_MBED_H
+#define SIL_MBED_H
+
+// SIL 用の mbed.h（Linux で mbed 版のソースをそのままビルドするための最小限の API）
+//   - 時刻（us ティッカー・Kernel::Clock・ThisThread）は SimClock の仮想の時刻
+//   - BufferedSerial は SimSerial（pty）、CAN は SimCan、PwmOut / InterruptIn は SimPins（物理モデル SimMotor が読み書きする）
+//   - Thread は std::thread、Mutex は std::recursive_mutex。critical section は割り込み（SimPins の rise / fall）と同じロック
+// MotorDriver / Encoder は ALTAIR_USE_MBED_HAL を定義して MbedHal（PwmOut / InterruptIn）で動かす
+// レジスタを直接触るもの（Stm32Hal、MotorGroup、ServoGroup、incenc）は SIL では動かない
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "SimClock.h"
+#include "SimPins.h"
+
+using namespace std::chrono_literals;
+
+// STM32 と同じ並び（ポート × 16 + ピン番号）
+enum PinName {
+    PA_0 = 0x00, PA_1, PA_2, PA_3, PA_4, PA_5, PA_6, PA_7, PA_8, PA_9, PA_10, PA_11, PA_12, PA_13, PA_14, PA_15,
+    PB_0 = 0x10, PB_1, PB_2, PB_3, PB_4, PB_5, PB_6, PB_7, PB_8, PB_9, PB_10, PB_11, PB_12, PB_13, PB_14, PB_15,
+    PC_0 = 0x20, PC_1, PC_2, PC_3, PC_4, PC_5, PC_6, PC_7, PC_8, PC_9, PC_10, PC_11, PC_12, PC_13, PC_14, PC_15,
+    PD_0 = 0x30, PD_1, PD_2, PD_3, PD_4, PD_5, PD_6, PD_7, PD_8, PD_9, PD_10, PD_11, PD_12, PD_13, PD_14, PD_15,
+    PE_0 = 0x40, PE_1, PE_2, PE_3, PE_4, PE_5, PE_6, PE_7, PE_8, PE_9, PE_10, PE_11, PE_12, PE_13, PE_14, PE_15,
+    USBTX = PA_2,
+    USBRX = PA_3,
+    NC = -1
+};
+
+#define MBED_ALIGN(N) alignas(N)
+#define MBED_ASSERT(expr) ((void)(expr))
+
+template <class F>
+using Callback = std::function<F>;
+
+template <class F>
+std::function<void()> callback(F func) {
+    return std::function<void()>(func);
+}
+
+template <class T, class M>
+std::function<void()> callback(T* object, M method) {
+    return [object, method]() { (object->*method)(); };
+}
+
+// critical section（割り込み禁止）
+inline void core_util_critical_section_enter() {
+    SimPins::lock().lock();
+}
+
+inline void core_util_critical_section_exit() {
+    SimPins::lock().unlock();
+}
+
+// us ティッカー
+struct ticker_data_t;
+
+inline const ticker_data_t* get_us_ticker_data() {
+    return nullptr;
+}
+
+inline uint64_t ticker_read_us(const ticker_data_t*) {
+    return SimClock::nowUs();
+}
+
+inline uint32_t us_ticker_read() {
+    return static_cast<uint32_t>(SimClock::nowUs());
+}
+
+inline void wait_us(int us) {
+    SimClock::sleepForUs(static_cast<uint64_t>(us));
+}
+
+namespace Kernel {
+struct Clock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<Clock>;
+    static const bool is_steady = true;
+    static time_point now() {
+        return time_point(duration(static_cast<rep>(SimClock::nowUs() / 1000)));
+    }
+};
+}  // namespace Kernel
+
+class DigitalOut {
+public:
+    explicit DigitalOut(PinName pin, int value = 0) : pin(pin) { write(value); }
+    void write(int value) { SimPins::setDuty(pin, value ? 1.0f : 0.0f); }
+    int read() { return SimPins::getDuty(pin) > 0.5f ? 1 : 0; }
+    DigitalOut& operator=(int value) { write(value); return *this; }
+    operator int() { return read(); }
+
+private:
+    PinName pin;
+};
+
+class DigitalIn {
+public:
+    explicit DigitalIn(PinName pin) : pin(pin) {}
+    int read() { return SimPins::getLevel(pin); }
+    operator int() { return read(); }
+
+private:
+    PinName pin;
+};
+
+class InterruptIn {
+public:
+    explicit InterruptIn(PinName pin) : pin(pin) {}
+    ~InterruptIn() {
+        SimPins::setRise(pin, nullptr);
+        SimPins::setFall(pin, nullptr);
+    }
+    int read() { return SimPins::getLevel(pin); }
+    void rise(Callback<void()> func) { SimPins::setRise(pin, std::move(func)); }
+    void fall(Callback<void()> func) { SimPins::setFall(pin, std::move(func)); }
+
+private:
+    PinName pin;
+};
+
+class PwmOut {
+public:
+    explicit PwmOut(PinName pin) : pin(pin), period_us_value(20000) { write(0.0f); }
+    void period(float seconds) { period_us_value = static_cast<int>(seconds * 1e6f); }
+    void period_ms(int ms) { period_us_value = ms * 1000; }
+    void period_us(int us) { period_us_value = us; }
+    void write(float duty) { SimPins::setDuty(pin, duty < 0.0f ? 0.0f : (duty > 1.0f ? 1.0f : duty)); }
+    float read() { return SimPins::getDuty(pin); }
+    void pulsewidth(float seconds) { pulsewidth_us(static_cast<int>(seconds * 1e6f)); }
+    void pulsewidth_us(int us) { write(static_cast<float>(us) / static_cast<float>(period_us_value)); }
+    PwmOut& operator=(float duty) { write(duty); return *this; }
+
+private:
+    PinName pin;
+    int period_us_value;
+};
+
+// UART（SimSerial::bind で tx / rx のピンに結びつけた pty を使う。結びつけていなければ送信は捨て、受信は来ない）
+class BufferedSerial {
+public:
+    BufferedSerial(PinName tx, PinName rx, int baud = 9600);
+    ssize_t write(const void* buffer, size_t length);
+    ssize_t read(void* buffer, size_t length);
+    bool readable();
+    bool writable() { return true; }
+    void set_baud(int baud);
+    void set_blocking(bool blocking) { this->blocking = blocking; }
+    int sync() { return 0; }
+
+private:
+    class SimSerial* serial;
+    bool blocking;
+};
+
+enum CANFormat {
+    CANStandard = 0,
+    CANExtended = 1,
+    CANAny = 2
+};
+
+enum CANType {
+    CANData = 0,
+    CANRemote = 1
+};
+
+class CANMessage {
+public:
+    CANMessage() : id(0), len(8), format(CANStandard), type(CANData) { memset(data, 0, sizeof(data)); }
+    CANMessage(unsigned int id, const unsigned char* data, unsigned char len = 8, CANType type = CANData,
+               CANFormat format = CANStandard)
+        : id(id), len(len > 8 ? 8 : len), format(format), type(type) {
+        memset(this->data, 0, sizeof(this->data));
+        if (data != nullptr) {
+            memcpy(this->data, data, this->len);
+        }
+    }
+
+    unsigned int id;
+    unsigned char data[8];
+    unsigned char len;
+    CANFormat format;
+    CANType type;
+};
+
+// CAN（SimCan::bind で rd / td のピンに結びつけたバスのノードを使う。結びつけていなければ送信は捨て、受信は来ない）
+class CAN {
+public:
+    CAN(PinName rd, PinName td, int hz = 100000);
+    int write(CANMessage msg);   // 1：メールボックスに入れた、0：メールボックスが空いていない
+    int read(CANMessage& msg, int handle = 0);
+    int frequency(int hz);
+
+private:
+    class SimCan* bus;
+    int node;
+};
+
+namespace rtos {
+
+enum osPriority {
+    osPriorityIdle = 1,
+    osPriorityLow = 8,
+    osPriorityBelowNormal = 16,
+    osPriorityNormal = 24,
+    osPriorityAboveNormal = 32,
+    osPriorityHigh = 40,
+    osPriorityRealtime = 48
+};
+
+enum osStatus {
+    osOK = 0,
+    osError = -1
+};
+
+// 優先度とスタックは受け取るだけ（Linux のスレッドで動かす）
+class Thread {
+public:
+    explicit Thread(osPriority priority = osPriorityNormal, uint32_t stack_size = 4096,
+                    unsigned char* stack_mem = nullptr, const char* name = nullptr) {
+        (void)priority;
+        (void)stack_size;
+        (void)stack_mem;
+        (void)name;
+    }
+    ~Thread() {
+        if (thread.joinable()) {
+            thread.detach();
+        }
+    }
+    osStatus start(Callback<void()> task) {
+        if (thread.joinable()) {
+            return osError;
+        }
+        thread = std::thread([task]() {
+            SimClock::setThreadTimerSlack();
+            task();
+        });
+        return osOK;
+    }
+    osStatus join() {
+        if (thread.joinable()) {
+            thread.join();
+        }
+        return osOK;
+    }
+    // 止められないので切り離す（呼ぶ側が終了のフラグを落としてから呼ぶこと）
+    osStatus terminate() {
+        if (thread.joinable()) {
+            thread.detach();
+        }
+        return osOK;
+    }
+    osStatus set_priority(osPriority priority) {
+        (void)priority;
+        return osOK;
+    }
+
+private:
+    std::thread thread;
+};
+
+// mbed の Mutex と同じく、同じスレッドから重ねて lock してよい
+class Mutex {
+public:
+    void lock() {
+        mutex.lock();
+    }
+    bool trylock() {
+        return mutex.try_lock();
+    }
+    void unlock() {
+        mutex.unlock();
+    }
+
+private:
+    std::recursive_mutex mutex;
+};
+
+namespace ThisThread {
+
+template <class Rep, class Period>
+void sleep_for(std::chrono::duration<Rep, Period> duration) {
+    SimClock::sleepForUs(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+}
+
+inline void sleep_until(Kernel::Clock::time_point time) {
+    SimClock::sleepUntilUs(static_cast<uint64_t>(time.time_since_epoch().count()) * 1000ULL);
+}
+
+}  // namespace ThisThread
+
+}  // namespace rtos
+
+using namespace rtos;
+
+// mbed::ScopedLock と同じ（スコープを抜けるときに unlock する）
+template <class Lockable>
+class ScopedLock {
+public:
+    explicit ScopedLock(Lockable& lockable) : lockable(lockable) {
+        lockable.lock();
+    }
+    ~ScopedLock() {
+        lockable.unlock();
+    }
+    ScopedLock(const ScopedLock&) = delete;
+    ScopedLock& operator=(const ScopedLock&) = delete;
+
+private:
+    Lockable& lockable;
+};
+
+// Stm32Hal / MotorGroup などのレジスタ操作（宣言だけ。SIL では使わない）
+typedef struct {
+    volatile uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR1, CCR2, CCR3, CCR4;
+} TIM_TypeDef;
+
+struct PinMap {
+    PinName pin;
+    int peripheral;
+    int function;
+};
+
+extern const PinMap PinMap_PWM[];
+uint32_t pinmap_peripheral(PinName pin, const PinMap* map);
+uint32_t pinmap_function(PinName pin, const PinMap* map);
+#define STM_PIN_CHANNEL(X) (((X) >> 11) & 0x1F)
+
+#endif // SIL_MBED_H
@@ -0,0 +1,89 @@
+#include "mbed.h"
+
+#include <errno.h>
+#include "SimCan.h"
+#include "SimSerial.h"
+
+BufferedSerial::BufferedSerial(PinName tx, PinName rx, int baud) :
+    serial(SimSerial::find(tx, rx)), blocking(true)
+{
+    set_baud(baud);
+}
+
+ssize_t BufferedSerial::write(const void* buffer, size_t length)
+{
+    if (serial == nullptr) {
+        return static_cast<ssize_t>(length);
+    }
+    return static_cast<ssize_t>(serial->write(static_cast<const uint8_t*>(buffer), length));
+}
+
+ssize_t BufferedSerial::read(void* buffer, size_t length)
+{
+    if (serial == nullptr) {
+        // 何も届かない UART（ブロッキングなら mbed と同じく戻らない）
+        while (blocking) {
+            SimClock::sleepForUs(1000000);
+        }
+        return -EAGAIN;
+    }
+    size_t count = serial->read(static_cast<uint8_t*>(buffer), length, blocking ? UINT64_MAX : 0);
+    return (count == 0 && !blocking) ? -EAGAIN : static_cast<ssize_t>(count);
+}
+
+bool BufferedSerial::readable()
+{
+    // readable で空回りして待つループ（SkenMdd::tcp など）が CPU を占有しないよう、読めなければ 1 バイトの時間だけ待つ
+    // 今 pty に書かれたバイトも、マイコンに届くのは 1 バイトの時間の後なので、待っても届く時刻は変わらない
+    return serial != nullptr && serial->waitReadable(serial->byteTimeUs());
+}
+
+void BufferedSerial::set_baud(int baud)
+{
+    if (serial != nullptr) {
+        serial->setBaud(baud);
+    }
+}
+
+CAN::CAN(PinName rd, PinName td, int hz) :
+    bus(nullptr), node(0)
+{
+    bus = SimCan::find(rd, td, node);
+    frequency(hz);
+}
+
+int CAN::write(CANMessage msg)
+{
+    if (bus == nullptr) {
+        return 1;
+    }
+    SimCan::Frame frame;
+    frame.id = msg.id;
+    frame.len = msg.len;
+    memcpy(frame.data, msg.data, sizeof(frame.data));
+    return bus->write(node, frame) ? 1 : 0;
+}
+
+int CAN::read(CANMessage& msg, int handle)
+{
+    (void)handle;
+    if (bus == nullptr) {
+        SimClock::sleepForUs(100);
+        return 0;
+    }
+    // read で空回りして待つループ（CanMdd::tcp など）が CPU を占有しないよう、届いていなければ一番短いフレームの時間だけ待つ
+    SimCan::Frame frame;
+    if (!bus->read(node, frame, bus->frameTimeUs(0))) {
+        return 0;
+    }
+    msg = CANMessage(frame.id, frame.data, frame.len);
+    return 1;
+}
+
+int CAN::frequency(int hz)
+{
+    if (bus != nullptr) {
+        bus->setBitrate(hz);
+    }
+    return 1;
+}
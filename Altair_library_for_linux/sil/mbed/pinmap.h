@@ -0,0 +1,7 @@
+#ifndef SIL_PINMAP_H
+#define SIL_PINMAP_H
+
+// SIL 用（pinmap_peripheral などは mbed.h で宣言している）
+#include "mbed.h"
+
+#endif // SIL_PINMAP_H
@@ -0,0 +1,7 @@
+#ifndef SIL_RTOS_H
+#define SIL_RTOS_H
+
+// SIL 用（Thread / ThisThread は mbed.h にある）
+#include "mbed.h"
+
+#endif // SIL_RTOS_H
@@ -0,0 +1,214 @@
+// MDD の送信経路（SkenMdd：UART / CanMdd：CAN）ごとの、コマンドの往復時間の比較
+//   - マイコン側：mbed 版の SkenMdd と CanMdd をそのまま動かし、同じ MddInterface::tcp で n 回ずつ送る
+//   - UART：SimSerial（1 バイトを 10 ビット / ボーレートの時間）の反対側で、このライブラリの MddDevice が seq を返す
+//   - CAN ：SimCan（調停・送信メールボックス 3 個・受信 FIFO 3 段）の別のノードで、MDD 役のスレッドが ACK を返す
+//           設定コマンドは 4 フレームで 1 コマンド。4 フレーム目を受け取ったときに反映して ACK を返す（CubeIDE 版の MDD と同じ）
+// 時刻はすべて SimClock の仮想の時刻
+//
+// 使い方：mdd_latency [-n 回数] [-b ボーレート] [-c CAN のビットレート] [-s 倍率]
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+
+#include "mbed.h"
+#include "can_mdd.h"
+#include "mdd.h"
+
+#include "EventLoop.h"
+#include "LatencyHistogram.h"
+#include "MddDevice.h"
+#include "SerialPort.h"
+#include "SimCan.h"
+#include "SimClock.h"
+#include "SimSerial.h"
+
+namespace {
+
+const PinName MDD_TX = PC_12;
+const PinName MDD_RX = PD_2;
+const PinName CAN_RD = PA_11;       // マイコン側の CAN
+const PinName CAN_TD = PA_12;
+const PinName MDD_CAN_RD = PB_8;    // MDD 役のノード
+const PinName MDD_CAN_TD = PB_9;
+const uint8_t MDD_NODE = 0;
+const unsigned int RESEND_MS = 5;
+const unsigned int MAX_WAIT_MS = 50;
+const uint64_t COMMAND_INTERVAL_US = 1000;
+
+struct Options {
+    int count = 1000;
+    int baud = 115200;
+    int bitrate = 1000000;
+    double scale = 1.0;
+};
+
+struct Result {
+    LatencyHistogram latency;
+    uint32_t failed = 0;
+};
+
+std::atomic<bool> host_running(true);
+std::atomic<bool> mdd_running(true);
+
+// UART の MDD（pty の反対側）
+void uartMddTask(SerialPort& port)
+{
+    EventLoop loop;
+    MddDevice device(loop, port);
+    while (host_running) {
+        loop.runOnce(1);
+    }
+}
+
+// CAN の MDD。指令フレームには seq 0、設定コマンドには 4 フレーム目で seq を付けて ACK を返す
+void canMddTask(int bitrate)
+{
+    CAN can(MDD_CAN_RD, MDD_CAN_TD, bitrate);
+    const unsigned int base_id = CAN_MDD_BASE_ID + (MDD_NODE << 3);
+    uint8_t config_id = 0;
+    uint8_t config_seq = 0;
+    unsigned int config_frames = 0;   // 受け取った設定フレームのビット
+    while (mdd_running) {
+        CANMessage msg;
+        if (!can.read(msg)) {
+            continue;
+        }
+        unsigned char ack[2];
+        if (msg.id == base_id + CAN_MDD_OFS_RPS || msg.id == base_id + CAN_MDD_OFS_PWM) {
+            ack[0] = 0;
+            ack[1] = (msg.id == base_id + CAN_MDD_OFS_RPS) ? MOTOR_RPS_COMMAND_MODE : MOTOR_PWM_COMMAND_MODE;
+        } else if (msg.id >= base_id + CAN_MDD_OFS_CONFIG && msg.id < base_id + CAN_MDD_OFS_CONFIG + 4) {
+            unsigned int n = msg.id - (base_id + CAN_MDD_OFS_CONFIG);
+            if (msg.data[0] != config_id || msg.data[1] != config_seq) {
+                config_id = msg.data[0];
+                config_seq = msg.data[1];
+                config_frames = 0;
+            }
+            config_frames |= 1U << n;
+            if (n != 3 || config_frames != 0xF) {
+                continue;
+            }
+            config_frames = 0;
+            ack[0] = config_seq;
+            ack[1] = config_id;
+        } else {
+            continue;
+        }
+        while (mdd_running && !can.write(CANMessage(base_id + CAN_MDD_OFS_ACK, ack, 2))) {
+        }
+    }
+}
+
+void measure(MddInterface& mdd, uint8_t id, int count, Result& result)
+{
+    for (int i = 0; i < count; i++) {
+        float data[4] = {0.01f * i, -0.01f * i, 0.5f, 1.0f};
+        uint64_t start = Timebase::nowUs();
+        if (!mdd.tcp(id, data, RESEND_MS, MAX_WAIT_MS)) {
+            result.failed++;
+        }
+        result.latency.record(Timebase::nowUs() - start);
+        SimClock::sleepForUs(COMMAND_INTERVAL_US);
+    }
+}
+
+void printResult(const char* name, const Result& result)
+{
+    result.latency.print(stdout, name);
+    printf("    failed %u\n", result.failed);
+}
+
+void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-n count] [-b baud] [-c can_bitrate] [-s scale]\n", name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    int option;
+    while ((option = getopt(argc, argv, "n:b:c:s:")) != -1) {
+        switch (option) {
+            case 'n': options.count = atoi(optarg); break;
+            case 'b': options.baud = atoi(optarg); break;
+            case 'c': options.bitrate = atoi(optarg); break;
+            case 's': options.scale = atof(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (options.count <= 0 || options.baud <= 0 || options.bitrate <= 0 || options.scale <= 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+    SimClock::setScale(options.scale);
+    SimClock::setThreadTimerSlack();
+
+    // UART（pty）と CAN バス
+    SimSerial mdd_uart("mdd", options.baud);
+    mdd_uart.bind(MDD_TX, MDD_RX);
+    if (!mdd_uart.start()) {
+        fprintf(stderr, "cannot create pty\n");
+        return 1;
+    }
+    SimCan can_bus("can", options.bitrate);
+    can_bus.bind(CAN_RD, CAN_TD);
+    can_bus.bind(MDD_CAN_RD, MDD_CAN_TD);
+    can_bus.start();
+
+    // MDD 側
+    SerialPort host_port;
+    if (!host_port.open(mdd_uart.getSlavePath(), options.baud)) {
+        fprintf(stderr, "cannot open pty\n");
+        return 1;
+    }
+    std::thread uart_mdd_thread([&]() {
+        SimClock::setThreadTimerSlack();
+        uartMddTask(host_port);
+    });
+    Thread can_mdd_thread;
+    can_mdd_thread.start([&]() { canMddTask(options.bitrate); });
+
+    // マイコン側（アプリケーションからは同じ MddInterface）
+    BufferedSerial serial(MDD_TX, MDD_RX);
+    SkenMdd uart_mdd(serial);
+    uart_mdd.init();
+    serial.set_baud(options.baud);
+    CAN can(CAN_RD, CAN_TD, options.bitrate);
+    CanMdd can_mdd(can, MDD_NODE);
+    can_mdd.init();
+
+    Result uart_rps, uart_config, can_rps, can_config;
+    uint64_t real_start_ns = SimClock::realNowNs();
+    measure(uart_mdd, MOTOR_RPS_COMMAND_MODE, options.count, uart_rps);
+    measure(uart_mdd, M1_PID_GAIN_CONFIG, options.count, uart_config);
+    measure(can_mdd, MOTOR_RPS_COMMAND_MODE, options.count, can_rps);
+    measure(can_mdd, M1_PID_GAIN_CONFIG, options.count, can_config);
+    double real_seconds = static_cast<double>(SimClock::realNowNs() - real_start_ns) * 1e-9;
+
+    mdd_running = false;
+    can_mdd_thread.join();
+    host_running = false;
+    uart_mdd_thread.join();
+    can_bus.stop();
+
+    printf("MDD tcp round trip (virtual time, resend %u ms, %d commands each, %.2f s real):\n",
+           RESEND_MS, options.count, real_seconds);
+    printf("  uart %d baud: frame %d B = %llu us on the wire\n", options.baud, MDD_FRAME_SIZE,
+           static_cast<unsigned long long>(MDD_FRAME_SIZE * mdd_uart.byteTimeUs()));
+    printResult("    rps   ", uart_rps);
+    printResult("    config", uart_config);
+    SimCan::Stats stats = can_bus.getStats();
+    printf("  can  %d bps: frame 8 B = %llu us on the wire (config: 4 frames)\n", options.bitrate,
+           static_cast<unsigned long long>(can_bus.frameTimeUs(8)));
+    printResult("    rps   ", can_rps);
+    printResult("    config", can_config);
+    printf("  can bus: frames %llu, tx mailbox full %llu, rx overruns %llu\n",
+           static_cast<unsigned long long>(stats.frames), static_cast<unsigned long long>(stats.tx_full),
+           static_cast<unsigned long long>(stats.rx_overruns));
+    return (uart_rps.failed + uart_config.failed + can_rps.failed + can_config.failed) == 0 ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+// SIL（ソフトウェア・イン・ザ・ループ）の実行プログラム
+//   ファームウェア側：mbed 版の RobotControl・AltairSerial・SkenMdd と CubeIDE 版の serial_lib を、そのまま Linux のスレッドで動かす
+//   物理モデル側    ：SimPlant の 4 つの DC モータ（PWM の Duty を読み、エンコーダの割り込みを起こす）
+//   ホスト側        ：このライブラリの AltairSerialHost・SerialLibHost・MddDevice が pty の反対側から通信する（--external なら外のプログラム）
+// 時刻はすべて SimClock の仮想の時刻。-s で倍率を上げると、同じ動作を短い実時間で試せる
+//
+// 使い方：sil_runner [-s 倍率] [-t 秒（仮想の時刻）] [-b ボーレート] [-r 指令の周期 Hz] [--external]
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+
+#include "mbed.h"
+#include "robot_control.h"
+#include "AltairSerial.h"
+#include "mdd.h"
+extern "C" {
+#include "serial_lib.h"
+}
+
+#include "ArrayLink.h"
+#include "LatencyHistogram.h"
+#include "MddDevice.h"
+#include "SimClock.h"
+#include "SimMotor.h"
+#include "SimSerial.h"
+
+namespace {
+
+const int MOTOR_COUNT = 4;
+const PinName MOTOR_PINS[MOTOR_COUNT][2] = {{PB_4, PB_5}, {PB_6, PB_7}, {PB_8, PB_9}, {PB_14, PB_15}};
+const PinName ENCODER_PINS[MOTOR_COUNT][2] = {{PC_0, PC_1}, {PC_2, PC_3}, {PC_6, PC_7}, {PC_8, PC_9}};
+const PinName MDD_TX = PC_12;
+const PinName MDD_RX = PD_2;
+
+const uint32_t MDD_PERIOD_US = 10000;   // SkenMdd::tcp を呼ぶ周期（仮想の時刻）
+
+struct Options {
+    double scale = 1.0;
+    double seconds = 10.0;
+    int baud = 115200;
+    double rate = 100.0;
+    bool external = false;
+};
+
+std::atomic<bool> firmware_running(true);
+std::atomic<bool> host_running(true);
+
+// ---- ファームウェア（マイコンで動かすものと同じコード） ----
+
+RobotControl* robot;
+LatencyHistogram mdd_tcp_latency;   // SkenMdd::tcp が戻るまでの時間
+uint32_t mdd_tcp_failed;
+
+// 受信：[seq, vx, vy, omega]、送信：[seq, 各車輪の目標回転数 ×4, 各車輪の Duty ×4]
+void altairTask(int baud)
+{
+    AltairSerial serial(USB_A, baud);
+    float command[4];
+    float reply[1 + MOTOR_COUNT * 2];
+    while (firmware_running) {
+        int length = 4;
+        serial.receiveFloatArrayWithHeader(command, length);
+        if (length != 4) {
+            continue;
+        }
+        robot->startControl(command[1], command[2], command[3]);
+        reply[0] = command[0];
+        for (int i = 0; i < MOTOR_COUNT; i++) {
+            reply[1 + i] = static_cast<float>(robot->getTargetRPS(i));
+            reply[1 + MOTOR_COUNT + i] = static_cast<float>(robot->getMotorOutput(i));
+        }
+        serial.sendFloatArrayWithHeader(reply, 1 + MOTOR_COUNT * 2);
+    }
+}
+
+// 受け取った int16_t の配列をそのまま返す
+void serialLibTask(USART_HandleTypeDef* huart)
+{
+    int16_t data[4];
+    Serial_Init(huart);
+    while (firmware_running) {
+        if (Serial_ReceiveData(huart, data, 4)) {
+            Serial_SendData(huart, data, 4);
+        }
+    }
+}
+
+// 各車輪の Duty を MDD（id 1）へ送る
+void mddTask()
+{
+    BufferedSerial serial(MDD_TX, MDD_RX);
+    SkenMdd mdd(serial);
+    mdd.init();
+    uint64_t next = Timebase::nowUs();
+    while (firmware_running) {
+        float data[4];
+        for (int i = 0; i < MOTOR_COUNT; i++) {
+            data[i] = static_cast<float>(robot->getMotorOutput(i));
+        }
+        uint64_t start = Timebase::nowUs();
+        if (!mdd.tcp(1, data, 5, 50)) {
+            mdd_tcp_failed++;
+        }
+        mdd_tcp_latency.record(Timebase::nowUs() - start);
+        next += MDD_PERIOD_US;
+        SimClock::sleepUntilUs(next);
+    }
+}
+
+// ---- ホスト（PC 側） ----
+
+struct HostStats {
+    LatencyHistogram altair_rtt;
+    LatencyHistogram serial_lib_rtt;
+    uint32_t altair_sent = 0;
+    uint32_t altair_received = 0;
+    uint32_t serial_lib_sent = 0;
+    uint32_t serial_lib_received = 0;
+    uint32_t serial_lib_mismatch = 0;   // 送ったものと違う値が返ってきた
+    uint32_t mdd_commands = 0;
+    uint32_t mdd_errors = 0;
+    double tracking_square_sum = 0.0;   // 目標回転数と物理モデルの回転数の差の二乗和 [rps²]
+    double tracking_max = 0.0;
+    uint32_t tracking_samples = 0;
+};
+
+// 機体速度の指令（2 秒ごとに前進・横移動・旋回・停止を繰り返す）
+void missionProfile(double t, float& vx, float& vy, float& omega)
+{
+    int phase = static_cast<int>(fmod(t, 8.0) / 2.0);
+    vx = (phase == 0) ? 600.0f : 0.0f;
+    vy = (phase == 1) ? 400.0f : 0.0f;
+    omega = (phase == 2) ? 90.0f : 0.0f;
+}
+
+struct HostPorts {
+    SerialPort altair;
+    SerialPort serial_lib;
+    SerialPort mdd;
+};
+
+void hostTask(HostPorts& ports, SimPlant& plant, const Options& options, HostStats& stats)
+{
+    EventLoop loop;
+    uint64_t altair_send_us[256] = {};
+    uint64_t serial_lib_send_us[256] = {};
+    int16_t serial_lib_sent_data[256][4];
+
+    AltairSerialHost altair(loop, ports.altair);
+    altair.onReceive([&](const float* values, int count) {
+        if (count != 1 + MOTOR_COUNT * 2) {
+            return;
+        }
+        uint8_t seq = static_cast<uint8_t>(static_cast<uint32_t>(values[0]));
+        if (altair_send_us[seq] != 0) {
+            stats.altair_rtt.record(SimClock::nowUs() - altair_send_us[seq]);
+            altair_send_us[seq] = 0;
+        }
+        stats.altair_received++;
+        for (int i = 0; i < MOTOR_COUNT; i++) {
+            double error = fabs(values[1 + i] - plant.motor(i).getRPS());
+            stats.tracking_square_sum += error * error;
+            if (error > stats.tracking_max) {
+                stats.tracking_max = error;
+            }
+        }
+        stats.tracking_samples += MOTOR_COUNT;
+    });
+
+    SerialLibHost serial_lib(loop, ports.serial_lib);
+    serial_lib.onReceive([&](const int16_t* values, int count) {
+        if (count != 4) {
+            return;
+        }
+        uint8_t seq = static_cast<uint8_t>(values[0]);
+        if (serial_lib_send_us[seq] != 0) {
+            stats.serial_lib_rtt.record(SimClock::nowUs() - serial_lib_send_us[seq]);
+            serial_lib_send_us[seq] = 0;
+        }
+        for (int i = 0; i < 4; i++) {
+            if (values[i] != serial_lib_sent_data[seq][i]) {
+                stats.serial_lib_mismatch++;
+                break;
+            }
+        }
+        stats.serial_lib_received++;
+    });
+
+    MddDevice mdd(loop, ports.mdd);
+
+    // 指令は仮想の時刻で 1/rate ごと。その間は実時間で約 50us ごとに受信を見る
+    uint64_t period_us = static_cast<uint64_t>(1e6 / options.rate);
+    uint64_t poll_us = static_cast<uint64_t>(50.0 * options.scale) + 1;
+    uint64_t start_us = SimClock::nowUs();
+    uint64_t next_us = start_us;
+    uint32_t seq = 0;
+    while (host_running) {
+        loop.runOnce(0);
+        uint64_t now = SimClock::nowUs();
+        if (now >= next_us) {
+            float vx, vy, omega;
+            missionProfile(static_cast<double>(now - start_us) * 1e-6, vx, vy, omega);
+            float command[4] = {static_cast<float>(seq & 0xFF), vx, vy, omega};
+            int16_t data[4] = {static_cast<int16_t>(seq & 0xFF), static_cast<int16_t>(seq), static_cast<int16_t>(-vx),
+                               static_cast<int16_t>(omega)};
+            altair_send_us[seq & 0xFF] = now;
+            serial_lib_send_us[seq & 0xFF] = now;
+            for (int i = 0; i < 4; i++) {
+                serial_lib_sent_data[seq & 0xFF][i] = data[i];
+            }
+            altair.send(command, 4);
+            serial_lib.send(data, 4);
+            stats.altair_sent++;
+            stats.serial_lib_sent++;
+            seq++;
+            next_us += period_us;
+        }
+        uint64_t wake = now + poll_us;
+        SimClock::sleepUntilUs(wake < next_us ? wake : next_us);
+    }
+    stats.mdd_commands = mdd.getCommands();
+    stats.mdd_errors = mdd.getErrors();
+}
+
+// ---- 結果 ----
+
+void printLink(SimSerial& uart, double seconds, uint32_t messages)
+{
+    SimSerial::Stats stats = uart.getStats();
+    double duration_us = seconds * 1e6;
+    printf("  %-10s %6d baud  %8.1f msg/s  to MCU %8.0f B/s (%5.1f%%)  from MCU %8.0f B/s (%5.1f%%)  max queue %zu  blocked %llu\n",
+           uart.getName(), uart.getBaud(), messages / seconds,
+           stats.rx_bytes / seconds, 100.0 * static_cast<double>(stats.rx_busy_us) / duration_us,
+           stats.tx_bytes / seconds, 100.0 * static_cast<double>(stats.tx_busy_us) / duration_us,
+           stats.max_tx_queue, static_cast<unsigned long long>(stats.tx_blocked));
+}
+
+void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-s scale] [-t seconds] [-b baud] [-r rate_hz] [--external]\n", name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    static const struct option long_options[] = {
+        {"scale", required_argument, nullptr, 's'},
+        {"time", required_argument, nullptr, 't'},
+        {"baud", required_argument, nullptr, 'b'},
+        {"rate", required_argument, nullptr, 'r'},
+        {"external", no_argument, nullptr, 'e'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "s:t:b:r:", long_options, nullptr)) != -1) {
+        switch (option) {
+            case 's': options.scale = atof(optarg); break;
+            case 't': options.seconds = atof(optarg); break;
+            case 'b': options.baud = atoi(optarg); break;
+            case 'r': options.rate = atof(optarg); break;
+            case 'e': options.external = true; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (options.scale <= 0.0 || options.seconds <= 0.0 || options.baud <= 0 || options.rate <= 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+    SimClock::setScale(options.scale);
+    SimClock::setThreadTimerSlack();
+
+    // UART（pty）と物理モデル
+    SimSerial altair_uart("altair", options.baud);
+    SimSerial serial_lib_uart("serial_lib", options.baud);
+    SimSerial mdd_uart("mdd", 115200);
+    altair_uart.bind(PA_9, PA_10);
+    mdd_uart.bind(MDD_TX, MDD_RX);
+    if (!altair_uart.start() || !serial_lib_uart.start() || !mdd_uart.start()) {
+        fprintf(stderr, "cannot create pty\n");
+        return 1;
+    }
+
+    SimPlant plant;
+    SimMotorConfig motor_config = SimMotor_defaultConfig();
+    motor_config.counts_per_rev = ENCODER_DEFAULT_COUNTS_PER_REV;
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        plant.motor(i).attach(MOTOR_PINS[i][0], MOTOR_PINS[i][1], ENCODER_PINS[i][0], ENCODER_PINS[i][1], motor_config);
+    }
+
+    // ファームウェア（メカナム、車輪の半径 50mm、回転中心から車輪まで 200mm）
+    RobotControl robot_control(Mecanum_Mode, 50.0, 200.0, RPS_MODE);
+    robot = &robot_control;
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        robot->configureMotor(i, MOTOR_PINS[i][0], MOTOR_PINS[i][1]);
+        robot->configureEncoder(i, ENCODER_PINS[i][0], ENCODER_PINS[i][1]);
+        robot->setPIDGains(i, 0.1f, 1.5f, 0.0f, 0.01f);
+    }
+    plant.start();
+
+    // ホスト側の pty はファームウェアが送り始める前に開いておく（開くときに古いデータを捨てるので）
+    HostPorts host_ports;
+    if (!options.external
+        && (!host_ports.altair.open(altair_uart.getSlavePath(), options.baud)
+            || !host_ports.serial_lib.open(serial_lib_uart.getSlavePath(), options.baud)
+            || !host_ports.mdd.open(mdd_uart.getSlavePath(), 115200))) {
+        fprintf(stderr, "cannot open pty\n");
+        return 1;
+    }
+
+    USART_HandleTypeDef serial_lib_handle = {&serial_lib_uart};
+    Thread altair_thread;
+    Thread serial_lib_thread;
+    Thread mdd_thread;
+    altair_thread.start([&]() { altairTask(options.baud); });
+    serial_lib_thread.start([&]() { serialLibTask(&serial_lib_handle); });
+    mdd_thread.start(mddTask);
+
+    printf("altair     %s\nserial_lib %s\nmdd        %s\n",
+           altair_uart.getSlavePath(), serial_lib_uart.getSlavePath(), mdd_uart.getSlavePath());
+    fflush(stdout);
+
+    HostStats host_stats;
+    std::thread host_thread;
+    if (!options.external) {
+        host_thread = std::thread([&]() {
+            SimClock::setThreadTimerSlack();
+            hostTask(host_ports, plant, options, host_stats);
+        });
+    }
+
+    uint64_t start_us = SimClock::nowUs();
+    uint64_t real_start_ns = SimClock::realNowNs();
+    SimClock::sleepUntilUs(start_us + static_cast<uint64_t>(options.seconds * 1e6));
+    double seconds = static_cast<double>(SimClock::nowUs() - start_us) * 1e-6;
+    double real_seconds = static_cast<double>(SimClock::realNowNs() - real_start_ns) * 1e-9;
+    // 送りかけの SkenMdd::tcp が応答を受け取れるよう、MDD 側より先にファームウェアを止める
+    firmware_running = false;
+    mdd_thread.join();
+    host_running = false;
+    if (host_thread.joinable()) {
+        host_thread.join();
+    }
+
+    plant.stop();
+    printf("\nvirtual %.2f s in %.2f s real (x%.1f), plant steps %llu\n", seconds, real_seconds, seconds / real_seconds,
+           static_cast<unsigned long long>(plant.getSteps()));
+    plant.getLag().print(stdout, "plant lag");
+    printf("links:\n");
+    printLink(altair_uart, seconds, host_stats.altair_received);
+    printLink(serial_lib_uart, seconds, host_stats.serial_lib_received);
+    printLink(mdd_uart, seconds, host_stats.mdd_commands);
+    if (!options.external) {
+        printf("round trip (virtual time):\n");
+        host_stats.altair_rtt.print(stdout, "  altair    ");
+        host_stats.serial_lib_rtt.print(stdout, "  serial_lib");
+        printf("  altair     sent %u received %u\n", host_stats.altair_sent, host_stats.altair_received);
+        printf("  serial_lib sent %u received %u mismatch %u\n", host_stats.serial_lib_sent,
+               host_stats.serial_lib_received, host_stats.serial_lib_mismatch);
+        printf("  mdd        commands %u errors %u\n", host_stats.mdd_commands, host_stats.mdd_errors);
+    }
+    mdd_tcp_latency.print(stdout, "SkenMdd::tcp");
+    printf("  failed %u\n", mdd_tcp_failed);
+    if (host_stats.tracking_samples > 0) {
+        printf("wheel tracking error: rms %.3f rps, max %.3f rps\n",
+               sqrt(host_stats.tracking_square_sum / host_stats.tracking_samples), host_stats.tracking_max);
+    }
+    fflush(stdout);
+
+    // AltairSerial / serial_lib のスレッドは受信を待ったまま戻らない（マイコンと同じ）ので、後片付けせずに終わる
+    quick_exit(0);
+}
@@ -0,0 +1,209 @@
+#include "SweepEpisode.h"
+
+#include <math.h>
+
+namespace {
+
+const float PI = 3.14159265f;
+const float SQRT2 = 1.41421356f;
+
+float uniform(std::mt19937_64& random, float low, float high)
+{
+    return (high > low) ? std::uniform_real_distribution<float>(low, high)(random) : low;
+}
+
+}  // namespace
+
+SweepConfig SweepConfig_default()
+{
+    SweepConfig config;
+    config.wheel_radius = 50.0f;
+    config.turning_radius = 200.0f;
+    config.vx_step = 600.0f;
+    config.omega_step = 180.0f;
+    config.phase_time = 1.0f;
+    config.control_period = 0.01f;
+    config.plant_step = 1.0e-4f;
+    config.settle_band = 0.05f;
+    config.settle_hold = 0.2f;
+    config.steady_band = 0.03f;
+    config.pid_tf = 0.01f;
+    // SIL と同じモータ。慣性の 3/4 をギヤの先（車輪の側）に置き、バックラッシュがあるときはそこで分かれる
+    config.motor = SimMotor_defaultConfig();
+    config.motor.inertia = 0.5e-4f;
+    config.motor.load_inertia = 1.5e-4f;
+    config.variation.friction_min = 0.5f;
+    config.variation.friction_max = 2.0f;
+    config.variation.backlash_max = 2.0f;
+    config.variation.encoder_noise = 1.0f;
+    config.variation.radius_spread = 0.02f;
+    return config;
+}
+
+SweepEpisode::SweepEpisode(const SweepConfig& config, const SweepGains& gains, uint64_t seed) :
+    config(config), gains(gains), random(seed),
+    noise(0.0f, config.variation.encoder_noise > 0.0f ? config.variation.encoder_noise : 1.0f),
+    kinematics(config.wheel_radius, gains.turning_radius, RPS_MODE),
+    profile(config.control_period)
+{
+    // 旋回の加速度は、車輪の周速が並進と同じ加速度になる値
+    float omega_accel = gains.max_accel / gains.turning_radius * 180.0f / PI;
+    MotionProfileConfig motion = {{gains.max_accel, gains.max_accel, omega_accel}, {0.0f, 0.0f, 0.0f}, 0.0f};
+    profile.setConfig(motion);
+
+    const SweepVariation& variation = config.variation;
+    true_turning_radius = config.turning_radius * (1.0f + uniform(random, -variation.radius_spread, variation.radius_spread));
+    for (int i = 0; i < WHEELS; i++) {
+        SimMotorConfig motor = config.motor;
+        motor.coulomb *= uniform(random, variation.friction_min, variation.friction_max);
+        motor.viscous *= uniform(random, variation.friction_min, variation.friction_max);
+        motor.backlash = uniform(random, 0.0f, variation.backlash_max) * PI / 180.0f;
+        motors[i].setConfig(motor);
+        motors[i].reset();
+
+        PidCore_Init(&pids[i]);
+        PidCore_setGain(&pids[i], gains.kp, gains.ki, gains.kd, config.pid_tf);
+        last_counts[i] = 0;
+    }
+}
+
+SweepScore SweepEpisode::run()
+{
+    int steps_per_control = static_cast<int>(lroundf(config.control_period / config.plant_step));
+    int controls_per_phase = static_cast<int>(lroundf(config.phase_time / config.control_period));
+    // 1 段目の vx、2 段目の vx と ω
+    StepTrack steps[3] = {
+        {0.0f, config.vx_step, 0.0f, 0.0f, 0.0f, 0},
+        {config.vx_step, 0.0f, 0.0f, 0.0f, 0.0f, 0},
+        {0.0f, config.omega_step, 0.0f, 0.0f, 0.0f, 0}
+    };
+    float energy = 0.0f;
+    float duties[WHEELS] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (int phase = 0; phase < 2; phase++) {
+        if (phase == 0) {
+            setTarget(config.vx_step, 0.0f, 0.0f);
+        } else {
+            setTarget(0.0f, 0.0f, config.omega_step);
+        }
+        int step_count = 0;
+        for (int k = 0; k < controls_per_phase; k++) {
+            control(duties);
+            for (int s = 0; s < steps_per_control; s++) {
+                float speed[WHEELS];   // 車輪の周速 [mm/s]
+                for (int i = 0; i < WHEELS; i++) {
+                    // MotorDriver::setDuty と同じ（0 はフリーラン、上限 0.95）
+                    float duty = duties[i];
+                    float duty1 = (duty > 0.0f) ? fminf(duty, 0.95f) : 0.0f;
+                    float duty2 = (duty < 0.0f) ? fminf(-duty, 0.95f) : 0.0f;
+                    motors[i].step(duty1, duty2, 0.0f, config.plant_step);
+                    if (motors[i].getPower() > 0.0f) {
+                        energy += motors[i].getPower() * config.plant_step;
+                    }
+                    speed[i] = motors[i].getOmega() * config.wheel_radius;
+                }
+                // Mecanum::calc の逆（実際の旋回半径で ω に直す）
+                float vx = (-speed[0] - speed[1] + speed[2] + speed[3]) * SQRT2 / 4.0f;
+                float omega = (speed[0] + speed[1] + speed[2] + speed[3]) / 4.0f / true_turning_radius * 180.0f / PI;
+                float t = static_cast<float>(++step_count) * config.plant_step;
+                if (phase == 0) {
+                    track(steps[0], vx, t);
+                } else {
+                    track(steps[1], vx, t);
+                    track(steps[2], omega, t);
+                }
+            }
+        }
+    }
+
+    // 整定しないまま段が終わる・範囲の中でも偏差が残る候補は、速さや省エネで勝っても使えない
+    SweepScore score = {0.0f, 0.0f, energy, 0.0f, true};
+    for (const StepTrack& step : steps) {
+        score.settling_time = fmaxf(score.settling_time, settlingTime(step));
+        score.overshoot = fmaxf(score.overshoot, overshoot(step));
+        score.steady_error = fmaxf(score.steady_error, steadyError(step));
+        if (settlingTime(step) > config.phase_time - config.settle_hold || !(steadyError(step) <= config.steady_band * 100.0f)) {
+            score.feasible = false;
+        }
+    }
+    return score;
+}
+
+// RobotControl::setTarget と同じ（運動学で出せる速度に縮めてからプロファイルの目標にする）
+void SweepEpisode::setTarget(float vx, float vy, float omega)
+{
+    MotorControlData data = {};
+    AppliedTwist applied = kinematics.calc(vx, vy, omega, data);
+    profile.setTarget(static_cast<float>(applied.vx_mm_s), static_cast<float>(applied.vy_mm_s),
+                      static_cast<float>(applied.omega_deg_s));
+}
+
+// RobotControl::updateMotion / updateWheels の 1 周期
+void SweepEpisode::control(float duties[WHEELS])
+{
+    MotorControlData data = {};
+    profile.update();
+    AppliedTwist applied = kinematics.calc(profile.getVx(), profile.getVy(), profile.getOmega(), data);
+    if (applied.saturated) {
+        profile.limitVelocity(applied.vx_mm_s, applied.vy_mm_s, applied.omega_deg_s);
+    }
+    for (int i = 0; i < WHEELS; i++) {
+        int32_t count = readEncoder(i);
+        float rps = static_cast<float>(count - last_counts[i]) / config.motor.counts_per_rev / config.control_period;
+        last_counts[i] = count;
+        float target = static_cast<float>(data.motor_data[i].target_value);
+        // RobotControl と同じく、PID の飽和を出力段で Duty が上限に張り付くところに合わせる
+        float limit = outputs[i].getMaxDuty();
+        float offset = outputs[i].getFeedforward(target);
+        PidCore_setOutputLimit(&pids[i], -limit - offset, limit - offset);
+        float control_signal = PidCore_update(&pids[i], target, rps, config.control_period);
+        duties[i] = outputs[i].update(control_signal, target, config.control_period, limit);
+    }
+}
+
+// エンコーダのカウント（出力側の角度を量子化し、ノイズを足す）
+int32_t SweepEpisode::readEncoder(int wheel)
+{
+    double counts = floor(motors[wheel].getAngle() / (2.0 * PI) * config.motor.counts_per_rev);
+    if (config.variation.encoder_noise > 0.0f) {
+        counts += static_cast<double>(lroundf(noise(random)));
+    }
+    return static_cast<int32_t>(counts);
+}
+
+void SweepEpisode::track(StepTrack& step, float value, float t) const
+{
+    float size = step.to - step.from;
+    float error = value - step.to;
+    if (fabsf(error) > config.settle_band * fabsf(size)) {
+        step.last_outside = t;
+    }
+    if (t > config.phase_time - config.settle_hold) {
+        step.error_sum += error;
+        step.error_count++;
+    }
+    float over = (size > 0.0f) ? error : -error;
+    if (over > step.peak) {
+        step.peak = over;
+    }
+}
+
+float SweepEpisode::settlingTime(const StepTrack& step)
+{
+    return step.last_outside;
+}
+
+float SweepEpisode::overshoot(const StepTrack& step)
+{
+    float size = fabsf(step.to - step.from);
+    return (size > 0.0f) ? step.peak / size * 100.0f : 0.0f;
+}
+
+float SweepEpisode::steadyError(const StepTrack& step)
+{
+    float size = fabsf(step.to - step.from);
+    if (size <= 0.0f || step.error_count == 0) {
+        return 0.0f;
+    }
+    return fabsf(step.error_sum / static_cast<float>(step.error_count)) / size * 100.0f;
+}
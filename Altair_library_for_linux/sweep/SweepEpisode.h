@@ -0,0 +1,108 @@
+#ifndef SWEEP_EPISODE_H
+#define SWEEP_EPISODE_H
+
+#include <stdint.h>
+#include <random>
+#include "pid_core.h"
+#include "Kinematics.h"
+#include "MotionProfile.h"
+#include "MotorOutput.h"
+#include "MotorModel.h"
+
+// ゲイン探索の 1 エピソード（4 輪メカナムの閉ループを、実時間を待たずに最後まで回す）
+//   - 制御側は RobotControl と同じ順（MotionProfile → Mecanum::calc → 車輪ごとの PidCore → MotorOutput → Duty）で、
+//     マイコン側と同じヘッダ（pid_core.h / MotionProfile.h / Kinematics.h / MotorOutput.h）をそのまま使う
+//   - モータは MotorModel。摩擦・ギヤのバックラッシュ・エンコーダのノイズ・実際の旋回半径をエピソードごとに乱数で変える
+//   - 指令は 2 段のステップ（前進 vx_step → 止まって旋回 omega_step）。車輪の本当の回転数から機体速度を出して採点する
+//   - 段の終わりの settle_hold 秒に整定の範囲に入っていないか、その間の平均の誤差が steady_band を超えれば、使えない（feasible = false）
+// 1 つのエピソードは制御器もモータも乱数も自分だけで持つので、別々のスレッドでいくつでも同時に回せる
+
+// 探索する値（1 つの候補）
+struct SweepGains {
+    float kp;
+    float ki;
+    float kd;
+    float max_accel;        // MotionProfile の並進の加速度上限 [mm/s²]（旋回は max_accel / 旋回半径）
+    float turning_radius;   // Mecanum に渡す旋回半径 [mm]
+};
+
+// 乱数で変えるモータの値の範囲
+struct SweepVariation {
+    float friction_min;     // 動摩擦・粘性摩擦に掛ける倍率の範囲
+    float friction_max;
+    float backlash_max;     // ギヤの遊び [deg]（0〜backlash_max）
+    float encoder_noise;    // エンコーダの読みに足すノイズの標準偏差 [カウント]
+    float radius_spread;    // 実際の旋回半径のばらつき（±割合）
+};
+
+struct SweepConfig {
+    float wheel_radius;     // 車輪の半径 [mm]
+    float turning_radius;   // 実際の旋回半径の中心 [mm]
+    float vx_step;          // 1 段目の前進速度 [mm/s]
+    float omega_step;       // 2 段目の旋回速度 [deg/s]
+    float phase_time;       // 1 段の長さ [s]
+    float control_period;   // 制御周期 [s]
+    float plant_step;       // モータの積分の刻み [s]
+    float settle_band;      // 整定とみなす誤差（ステップの大きさに対する割合）
+    float settle_hold;      // 段の終わりに整定の範囲に入っていなければならない時間 [s]
+    float steady_band;      // 段の終わりの settle_hold 秒の平均の誤差の上限（ステップの大きさに対する割合）
+    float pid_tf;           // D 項フィルタの時定数 [s]
+    SimMotorConfig motor;   // モータの中心値
+    SweepVariation variation;
+};
+
+// 既定値（RobotControl の例と同じ 10ms 周期、車輪の半径 50mm、旋回半径 200mm）
+SweepConfig SweepConfig_default();
+
+// 1 エピソードの採点（どれも小さいほど良い）
+struct SweepScore {
+    float settling_time;    // 遅い方のステップの整定時間 [s]（整定しなければ phase_time）
+    float overshoot;        // 最大のオーバーシュート [%]
+    float energy;           // 4 輪で電源から取ったエネルギー [J]
+    float steady_error;     // 段の終わりの settle_hold 秒の平均の誤差の最大 [%]
+    bool feasible;          // 全部のステップが段の終わりまでに整定し、定常偏差が steady_band 以内
+};
+
+class SweepEpisode {
+public:
+    static const int WHEELS = 4;
+
+    // seed が同じなら、どのスレッドで回しても同じ結果になる
+    SweepEpisode(const SweepConfig& config, const SweepGains& gains, uint64_t seed);
+
+    SweepScore run();
+
+private:
+    // ステップ 1 つ分の採点
+    struct StepTrack {
+        float from;
+        float to;
+        float peak;            // to を越えた最大の量（ステップの向き）
+        float last_outside;    // 最後に整定の範囲の外にいた時刻 [s]（段の始めから）
+        float error_sum;       // 段の終わりの settle_hold 秒の誤差の和
+        int error_count;
+    };
+
+    SweepConfig config;
+    SweepGains gains;
+    std::mt19937_64 random;
+    std::normal_distribution<float> noise;
+    float true_turning_radius;
+
+    Mecanum kinematics;
+    MotionProfile profile;
+    PidCore pids[WHEELS];
+    MotorOutput outputs[WHEELS];
+    MotorModel motors[WHEELS];
+    int32_t last_counts[WHEELS];
+
+    void setTarget(float vx, float vy, float omega);
+    void control(float duties[WHEELS]);
+    int32_t readEncoder(int wheel);
+    void track(StepTrack& step, float value, float t) const;
+    static float settlingTime(const StepTrack& step);
+    static float overshoot(const StepTrack& step);
+    static float steadyError(const StepTrack& step);
+};
+
+#endif // SWEEP_EPISODE_H
@@ -0,0 +1,120 @@
+#include "WorkStealingPool.h"
+
+namespace {
+
+// 今のスレッドがどのプールの何番目のスレッドか（プールの外なら nullptr）
+thread_local WorkStealingPool* current_pool = nullptr;
+thread_local unsigned current_index = 0;
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned count) :
+    pending(0), queued(0), next_worker(0), steals(0), stopping(false)
+{
+    if (count == 0) {
+        count = std::thread::hardware_concurrency();
+    }
+    if (count == 0) {
+        count = 1;
+    }
+    for (unsigned i = 0; i < count; i++) {
+        workers.emplace_back(new Worker);
+    }
+    for (unsigned i = 0; i < count; i++) {
+        threads.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    unsigned index = (current_pool == this)
+        ? current_index
+        : static_cast<unsigned>(next_worker++ % workers.size());
+    pending++;
+    queued++;
+    {
+        std::lock_guard<std::mutex> guard(workers[index]->mutex);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // 眠ろうとしているスレッドが queued を見てから眠るまでの間に起こさないよう、mutex を通してから起こす
+        std::lock_guard<std::mutex> guard(mutex);
+    }
+    work_ready.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> guard(mutex);
+    all_done.wait(guard, [this]() { return pending == 0; });
+}
+
+void WorkStealingPool::parallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+    for (size_t i = 0; i < count; i++) {
+        submit([&func, i]() { func(i); });
+    }
+    wait();
+}
+
+void WorkStealingPool::run(unsigned index)
+{
+    current_pool = this;
+    current_index = index;
+    for (;;) {
+        Task task;
+        if (take(index, task)) {
+            task();
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> guard(mutex);
+                all_done.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(mutex);
+        work_ready.wait(guard, [this]() { return queued > 0 || stopping; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+// 自分のキューの後ろから取り、なければほかのスレッドのキューの前から盗む
+bool WorkStealingPool::take(unsigned index, Task& task)
+{
+    {
+        Worker& self = *workers[index];
+        std::lock_guard<std::mutex> guard(self.mutex);
+        if (!self.tasks.empty()) {
+            task = std::move(self.tasks.back());
+            self.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    for (size_t i = 1; i < workers.size(); i++) {
+        Worker& victim = *workers[(index + i) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued--;
+            steals++;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,66 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ワークスティーリングのスレッドプール
+//   - スレッドごとに仕事の両端キューを持ち、自分のキューは後ろから取る（直前に積んだ仕事の続きを同じコアで）
+//   - 自分のキューが空になったら、ほかのスレッドのキューの前から盗む（古い＝大きな仕事を持っていく）
+//   - 仕事の長さがばらついても（収束の遅いエピソードなど）、空いたスレッドが残りを引き取るので最後まで全コアが埋まる
+// 仕事の中から submit してよい（そのスレッドのキューに積む）
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task;
+
+    // threads：スレッドの数（0 でコアの数）
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // 仕事を積む（プールの外からはスレッドのキューに順番に配る）
+    void submit(Task task);
+
+    // 積んだ仕事が全部終わるまで待つ（プールの外から呼ぶ）
+    void wait();
+
+    // [0, count) の各 i で func(i) を呼び、全部終わるまで待つ（プールの外から呼ぶ）
+    void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+    unsigned getThreads() const { return static_cast<unsigned>(workers.size()); }
+
+    // ほかのスレッドから盗んだ回数
+    uint64_t getSteals() const { return steals; }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::mutex mutex;                 // sleeping / pending の待ち合わせ用
+    std::condition_variable work_ready;
+    std::condition_variable all_done;
+    std::atomic<size_t> pending;      // 積んだがまだ終わっていない仕事の数
+    std::atomic<size_t> queued;       // キューに入っている仕事の数
+    std::atomic<size_t> next_worker;  // プールの外から積むときの配り先
+    std::atomic<uint64_t> steals;
+    bool stopping;
+
+    void run(unsigned index);
+    bool take(unsigned index, Task& task);
+};
+
+#endif // WORK_STEALING_POOL_H
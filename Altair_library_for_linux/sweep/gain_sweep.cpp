@@ -0,0 +1,259 @@
+// ゲインのモンテカルロ探索
+//   - 候補（PID のゲイン・MotionProfile の加速度上限・Mecanum の旋回半径）を範囲から乱数で n 個選ぶ
+//   - 候補ごとに、モータの摩擦・バックラッシュ・エンコーダのノイズ・実際の旋回半径を変えた m 回のエピソードを回す
+//   - エピソードは 1 つずつ WorkStealingPool の仕事にして、全コアで並列に回す（制御器はエピソードごとに別のもの）
+//   - 整定しないエピソード・定常偏差が残るエピソードが 1 つでもある候補は使えないとして外し、
+//     残りの候補の中で、整定時間・オーバーシュート・エネルギーの平均でパレート最適な候補を出す
+// 結果は --seed が同じならスレッドの数によらず同じ
+//
+// 使い方：gain_sweep [-n 候補の数] [-m 1 候補のエピソードの数] [-j スレッドの数] [--seed 値] [-o CSV]
+//                    [--kp 下限:上限] [--ki 下限:上限] [--kd 下限:上限] [--accel 下限:上限] [--radius 下限:上限]
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "SweepEpisode.h"
+#include "WorkStealingPool.h"
+
+namespace {
+
+// 探索の範囲（下限 > 0 なら対数で一様、そうでなければ一様）
+struct Range {
+    float low;
+    float high;
+};
+
+struct Options {
+    int candidates = 200;
+    int episodes = 16;
+    unsigned threads = 0;
+    uint64_t seed = 1;
+    const char* output = nullptr;
+    // 既定の範囲は、使える候補が半分以上になるところ（kp 0.2 以上・kd 0.004 以上は振動、ki 0.3 以下は追いつかない、
+    // 加速度 800 以下は 1 段で届かない、旋回半径が実際の値から 2% 以上離れると ω に定常偏差が残る）
+    Range kp = {0.01f, 0.1f};
+    Range ki = {0.5f, 5.0f};
+    Range kd = {0.0f, 0.0025f};
+    Range accel = {1000.0f, 20000.0f};
+    Range radius = {197.0f, 203.0f};
+};
+
+// 1 候補の結果（エピソードの平均と、整定時間の最悪値）
+struct Candidate {
+    SweepGains gains;
+    SweepScore mean;            // feasible は全エピソードが使えるとき true
+    float worst_settling_time;
+    int infeasible;             // 使えなかったエピソードの数
+    bool pareto;
+};
+
+float sample(std::mt19937_64& random, const Range& range)
+{
+    if (range.high <= range.low) {
+        return range.low;
+    }
+    if (range.low > 0.0f) {
+        std::uniform_real_distribution<float> log_uniform(logf(range.low), logf(range.high));
+        return expf(log_uniform(random));
+    }
+    return std::uniform_real_distribution<float>(range.low, range.high)(random);
+}
+
+// 候補とエピソードの番号から決まるシード（SplitMix64 で混ぜる）
+uint64_t episodeSeed(uint64_t seed, int candidate, int episode)
+{
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (static_cast<uint64_t>(candidate) * 1000003ULL + static_cast<uint64_t>(episode) + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// a が b 以下で、どれか 1 つは小さい
+bool dominates(const SweepScore& a, const SweepScore& b)
+{
+    bool no_worse = a.settling_time <= b.settling_time && a.overshoot <= b.overshoot && a.energy <= b.energy;
+    bool better = a.settling_time < b.settling_time || a.overshoot < b.overshoot || a.energy < b.energy;
+    return no_worse && better;
+}
+
+// 使えない候補は前に出さず、比べる相手にもしない（成績の数字が良くても、整定しないなら意味がない）
+void markPareto(std::vector<Candidate>& candidates)
+{
+    for (Candidate& candidate : candidates) {
+        candidate.pareto = candidate.mean.feasible;
+        if (!candidate.pareto) {
+            continue;
+        }
+        for (const Candidate& other : candidates) {
+            if (other.mean.feasible && dominates(other.mean, candidate.mean)) {
+                candidate.pareto = false;
+                break;
+            }
+        }
+    }
+}
+
+bool parseRange(const char* text, Range& range)
+{
+    return sscanf(text, "%f:%f", &range.low, &range.high) == 2 && range.low <= range.high;
+}
+
+bool writeCsv(const char* path, const std::vector<Candidate>& candidates)
+{
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "kp,ki,kd,max_accel,turning_radius,settling_time,overshoot,energy,steady_error,worst_settling_time,"
+                  "infeasible_episodes,pareto\n");
+    for (const Candidate& c : candidates) {
+        fprintf(file, "%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%d,%d\n",
+                c.gains.kp, c.gains.ki, c.gains.kd, c.gains.max_accel, c.gains.turning_radius,
+                c.mean.settling_time, c.mean.overshoot, c.mean.energy, c.mean.steady_error, c.worst_settling_time,
+                c.infeasible, c.pareto ? 1 : 0);
+    }
+    return fclose(file) == 0;
+}
+
+void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-n candidates] [-m episodes] [-j threads] [--seed value] [-o csv]\n"
+                    "       [--kp lo:hi] [--ki lo:hi] [--kd lo:hi] [--accel lo:hi] [--radius lo:hi]\n", name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    static const struct option long_options[] = {
+        {"candidates", required_argument, nullptr, 'n'},
+        {"episodes", required_argument, nullptr, 'm'},
+        {"threads", required_argument, nullptr, 'j'},
+        {"output", required_argument, nullptr, 'o'},
+        {"seed", required_argument, nullptr, 's'},
+        {"kp", required_argument, nullptr, 'P'},
+        {"ki", required_argument, nullptr, 'I'},
+        {"kd", required_argument, nullptr, 'D'},
+        {"accel", required_argument, nullptr, 'A'},
+        {"radius", required_argument, nullptr, 'R'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int option;
+    bool ranges_ok = true;
+    while ((option = getopt_long(argc, argv, "n:m:j:o:", long_options, nullptr)) != -1) {
+        switch (option) {
+            case 'n': options.candidates = atoi(optarg); break;
+            case 'm': options.episodes = atoi(optarg); break;
+            case 'j': options.threads = static_cast<unsigned>(atoi(optarg)); break;
+            case 'o': options.output = optarg; break;
+            case 's': options.seed = strtoull(optarg, nullptr, 0); break;
+            case 'P': ranges_ok &= parseRange(optarg, options.kp); break;
+            case 'I': ranges_ok &= parseRange(optarg, options.ki); break;
+            case 'D': ranges_ok &= parseRange(optarg, options.kd); break;
+            case 'A': ranges_ok &= parseRange(optarg, options.accel); break;
+            case 'R': ranges_ok &= parseRange(optarg, options.radius); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (options.candidates <= 0 || options.episodes <= 0 || !ranges_ok
+        || options.accel.low <= 0.0f || options.radius.low <= 0.0f) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // 候補は主スレッドで先に選んでおく（スレッドの数で結果が変わらないように）
+    const SweepConfig config = SweepConfig_default();
+    std::mt19937_64 random(options.seed);
+    std::vector<Candidate> candidates(options.candidates);
+    for (Candidate& candidate : candidates) {
+        candidate.gains.kp = sample(random, options.kp);
+        candidate.gains.ki = sample(random, options.ki);
+        candidate.gains.kd = sample(random, options.kd);
+        candidate.gains.max_accel = sample(random, options.accel);
+        candidate.gains.turning_radius = sample(random, options.radius);
+    }
+
+    // エピソードごとの結果は自分の場所に書くだけなので、ロックはいらない
+    size_t total = static_cast<size_t>(options.candidates) * static_cast<size_t>(options.episodes);
+    std::vector<SweepScore> scores(total);
+    WorkStealingPool pool(options.threads);
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(total, [&](size_t index) {
+        int candidate = static_cast<int>(index / options.episodes);
+        int episode = static_cast<int>(index % options.episodes);
+        SweepEpisode run(config, candidates[candidate].gains, episodeSeed(options.seed, candidate, episode));
+        scores[index] = run.run();
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int feasible = 0;
+    int unsettled = 0;      // 整定しないエピソードがある候補
+    int offset = 0;         // 整定はするが、定常偏差が残るエピソードがある候補
+    for (size_t c = 0; c < candidates.size(); c++) {
+        Candidate& candidate = candidates[c];
+        candidate.mean = {0.0f, 0.0f, 0.0f, 0.0f, true};
+        candidate.worst_settling_time = 0.0f;
+        candidate.infeasible = 0;
+        bool any_unsettled = false;
+        for (int e = 0; e < options.episodes; e++) {
+            const SweepScore& score = scores[c * options.episodes + e];
+            candidate.mean.settling_time += score.settling_time / options.episodes;
+            candidate.mean.overshoot += score.overshoot / options.episodes;
+            candidate.mean.energy += score.energy / options.episodes;
+            candidate.mean.steady_error += score.steady_error / options.episodes;
+            candidate.worst_settling_time = std::max(candidate.worst_settling_time, score.settling_time);
+            if (!score.feasible) {
+                candidate.infeasible++;
+                any_unsettled = any_unsettled || score.settling_time > config.phase_time - config.settle_hold;
+            }
+        }
+        candidate.mean.feasible = candidate.infeasible == 0;
+        if (candidate.mean.feasible) {
+            feasible++;
+        } else if (any_unsettled) {
+            unsettled++;
+        } else {
+            offset++;
+        }
+    }
+    markPareto(candidates);
+
+    printf("%zu episodes (%d candidates x %d) on %u threads: %.2f s, %.1f episodes/s, %llu steals\n",
+           total, options.candidates, options.episodes, pool.getThreads(), seconds, total / seconds,
+           static_cast<unsigned long long>(pool.getSteals()));
+
+    std::vector<const Candidate*> front;
+    for (const Candidate& candidate : candidates) {
+        if (candidate.pareto) {
+            front.push_back(&candidate);
+        }
+    }
+    std::sort(front.begin(), front.end(), [](const Candidate* a, const Candidate* b) {
+        return a->mean.settling_time < b->mean.settling_time;
+    });
+    printf("feasible %d of %d (every episode settles within %.1f s with a steady error under %.0f%%): "
+           "%d never settle, %d keep a steady error\n",
+           feasible, options.candidates, config.phase_time - config.settle_hold, config.steady_band * 100.0f,
+           unsettled, offset);
+    printf("pareto front (%zu of %d):\n", front.size(), feasible);
+    printf("  %8s %8s %8s %8s %7s | %8s %8s %8s %8s %8s\n",
+           "kp", "ki", "kd", "accel", "radius", "settle", "over%", "energyJ", "steady%", "worst");
+    for (const Candidate* c : front) {
+        printf("  %8.4f %8.3f %8.5f %8.0f %7.1f | %8.3f %8.2f %8.2f %8.2f %8.3f\n",
+               c->gains.kp, c->gains.ki, c->gains.kd, c->gains.max_accel, c->gains.turning_radius,
+               c->mean.settling_time, c->mean.overshoot, c->mean.energy, c->mean.steady_error, c->worst_settling_time);
+    }
+
+    if (options.output != nullptr && !writeCsv(options.output, candidates)) {
+        fprintf(stderr, "cannot write %s\n", options.output);
+        return 1;
+    }
+    return 0;
+}
@@ -2,7 +2,14 @@
 #define ALTAIR_SERIAL_H
 
 #include "mbed.h"
-#include <cstring>  // memcpyを使うため
+#include "frame_core.h"
+#include "msg_core.h"
+
+// float の配列を frame_core のフレーム（COBS + CRC-16、区切り 0x00）で送受信する
+// ペイロードは float（リトルエンディアン 4 バイト）を並べたもの（msg_core.h）
+
+// 1 フレームで送受信できる float の最大数
+#define ALTAIR_SERIAL_MAX_FLOATS (FRAME_MAX_PAYLOAD / 4)
 
 enum USBMode {
     USB_A,
@@ -26,45 +33,42 @@ public:
         }
     }
 
-    // Float型配列をヘッダーとともに送信
+    // Float型配列をフレームにして送信（length は ALTAIR_SERIAL_MAX_FLOATS まで）
     void sendFloatArrayWithHeader(float* data, int length) {
-        uint8_t header = 0xA5;
-        serial->write(&header, 1);  // ヘッダー送信
-        for (int i = 0; i < length; i++) {
-            sendFloat(data[i]);  // 各floatを送信
+        uint8_t frame[FRAME_ENCODED_SIZE(ALTAIR_SERIAL_MAX_FLOATS * 4)];
+        if (length > ALTAIR_SERIAL_MAX_FLOATS) {
+            length = ALTAIR_SERIAL_MAX_FLOATS;
+        }
+        if (length < 0) {
+            length = 0;
         }
+        uint8_t* payload = Frame_payload(frame);
+        uint8_t* end = MsgCore_putArray_float(payload, data, (uint16_t)length);
+        serial->write(frame, Frame_encode(frame, (uint16_t)(end - payload)));
     }
 
-    // ヘッダー付きのFloat型配列を受信
+    // Float型配列のフレームを受信
+    // length に buffer の要素数を渡すと、正しいフレームを受け取るまで待ち、受け取った個数を length に返す
+    // 壊れたフレーム・buffer に入り切らないフレームは読み捨てる
     void receiveFloatArrayWithHeader(float* buffer, int& length) {
-        uint8_t header;
-        do {
-            serial->read(&header, 1);  // ヘッダー待ち
-        } while (header != 0xA5);
-
-        for (int i = 0; i < length; i++) {
-            buffer[i] = receiveFloat();  // 各floatを受信
+        uint8_t frame[FRAME_ENCODED_SIZE(ALTAIR_SERIAL_MAX_FLOATS * 4)];
+        FrameReceiver receiver;
+        FrameReceiver_Init(&receiver, frame, sizeof(frame));
+        for (;;) {
+            uint8_t byte;
+            serial->read(&byte, 1);
+            if (FrameReceiver_push(&receiver, byte)
+                && receiver.payload_length % sizeof(float) == 0
+                && receiver.payload_length <= (size_t)length * sizeof(float)) {
+                break;
+            }
         }
+        length = (int)(receiver.payload_length / sizeof(float));
+        MsgCore_getArray_float(receiver.payload, buffer, (uint16_t)length);
     }
 
 private:
     BufferedSerial* serial;
-
-    // Floatをバイト列に変換して送信
-    void sendFloat(float value) {
-        uint8_t floatBytes[sizeof(float)];
-        memcpy(floatBytes, &value, sizeof(float));
-        serial->write(floatBytes, sizeof(float));
-    }
-
-    // バイト列をFloatに変換して受信
-    float receiveFloat() {
-        uint8_t floatBytes[sizeof(float)];
-        serial->read(floatBytes, sizeof(float));
-        float value;
-        memcpy(&value, floatBytes, sizeof(float));
-        return value;
-    }
 };
 
 #endif
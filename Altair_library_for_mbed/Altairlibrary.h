@@ -4,16 +4,29 @@
 #define ALTAIRLIBRARY_H
 
 #include "AltairSerial.h"
+#include "msg_schema.h"
 #include "mdd.h"
+#include "can_mdd.h"
+#include "Timebase.h"
+#include "hal_policy.h"
 #include "encoder.h"
 #include "rtos.h"
 #include "MotorDriver.h"
+#include "MotorGroup.h"
 #include "PIDController.h"
+#include "pid_autotune.h"
+#include "GainSchedule.h"
+#include "MotionProfile.h"
 #include "Servo.h"
+#include "ServoGroup.h"
 #include "TwoWheelKinematics.h"
 #include "Kinematics.h"
 #include "robot_control.h"
+#include "StaticRobotControl.h"
+#include "MultiRateExecutive.h"
+#include "safety_monitor.h"
 #include "InverseKinematics.h"
+#include "PathFollower.h"
 #include "incenc.h"
 
 #endif // ALTAIRLIBRARY_H
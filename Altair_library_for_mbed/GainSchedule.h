@@ -0,0 +1,112 @@
+#ifndef GAIN_SCHEDULE_H
+#define GAIN_SCHEDULE_H
+
+#include <math.h>
+
+// 目標回転数をキーにしたゲインスケジューリング＋フィードフォワード表
+//   - ブレークポイント間は区分線形補間、範囲外は端の値で止める
+//   - 表は constexpr 配列で書けばフラッシュ（.rodata）に置かれ、RAM を使わない
+//   - ブレークポイントが等間隔なら O(1)（添字の計算）、そうでなければ二分探索で O(log n)
+//   - nominal_voltage を設定すると、電池電圧に反比例してゲインとフィードフォワードを補正する
+// mbed / Arduino で同一内容
+struct GainSchedulePoint {
+    float rps;   // ブレークポイント（目標回転数の絶対値）
+    float kp;
+    float ki;
+    float kd;
+    float ff;    // フィードフォワード Duty（目標回転数の符号を付けて出力に加算）
+};
+
+class GainSchedule {
+public:
+    // constexpr GainSchedulePoint table[] = {...};
+    // constexpr GainSchedule schedule(table, 12.0f);  // ← 記述子ごとフラッシュに置ける
+    template <int N>
+    constexpr GainSchedule(const GainSchedulePoint (&points)[N], float nominal_voltage = 0.0f)
+        : points(points), count(N),
+          step(uniformStep(points, N)),
+          inv_step(step > 0.0f ? 1.0f / step : 0.0f),
+          nominal_voltage(nominal_voltage) {}
+
+    // 目標回転数 rps（符号付き）でのゲインとフィードフォワードを返す
+    // battery_voltage: 現在の電池電圧（0 または nominal_voltage 未設定なら補正なし）
+    GainSchedulePoint lookup(float rps, float battery_voltage = 0.0f) const {
+        float x = fabsf(rps);
+        GainSchedulePoint result;
+
+        if (count == 1 || x <= points[0].rps) {
+            result = points[0];
+        } else if (x >= points[count - 1].rps) {
+            result = points[count - 1];
+        } else {
+            int i = segment(x);
+            const GainSchedulePoint& a = points[i];
+            const GainSchedulePoint& b = points[i + 1];
+            float t = (x - a.rps) / (b.rps - a.rps);
+            result.kp = a.kp + (b.kp - a.kp) * t;
+            result.ki = a.ki + (b.ki - a.ki) * t;
+            result.kd = a.kd + (b.kd - a.kd) * t;
+            result.ff = a.ff + (b.ff - a.ff) * t;
+        }
+        result.rps = rps;
+
+        // Duty → 電圧の比が電池電圧に比例するので、ゲインは電圧に反比例させる
+        if (nominal_voltage > 0.0f && battery_voltage > 0.0f) {
+            float scale = nominal_voltage / battery_voltage;
+            result.kp *= scale;
+            result.ki *= scale;
+            result.kd *= scale;
+            result.ff *= scale;
+        }
+        if (rps < 0.0f) {
+            result.ff = -result.ff;
+        }
+        return result;
+    }
+
+    bool isUniform() const { return step > 0.0f; }
+    int size() const { return count; }
+
+private:
+    const GainSchedulePoint* points;
+    int count;
+    float step;       // 等間隔表の間隔（不等間隔なら 0）
+    float inv_step;
+    float nominal_voltage;
+
+    // points[i].rps <= x < points[i + 1].rps となる i（x は表の範囲内）
+    int segment(float x) const {
+        if (step > 0.0f) {
+            int i = static_cast<int>((x - points[0].rps) * inv_step);
+            if (i > count - 2) i = count - 2;
+            // 等間隔の判定は 1e-4 の揺れを許すので、ブレークポイントの近くでは隣の区間を指すことがある。ずれた分だけ動かして合わせる
+            while (i > 0 && x < points[i].rps) i--;
+            while (i < count - 2 && x >= points[i + 1].rps) i++;
+            return i;
+        }
+        int lo = 0;
+        int hi = count - 1;
+        while (hi - lo > 1) {
+            int mid = (lo + hi) / 2;
+            if (points[mid].rps <= x) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    // 等間隔判定（C++11 の constexpr に収まるよう再帰で書く）
+    static constexpr float absf(float v) { return v < 0.0f ? -v : v; }
+    static constexpr bool uniformFrom(const GainSchedulePoint* p, int n, int i, float d) {
+        return (i >= n) ? true
+             : (absf((p[i].rps - p[i - 1].rps) - d) <= d * 1e-4f) && uniformFrom(p, n, i + 1, d);
+    }
+    static constexpr float uniformStep(const GainSchedulePoint* p, int n) {
+        return (n < 2 || p[1].rps <= p[0].rps) ? 0.0f
+             : (uniformFrom(p, n, 2, p[1].rps - p[0].rps) ? p[1].rps - p[0].rps : 0.0f);
+    }
+};
+
+#endif // GAIN_SCHEDULE_H
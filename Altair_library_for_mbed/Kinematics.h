@@ -2,6 +2,7 @@
 #define KINEMATICS_H
 
 #include <cmath>
+#include "twist_limit.h"
 
 // モータ制御データ構造体の定義
 struct MotorData {
@@ -13,30 +14,84 @@ struct MotorControlData {
     MotorData motor_data[4];
 };
 
+// calc が実際に出した機体速度（車輪の飽和で縮めた後）
+// Kinematics には残さず返り値で渡すので、目標を決めるスレッドと制御スレッドが同じ Kinematics の calc を呼んでもよい
+struct AppliedTwist {
+    double vx_mm_s;
+    double vy_mm_s;
+    double omega_deg_s;
+    bool saturated;   // どれかの車輪が上限に掛かって縮めた
+};
+
 enum ControlMode {
     RPS_MODE,
     MMPS_MODE // mm/s
 };
 
 // 基底クラス Kinematics の定義
+// 車輪の上限（目標値と同じ単位）を設定すると、calc は上限を超えないように機体速度を縮めてから各車輪の目標値を出し、
+// 縮めた後の機体速度を返す
 class Kinematics {
 public:
-    virtual void calc(double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) = 0;
+    virtual AppliedTwist calc(double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) = 0;
     virtual ~Kinematics() = default; // 仮想デストラクタ
+
+    // 全車輪に同じ上限を設定する（0 で制限なし）
+    void setWheelLimit(double limit) {
+        for (int i = 0; i < 4; i++) {
+            wheel_limit[i] = static_cast<float>(limit);
+        }
+    }
+
+    // 車輪ごとの上限を設定する（limits は車輪数分）
+    void setWheelLimits(const double* limits, int count) {
+        for (int i = 0; i < 4; i++) {
+            wheel_limit[i] = (i < count) ? static_cast<float>(limits[i]) : 0.0f;
+        }
+    }
+
+    // 飽和時の方針（TWIST_LIMIT_UNIFORM / TWIST_LIMIT_ROTATION_FIRST / TWIST_LIMIT_TRANSLATION_FIRST）
+    void setLimitPolicy(TwistLimitPolicy policy) {
+        limit_policy = policy;
+    }
+
+protected:
+    // 派生クラスの calc から呼ぶ。translation / rotation は各車輪の目標値の並進成分・回転成分
+    AppliedTwist applyLimits(const float* translation, const float* rotation, int count,
+                             double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) {
+        float wheel[4];
+        float st, sr;
+        TwistLimit_solve(translation, rotation, wheel_limit, count, limit_policy, wheel, &st, &sr);
+        for (int i = 0; i < count; i++) {
+            motor_control_data.motor_data[i].target_value = wheel[i];
+        }
+        return {vx_mm_s * st, vy_mm_s * st, omega_deg_s * sr, st < 1.0f || sr < 1.0f};
+    }
+
+private:
+    float wheel_limit[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    TwistLimitPolicy limit_policy = TWIST_LIMIT_UNIFORM;
 };
 
 // Mecanum クラス
 class Mecanum : public Kinematics {
 public:
+    static constexpr int WHEEL_COUNT = 4;  // StaticRobotControl の車輪数チェック用
+
     Mecanum(double wheel_radius_mm, double turning_radius_mm, ControlMode mode)
         : wheel_radius_mm(wheel_radius_mm), turning_radius_mm(turning_radius_mm), mode(mode) {}
 
-    void calc(double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) override {
+    AppliedTwist calc(double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) override {
         double omega_rad_s = omega_deg_s * M_PI / 180.0; // 角速度をラジアン毎秒に変換
-        motor_control_data.motor_data[0].target_value = computeTargetValue((-vx_mm_s + vy_mm_s) / std::sqrt(2) + turning_radius_mm * omega_rad_s);
-        motor_control_data.motor_data[1].target_value = computeTargetValue((-vx_mm_s - vy_mm_s) / std::sqrt(2) + turning_radius_mm * omega_rad_s);
-        motor_control_data.motor_data[2].target_value = computeTargetValue((vx_mm_s - vy_mm_s) / std::sqrt(2) + turning_radius_mm * omega_rad_s);
-        motor_control_data.motor_data[3].target_value = computeTargetValue((vx_mm_s + vy_mm_s) / std::sqrt(2) + turning_radius_mm * omega_rad_s);
+        float rotation = computeTargetValue(turning_radius_mm * omega_rad_s);
+        float translation[4] = {
+            static_cast<float>(computeTargetValue((-vx_mm_s + vy_mm_s) / std::sqrt(2))),
+            static_cast<float>(computeTargetValue((-vx_mm_s - vy_mm_s) / std::sqrt(2))),
+            static_cast<float>(computeTargetValue((vx_mm_s - vy_mm_s) / std::sqrt(2))),
+            static_cast<float>(computeTargetValue((vx_mm_s + vy_mm_s) / std::sqrt(2)))
+        };
+        float rotations[4] = {rotation, rotation, rotation, rotation};
+        return applyLimits(translation, rotations, 4, vx_mm_s, vy_mm_s, omega_deg_s, motor_control_data);
     }
 
 private:
@@ -56,14 +111,21 @@ private:
 // Omni3 クラス
 class Omni3 : public Kinematics {
 public:
+    static constexpr int WHEEL_COUNT = 3;  // StaticRobotControl の車輪数チェック用
+
     Omni3(double wheel_radius_mm, double turning_radius_mm, ControlMode mode)
         : wheel_radius_mm(wheel_radius_mm), turning_radius_mm(turning_radius_mm), mode(mode) {}
 
-    void calc(double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) override {
+    AppliedTwist calc(double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) override {
         double omega_rad_s = omega_deg_s * M_PI / 180.0; // 角速度をラジアン毎秒に変換
-        motor_control_data.motor_data[0].target_value = computeTargetValue(-vx_mm_s + turning_radius_mm * omega_rad_s);
-        motor_control_data.motor_data[1].target_value = computeTargetValue(vx_mm_s / 2 - vy_mm_s * std::sqrt(3) / 2 + turning_radius_mm * omega_rad_s);
-        motor_control_data.motor_data[2].target_value = computeTargetValue(vx_mm_s / 2 + vy_mm_s * std::sqrt(3) / 2 + turning_radius_mm * omega_rad_s);
+        float rotation = computeTargetValue(turning_radius_mm * omega_rad_s);
+        float translation[3] = {
+            static_cast<float>(computeTargetValue(-vx_mm_s)),
+            static_cast<float>(computeTargetValue(vx_mm_s / 2 - vy_mm_s * std::sqrt(3) / 2)),
+            static_cast<float>(computeTargetValue(vx_mm_s / 2 + vy_mm_s * std::sqrt(3) / 2))
+        };
+        float rotations[3] = {rotation, rotation, rotation};
+        return applyLimits(translation, rotations, 3, vx_mm_s, vy_mm_s, omega_deg_s, motor_control_data);
     }
 
 private:
@@ -82,15 +144,22 @@ private:
 // Omni4 クラス
 class Omni4 : public Kinematics {
 public:
+    static constexpr int WHEEL_COUNT = 4;  // StaticRobotControl の車輪数チェック用
+
     Omni4(double wheel_radius_mm, double turning_radius_mm, ControlMode mode)
         : wheel_radius_mm(wheel_radius_mm), turning_radius_mm(turning_radius_mm), mode(mode) {}
 
-    void calc(double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) override {
+    AppliedTwist calc(double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) override {
         double omega_rad_s = omega_deg_s * M_PI / 180.0; // 角速度をラジアン毎秒に変換
-        motor_control_data.motor_data[0].target_value = computeTargetValue(vx_mm_s - vy_mm_s - turning_radius_mm * omega_rad_s); // 左前
-        motor_control_data.motor_data[1].target_value = computeTargetValue(vx_mm_s + vy_mm_s + turning_radius_mm * omega_rad_s); // 右前
-        motor_control_data.motor_data[2].target_value = computeTargetValue(vx_mm_s - vy_mm_s + turning_radius_mm * omega_rad_s); // 右後
-        motor_control_data.motor_data[3].target_value = computeTargetValue(vx_mm_s + vy_mm_s - turning_radius_mm * omega_rad_s); // 左後
+        float rotation = computeTargetValue(turning_radius_mm * omega_rad_s);
+        float translation[4] = {
+            static_cast<float>(computeTargetValue(vx_mm_s - vy_mm_s)), // 左前
+            static_cast<float>(computeTargetValue(vx_mm_s + vy_mm_s)), // 右前
+            static_cast<float>(computeTargetValue(vx_mm_s - vy_mm_s)), // 右後
+            static_cast<float>(computeTargetValue(vx_mm_s + vy_mm_s))  // 左後
+        };
+        float rotations[4] = {-rotation, rotation, rotation, -rotation};
+        return applyLimits(translation, rotations, 4, vx_mm_s, vy_mm_s, omega_deg_s, motor_control_data);
     }
 
 private:
@@ -0,0 +1,213 @@
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+#include <math.h>
+
+// 機体速度（vx, vy, ω）の加速度・躍度制限つき速度プロファイル
+// 目標速度がステップで変わっても、制御周期ごとに update() を呼ぶと
+//   - 各軸の加速度を max_accel 以下、加加速度（躍度）を max_jerk 以下に抑えた S 字（jerk 0 なら台形）
+//   - 並進加速度の合成 |(ax, ay)| を max_linear_accel 以下
+// で目標に近づく速度を出力する。動的確保なし
+// mbed / Arduino で同一内容
+struct MotionProfileConfig {
+    float max_accel[3];       // vx, vy [mm/s^2], ω [deg/s^2]（0 で制限なし＝ステップ）
+    float max_jerk[3];        // vx, vy [mm/s^3], ω [deg/s^3]（0 で制限なし＝台形）
+    float max_linear_accel;   // 並進加速度の合成の上限 [mm/s^2]（0 で制限なし）
+};
+
+class MotionProfile {
+public:
+    enum Axis { VX = 0, VY = 1, OMEGA = 2 };
+
+    MotionProfile(float dt = 0.01f, const MotionProfileConfig& config = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 0.0f})
+        : dt(dt), config(config) {
+        reset(0.0f, 0.0f, 0.0f);
+    }
+
+    void setConfig(const MotionProfileConfig& new_config) {
+        config = new_config;
+    }
+
+    // 呼び出し周期 [s] を変更する（マルチレートで update の周期を変えるとき）
+    void setPeriod(float new_dt) {
+        dt = new_dt;
+    }
+
+    void setTarget(float vx, float vy, float omega) {
+        target[VX] = vx;
+        target[VY] = vy;
+        target[OMEGA] = omega;
+    }
+
+    // 現在速度を強制的に設定する（加速度は 0 に戻る）
+    void reset(float vx, float vy, float omega) {
+        velocity[VX] = target[VX] = vx;
+        velocity[VY] = target[VY] = vy;
+        velocity[OMEGA] = target[OMEGA] = omega;
+        for (int i = 0; i < 3; i++) {
+            accel[i] = 0.0f;
+        }
+    }
+
+    // 1 制御周期進める
+    void update() {
+        float previous[3];
+        for (int i = 0; i < 3; i++) {
+            previous[i] = accel[i];
+            accel[i] = nextAccel(i);
+        }
+
+        // 並進加速度の合成制限
+        if (config.max_linear_accel > 0.0f) {
+            limitLinearAccel(previous);
+        }
+
+        for (int i = 0; i < 3; i++) {
+            if (config.max_accel[i] <= 0.0f) {
+                velocity[i] = target[i];
+                continue;
+            }
+            float error = target[i] - velocity[i];
+            float step = accel[i] * dt;
+            // 目標を越える場合はそこで止める。ただし躍度制限があるときは、加速度を 1 周期で 0 にできる大きさのときだけ
+            // （加速中に近い目標へ変えられると止まり切れないので、行き過ぎてから躍度制限のまま戻る）
+            bool crosses = (error >= 0.0f && step >= error) || (error <= 0.0f && step <= error);
+            bool can_stop = config.max_jerk[i] <= 0.0f
+                            || (fabsf(previous[i]) <= config.max_jerk[i] * dt && fabsf(accel[i]) <= config.max_jerk[i] * dt);
+            if (crosses && can_stop) {
+                // この周期の実際の加速度は error / dt。次の周期の躍度をここから数えるよう、0 ではなくそれを残す
+                velocity[i] = target[i];
+                accel[i] = (dt > 0.0f) ? error / dt : 0.0f;
+            } else {
+                velocity[i] += step;
+            }
+        }
+    }
+
+    // 車輪の飽和などで機体速度全体を scale 倍に縮める（向きと比率は保つ）
+    void scaleVelocity(float scale) {
+        for (int i = 0; i < 3; i++) {
+            velocity[i] *= scale;
+            accel[i] *= scale;
+        }
+    }
+
+    // 運動学で実際に出せた速度に合わせる（縮められた軸は加速度も 0 に戻す）
+    void limitVelocity(float vx, float vy, float omega) {
+        const float limited[3] = {vx, vy, omega};
+        for (int i = 0; i < 3; i++) {
+            if (limited[i] != velocity[i]) {
+                velocity[i] = limited[i];
+                accel[i] = 0.0f;
+            }
+        }
+    }
+
+    float getVx() const { return velocity[VX]; }
+    float getVy() const { return velocity[VY]; }
+    float getOmega() const { return velocity[OMEGA]; }
+    bool isSettled() const {
+        return velocity[VX] == target[VX] && velocity[VY] == target[VY] && velocity[OMEGA] == target[OMEGA];
+    }
+
+private:
+    float dt;
+    MotionProfileConfig config;
+    float target[3];
+    float velocity[3];
+    float accel[3];
+
+    // 並進加速度 (ax, ay) を合成の上限に収める
+    // 方向を保って縮めると、縮める倍率が周期ごとに変わった分だけ軸ごとの躍度を超えることがあるので、
+    // 縮めた値が前の周期の加速度 ± max_jerk·dt を外れた軸はその範囲に戻し、残りの大きさをもう一方の軸に回す
+    void limitLinearAccel(const float previous[3]) {
+        float limit = config.max_linear_accel;
+        float a = sqrtf(accel[VX] * accel[VX] + accel[VY] * accel[VY]);
+        if (a <= limit) {
+            return;
+        }
+        float scaled[2] = {accel[VX] * limit / a, accel[VY] * limit / a};
+        float lo[2];
+        float hi[2];
+        int clamped = -1;
+        int count = 0;
+        for (int i = 0; i < 2; i++) {
+            float step = config.max_jerk[i] * dt;
+            lo[i] = (config.max_jerk[i] > 0.0f) ? previous[i] - step : -limit;
+            hi[i] = (config.max_jerk[i] > 0.0f) ? previous[i] + step : limit;
+            if (scaled[i] < lo[i] || scaled[i] > hi[i]) {
+                clamped = i;
+                count++;
+            }
+        }
+        if (count == 0) {
+            accel[VX] = scaled[0];
+            accel[VY] = scaled[1];
+            return;
+        }
+        if (count == 1) {
+            int k = 1 - clamped;
+            float c = (scaled[clamped] < lo[clamped]) ? lo[clamped] : hi[clamped];
+            float rest = limit * limit - c * c;
+            float other = (rest > 0.0f) ? sqrtf(rest) : 0.0f;
+            other = (scaled[k] < 0.0f) ? -other : other;
+            if (other >= lo[k] && other <= hi[k] && fabsf(c) <= limit) {
+                accel[VX + clamped] = c;
+                accel[VX + k] = other;
+                return;
+            }
+        }
+        // 両軸とも外れる：前の周期の加速度（上限の内側）から今の加速度へ向かう線分の上で、上限に収まるところまで戻す
+        float px = previous[VX];
+        float py = previous[VY];
+        float p2 = px * px + py * py;
+        if (p2 > limit * limit * 1.0001f) {
+            // 前の周期が上限の外（設定を変えた直後など）：方向を保って縮める
+            accel[VX] = scaled[0];
+            accel[VY] = scaled[1];
+            return;
+        }
+        float dx = accel[VX] - px;
+        float dy = accel[VY] - py;
+        float d2 = dx * dx + dy * dy;
+        float pd = px * dx + py * dy;
+        float disc = pd * pd + d2 * (limit * limit - p2);
+        float lambda = (-pd + sqrtf(disc > 0.0f ? disc : 0.0f)) / d2;
+        if (lambda < 0.0f) lambda = 0.0f;
+        if (lambda > 1.0f) lambda = 1.0f;
+        accel[VX] = px + lambda * dx;
+        accel[VY] = py + lambda * dy;
+    }
+
+    float nextAccel(int i) const {
+        float a_max = config.max_accel[i];
+        if (a_max <= 0.0f) {
+            return 0.0f;
+        }
+        float error = target[i] - velocity[i];
+        float jerk = config.max_jerk[i];
+        if (jerk <= 0.0f) {
+            // 台形：最大加速度で近づき、最後の 1 周期は update() で目標に合わせる
+            return (error > 0.0f) ? a_max : (error < 0.0f) ? -a_max : 0.0f;
+        }
+
+        // S 字：今の加速度を躍度制限で 0 に戻すまでに a^2 / 2j だけ速度が進むので、
+        // 残りの速度差 e に対して a = sqrt(2 j |e|) を越えないように加速度を決める
+        // （離散化の遅れ分、この周期で進む速度を先に差し引く）
+        float remaining = fabsf(error) - fabsf(accel[i]) * dt;
+        float desired = (remaining > 0.0f) ? sqrtf(2.0f * jerk * remaining) : 0.0f;
+        if (desired > a_max) {
+            desired = a_max;
+        }
+        if (error < 0.0f) {
+            desired = -desired;
+        }
+        float max_step = jerk * dt;
+        float delta = desired - accel[i];
+        if (delta > max_step) delta = max_step;
+        if (delta < -max_step) delta = -max_step;
+        return accel[i] + delta;
+    }
+};
+
+#endif // MOTION_PROFILE_H
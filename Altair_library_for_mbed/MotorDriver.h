@@ -2,53 +2,25 @@
 #define MOTOR_DRIVER_H
 
 #include "mbed.h"
+#include "hal_policy.h"
 
-class MotorDriver {
+// PWM 2 本で正転・逆転するモータドライバ（PWM 周期 0.1ms、Duty の上限 0.95）
+// 出力は hal_core.h の HalMotorDriver（setDuty / setDecayMode / stop / brake）で、ピンへの書き込みは AltairHal
+class MotorDriver : public HalMotorDriver<AltairHal> {
 public:
-    MotorDriver(PinName ps1Pin, PinName ps2Pin) : ps1(ps1Pin), ps2(ps2Pin) {
-        ps1.period(0.0001f); // PWM周期を0.1msに設定
-        ps2.period(0.0001f); // PWM周期を0.1msに設定
-    }
+    MotorDriver(PinName ps1Pin, PinName ps2Pin) : HalMotorDriver<AltairHal>(ps1Pin, ps2Pin, 100, 0.95f) {}
 
+    // 速度を -100〜100 [%] で設定する（0 はフリーランで停止）
     void setSpeed(int speed) {
         if (speed > 100) speed = 100;
         if (speed < -100) speed = -100;
 
-        if (speed > 0) {
-            forward(speed / 100.0f);
-        } else if (speed < 0) {
-            reverse(-speed / 100.0f);
-        } else {
+        if (speed == 0) {
             stop();
+        } else {
+            setDuty(speed / 100.0f);
         }
     }
-
-private:
-    void stop() {
-        ps1.write(0.0f);
-        ps2.write(0.0f);
-    }
-
-    void brake() {
-        // ショートブレーキの実装
-        ps1.write(1.0f); // 両方のPWMピンをHIGHに設定
-        ps2.write(1.0f); // これにより、モーターはすぐに停止
-    }
-
-    void forward(float speed) {
-        if (speed > 0.95f) speed = 0.95f;
-        ps1.write(speed);
-        ps2.write(0.0f);
-    }
-
-    void reverse(float speed) {
-        if (speed > 0.95f) speed = 0.95f;
-        ps1.write(0.0f);
-        ps2.write(speed);
-    }
-
-    PwmOut ps1;
-    PwmOut ps2;
 };
 
 #endif // MOTOR_DRIVER_H
@@ -0,0 +1,124 @@
+#ifndef MOTOR_GROUP_H
+#define MOTOR_GROUP_H
+
+#include "mbed.h"
+#include "pinmap.h"
+#include "PeripheralPins.h"
+
+// 複数の MotorDriver の PWM を同じ PWM 周期で一斉に切り替えるクラス
+// MotorDriver を生成した後、同じピンを渡して使う。
+// PwmOut::write を経由せず、ピンに対応するタイマの CCR レジスタへ直接書き込む。
+template <int N>
+class MotorGroup {
+public:
+    // pins[i][0] が ps1Pin、pins[i][1] が ps2Pin
+    MotorGroup(const PinName (&pins)[N][2]) : timer_count(0) {
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < 2; j++) {
+                setupChannel(channels[i][j], pins[i][j]);
+            }
+        }
+        // ARR プリロード有効化（CCR プリロードは setupChannel で有効化済み）
+        for (int i = 0; i < timer_count; i++) {
+            timers[i]->CR1 |= TIM_CR1_ARPE;
+        }
+    }
+
+    // 全モータの速度を設定する（-100〜100、MotorDriver::setSpeed と同じ仕様）
+    // 書き込みは次の更新イベントで全チャンネル同時に反映される
+    void setSpeeds(const int (&speeds)[N]) {
+        holdUpdate();
+        for (int i = 0; i < N; i++) {
+            int speed = speeds[i];
+            if (speed > 95) speed = 95;
+            if (speed < -95) speed = -95;
+
+            if (speed > 0) {
+                writeChannel(channels[i][0], speed);
+                writeChannel(channels[i][1], 0);
+            } else {
+                writeChannel(channels[i][0], 0);
+                writeChannel(channels[i][1], -speed);
+            }
+        }
+        releaseUpdate();
+    }
+
+    // 全モータを同時にショートブレーキ停止する
+    void brake() {
+        holdUpdate();
+        for (int i = 0; i < N; i++) {
+            *channels[i][0].ccr = fullCompare(channels[i][0].tim);
+            *channels[i][1].ccr = fullCompare(channels[i][1].tim);
+        }
+        releaseUpdate();
+    }
+
+    // PWM 周期を変更した後に呼ぶ（ARR から 1% あたりのカウント値を再計算）
+    void updateScale() {
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < 2; j++) {
+                channels[i][j].scale_q16 = scaleOf(channels[i][j].tim);
+            }
+        }
+    }
+
+private:
+    struct Channel {
+        TIM_TypeDef* tim;
+        volatile uint32_t* ccr;
+        uint64_t scale_q16;   // 1% あたりのカウント値（Q16 固定小数点。ARR = 0xFFFF や 32bit タイマでもあふれないよう 64bit）
+    };
+
+    Channel channels[N][2];
+    TIM_TypeDef* timers[N * 2];
+    int timer_count;
+
+    void setupChannel(Channel& ch, PinName pin) {
+        TIM_TypeDef* tim = reinterpret_cast<TIM_TypeDef*>(pinmap_peripheral(pin, PinMap_PWM));
+        uint32_t index = STM_PIN_CHANNEL(pinmap_function(pin, PinMap_PWM)) - 1;
+
+        ch.tim = tim;
+        ch.ccr = &tim->CCR1 + index;
+        ch.scale_q16 = scaleOf(tim);
+
+        // CCR プリロード有効化
+        volatile uint32_t* ccmr = (index < 2) ? &tim->CCMR1 : &tim->CCMR2;
+        *ccmr |= (index % 2 == 0) ? TIM_CCMR1_OC1PE : TIM_CCMR1_OC2PE;
+
+        for (int i = 0; i < timer_count; i++) {
+            if (timers[i] == tim) {
+                return;
+            }
+        }
+        timers[timer_count++] = tim;
+    }
+
+    void writeChannel(const Channel& ch, int percent) {
+        *ch.ccr = static_cast<uint32_t>((static_cast<uint64_t>(percent) * ch.scale_q16) >> 16);
+    }
+
+    static uint64_t scaleOf(const TIM_TypeDef* tim) {
+        return ((static_cast<uint64_t>(tim->ARR) + 1) << 16) / 100U;
+    }
+
+    // Duty 100% の CCR（ARR + 1。32bit タイマの ARR = 0xFFFFFFFF では ARR のまま）
+    static uint32_t fullCompare(const TIM_TypeDef* tim) {
+        return (tim->ARR == 0xFFFFFFFFU) ? tim->ARR : tim->ARR + 1;
+    }
+
+    // UDIS を立てている間は CCR の書き込みがプリロードレジスタに留まり、途中の組み合わせが出力されない
+    void holdUpdate() {
+        for (int i = 0; i < timer_count; i++) {
+            timers[i]->CR1 |= TIM_CR1_UDIS;
+        }
+    }
+
+    void releaseUpdate() {
+        for (int i = 0; i < timer_count; i++) {
+            timers[i]->CR1 &= ~TIM_CR1_UDIS;
+        }
+    }
+};
+
+#endif // MOTOR_GROUP_H
@@ -0,0 +1,151 @@
+#ifndef MULTI_RATE_EXECUTIVE_H
+#define MULTI_RATE_EXECUTIVE_H
+
+#include <new>
+#include "mbed.h"
+#include "rate_executive.h"
+#include "snapshot.h"
+#include "Timebase.h"
+
+// rate_executive.h のスレッド版（mbed RTOS）
+//   - タスクごとに 1 本のスレッドで動かし、周期の短いタスクほど高い優先度にする（レート単調）
+//   - スレッドとスタックはメンバとして持つ（動的確保なし）。スレッドは start で優先度を決めて作り、stop で終了を待って壊す
+//   - 周期は ms 単位（Kernel::Clock の分解能）、実行時間と CPU 使用率は Timebase で us 単位に計る
+//   - 次の周期までに終わらなかった回数を overruns に数え、遅れた分の周期は飛ばす
+// 優先度は osPriorityAboveNormal から上に割り当てるので、main（osPriorityNormal）より先に動く
+template <int MaxTasks = 4, uint32_t StackSize = 1024>
+class MultiRateExecutive {
+    static_assert(MaxTasks > 0 && MaxTasks <= 8 && MaxTasks <= RATE_EXECUTIVE_MAX_TASKS, "タスクは 1〜8 個です");
+
+public:
+    // window: CPU 使用率の計測窓
+    explicit MultiRateExecutive(std::chrono::milliseconds window = 1000ms)
+        : running(false), started(false) {
+        RateExecutive_Init(&core, Timebase::micros, static_cast<uint32_t>(window.count()) * 1000);
+    }
+
+    ~MultiRateExecutive() {
+        stop();
+    }
+
+    MultiRateExecutive(const MultiRateExecutive&) = delete;
+    MultiRateExecutive& operator=(const MultiRateExecutive&) = delete;
+
+    // タスクを追加してタスク番号を返す（start の前に呼ぶ。いっぱいなら -1）
+    int addTask(const char* name, Callback<void()> func, std::chrono::milliseconds period) {
+        if (started || core.count >= MaxTasks) {
+            return -1;
+        }
+        int index = RateExecutive_addTask(&core, name, nullptr, nullptr, static_cast<uint32_t>(period.count()));
+        if (index >= 0) {
+            funcs[index] = func;
+        }
+        return index;
+    }
+
+    void start() {
+        if (started) {
+            return;
+        }
+        running = true;
+        started = true;
+        epoch = Kernel::Clock::now();  // 全タスクの周期の起点をそろえる
+        // 優先度はスレッドを作るときに渡す（start の後で変えると、変えるまでの間 osPriorityNormal で動く）
+        for (int rank = 0; rank < core.count; rank++) {
+            int index = core.order[rank];
+            osPriority priority = static_cast<osPriority>(osPriorityAboveNormal + (core.count - 1 - rank));
+            threads[index] = new (thread_storage[index]) Thread(priority, StackSize, stacks[index], core.tasks[index].name);
+            threads[index]->start([this, index]() { taskLoop(index); });
+        }
+    }
+
+    // 各タスクが実行中の周期を終えるのを待ってから止める（タスクの中からは呼ばない）
+    // Thread::terminate と違い、タスクがロックを持ったまま止まることがない。止めた後は start でもう一度動かせる
+    void stop() {
+        if (!started) {
+            return;
+        }
+        running = false;
+        for (int i = 0; i < core.count; i++) {
+            threads[i]->join();
+            threads[i]->~Thread();
+            threads[i] = nullptr;
+        }
+        started = false;
+    }
+
+    int getTaskCount() const { return core.count; }
+
+    // 実行回数・overruns・実行時間 [us]・CPU 使用率など
+    const RateTask& getTask(int index) const { return core.tasks[index]; }
+
+    float getUtilization(int index) const { return core.tasks[index].utilization; }
+    float getTotalUtilization() const { return core.total_utilization; }
+
+    // 実行時間の見積もり exec_us[i]（タスク番号順、[us]）から ticks [ms] 分のスケジュールを模擬する
+    // 戻り値は CPU 使用率の合計。result にタスクごとの最大応答時間 [us] と周期に間に合わなかった回数が入る
+    float simulate(const uint32_t* exec_us, uint32_t ticks, RateSimResult* result) const {
+        return RateExecutive_simulate(&core, exec_us, 1000, ticks, core.count, result);
+    }
+
+private:
+    RateExecutive core;  // タスク表と計測（CubeIDE 版と共通）
+    Callback<void()> funcs[MaxTasks];
+    MBED_ALIGN(8) unsigned char stacks[MaxTasks][StackSize];
+    alignas(Thread) unsigned char thread_storage[MaxTasks][sizeof(Thread)];  // start で Thread を作る場所
+    Thread* threads[MaxTasks] = {};
+    Kernel::Clock::time_point epoch;
+    volatile bool running;
+    bool started;
+
+    void taskLoop(int index) {
+        RateTask* task = &core.tasks[index];
+        const std::chrono::milliseconds period(task->period);
+        Kernel::Clock::time_point next = epoch;
+        while (running) {
+            uint32_t mark = RateExecutive_begin(&core);
+            uint32_t start = Timebase::micros();
+            funcs[index]();
+            RateExecutive_finish(&core, task, Timebase::micros() - start, mark);
+
+            next += period;
+            Kernel::Clock::time_point now = Kernel::Clock::now();
+            if (now > next) {
+                // 次の周期に間に合わなかった：遅れた分の周期は飛ばしてすぐ次を実行する
+                task->overruns++;
+                next += ((now - next) / period) * period;
+            }
+            ThisThread::sleep_until(next);
+        }
+    }
+};
+
+// snapshot.h の型付き版（書き込みは 1 つのタスクだけ）
+template <class T>
+class SnapshotBuffer {
+public:
+    SnapshotBuffer() {
+        Snapshot_Init(&core, buffers, sizeof(T));
+    }
+
+    void write(const T& value) {
+        Snapshot_write(&core, &value);
+    }
+
+    T read() const {
+        T value;
+        Snapshot_read(&core, &value);
+        return value;
+    }
+
+    // 書き込み回数も返す（0 はまだ書かれていない。前回と同じなら更新なし）
+    uint32_t read(T& value) const {
+        return Snapshot_read(&core, &value);
+    }
+
+private:
+    T buffers[2];
+    Snapshot core;
+};
+
+#endif // MULTI_RATE_EXECUTIVE_H
@@ -0,0 +1,261 @@
+#ifndef PATH_FOLLOWER_H
+#define PATH_FOLLOWER_H
+
+#include <cmath>
+#include <cstdint>
+#include "InverseKinematics.h"
+
+// 経路追従（InverseKinematics の自己位置から RobotControl::startControl への速度指令を作る）
+//   - 経路は PathPoint の配列（8 バイト / 点）。constexpr 配列で書けばフラッシュに置かれる
+//   - 最寄り区間は前回の区間から順に進めるだけなので、経路が長くても 1 周期の計算量は O(1)
+//   - 先読み距離 lookahead の点に向かう pure pursuit（オムニ・メカナム用）と、
+//     差動二輪用の Ramsete を選べる
+//   - 速度は区間ごとの最高速度、曲率（横加速度）、終点までの減速距離のうち最小のもの
+// 座標は InverseKinematics と同じ [mm] と [deg]（mbed / Arduino で同一内容）
+struct PathPoint {
+    int16_t x;         // [mm]
+    int16_t y;         // [mm]
+    int16_t heading;   // この点での目標姿勢 [0.01 deg]（オムニ・メカナムのみ）
+    uint16_t speed;    // この点へ向かう区間の最高速度 [mm/s]
+};
+
+struct PathFollowerConfig {
+    float lookahead;          // 先読み距離 [mm]
+    float max_lateral_accel;  // 曲がるときの横加速度の上限 [mm/s^2]（0 で制限なし）
+    float max_decel;          // 終点に向けた減速度 [mm/s^2]（0 で減速なし）
+    float heading_gain;       // 姿勢の P ゲイン [1/s]
+    float max_omega;          // 角速度の上限 [deg/s]
+    float goal_tolerance;     // 到着とみなす距離 [mm]
+    float ramsete_b;          // Ramsete の b [rad^2/m^2]
+    float ramsete_zeta;       // Ramsete の ζ
+};
+
+enum PathFollowMode {
+    PURE_PURSUIT_MODE,  // オムニ・メカナム（vx, vy, ω を出す）
+    RAMSETE_MODE        // 差動二輪（vx, ω を出す。vy は 0）
+};
+
+// 機体座標の速度指令（startControl にそのまま渡す）
+struct PathCommand {
+    float vx;       // [mm/s]
+    float vy;       // [mm/s]
+    float omega;    // [deg/s]
+    bool finished;
+};
+
+class PathFollower {
+public:
+    PathFollower(const PathFollowerConfig& config = {300.0f, 1000.0f, 1000.0f, 3.0f, 180.0f, 10.0f, 10.0f, 0.7f},
+                 PathFollowMode mode = PURE_PURSUIT_MODE)
+        : config(config), mode(mode), points(nullptr), count(0) {
+        reset();
+    }
+
+    template <int N>
+    void setPath(const PathPoint (&path)[N]) {
+        setPath(path, N);
+    }
+
+    void setPath(const PathPoint* path, int point_count) {
+        points = path;
+        count = point_count;
+        reset();
+    }
+
+    void setConfig(const PathFollowerConfig& new_config) {
+        config = new_config;
+    }
+
+    void setMode(PathFollowMode new_mode) {
+        mode = new_mode;
+    }
+
+    // 経路の先頭から追従し直す
+    void reset() {
+        segment = 0;
+        finished = (count < 2);
+        // 区間 0 の終点から経路の終点までの距離（区間が進むたびに引いていく）
+        remaining_after = 0.0f;
+        for (int i = 1; i + 1 < count; i++) {
+            remaining_after += segmentLength(i);
+        }
+    }
+
+    // 1 制御周期ごとに現在の自己位置を渡す
+    PathCommand update(const Position& pose) {
+        PathCommand command = {0.0f, 0.0f, 0.0f, true};
+        if (finished) {
+            return command;
+        }
+        float px = pose.x;
+        float py = pose.y;
+
+        // 最寄り区間：次の区間の方が近い間だけ進める
+        while (segment < count - 2 && distanceSq(segment + 1, px, py) <= distanceSq(segment, px, py)) {
+            remaining_after -= segmentLength(segment + 1);
+            segment++;
+        }
+
+        // 区間上の射影点
+        float ax = points[segment].x, ay = points[segment].y;
+        float bx = points[segment + 1].x, by = points[segment + 1].y;
+        float t = projection(segment, px, py);
+        float qx = ax + (bx - ax) * t;
+        float qy = ay + (by - ay) * t;
+        float seg_len = segmentLength(segment);
+        float dist_to_goal = seg_len * (1.0f - t) + ((remaining_after > 0.0f) ? remaining_after : 0.0f);
+
+        // 終点に着いたら終了（差動二輪は横にずれたまま終点を通り過ぎることがあるので、通過でも終了）
+        float gx = points[count - 1].x - px;
+        float gy = points[count - 1].y - py;
+        if (segment == count - 2 &&
+            (gx * gx + gy * gy <= config.goal_tolerance * config.goal_tolerance ||
+             (mode == RAMSETE_MODE && t >= 1.0f))) {
+            finished = true;
+            return command;
+        }
+
+        // 射影点から経路に沿って lookahead だけ先の点（区間をまたいで進む）
+        float remaining = config.lookahead;
+        float lx = qx, ly = qy;
+        int j = segment;
+        float turn = 0.0f;          // 先読み範囲で曲がる角度の合計 [rad]
+        float speed_limit = points[segment + 1].speed;
+        while (true) {
+            float ex = points[j + 1].x - lx;
+            float ey = points[j + 1].y - ly;
+            float d = std::sqrt(ex * ex + ey * ey);
+            if (d >= remaining || j + 1 == count - 1) {
+                float s = (d > remaining && d > 0.0f) ? remaining / d : 1.0f;
+                lx += ex * s;
+                ly += ey * s;
+                break;
+            }
+            remaining -= d;
+            lx = points[j + 1].x;
+            ly = points[j + 1].y;
+            turn += wrapRad(segmentAngle(j + 1) - segmentAngle(j));
+            j++;
+            if (points[j + 1].speed < speed_limit) {
+                speed_limit = points[j + 1].speed;
+            }
+        }
+
+        // 速度：区間の最高速度・曲率・終点までの減速
+        float speed = speed_limit;
+        float curvature = std::fabs(turn) / config.lookahead;
+        if (config.max_lateral_accel > 0.0f && curvature > 0.0f) {
+            float v = std::sqrt(config.max_lateral_accel / curvature);
+            if (v < speed) speed = v;
+        }
+        if (config.max_decel > 0.0f) {
+            float v = std::sqrt(2.0f * config.max_decel * dist_to_goal);
+            if (v < speed) speed = v;
+        }
+
+        float theta = pose.theta * DEG_TO_RAD;
+        float c = std::cos(theta);
+        float s = std::sin(theta);
+
+        if (mode == PURE_PURSUIT_MODE) {
+            // 先読み点に向かう方向へ進む（ワールド座標 → 機体座標）
+            float dx = lx - px;
+            float dy = ly - py;
+            float d = std::sqrt(dx * dx + dy * dy);
+            if (d > 0.0f) {
+                float wx = dx / d * speed;
+                float wy = dy / d * speed;
+                command.vx = c * wx + s * wy;
+                command.vy = -s * wx + c * wy;
+            }
+            // 姿勢は区間の両端の目標姿勢を補間して P 制御
+            float h0 = points[segment].heading * 0.01f;
+            float h1 = points[segment + 1].heading * 0.01f;
+            float target_heading = h0 + wrapDeg(h1 - h0) * t;
+            command.omega = clamp(config.heading_gain * wrapDeg(target_heading - pose.theta), config.max_omega);
+        } else {
+            // Ramsete：射影点を参照姿勢、曲率から参照角速度を作る（計算は m と rad）
+            float ref_theta = segmentAngle(segment);
+            float vd = speed * 0.001f;
+            float wd = (config.lookahead > 0.0f) ? vd * turn / (config.lookahead * 0.001f) : 0.0f;
+            float dx = (qx - px) * 0.001f;
+            float dy = (qy - py) * 0.001f;
+            float ex = c * dx + s * dy;
+            float ey = -s * dx + c * dy;
+            float eth = wrapRad(ref_theta - theta);
+            float k = 2.0f * config.ramsete_zeta * std::sqrt(wd * wd + config.ramsete_b * vd * vd);
+            float sinc = (std::fabs(eth) > 1e-4f) ? std::sin(eth) / eth : 1.0f;
+            float v = vd * std::cos(eth) + k * ex;
+            // 補正で区間の最高速度・減速の速度を超えないようにする
+            v = clamp(v, vd);
+            float w = wd + k * eth + config.ramsete_b * vd * sinc * ey;
+            command.vx = v * 1000.0f;
+            command.omega = clamp(w / DEG_TO_RAD, config.max_omega);
+        }
+        command.finished = false;
+        return command;
+    }
+
+    bool isFinished() const { return finished; }
+    int getSegment() const { return segment; }
+
+private:
+    static constexpr float DEG_TO_RAD = 3.14159265f / 180.0f;
+
+    PathFollowerConfig config;
+    PathFollowMode mode;
+    const PathPoint* points;
+    int count;
+    int segment;
+    float remaining_after;
+    bool finished;
+
+    float segmentLength(int i) const {
+        float dx = points[i + 1].x - points[i].x;
+        float dy = points[i + 1].y - points[i].y;
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    float segmentAngle(int i) const {
+        return std::atan2(static_cast<float>(points[i + 1].y - points[i].y),
+                          static_cast<float>(points[i + 1].x - points[i].x));
+    }
+
+    // 区間 i 上の射影位置（0〜1）
+    float projection(int i, float px, float py) const {
+        float ax = points[i].x, ay = points[i].y;
+        float dx = points[i + 1].x - ax;
+        float dy = points[i + 1].y - ay;
+        float len_sq = dx * dx + dy * dy;
+        if (len_sq <= 0.0f) {
+            return 1.0f;
+        }
+        float t = ((px - ax) * dx + (py - ay) * dy) / len_sq;
+        return (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+    }
+
+    float distanceSq(int i, float px, float py) const {
+        float t = projection(i, px, py);
+        float qx = points[i].x + (points[i + 1].x - points[i].x) * t;
+        float qy = points[i].y + (points[i + 1].y - points[i].y) * t;
+        return (px - qx) * (px - qx) + (py - qy) * (py - qy);
+    }
+
+    static float wrapRad(float a) {
+        while (a > 3.14159265f) a -= 2.0f * 3.14159265f;
+        while (a < -3.14159265f) a += 2.0f * 3.14159265f;
+        return a;
+    }
+
+    static float wrapDeg(float a) {
+        while (a > 180.0f) a -= 360.0f;
+        while (a < -180.0f) a += 360.0f;
+        return a;
+    }
+
+    static float clamp(float v, float limit) {
+        return (v > limit) ? limit : (v < -limit) ? -limit : v;
+    }
+};
+
+#endif // PATH_FOLLOWER_H
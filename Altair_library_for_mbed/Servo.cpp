@@ -7,7 +7,7 @@ Servo::Servo(PinName pin) : pwm(pin) {
 
 // 角度を設定するメソッドの実装
 void Servo::write(float angle) {
-    // 0度から180度までを0.5msから2.5msのパルス幅に変換する
-    float pulsewidth = 0.0005 + (angle / 180.0) * 0.002;
-    pwm.pulsewidth(pulsewidth);
+    // 0度から180度までを0.5msから2.5msのパルス幅に変換する（float のまま us 単位で計算する）
+    int pulsewidth_us = 500 + static_cast<int>(angle * (2000.0f / 180.0f));
+    pwm.pulsewidth_us(pulsewidth_us);
 }
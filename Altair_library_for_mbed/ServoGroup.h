@@ -0,0 +1,143 @@
+#ifndef SERVO_GROUP_H
+#define SERVO_GROUP_H
+
+#include <utility>
+#include "mbed.h"
+#include "pinmap.h"
+#include "PeripheralPins.h"
+#include "servo_motion.h"
+
+// 複数のサーボ（最大 16 個）を同じ PWM 周期で一斉に動かすクラス
+//   - サーボごとに校正（可動範囲・パルス幅・ずれ・反転）と速度・加速度の上限を持つ（servo_motion.h）
+//   - update を一定周期で呼ぶと、全サーボを 1 周期分補間し、ピンに対応するタイマの CCR へ直接書き込む
+//   - 書き込み中は更新イベントを止める（UDIS）ので、全チャンネルが次の PWM 周期で同時に反映される
+//   - 全タイマのカウンタを揃えるので、各チャンネルのパルスは同じ時刻に立ち上がる
+// タイマは周期 20ms に設定し直すので、同じタイマのチャンネルをモータなど他の用途と共用しない
+template <int N>
+class ServoGroup {
+    static_assert(N > 0 && N <= 16, "サーボは 1〜16 個です");
+
+public:
+    explicit ServoGroup(const PinName (&pins)[N]) : ServoGroup(pins, std::make_index_sequence<N>()) {}
+
+    // 校正を設定する（現在の角度はそのまま）
+    void setCalibration(int index, const ServoCalibration& calibration) {
+        if (index >= 0 && index < N) {
+            ServoMotion_setCalibration(&servos[index].motion, &calibration);
+        }
+    }
+
+    // 目標角 [deg] を設定する。最初の 1 回は姿勢が分からないので、補間せずにその角度から始める
+    void setTarget(int index, float angle) {
+        if (index < 0 || index >= N) {
+            return;
+        }
+        if (servos[index].active) {
+            ServoMotion_setTarget(&servos[index].motion, angle);
+        } else {
+            ServoMotion_jump(&servos[index].motion, angle);
+            servos[index].active = true;
+        }
+    }
+
+    void setTargets(const float (&angles)[N]) {
+        for (int i = 0; i < N; i++) {
+            setTarget(i, angles[i]);
+        }
+    }
+
+    // 全サーボを 1 周期分補間して出力する（dt: 呼ぶ周期 [s]。20ms ごとに呼ぶと PWM 周期と揃う）
+    void update(float dt) {
+        for (int i = 0; i < N; i++) {
+            ServoMotion_update(&servos[i].motion, dt);
+        }
+        holdUpdate();
+        for (int i = 0; i < N; i++) {
+            // 一度も目標を設定していないサーボはパルスを出さない（脱力のまま）
+            uint32_t pulse = servos[i].active ? ServoMotion_pulse(&servos[i].motion) : 0;
+            *servos[i].ccr = static_cast<uint32_t>((static_cast<uint64_t>(pulse) * servos[i].scale_q16) >> 16);
+        }
+        releaseUpdate();
+    }
+
+    // 現在の指令角 [deg]
+    float getAngle(int index) const {
+        return (index >= 0 && index < N) ? servos[index].motion.position : 0.0f;
+    }
+
+    bool isSettled() const {
+        for (int i = 0; i < N; i++) {
+            if (!ServoMotion_isSettled(&servos[i].motion)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct Channel {
+        ServoMotion motion;
+        volatile uint32_t* ccr;
+        uint32_t scale_q16;  // 1us あたりのカウント値（Q16 固定小数点）
+        bool active;
+    };
+
+    PwmOut pwms[N];  // ピンとタイマの設定用（出力は CCR へ直接書く）
+    Channel servos[N];
+    TIM_TypeDef* timers[N];
+    int timer_count;
+
+    template <size_t... I>
+    ServoGroup(const PinName (&pins)[N], std::index_sequence<I...>) : pwms{{pins[I]}...}, timer_count(0) {
+        ServoCalibration calibration = ServoMotion_defaultCalibration();
+        for (int i = 0; i < N; i++) {
+            pwms[i].period_ms(20);
+            pwms[i].pulsewidth_us(0);
+            setupChannel(servos[i], pins[i]);
+            ServoMotion_Init(&servos[i].motion, &calibration, 90.0f);
+            servos[i].active = false;
+        }
+        // ARR プリロード有効化と、全タイマのカウンタ位相合わせ
+        core_util_critical_section_enter();
+        for (int i = 0; i < timer_count; i++) {
+            timers[i]->CR1 |= TIM_CR1_ARPE;
+            timers[i]->CNT = 0;
+        }
+        core_util_critical_section_exit();
+    }
+
+    void setupChannel(Channel& ch, PinName pin) {
+        TIM_TypeDef* tim = reinterpret_cast<TIM_TypeDef*>(pinmap_peripheral(pin, PinMap_PWM));
+        uint32_t index = STM_PIN_CHANNEL(pinmap_function(pin, PinMap_PWM)) - 1;
+
+        ch.ccr = &tim->CCR1 + index;
+        // period_ms(20) の後の ARR から 1us あたりのカウント値を求める
+        ch.scale_q16 = static_cast<uint32_t>((static_cast<uint64_t>(tim->ARR + 1) << 16) / 20000U);
+
+        // CCR プリロード有効化
+        volatile uint32_t* ccmr = (index < 2) ? &tim->CCMR1 : &tim->CCMR2;
+        *ccmr |= (index % 2 == 0) ? TIM_CCMR1_OC1PE : TIM_CCMR1_OC2PE;
+
+        for (int i = 0; i < timer_count; i++) {
+            if (timers[i] == tim) {
+                return;
+            }
+        }
+        timers[timer_count++] = tim;
+    }
+
+    // UDIS を立てている間は CCR の書き込みがプリロードレジスタに留まり、途中の組み合わせが出力されない
+    void holdUpdate() {
+        for (int i = 0; i < timer_count; i++) {
+            timers[i]->CR1 |= TIM_CR1_UDIS;
+        }
+    }
+
+    void releaseUpdate() {
+        for (int i = 0; i < timer_count; i++) {
+            timers[i]->CR1 &= ~TIM_CR1_UDIS;
+        }
+    }
+};
+
+#endif // SERVO_GROUP_H
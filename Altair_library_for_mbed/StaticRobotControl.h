@@ -0,0 +1,366 @@
+#ifndef STATIC_ROBOT_CONTROL_H
+#define STATIC_ROBOT_CONTROL_H
+
+#include <utility>
+#include "mbed.h"
+#include "MotorDriver.h"
+#include "MotorOutput.h"
+#include "encoder.h"
+#include "PIDController.h"
+#include "GainSchedule.h"
+#include "MotionProfile.h"
+#include "Kinematics.h"
+#include "TwoWheelKinematics.h"
+#include "safety_monitor.h"
+#include "Timebase.h"
+
+// 動的確保なしの RobotControl
+//   - モータ・エンコーダ・PID・運動学・制御スレッドのスタックをすべてメンバとして持つ（new を使わない）
+//   - 設定は constexpr の robotConfig<N>() から .wheel<I>() で組み立て、全車輪を設定したかをコンパイル時に確認する
+//   - 車輪数と運動学の組み合わせ（Mecanum は 4 輪など）もコンパイル時に確認する
+//   - 制御ループは車輪数が定数で、未設定の車輪の null チェックや仮想呼び出しがない
+//   - 安全監視（safety_monitor.h）は RobotControl と同じ
+// 使い方は readme/StaticRobotControl.md を参照
+
+// 1 輪分の設定
+struct WheelConfig {
+    PinName motor_pin1;
+    PinName motor_pin2;
+    PinName encoder_pin_a;
+    PinName encoder_pin_b;
+    float kp;
+    float ki;
+    float kd;
+    float time_constant;  // 微分フィルタの時定数 [s]
+};
+
+// Configured は設定済みの車輪のビット（.wheel<I>() のたびに型が変わる）
+template <int NMotors, unsigned Configured = 0>
+struct RobotConfig {
+    double wheel_radius_mm;
+    double turning_radius_mm;  // 差動二輪はタイヤ間距離の半分
+    ControlMode control_mode;
+    WheelConfig wheels[NMotors];
+
+    template <int I>
+    constexpr RobotConfig<NMotors, Configured | (1u << I)> wheel(const WheelConfig& config) const {
+        static_assert(I >= 0 && I < NMotors, "車輪番号が範囲外です");
+        static_assert((Configured & (1u << I)) == 0, "同じ車輪を 2 回設定しています");
+        RobotConfig<NMotors, Configured | (1u << I)> next = {wheel_radius_mm, turning_radius_mm, control_mode, {}};
+        for (int i = 0; i < NMotors; i++) {
+            next.wheels[i] = (i == I) ? config : wheels[i];
+        }
+        return next;
+    }
+
+    static constexpr bool isComplete() {
+        return Configured == (1u << NMotors) - 1;
+    }
+};
+
+template <int NMotors>
+constexpr RobotConfig<NMotors> robotConfig(double wheel_radius_mm, double turning_radius_mm, ControlMode control_mode = RPS_MODE) {
+    static_assert(NMotors > 0 && NMotors <= 4, "車輪は 1〜4 輪です");
+    return {wheel_radius_mm, turning_radius_mm, control_mode, {}};
+}
+
+// 運動学の作り方（TwoWheelKinematics だけ直径とタイヤ間距離で作る）
+template <class Drive>
+struct DriveFactory {
+    static Drive make(double wheel_radius_mm, double turning_radius_mm, ControlMode control_mode) {
+        return Drive(wheel_radius_mm, turning_radius_mm, control_mode);
+    }
+};
+
+template <>
+struct DriveFactory<TwoWheelKinematics> {
+    static TwoWheelKinematics make(double wheel_radius_mm, double turning_radius_mm, ControlMode control_mode) {
+        return TwoWheelKinematics(wheel_radius_mm * 2.0, turning_radius_mm * 2.0, control_mode);
+    }
+};
+
+// Drive: Mecanum / Omni3 / Omni4 / TwoWheelKinematics、NMotors: 車輪数、StackSize: 制御スレッドのスタック [byte]
+template <class Drive, int NMotors, uint32_t StackSize = OS_STACK_SIZE>
+class StaticRobotControl {
+    static_assert(NMotors == Drive::WHEEL_COUNT, "車輪数が運動学と合っていません");
+
+public:
+    template <unsigned Configured>
+    explicit StaticRobotControl(const RobotConfig<NMotors, Configured>& config)
+        : StaticRobotControl(config, std::make_index_sequence<NMotors>()) {
+        static_assert(RobotConfig<NMotors, Configured>::isComplete(), "設定していない車輪があります");
+    }
+
+    ~StaticRobotControl() {
+        stopControl();
+        if (thread_started) {
+            running = false;
+            motor_control_thread.join();
+        }
+    }
+
+    // 制御スレッドに this を渡しているのでコピーしない
+    StaticRobotControl(const StaticRobotControl&) = delete;
+    StaticRobotControl& operator=(const StaticRobotControl&) = delete;
+
+    // 実行中のゲイン変更（PID の内部状態はそのまま）
+    void setPIDGains(int motor_index, float kp, float ki, float kd, float time_constant) {
+        if (motor_index >= 0 && motor_index < NMotors) {
+            pids[motor_index].setGains(kp, ki, kd, time_constant);
+        }
+    }
+
+    void setOutputConfig(int motor_index, const MotorOutputConfig& config) {
+        if (motor_index >= 0 && motor_index < NMotors) {
+            outputs[motor_index].setConfig(config);
+        }
+    }
+
+    void setDecayMode(int motor_index, DecayMode decay_mode) {
+        if (motor_index >= 0 && motor_index < NMotors) {
+            motors[motor_index].setDecayMode(decay_mode);
+        }
+    }
+
+    // 目標回転数に応じて PID ゲインとフィードフォワードを切り替える（nullptr で固定ゲインに戻す）
+    void setGainSchedule(int motor_index, const GainSchedule* schedule) {
+        if (motor_index >= 0 && motor_index < NMotors) {
+            schedules[motor_index] = schedule;
+        }
+    }
+
+    // ゲインスケジュールの電圧補正に使う電池電圧 [V]
+    void setBatteryVoltage(float voltage) {
+        battery_voltage = voltage;
+    }
+
+    // 機体速度の加速度・躍度制限（既定は制限なし＝startControl の値をそのまま使う）
+    void setMotionLimits(const MotionProfileConfig& config) {
+        ScopedLock<Mutex> lock(control_mutex);
+        profile.setConfig(config);
+    }
+
+    // 車輪の目標値の上限（RPS_MODE なら rps、MMPS_MODE なら mm/s。0 で制限なし）
+    void setWheelSpeedLimit(double limit, TwistLimitPolicy policy = TWIST_LIMIT_UNIFORM) {
+        ScopedLock<Mutex> lock(control_mutex);
+        kinematics.setWheelLimit(limit);
+        kinematics.setLimitPolicy(policy);
+    }
+
+    void startControl(double vx_mm_s, double vy_mm_s, double omega_deg_s) {
+        SafetyMonitor_feed(&safety);
+        if (safety.state == SAFETY_BRAKE && SafetyMonitor_isRecoverable(&safety)) {
+            safety_resume = true;  // 指令の途絶・停止要求で止まっていたなら再開する
+        }
+        active = true;
+        if (!thread_started) {
+            motor_control_thread.start(callback(this, &StaticRobotControl::controlLoop));
+            thread_started = true;
+        }
+        // 目標の時点で車輪が飽和するなら、運動学で出せる速度に縮めた目標にしておく
+        // profile と kinematics は制御ループが 1 周期の間使っているので、周期の合間に書き換える
+        ScopedLock<Mutex> lock(control_mutex);
+        MotorControlData target_data = {};
+        AppliedTwist applied = kinematics.calc(vx_mm_s, vy_mm_s, omega_deg_s, target_data);
+        profile.setTarget(applied.vx_mm_s, applied.vy_mm_s, applied.omega_deg_s);
+    }
+
+    // 減速してからブレーキをかけ、制御ループを休ませる
+    // 制御スレッドは終わらせずに待たせる（mbed の Thread は start し直せない）ので、もう一度 startControl を呼べば再開する
+    void stopControl() {
+        SafetyMonitor_trip(&safety, SAFETY_FAULT_STOP_REQUEST);
+        if (!thread_started) {
+            return;
+        }
+        // 休ませている間（active が false）は減速する周期が回らないので待たない
+        int wait_ms = active ? static_cast<int>(safety.config.ramp_time * 1000.0f) + 20 : 0;
+        while (safety.state != SAFETY_BRAKE && wait_ms-- > 0) {
+            ThisThread::sleep_for(1ms);
+        }
+        // 制御ループは 1 周期を control_mutex を持ったまま回すので、ここで active を落とした後に Duty を書くことはない
+        ScopedLock<Mutex> lock(control_mutex);
+        active = false;
+        for (int i = 0; i < NMotors; i++) {
+            motors[i].brake();
+        }
+    }
+
+    // 安全監視（RobotControl と同じ。既定はすべて監視しない）
+    void setSafetyConfig(const SafetyConfig& config) {
+        safety.config = config;
+    }
+
+    void emergencyStop() {
+        SafetyMonitor_trip(&safety, SAFETY_FAULT_EMERGENCY);
+    }
+
+    void resetSafety() {
+        safety_resume = true;
+    }
+
+    SafetyState getSafetyState() const {
+        return safety.state;
+    }
+
+    uint8_t getSafetyFaults() const {
+        return safety.faults;
+    }
+
+    float getSafetyLatency() const {
+        return safety.max_latency;
+    }
+
+    double getMotorOutput(int motor_index) const {
+        return (motor_index >= 0 && motor_index < NMotors) ? motor_control_data.motor_data[motor_index].pwm_command : 0.0;
+    }
+
+    double getTargetRPS(int motor_index) const {
+        return (motor_index >= 0 && motor_index < NMotors) ? motor_control_data.motor_data[motor_index].target_value : 0.0;
+    }
+
+    // 差動二輪の自己位置（TwoWheelKinematics 以外では常に原点）
+    Position getPosition() const {
+        return positionOf(kinematics);
+    }
+
+    void resetPosition(float x_mm = 0.0f, float y_mm = 0.0f, float theta_deg = 0.0f) {
+        resetOdometry(kinematics, x_mm, y_mm, theta_deg);
+    }
+
+    Drive& getKinematics() {
+        return kinematics;
+    }
+
+private:
+    Drive kinematics;
+    MotorDriver motors[NMotors];
+    Encoder encoders[NMotors];
+    PIDController pids[NMotors];
+    MotorOutput outputs[NMotors];
+    const GainSchedule* schedules[NMotors];
+    float battery_voltage;
+    MotionProfile profile;
+    MotorControlData motor_control_data;
+    SafetyMonitor safety;
+    volatile bool safety_resume;
+    MBED_ALIGN(8) unsigned char stack[StackSize];
+    Thread motor_control_thread;
+    Mutex control_mutex;     // 制御ループの 1 周期と、stopControl・profile と kinematics の書き換えを排他する
+    volatile bool running;   // false で制御スレッドを終わらせる（デストラクタだけ）
+    volatile bool active;    // 制御ループが車輪を動かすか（startControl で true、stopControl で false）
+    bool thread_started;
+
+    template <unsigned Configured, size_t... I>
+    StaticRobotControl(const RobotConfig<NMotors, Configured>& config, std::index_sequence<I...>)
+        : kinematics(DriveFactory<Drive>::make(config.wheel_radius_mm, config.turning_radius_mm, config.control_mode)),
+          motors{{config.wheels[I].motor_pin1, config.wheels[I].motor_pin2}...},
+          encoders{{config.wheels[I].encoder_pin_a, config.wheels[I].encoder_pin_b}...},
+          pids{{config.wheels[I].kp, config.wheels[I].ki, config.wheels[I].kd, config.wheels[I].time_constant, 0.01f}...},
+          schedules{},
+          battery_voltage(0.0f),
+          motor_control_data{},
+          safety_resume(false),
+          motor_control_thread(osPriorityNormal, StackSize, stack),
+          running(true),
+          active(false),
+          thread_started(false) {
+        // PID の出力制限は controlLoop が毎周期、出力段の Duty の上限から決める
+        SafetyConfig safety_config = {};
+        SafetyMonitor_Init(&safety, &safety_config);
+    }
+
+    void controlLoop() {
+        // 周期は実測する（最初の 1 回は 10ms とする）
+        uint64_t last_time = Timebase::nowUs() - 10000;
+        while (running) {
+            float dt = Timebase::elapsed(last_time);
+            {
+                ScopedLock<Mutex> lock(control_mutex);
+                if (active) {
+                    controlStep(dt);
+                }
+            }
+            ThisThread::sleep_for(10ms);
+        }
+    }
+
+    // 制御ループの 1 周期（速度プロファイル → 運動学 → 安全監視 → PID → 出力整形）
+    void controlStep(float dt) {
+        if (safety_resume) {
+            safety_resume = false;
+            SafetyMonitor_reset(&safety);
+            for (int i = 0; i < NMotors; i++) {
+                pids[i].reset();
+                outputs[i].reset();
+            }
+        }
+        if (safety.state == SAFETY_BRAKE) {
+            profile.reset(0.0f, 0.0f, 0.0f);  // 再開するときは静止から加速させる
+        }
+
+        // 速度プロファイルを 1 周期進めて各車輪の目標値を更新する
+        profile.setPeriod(dt);
+        profile.update();
+        AppliedTwist applied = kinematics.calc(profile.getVx(), profile.getVy(), profile.getOmega(), motor_control_data);
+        if (applied.saturated) {
+            profile.limitVelocity(applied.vx_mm_s, applied.vy_mm_s, applied.omega_deg_s);
+        }
+        updateOdometry(kinematics, encoders);
+
+        // 安全監視を先に進め、この周期の Duty の上限（倍率 × max_duty）を決める
+        // 拘束の判定には、今の速度を生んだ前の周期の Duty を使う
+        double current_rps[NMotors];
+        for (int i = 0; i < NMotors; i++) {
+            current_rps[i] = encoders[i].getRPS();
+            SafetyMonitor_checkMotor(&safety, i, motor_control_data.motor_data[i].pwm_command,
+                                     motor_control_data.motor_data[i].target_value, current_rps[i], dt);
+        }
+        float scale = SafetyMonitor_update(&safety, dt);
+
+        for (int i = 0; i < NMotors; i++) {
+            if (safety.state == SAFETY_BRAKE) {
+                motor_control_data.motor_data[i].pwm_command = 0.0;
+                motors[i].brake();
+                continue;
+            }
+            double target = motor_control_data.motor_data[i].target_value;
+            double feedforward = 0.0;
+            if (schedules[i] != nullptr) {
+                GainSchedulePoint gains = schedules[i]->lookup(target, battery_voltage);
+                pids[i].setGains(gains.kp, gains.ki, gains.kd);
+                feedforward = gains.ff;
+            }
+            // PID が飽和するのを、出力段で Duty が上限に張り付くところに合わせる（フィードフォワードの分を除く）
+            float limit = outputs[i].getMaxDuty() * scale;
+            float offset = static_cast<float>(feedforward) + outputs[i].getFeedforward(target);
+            pids[i].setOutputLimits(-limit - offset, limit - offset);
+            double control_signal = pids[i].compute(target, current_rps[i], dt) + feedforward;
+            float duty = outputs[i].update(control_signal, target, dt, limit);
+            motor_control_data.motor_data[i].pwm_command = duty;
+            motors[i].setDuty(duty);
+        }
+    }
+
+    // オドメトリは差動二輪だけ（それ以外は何もしない方が選ばれる）
+    static void updateOdometry(TwoWheelKinematics& drive, Encoder* wheel_encoders) {
+        drive.updateOdometry(wheel_encoders[0], wheel_encoders[1]);
+    }
+    template <class D>
+    static void updateOdometry(D&, Encoder*) {}
+
+    static Position positionOf(const TwoWheelKinematics& drive) {
+        return drive.getPosition();
+    }
+    template <class D>
+    static Position positionOf(const D&) {
+        return {0.0f, 0.0f, 0.0f};
+    }
+
+    static void resetOdometry(TwoWheelKinematics& drive, float x_mm, float y_mm, float theta_deg) {
+        drive.resetOdometry(x_mm, y_mm, theta_deg);
+    }
+    template <class D>
+    static void resetOdometry(D&, float, float, float) {}
+};
+
+#endif // STATIC_ROBOT_CONTROL_H
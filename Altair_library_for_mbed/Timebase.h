@@ -0,0 +1,31 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include "mbed.h"
+
+// 全モジュール共通の単調増加の時刻 [us]（64 ビット、桁あふれなし）
+// mbed の us ティッカー（フリーランのタイマを mbed がソフトウェアで 64 ビットに拡張したもの）を読む
+//   - Kernel::Clock（1ms 刻み）と違い、速度や PID の dt を 1us 刻みで計れる
+//   - スリープ中も進み、16 ビットのティッカーのターゲットでも桁あふれしない
+// エンコーダの速度計算（hal_policy.h）、SkenMdd / CanMdd のタイムアウト、RobotControl の dt など、時間を計るところはすべてこれを使う
+struct Timebase {
+    // 今の時刻 [us]
+    static uint64_t nowUs() {
+        return ticker_read_us(get_us_ticker_data());
+    }
+
+    // 今の時刻 [us] の下位 32 ビット（差を取れば約 71 分まで正しい）
+    static uint32_t micros() {
+        return static_cast<uint32_t>(nowUs());
+    }
+
+    // last_us からの経過時間 [s] を返し、last_us を今の時刻にする
+    static float elapsed(uint64_t& last_us) {
+        uint64_t now = nowUs();
+        float elapsed = static_cast<float>(now - last_us) * 1e-6f;
+        last_us = now;
+        return elapsed;
+    }
+};
+
+#endif // TIMEBASE_H
@@ -2,24 +2,121 @@
 #define TWO_WHEEL_KINEMATICS_H
 
 #include "mbed.h"
+#include "Kinematics.h"
+#include "InverseKinematics.h"
 
-class TwoWheelKinematics {
+// 対向 2 輪（差動二輪）の運動学とオドメトリ
+//   - 逆運動学：vR = v + ω d/2, vL = v - ω d/2（旋回半径 v/ω を使わないので直進でも発散しない）
+//   - 出力は ControlMode に合わせて車輪の回転数 [rps] か周速 [mm/s]
+//   - 順運動学：左右の車輪速度から (v, ω)
+//   - オドメトリ：エンコーダのカウント差から円弧で厳密に積分した自己位置
+// RobotControl では motor 0 が右、motor 1 が左
+class TwoWheelKinematics : public Kinematics {
 public:
-    // コンストラクタでタイヤ直径とタイヤ間距離を設定する
-    TwoWheelKinematics(float wheel_diameter, float wheel_distance)
-        : wheel_diameter(wheel_diameter), wheel_distance(wheel_distance) {}
+    static constexpr int WHEEL_COUNT = 2;  // StaticRobotControl の車輪数チェック用
 
-    // ロボットの速度 (v) と旋回角速度 (omega) を入力し、各タイヤの速度を計算する
+    // wheel_diameter: タイヤ直径 [mm]、wheel_distance: タイヤ間距離 [mm]
+    // counts_per_rev: 1 回転あたりのエンコーダカウント（Encoder の既定は ENCODER_DEFAULT_COUNTS_PER_REV = 8192）
+    TwoWheelKinematics(float wheel_diameter, float wheel_distance, ControlMode mode = RPS_MODE, float counts_per_rev = ENCODER_DEFAULT_COUNTS_PER_REV)
+        : wheel_diameter(wheel_diameter), wheel_distance(wheel_distance), mode(mode),
+          mm_per_count(static_cast<float>(M_PI) * wheel_diameter / counts_per_rev),
+          x(0.0f), y(0.0f), theta(0.0f), last_right(0), last_left(0), has_counts(false) {}
+
+    // ロボットの速度 v [mm/s] と旋回角速度 omega [rad/s] から左右の車輪の目標値を計算する
     void calculateWheelSpeeds(float v, float omega, float &vR, float &vL) {
-        float R = v / omega; // 旋回半径の計算
+        float turn = omega * wheel_distance / 2.0f;
+        vR = toOutput(v + turn);
+        vL = toOutput(v - turn);
+    }
+
+    // 左右の車輪の目標値（ControlMode の単位）から v [mm/s] と omega [rad/s] を求める
+    void calculateTwist(float right, float left, float &v, float &omega) const {
+        float vR = toSurface(right);
+        float vL = toSurface(left);
+        v = (vR + vL) / 2.0f;
+        omega = (vR - vL) / wheel_distance;
+    }
+
+    // Kinematics としての計算（RobotControl 用）。vy は差動二輪では出せないので無視する
+    AppliedTwist calc(double vx_mm_s, double vy_mm_s, double omega_deg_s, MotorControlData& motor_control_data) override {
+        (void)vy_mm_s;
+        float turn = static_cast<float>(toOutput(omega_deg_s * M_PI / 180.0 * wheel_distance / 2.0));
+        float v = static_cast<float>(toOutput(vx_mm_s));
+        float translation[2] = {v, v};
+        float rotations[2] = {turn, -turn};
+        return applyLimits(translation, rotations, 2, vx_mm_s, 0.0, omega_deg_s, motor_control_data);
+    }
+
+    // エンコーダのカウント（右・左）から自己位置を更新する
+    // 1 周期の移動を円弧とみなして積分するので、旋回中でも直線近似の誤差が出ない
+    void updateOdometry(int32_t right_count, int32_t left_count) {
+        if (!has_counts) {
+            last_right = right_count;
+            last_left = left_count;
+            has_counts = true;
+            return;
+        }
+        // カウントが int32_t の上限をまたいでも差が正しくなるように、uint32_t で引いてから戻す
+        float dR = static_cast<int32_t>(static_cast<uint32_t>(right_count) - static_cast<uint32_t>(last_right)) * mm_per_count;
+        float dL = static_cast<int32_t>(static_cast<uint32_t>(left_count) - static_cast<uint32_t>(last_left)) * mm_per_count;
+        last_right = right_count;
+        last_left = left_count;
+
+        // 円弧の弦の長さは ds * sin(dθ/2) / (dθ/2)。半径 ds/dθ と sin の差で書くと、dθ が小さいとき（ゆるい曲線を
+        // 短い周期で積分するとき）に float の桁落ちで位置がずれる
+        float ds = (dR + dL) / 2.0f;
+        float dtheta = (dR - dL) / wheel_distance;
+        float half = dtheta / 2.0f;
+        float chord = (std::fabs(half) < 1e-6f) ? ds : ds * std::sin(half) / half;
+        x += chord * std::cos(theta + half);
+        y += chord * std::sin(theta + half);
+        theta += dtheta;
+        if (theta > static_cast<float>(M_PI)) theta -= 2.0f * static_cast<float>(M_PI);
+        if (theta < -static_cast<float>(M_PI)) theta += 2.0f * static_cast<float>(M_PI);
+    }
 
-        vR = (R + wheel_distance / 2.0) * omega; // 右車輪の速度
-        vL = (R - wheel_distance / 2.0) * omega; // 左車輪の速度
+    void updateOdometry(Encoder& right, Encoder& left) {
+        updateOdometry(right.getCount(), left.getCount());
+    }
+
+    // 自己位置（InverseKinematics と同じく x, y [mm]、theta [deg]（0〜360））
+    Position getPosition() const {
+        float deg = theta * 180.0f / static_cast<float>(M_PI);
+        if (deg < 0.0f) {
+            deg += 360.0f;
+        }
+        return {x, y, deg};
+    }
+
+    void resetOdometry(float x_mm = 0.0f, float y_mm = 0.0f, float theta_deg = 0.0f) {
+        x = x_mm;
+        y = y_mm;
+        theta = theta_deg * static_cast<float>(M_PI) / 180.0f;
+        has_counts = false;
     }
 
 private:
     float wheel_diameter;  // タイヤ直径 (mm)
     float wheel_distance;  // タイヤ間距離 (mm)
+    ControlMode mode;
+    float mm_per_count;
+
+    float x;
+    float y;
+    float theta;  // [rad]（-π〜π）
+    int32_t last_right;
+    int32_t last_left;
+    bool has_counts;
+
+    // 周速 [mm/s] → 出力単位
+    double toOutput(double surface_mm_s) const {
+        return (mode == RPS_MODE) ? surface_mm_s / (M_PI * wheel_diameter) : surface_mm_s;
+    }
+
+    // 出力単位 → 周速 [mm/s]
+    float toSurface(float value) const {
+        return (mode == RPS_MODE) ? value * static_cast<float>(M_PI) * wheel_diameter : value;
+    }
 };
 
 #endif // TWO_WHEEL_KINEMATICS_H
@@ -0,0 +1,154 @@
+#include "can_mdd.h"
+#include <cstring>
+
+namespace {
+
+void packInt16(unsigned char* dst, float value, float scale)
+{
+    float scaled = value * scale;
+    int16_t v;
+    if (scaled > 32767.0f) {
+        v = 32767;
+    } else if (scaled < -32768.0f) {
+        v = -32768;
+    } else {
+        v = static_cast<int16_t>(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+    }
+    dst[0] = static_cast<unsigned char>(v & 0xFF);
+    dst[1] = static_cast<unsigned char>((v >> 8) & 0xFF);
+}
+
+float unpackInt16(const unsigned char* src, float scale)
+{
+    int16_t v = static_cast<int16_t>(src[0] | (src[1] << 8));
+    return v / scale;
+}
+
+} // namespace
+
+CanMdd::CanMdd(CAN& can, uint8_t node) :
+    can(can), base_id(CAN_MDD_BASE_ID + (node << 3)), seq(0),
+    ack_seq(0), ack_command(0), ack_flag(false), telemetry_rps{}, telemetry_flag(false)
+{
+}
+
+void CanMdd::init()
+{
+    // ボーレートは CAN オブジェクト生成時に設定済み
+}
+
+bool CanMdd::tcp(uint8_t id, const float (&command_data)[4], unsigned int resend_time, unsigned int max_wait_time)
+{
+    uint8_t tx_seq = ++seq;
+    // 指令フレームには seq を載せられないため、MDD はコマンドID のみを返す（seq=0）
+    uint8_t expect_seq = (id == MOTOR_RPS_COMMAND_MODE || id == MOTOR_PWM_COMMAND_MODE) ? 0 : tx_seq;
+    uint64_t start_time = Timebase::nowUs();
+    uint64_t send_time = start_time;
+    uint64_t now;
+
+    ack_flag = false;
+    sendData(id, command_data, tx_seq);
+    while ((now = Timebase::nowUs()) - start_time < max_wait_time * 1000ULL) {
+        pollReceive();
+        if (ack_flag && ack_seq == expect_seq && ack_command == id) {
+            ack_flag = false;
+            return true;
+        }
+        if (now - send_time >= resend_time * 1000ULL) {
+            sendData(id, command_data, tx_seq); // 再送信
+            send_time = now;
+        }
+    }
+    return false; // 最大待機時間を超えた場合、失敗を返す
+}
+
+void CanMdd::udp(uint8_t id, const float (&command_data)[4])
+{
+    sendData(id, command_data, ++seq);
+}
+
+void CanMdd::sync()
+{
+    writeFrame(CANMessage(CAN_MDD_SYNC_ID, static_cast<const unsigned char*>(nullptr), 0));
+}
+
+bool CanMdd::handleMessage(const CANMessage& msg)
+{
+    if (msg.id == base_id + CAN_MDD_OFS_ACK && msg.len >= 2) {
+        ack_seq = msg.data[0];
+        ack_command = msg.data[1];
+        ack_flag = true;
+        return true;
+    }
+    if (msg.id == base_id + CAN_MDD_OFS_TELEMETRY && msg.len == 8) {
+        for (int i = 0; i < 4; i++) {
+            telemetry_rps[i] = unpackInt16(&msg.data[i * 2], CAN_MDD_RPS_SCALE);
+        }
+        telemetry_flag = true;
+        return true;
+    }
+    return false;
+}
+
+bool CanMdd::readTelemetry(float (&rps)[4])
+{
+    pollReceive();
+    if (!telemetry_flag) {
+        return false;
+    }
+    for (int i = 0; i < 4; i++) {
+        rps[i] = telemetry_rps[i];
+    }
+    telemetry_flag = false;
+    return true;
+}
+
+bool CanMdd::sendData(uint8_t id, const float (&command_data)[4], uint8_t tx_seq)
+{
+    unsigned char data[8];
+
+    if (id == MOTOR_RPS_COMMAND_MODE || id == MOTOR_PWM_COMMAND_MODE) {
+        // 4 モータ分の指令を 1 フレームにまとめる
+        float scale = (id == MOTOR_RPS_COMMAND_MODE) ? CAN_MDD_RPS_SCALE : CAN_MDD_PWM_SCALE;
+        unsigned int ofs = (id == MOTOR_RPS_COMMAND_MODE) ? CAN_MDD_OFS_RPS : CAN_MDD_OFS_PWM;
+        for (int i = 0; i < 4; i++) {
+            packInt16(&data[i * 2], command_data[i], scale);
+        }
+        return writeFrame(CANMessage(base_id + ofs, data, 8));
+    }
+
+    // 設定コマンドは float 1 個ずつ、ID を分けて 4 フレームで送る
+    // 送信メールボックスは 3 個なので、4 フレーム目（設定を反映させるフレーム）は 1 個空くまで待つ
+    for (int i = 0; i < 4; i++) {
+        data[0] = id;
+        data[1] = tx_seq;
+        data[2] = 0;
+        data[3] = 0;
+        memcpy(&data[4], &command_data[i], sizeof(float));
+        if (!writeFrame(CANMessage(base_id + CAN_MDD_OFS_CONFIG + i, data, 8))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 送信メールボックスが空くまで待って 1 フレーム送る（CAN_MDD_TX_TIMEOUT_US 待っても空かなければ false）
+bool CanMdd::writeFrame(const CANMessage& msg)
+{
+    uint64_t start_time = Timebase::nowUs();
+    while (!can.write(msg)) {
+        if (Timebase::nowUs() - start_time >= CAN_MDD_TX_TIMEOUT_US) {
+            return false; // バスオフ・相手がいない（ACK が返らず再送が続く）など
+        }
+        pollReceive(); // 待っている間も受信 FIFO（3 段）があふれないように読む
+    }
+    return true;
+}
+
+void CanMdd::pollReceive()
+{
+    CANMessage msg;
+    while (can.read(msg)) {
+        handleMessage(msg);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef CAN_MDD_H_
+#define CAN_MDD_H_
+
+#include "mbed.h"
+#include "mdd.h"
+
+// SkenMdd（UART）と同じコマンド体系を CAN で送る MDD ドライバ
+//
+// ID 割り当て（ノードごとに 8 ID を使用、IDが小さいほど優先度が高い）
+//   CAN_MDD_SYNC_ID                 : 全ノード共通の同期フレーム（DLC=0）
+//   base + CAN_MDD_OFS_RPS          : 4 モータ分の RPS 指令（int16 x4, 0.01rps 単位）
+//   base + CAN_MDD_OFS_PWM          : 4 モータ分の PWM 指令（int16 x4, 0.01% 単位）
+//   base + CAN_MDD_OFS_ACK          : MDD からの ACK（[0]=seq, [1]=コマンドID）
+//   base + CAN_MDD_OFS_TELEMETRY    : MDD からの実測 RPS（int16 x4, 0.01rps 単位）
+//   base + CAN_MDD_OFS_CONFIG + n   : 設定コマンドの n 番目の float（[0]=コマンドID, [1]=seq, [4..7]=float）
+// base = CAN_MDD_BASE_ID + node * 8
+// CubeIDE 版 can_mdd.h と同じ割り当て
+
+constexpr unsigned int CAN_MDD_SYNC_ID = 0x080;
+constexpr unsigned int CAN_MDD_BASE_ID = 0x100;
+constexpr unsigned int CAN_MDD_OFS_RPS = 0;
+constexpr unsigned int CAN_MDD_OFS_PWM = 1;
+constexpr unsigned int CAN_MDD_OFS_ACK = 2;
+constexpr unsigned int CAN_MDD_OFS_TELEMETRY = 3;
+constexpr unsigned int CAN_MDD_OFS_CONFIG = 4;
+constexpr float CAN_MDD_RPS_SCALE = 100.0f;
+constexpr float CAN_MDD_PWM_SCALE = 100.0f;
+constexpr uint64_t CAN_MDD_TX_TIMEOUT_US = 2000;   // 送信メールボックスが空くのを待つ最大時間（125kbps でも 8 バイト 1 フレーム分より長い）
+
+class CanMdd : public MddInterface {
+public:
+    CanMdd(CAN& can, uint8_t node);
+
+    void init() override;
+    bool tcp(uint8_t id, const float (&command_data)[4], unsigned int resend_time, unsigned int max_wait_time) override;
+    void udp(uint8_t id, const float (&command_data)[4]) override;
+
+    // 全ノードへ同期フレームを送信（各 MDD は受信済みの指令をこのタイミングで反映する）
+    void sync();
+
+    // 受信フレームを解釈する（自ノード宛てなら true）
+    bool handleMessage(const CANMessage& msg);
+
+    // テレメトリを読み出す（新しいデータがあれば true）
+    bool readTelemetry(float (&rps)[4]);
+
+private:
+    CAN& can;
+    unsigned int base_id;
+    uint8_t seq;
+    uint8_t ack_seq;
+    uint8_t ack_command;
+    bool ack_flag;
+    float telemetry_rps[4];
+    bool telemetry_flag;
+
+    bool sendData(uint8_t id, const float (&command_data)[4], uint8_t seq);
+    bool writeFrame(const CANMessage& msg);
+    void pollReceive();
+};
+
+#endif /* CAN_MDD_H_ */
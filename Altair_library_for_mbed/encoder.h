@@ -2,27 +2,15 @@
 #define ENCODER_H
 
 #include "mbed.h"
+#include "hal_policy.h"
 
-class Encoder {
+// A/B 相エンコーダ（両相の両エッジで割り込み、4 逓倍）
+// 解読と回転数の計算は hal_core.h の HalEncoder（getCount / getRPS / reset）で、ピンの読み出しは AltairHal
+// counts_per_rev: 1 回転あたりのカウント（既定は ENCODER_DEFAULT_COUNTS_PER_REV = 8192）
+class Encoder : public HalEncoder<AltairHal> {
 public:
-    Encoder(PinName pinA, PinName pinB); // エンコーダの初期化
-
-    int32_t getCount(); // カウント値を取得
-    float getRPS(); // 回転速度 (RPS) を取得
-    void reset(); // カウントをリセット
-
-private:
-    void setupInterrupts(); // 割り込みを設定
-    void counterArise(); // A相の立ち上がり時にカウント
-    void counterAfall(); // A相の立ち下がり時にカウント
-    void counterBrise(); // B相の立ち上がり時にカウント
-    void counterBfall(); // B相の立ち下がり時にカウント
-
-    volatile int32_t encoder_count; // エンコーダのカウント値
-    int32_t last_count; // 前回のカウント値
-    Timer timer; // 時間計測用タイマー
-    InterruptIn interruptA; // A相の割り込み
-    InterruptIn interruptB; // B相の割り込み
+    Encoder(PinName pinA, PinName pinB, float counts_per_rev = ENCODER_DEFAULT_COUNTS_PER_REV)
+        : HalEncoder<AltairHal>(pinA, pinB, counts_per_rev) {}
 };
 
 #endif // ENCODER_H
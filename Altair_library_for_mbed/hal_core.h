@@ -0,0 +1,224 @@
+#ifndef HAL_CORE_H
+#define HAL_CORE_H
+
+#include <stdint.h>
+
+// ハードウェアアクセスをテンプレート引数（ポリシー）で差し替える共通コア（ヘッダのみ、mbed / Arduino で同一内容）
+//   - エンコーダの分解能・A/B 相の解読・Duty の扱いを 1 か所にまとめ、移植ごとの食い違いをなくす
+//   - コア（HalEncoder, HalMotorDriver）はポリシーの inline 関数だけを呼ぶので、ピン操作が制御コードにそのまま展開される
+//   - ポリシーは hal_policy.h（mbed：MbedHal / Stm32Hal、Arduino：ArduinoHal / ArduinoFastHal）と、ホスト用の MockHal
+//
+// ポリシーに必要なもの
+//   typename Hal::Pin                   ピンの型（PinName / int）
+//   typename Hal::Input(pin)            read() で 0 / 1、onChange(handler, context) で両エッジのたびに handler(context) を呼ぶ
+//   typename Hal::Pwm(pin, period_us)   write(duty) で Duty（0.0〜1.0）を出力する
+//   Hal::micros()                       1us 刻みの時刻（uint32_t、桁あふれしてよい）
+
+// 1 回転あたりのエンコーダカウントの既定値（2048 パルス × 4 逓倍）
+#ifndef ENCODER_DEFAULT_COUNTS_PER_REV
+#define ENCODER_DEFAULT_COUNTS_PER_REV 8192
+#endif
+
+// 出力 0 のときの停止方法
+enum DecayMode {
+    COAST_DECAY, // フリーラン（両ch Low）
+    BRAKE_DECAY  // ショートブレーキ（両ch High）
+};
+
+// A/B 相の前回と今回の状態（A を上位ビットにした 2 ビット）からカウントの増減を返す（4 逓倍）
+// A の立ち上がりで B が Low のときを正転とする。2 相同時の変化（読み飛ばし）とチャタリングは 0
+static inline int8_t Quadrature_step(uint8_t previous, uint8_t current) {
+    static const int8_t table[16] = {
+        0, -1, 1, 0,
+        1, 0, 0, -1,
+        -1, 0, 0, 1,
+        0, 1, -1, 0
+    };
+    return table[((previous & 3U) << 2) | (current & 3U)];
+}
+
+// A/B 相エンコーダ（両相の両エッジで割り込み、4 逓倍）
+template <class Hal>
+class HalEncoder {
+public:
+    HalEncoder(typename Hal::Pin pinA, typename Hal::Pin pinB, float counts_per_rev = ENCODER_DEFAULT_COUNTS_PER_REV)
+        : a(pinA), b(pinB), count(0), last_count(0), last_time(Hal::micros()) {
+        setCountsPerRev(counts_per_rev);
+        state = readState();
+        a.onChange(&HalEncoder::onEdge, this);
+        b.onChange(&HalEncoder::onEdge, this);
+    }
+
+    // 割り込みに this を登録しているのでコピーしない
+    HalEncoder(const HalEncoder&) = delete;
+    HalEncoder& operator=(const HalEncoder&) = delete;
+
+    int32_t getCount() const {
+        return count;
+    }
+
+    // 前回呼んでからの平均回転数 [rps]
+    float getRPS() {
+        int32_t current = count;
+        uint32_t now = Hal::micros();
+        int32_t delta_count = current - last_count;
+        uint32_t elapsed = now - last_time;
+        last_count = current;
+        last_time = now;
+        if (elapsed == 0) {
+            return 0.0f;
+        }
+        return static_cast<float>(delta_count) * rev_per_count_us / static_cast<float>(elapsed);
+    }
+
+    void reset() {
+        count = 0;
+        last_count = 0;
+    }
+
+    void setCountsPerRev(float counts_per_rev) {
+        rev_per_count_us = 1e6f / counts_per_rev;
+    }
+
+private:
+    typename Hal::Input a;
+    typename Hal::Input b;
+    volatile int32_t count;
+    uint8_t state;            // 前回の A/B 相
+    int32_t last_count;
+    uint32_t last_time;
+    float rev_per_count_us;   // 1 カウント / 1us を rps に直す係数
+
+    uint8_t readState() {
+        return static_cast<uint8_t>((a.read() << 1) | b.read());
+    }
+
+    static void onEdge(void* context) {
+        HalEncoder* self = static_cast<HalEncoder*>(context);
+        uint8_t current = self->readState();
+        self->count = self->count + Quadrature_step(self->state, current);
+        self->state = current;
+    }
+};
+
+// 2 本の PWM で正転・逆転するモータドライバ
+template <class Hal>
+class HalMotorDriver {
+public:
+    // period_us: PWM 周期 [us]（Arduino では使わない）、max_duty: 正転・逆転の Duty の上限
+    HalMotorDriver(typename Hal::Pin pin1, typename Hal::Pin pin2, uint32_t period_us = 100, float max_duty = 0.95f)
+        : ps1(pin1, period_us), ps2(pin2, period_us), decay_mode(COAST_DECAY), max_duty(max_duty) {
+        stop();
+    }
+
+    // Duty を小数で設定する（-1.0〜1.0）
+    // 0 のときは setDecayMode で選んだ方法で停止する
+    void setDuty(float duty) {
+        if (duty > 0.0f) {
+            ps1.write(duty < max_duty ? duty : max_duty);
+            ps2.write(0.0f);
+        } else if (duty < 0.0f) {
+            ps1.write(0.0f);
+            ps2.write(-duty < max_duty ? -duty : max_duty);
+        } else if (decay_mode == BRAKE_DECAY) {
+            brake();
+        } else {
+            stop();
+        }
+    }
+
+    void setDecayMode(DecayMode mode) {
+        decay_mode = mode;
+    }
+
+    void stop() {
+        ps1.write(0.0f);
+        ps2.write(0.0f);
+    }
+
+    // ショートブレーキ（両ch High）
+    void brake() {
+        ps1.write(1.0f);
+        ps2.write(1.0f);
+    }
+
+protected:
+    typename Hal::Pwm ps1;
+    typename Hal::Pwm ps2;
+    DecayMode decay_mode;
+    float max_duty;
+};
+
+// ホストでコアを動かすためのポリシー（ピンのレベル・Duty・時刻をメモリ上に持つ）
+//   MockHal::setLevel でピンを変えると、onChange で登録したハンドラが呼ばれる
+struct MockHal {
+    typedef int Pin;
+    static const int PIN_COUNT = 64;
+
+    struct State {
+        uint8_t level[PIN_COUNT];
+        float duty[PIN_COUNT];
+        void (*handler[PIN_COUNT])(void*);
+        void* context[PIN_COUNT];
+        uint32_t now_us;
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+
+    class Input {
+    public:
+        explicit Input(Pin pin) : pin(pin) {}
+        int read() const {
+            return state().level[pin];
+        }
+        void onChange(void (*handler)(void*), void* context) {
+            state().handler[pin] = handler;
+            state().context[pin] = context;
+        }
+
+    private:
+        Pin pin;
+    };
+
+    class Pwm {
+    public:
+        Pwm(Pin pin, uint32_t period_us) : pin(pin) {
+            (void)period_us;
+        }
+        void write(float duty) {
+            state().duty[pin] = duty;
+        }
+
+    private:
+        Pin pin;
+    };
+
+    static uint32_t micros() {
+        return state().now_us;
+    }
+
+    // ピンのレベルを変える（変化したら登録済みのハンドラを呼ぶ）
+    static void setLevel(Pin pin, int level) {
+        State& s = state();
+        uint8_t value = level ? 1 : 0;
+        if (s.level[pin] != value) {
+            s.level[pin] = value;
+            if (s.handler[pin]) {
+                s.handler[pin](s.context[pin]);
+            }
+        }
+    }
+
+    static void advance(uint32_t us) {
+        state().now_us += us;
+    }
+
+    static float duty(Pin pin) {
+        return state().duty[pin];
+    }
+};
+
+#endif // HAL_CORE_H
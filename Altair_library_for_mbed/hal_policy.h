@@ -0,0 +1,126 @@
+#ifndef HAL_POLICY_H
+#define HAL_POLICY_H
+
+#include "mbed.h"
+#include "gpio_api.h"
+#include "pinmap.h"
+#include "PeripheralPins.h"
+#include "hal_core.h"
+#include "Timebase.h"
+
+// hal_core.h のコアに渡す mbed 用のポリシー
+//   - MbedHal：mbed の API（InterruptIn::read、PwmOut::write）をそのまま使う
+//   - Stm32Hal：割り込みの登録とピンの初期化だけ mbed に任せ、読み書きはレジスタへ直接行う
+//       入力は GPIO の IDR をマスクで読み、PWM はピンに対応するタイマの CCR へ Duty × (ARR + 1) を書く
+// MotorDriver / Encoder は AltairHal（既定は Stm32Hal、ALTAIR_USE_MBED_HAL を定義すると MbedHal）を使う
+
+struct MbedHal {
+    typedef PinName Pin;
+
+    class Input {
+    public:
+        explicit Input(PinName pin) : in(pin), handler(nullptr), context(nullptr) {}
+        int read() {
+            return in.read();
+        }
+        void onChange(void (*new_handler)(void*), void* new_context) {
+            handler = new_handler;
+            context = new_context;
+            in.rise(callback(this, &Input::dispatch));
+            in.fall(callback(this, &Input::dispatch));
+        }
+
+    private:
+        InterruptIn in;
+        void (*handler)(void*);
+        void* context;
+
+        void dispatch() {
+            handler(context);
+        }
+    };
+
+    class Pwm {
+    public:
+        Pwm(PinName pin, uint32_t period_us) : out(pin) {
+            out.period_us(static_cast<int>(period_us));
+        }
+        void write(float duty) {
+            out.write(duty);
+        }
+
+    private:
+        PwmOut out;
+    };
+
+    static uint32_t micros() {
+        return Timebase::micros();
+    }
+};
+
+struct Stm32Hal {
+    typedef PinName Pin;
+
+    class Input {
+    public:
+        explicit Input(PinName pin) : in(pin), handler(nullptr), context(nullptr) {
+            gpio_t gpio;
+            gpio_init_in(&gpio, pin);
+            reg_in = gpio.reg_in;
+            mask = gpio.mask;
+        }
+        int read() const {
+            return (*reg_in & mask) ? 1 : 0;
+        }
+        void onChange(void (*new_handler)(void*), void* new_context) {
+            handler = new_handler;
+            context = new_context;
+            in.rise(callback(this, &Input::dispatch));
+            in.fall(callback(this, &Input::dispatch));
+        }
+
+    private:
+        InterruptIn in;           // EXTI の設定と割り込みの登録用
+        volatile uint32_t* reg_in;
+        uint32_t mask;
+        void (*handler)(void*);
+        void* context;
+
+        void dispatch() {
+            handler(context);
+        }
+    };
+
+    class Pwm {
+    public:
+        // PwmOut でピンとタイマを設定してから、CCR のアドレスと 1.0 あたりのカウント値を取っておく
+        Pwm(PinName pin, uint32_t period_us) : out(pin) {
+            out.period_us(static_cast<int>(period_us));
+            out.write(0.0f);
+            TIM_TypeDef* tim = reinterpret_cast<TIM_TypeDef*>(pinmap_peripheral(pin, PinMap_PWM));
+            uint32_t index = STM_PIN_CHANNEL(pinmap_function(pin, PinMap_PWM)) - 1;
+            ccr = &tim->CCR1 + index;
+            full_scale = static_cast<float>(tim->ARR + 1);
+        }
+        void write(float duty) {
+            *ccr = static_cast<uint32_t>(duty * full_scale);
+        }
+
+    private:
+        PwmOut out;
+        volatile uint32_t* ccr;
+        float full_scale;   // ARR + 1（Duty 1.0 のときの CCR）
+    };
+
+    static uint32_t micros() {
+        return Timebase::micros();
+    }
+};
+
+#ifdef ALTAIR_USE_MBED_HAL
+typedef MbedHal AltairHal;
+#else
+typedef Stm32Hal AltairHal;
+#endif
+
+#endif // HAL_POLICY_H
@@ -2,6 +2,8 @@
 #define MDD_H_
 
 #include "mbed.h"
+#include "mdd_frame.h"
+#include "Timebase.h"
 
 union ConvertIntFloat {
     int int_val;
@@ -9,35 +11,26 @@ union ConvertIntFloat {
     float float_val;
 };
 
-enum MddCommandId {
-    MOTOR_RPS_COMMAND_MODE = 0,
-    MOTOR_PWM_COMMAND_MODE,
-    MECANUM_MODE,
-    OMNI3_MODE,
-    OMNI4_MODE,
-    M1_PID_GAIN_CONFIG,
-    M2_PID_GAIN_CONFIG,
-    M3_PID_GAIN_CONFIG,
-    M4_PID_GAIN_CONFIG,
-    ROBOT_DIAMETER_CONFIG,
-    PID_RESET_COMMAND,
-    MOTOR_COMMAND_MODE_SELECT,
-    ENCODER_RESOLUTION_CONFIG
+// MDD への送信経路（UART / CAN）を差し替えるための共通インターフェース
+class MddInterface {
+public:
+    virtual void init() = 0;
+    virtual bool tcp(uint8_t id, const float (&command_data)[4], unsigned int resend_time, unsigned int max_wait_time) = 0;
+    virtual void udp(uint8_t id, const float (&command_data)[4]) = 0;
+    virtual ~MddInterface() = default; // 仮想デストラクタ
 };
 
-class SkenMdd {
+class SkenMdd : public MddInterface {
 private:
     BufferedSerial& serial;
     uint8_t seq;
     void sendData(uint8_t id, const float (&data)[4]);
-    void setFloatData(const float (&command_data)[4], uint8_t (&send_data)[21]);
-    uint8_t calcChecksum(const uint8_t (&send_data)[21]);
 
 public:
     SkenMdd(BufferedSerial& s);
-    void init();
-    bool tcp(uint8_t id, const float (&command_data)[4], unsigned int resend_time, unsigned int max_wait_time);
-    void udp(uint8_t id, const float (&command_data)[4]);
+    void init() override;
+    bool tcp(uint8_t id, const float (&command_data)[4], unsigned int resend_time, unsigned int max_wait_time) override;
+    void udp(uint8_t id, const float (&command_data)[4]) override;
 };
 
 #endif /* MDD_H_ */
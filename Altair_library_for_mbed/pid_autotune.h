@@ -0,0 +1,258 @@
+#ifndef PID_AUTOTUNE_H_
+#define PID_AUTOTUNE_H_
+
+// リレー帰還による PID オートチューナ（ヘッダのみ、動的確保なし）
+// 制御ループの中で 1 周期ごとに PidAutotune_update を呼び、返り値の Duty をモータに出力する。
+//   1. ステップ試験：step_duty を step_time [s] 出力し、定常値から静的ゲイン K を求める
+//   2. リレー試験：定常値を中心に step_duty ± relay_amplitude を切り替えて持続振動させ、
+//      振動の周期と振幅から、その周波数でのプラントのゲインと位相を求める
+//   3. K とその 1 点から一次遅れ＋むだ時間（FOPDT）モデル K, tau, L を同定し、モデルの限界ゲイン Ku・限界周期 Pu を解いて、
+//      Ziegler–Nichols（Ku, Pu から）と SIMC（K, tau, L から）のゲインを計算する
+// CubeIDE / mbed / Arduino で同一内容
+
+#include <math.h>
+
+#ifndef PID_AUTOTUNE_PI
+#define PID_AUTOTUNE_PI 3.14159265359f
+#endif
+
+typedef enum
+{
+    PID_AUTOTUNE_IDLE,
+    PID_AUTOTUNE_STEP,
+    PID_AUTOTUNE_RELAY,
+    PID_AUTOTUNE_DONE,
+    PID_AUTOTUNE_FAILED
+} PidAutotuneState;
+
+typedef enum
+{
+    PID_AUTOTUNE_RULE_ZN,   // Ziegler–Nichols（PID）
+    PID_AUTOTUNE_RULE_SIMC  // SIMC（PI）
+} PidAutotuneRule;
+
+typedef struct
+{
+    float step_duty;        // ステップ試験・リレー中心の Duty
+    float relay_amplitude;  // リレーの振幅（Duty）
+    float hysteresis;       // リレーのヒステリシス（測定値の単位、ノイズ対策）
+    float step_time;        // ステップ試験の時間 [s]
+    int   cycles;           // 平均に使うリレー振動の周期数（1 以上）
+    float timeout;          // リレー試験のタイムアウト [s]
+    float tau_c;            // SIMC の閉ループ時定数 [s]（0 でむだ時間 L と同じ）
+    PidAutotuneRule rule;   // 結果の kp, ki, kd に採用する調整則
+} PidAutotuneConfig;
+
+typedef struct
+{
+    float k;        // 静的ゲイン [測定値 / duty]
+    float tau;      // 時定数 [s]
+    float dead_time;// むだ時間 [s]
+    float ku;       // 限界ゲイン（同定したモデルの値）
+    float pu;       // 限界周期 [s]（同定したモデルの値）
+    float kp;
+    float ki;
+    float kd;
+} PidAutotuneResult;
+
+typedef struct
+{
+    PidAutotuneConfig config;
+    PidAutotuneResult result;
+    PidAutotuneState state;
+
+    float time;             // 現在の試験の経過時間 [s]
+    float sum;              // ステップ試験：定常値の積算
+    int   samples;
+    float center;           // リレー中心（ステップ試験の定常値）
+    float output;           // 現在の出力 Duty
+    float last_switch_time; // 前回の上向き切り替え時刻
+    float period_sum;
+    float amplitude_sum;
+    float cycle_max;
+    float cycle_min;
+    int   cycle_count;      // period_sum / amplitude_sum に積算した周期数
+} PidAutotune;
+
+// 試験できない設定（平均する周期がない、ステップ試験の Duty が 0 で K が求まらない）なら 0
+static inline int PidAutotune_isConfigValid(const PidAutotuneConfig *config)
+{
+    return config->cycles > 0 && config->step_duty != 0.0f;
+}
+
+// 返り値: 設定を受け付けたら 1、試験できない設定なら 0（state は PID_AUTOTUNE_FAILED になる）
+static inline int PidAutotune_Init(PidAutotune *tuner, const PidAutotuneConfig *config)
+{
+    tuner->config = *config;
+    tuner->output = 0.0f;
+    if (!PidAutotune_isConfigValid(config))
+    {
+        tuner->state = PID_AUTOTUNE_FAILED;
+        return 0;
+    }
+    tuner->state = PID_AUTOTUNE_IDLE;
+    return 1;
+}
+
+static inline void PidAutotune_start(PidAutotune *tuner)
+{
+    if (!PidAutotune_isConfigValid(&tuner->config))
+    {
+        tuner->state = PID_AUTOTUNE_FAILED;
+        tuner->output = 0.0f;
+        return;
+    }
+    tuner->state = PID_AUTOTUNE_STEP;
+    tuner->time = 0.0f;
+    tuner->sum = 0.0f;
+    tuner->samples = 0;
+    tuner->output = tuner->config.step_duty;
+}
+
+static inline void PidAutotune_finish(PidAutotune *tuner)
+{
+    PidAutotuneResult *r = &tuner->result;
+    float a = tuner->amplitude_sum / (float)tuner->cycle_count;
+    float h = tuner->config.hysteresis;
+    float period = tuner->period_sum / (float)tuner->cycle_count;
+    float omega;
+    float kg;
+    float lo;
+    float hi;
+    float tau_c;
+    int i;
+
+    if (a <= h || period <= 0.0f || r->k <= 0.0f)
+    {
+        tuner->state = PID_AUTOTUNE_FAILED;
+        return;
+    }
+
+    // 記述関数法：ヒステリシス付きリレーは |G| = πa / (4d)、∠G = -π + asin(h/a) の周波数で振動する
+    // （ヒステリシスの分だけ位相の遅れが π より小さい、限界周期より長い周期で振動する）
+    omega = 2.0f * PID_AUTOTUNE_PI / period;
+    kg = r->k * 4.0f * tuner->config.relay_amplitude / (PID_AUTOTUNE_PI * a);   // K / |G|
+
+    // その 1 点を通る FOPDT を解く
+    r->tau = (kg > 1.0f) ? sqrtf(kg * kg - 1.0f) / omega : 0.0f;
+    r->dead_time = (PID_AUTOTUNE_PI - asinf(h / a) - atanf(omega * r->tau)) / omega;
+    if (r->dead_time <= 0.0f)
+    {
+        tuner->state = PID_AUTOTUNE_FAILED;  // むだ時間のない一次遅れとしか説明できない（リレーでは振動しないはず）
+        return;
+    }
+
+    // モデルの限界周波数 atan(ωτ) + ωL = π を二分法で解く（左辺は ω について単調増加、ω = π/L で π を超える）
+    lo = 0.0f;
+    hi = PID_AUTOTUNE_PI / r->dead_time;
+    for (i = 0; i < 40; i++)
+    {
+        float mid = 0.5f * (lo + hi);
+        if (atanf(mid * r->tau) + mid * r->dead_time < PID_AUTOTUNE_PI)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    r->ku = sqrtf(1.0f + lo * r->tau * lo * r->tau) / r->k;
+    r->pu = 2.0f * PID_AUTOTUNE_PI / lo;
+
+    if (tuner->config.rule == PID_AUTOTUNE_RULE_ZN)
+    {
+        r->kp = 0.6f * r->ku;
+        r->ki = r->kp / (0.5f * r->pu);
+        r->kd = r->kp * 0.125f * r->pu;
+    }
+    else
+    {
+        tau_c = (tuner->config.tau_c > 0.0f) ? tuner->config.tau_c : r->dead_time;
+        r->kp = r->tau / (r->k * (tau_c + r->dead_time));
+        r->ki = r->kp / fminf(r->tau, 4.0f * (tau_c + r->dead_time));
+        r->kd = 0.0f;
+    }
+    tuner->state = PID_AUTOTUNE_DONE;
+}
+
+// 1 制御周期ごとに呼ぶ。measurement: 測定値（rps など）、dt: 制御周期 [s]
+// 返り値: モータに出力する Duty（試験終了後は 0）
+static inline float PidAutotune_update(PidAutotune *tuner, float measurement, float dt)
+{
+    const PidAutotuneConfig *c = &tuner->config;
+
+    tuner->time += dt;
+
+    if (tuner->state == PID_AUTOTUNE_STEP)
+    {
+        // 後半 1/4 の平均を定常値とする
+        if (tuner->time > c->step_time * 0.75f)
+        {
+            tuner->sum += measurement;
+            tuner->samples++;
+        }
+        if (tuner->time >= c->step_time)
+        {
+            tuner->center = (tuner->samples > 0) ? tuner->sum / (float)tuner->samples : measurement;
+            tuner->result.k = tuner->center / c->step_duty;
+            tuner->state = PID_AUTOTUNE_RELAY;
+            tuner->time = 0.0f;
+            tuner->last_switch_time = -1.0f;
+            tuner->period_sum = 0.0f;
+            tuner->amplitude_sum = 0.0f;
+            tuner->cycle_max = measurement;
+            tuner->cycle_min = measurement;
+            tuner->cycle_count = 0;
+            tuner->output = c->step_duty + c->relay_amplitude;
+        }
+    }
+    else if (tuner->state == PID_AUTOTUNE_RELAY)
+    {
+        if (measurement > tuner->cycle_max) tuner->cycle_max = measurement;
+        if (measurement < tuner->cycle_min) tuner->cycle_min = measurement;
+
+        if (measurement > tuner->center + c->hysteresis)
+        {
+            tuner->output = c->step_duty - c->relay_amplitude;
+        }
+        else if (measurement < tuner->center - c->hysteresis && tuner->output < c->step_duty)
+        {
+            // 上向きに切り替わった時刻で 1 周期を区切る
+            // （リレー開始から最初の切り替えまでは周期の途中なので捨てる）
+            tuner->output = c->step_duty + c->relay_amplitude;
+            if (tuner->last_switch_time >= 0.0f)
+            {
+                tuner->period_sum += tuner->time - tuner->last_switch_time;
+                tuner->amplitude_sum += 0.5f * (tuner->cycle_max - tuner->cycle_min);
+                tuner->cycle_count++;
+            }
+            tuner->last_switch_time = tuner->time;
+            tuner->cycle_max = measurement;
+            tuner->cycle_min = measurement;
+
+            if (tuner->cycle_count >= c->cycles)
+            {
+                PidAutotune_finish(tuner);
+            }
+        }
+
+        if (tuner->state == PID_AUTOTUNE_RELAY && tuner->time > c->timeout)
+        {
+            tuner->state = PID_AUTOTUNE_FAILED;
+        }
+    }
+
+    if (tuner->state != PID_AUTOTUNE_STEP && tuner->state != PID_AUTOTUNE_RELAY)
+    {
+        tuner->output = 0.0f;
+    }
+    return tuner->output;
+}
+
+static inline int PidAutotune_isRunning(const PidAutotune *tuner)
+{
+    return tuner->state == PID_AUTOTUNE_STEP || tuner->state == PID_AUTOTUNE_RELAY;
+}
+
+#endif /* PID_AUTOTUNE_H_ */
@@ -1,7 +1,10 @@
 #include "robot_control.h"
 
 RobotControl::RobotControl(RobotMode mode, double wheel_radius_mm, double turning_radius_mm, ControlMode control_mode)
-    : mode(mode), control_mode(control_mode), running(true), thread_started(false) {
+    : mode(mode), control_mode(control_mode), battery_voltage(0.0f), two_wheel(nullptr), running(true), active(false), thread_started(false), autotune_motor(-1),
+      safety_resume(false) {
+    SafetyConfig safety_config = {};
+    SafetyMonitor_Init(&safety, &safety_config);
     switch (mode) {
         case Mecanum_Mode:
             kinematics = new Mecanum(wheel_radius_mm, turning_radius_mm, control_mode);
@@ -12,22 +15,53 @@ RobotControl::RobotControl(RobotMode mode, double wheel_radius_mm, double turnin
         case Omni4_Mode:
             kinematics = new Omni4(wheel_radius_mm, turning_radius_mm, control_mode);
             break;
+        case TwoWheel_Mode:
+            two_wheel = new TwoWheelKinematics(wheel_radius_mm * 2.0, turning_radius_mm * 2.0, control_mode);
+            kinematics = two_wheel;
+            break;
     }
 
     for (int i = 0; i < 4; i++) {
+        motors[i] = nullptr;
+        pids[i] = nullptr;
+        schedules[i] = nullptr;
+        motor_control_data.motor_data[i].target_value = 0.0;
+        motor_control_data.motor_data[i].pwm_command = 0.0;
+        motion_data.motor_data[i].target_value = 0.0;
+        motion_data.motor_data[i].pwm_command = 0.0;
         external_rps[i] = 0.0;
         use_external_rps[i] = false;
     }
 }
 
+RobotControl::~RobotControl() {
+    stopControl();
+    if (thread_started) {
+        running = false;
+        motor_control_thread.join();
+    }
+    for (int i = 0; i < 4; i++) {
+        delete motors[i];
+        delete encoders[i];
+        delete pids[i];
+    }
+    delete kinematics;  // TwoWheel_Mode では two_wheel と同じもの
+}
+
 void RobotControl::configureMotor(int motor_index, PinName pin1, PinName pin2) {
     if (motor_index >= 0 && motor_index < 4) {
+        // 設定し直すときは前のものを解放する（同じピンを使うことがあるので、解放してから作る）
+        // 制御ループが前のものを使っている間は解放しない
+        ScopedLock<Mutex> lock(config_mutex);
+        delete motors[motor_index];
         motors[motor_index] = new MotorDriver(pin1, pin2);
     }
 }
 
 void RobotControl::configureEncoder(int motor_index, PinName pinA, PinName pinB) {
     if (motor_index >= 0 && motor_index < 4) {
+        ScopedLock<Mutex> lock(config_mutex);
+        delete encoders[motor_index];
         encoders[motor_index] = new Encoder(pinA, pinB);
         use_external_rps[motor_index] = false;
     }
@@ -42,42 +76,271 @@ void RobotControl::setExternalRPS(int motor_index, double rps) {
 
 void RobotControl::setPIDGains(int motor_index, float kp, float ki, float kd, float time_constant) {
     if (motor_index >= 0 && motor_index < 4) {
-        pids[motor_index] = new PIDController(kp, ki, kd, time_constant, 0.01);
+        // 2 回目からは作り直さずにゲインだけ変える（制御中でも積分が途切れない）
+        // 出力制限は updateWheels が毎周期、出力段の Duty の上限から決める
+        ScopedLock<Mutex> lock(config_mutex);
+        if (pids[motor_index] != nullptr) {
+            pids[motor_index]->setGains(kp, ki, kd, time_constant);
+        } else {
+            pids[motor_index] = new PIDController(kp, ki, kd, time_constant, 0.01);
+        }
+    }
+}
+
+void RobotControl::setOutputConfig(int motor_index, const MotorOutputConfig& config) {
+    if (motor_index >= 0 && motor_index < 4) {
+        outputs[motor_index].setConfig(config);
+    }
+}
+
+void RobotControl::setDecayMode(int motor_index, DecayMode decay_mode) {
+    ScopedLock<Mutex> lock(config_mutex);
+    if (motor_index >= 0 && motor_index < 4 && motors[motor_index] != nullptr) {
+        motors[motor_index]->setDecayMode(decay_mode);
     }
 }
 
 void RobotControl::startControl(double vx_mm_s, double vy_mm_s, double omega_deg_s) {
+    active = true;
+    if (!thread_started) {
+        motor_control_thread.start(callback(this, &RobotControl::controlLoop));
+        thread_started = true;
+    }
+    setTarget(vx_mm_s, vy_mm_s, omega_deg_s);
+}
+
+void RobotControl::setTarget(double vx_mm_s, double vy_mm_s, double omega_deg_s) {
+    SafetyMonitor_feed(&safety);
+    if (safety.state == SAFETY_BRAKE && SafetyMonitor_isRecoverable(&safety)) {
+        safety_resume = true;  // 指令の途絶・停止要求で止まっていたなら再開する
+    }
+    // 目標の時点で車輪が飽和するなら、運動学で出せる速度に縮めた目標にしておく
+    // profile と kinematics は制御ループが 1 周期の間使っているので、周期の合間に書き換える
+    ScopedLock<Mutex> lock(config_mutex);
+    MotorControlData target_data = {};
+    AppliedTwist applied = kinematics->calc(vx_mm_s, vy_mm_s, omega_deg_s, target_data);
+    profile.setTarget(applied.vx_mm_s, applied.vy_mm_s, applied.omega_deg_s);
+}
+
+void RobotControl::setGainSchedule(int motor_index, const GainSchedule* schedule) {
+    if (motor_index >= 0 && motor_index < 4) {
+        schedules[motor_index] = schedule;
+    }
+}
+
+void RobotControl::setBatteryVoltage(float voltage) {
+    battery_voltage = voltage;
+}
+
+void RobotControl::setMotionLimits(const MotionProfileConfig& config) {
+    ScopedLock<Mutex> lock(config_mutex);
+    profile.setConfig(config);
+}
+
+void RobotControl::setWheelSpeedLimit(double limit, TwistLimitPolicy policy) {
+    ScopedLock<Mutex> lock(config_mutex);
+    kinematics->setWheelLimit(limit);
+    kinematics->setLimitPolicy(policy);
+}
+
+void RobotControl::startAutotune(int motor_index, const PidAutotuneConfig& config) {
+    ScopedLock<Mutex> lock(config_mutex);  // 試験中の autotune を制御ループの周期の途中で書き換えない
+    if (motor_index < 0 || motor_index >= 4 || motors[motor_index] == nullptr) {
+        return;
+    }
+    if (!PidAutotune_Init(&autotune, &config)) {
+        return;  // 試験できない設定（getAutotuneResult は false を返す）
+    }
+    PidAutotune_start(&autotune);
+    autotune_motor = motor_index;
+    active = true;
     if (!thread_started) {
         motor_control_thread.start(callback(this, &RobotControl::controlLoop));
         thread_started = true;
     }
-    kinematics->calc(vx_mm_s, vy_mm_s, omega_deg_s, motor_control_data);
+}
+
+bool RobotControl::isAutotuneRunning() {
+    return autotune_motor >= 0;
+}
+
+bool RobotControl::getAutotuneResult(PidAutotuneResult& result) {
+    if (autotune_motor >= 0 || autotune.state != PID_AUTOTUNE_DONE) {
+        return false;
+    }
+    result = autotune.result;
+    return true;
 }
 
 void RobotControl::stopControl() {
-    running = false;
-    if (thread_started) {
-        motor_control_thread.terminate();
-        thread_started = false;
+    SafetyMonitor_trip(&safety, SAFETY_FAULT_STOP_REQUEST);
+    if (!thread_started) {
+        return;  // MultiRateExecutive で回している場合は updateWheels が減速してブレーキをかける
+    }
+    // 制御スレッドが減速を終えてブレーキをかけるまで待ってから止める（制御周期 2 回分の余裕を持たせる）
+    // 休ませている間（active が false）は減速する周期が回らないので待たない
+    int wait_ms = active ? static_cast<int>(safety.config.ramp_time * 1000.0f) + 20 : 0;
+    while (safety.state != SAFETY_BRAKE && wait_ms-- > 0) {
+        ThisThread::sleep_for(1ms);
+    }
+    // 制御スレッドは終わらせずに休ませる（次の startControl で再開する）
+    // 制御ループは 1 周期を config_mutex を持ったまま回すので、ここで active を落とした後に Duty を書くことはない
+    ScopedLock<Mutex> lock(config_mutex);
+    active = false;
+    for (int i = 0; i < 4; i++) {
+        if (motors[i] != nullptr) {
+            motors[i]->brake();
+        }
     }
 }
 
+void RobotControl::setSafetyConfig(const SafetyConfig& config) {
+    safety.config = config;
+}
+
+void RobotControl::emergencyStop() {
+    SafetyMonitor_trip(&safety, SAFETY_FAULT_EMERGENCY);
+}
+
+void RobotControl::resetSafety() {
+    safety_resume = true;  // 制御ループの側（次の updateWheels）で解除する
+}
+
+SafetyState RobotControl::getSafetyState() {
+    return safety.state;
+}
+
+uint8_t RobotControl::getSafetyFaults() {
+    return safety.faults;
+}
+
+float RobotControl::getSafetyLatency() {
+    return safety.max_latency;
+}
+
 void RobotControl::controlLoop() {
+    // 周期は sleep_for とスレッドの切り替えで揺れるので、実測の経過時間を dt にする（最初の 1 回は 10ms とする）
+    // stopControl の後も経過時間は計り続けるので、再開したときの dt は休んでいた時間を含まない
+    uint64_t last_time = Timebase::nowUs() - 10000;
     while (running) {
-        for (int i = 0; i < 4; i++) {
-            double current_rps;
-            if (encoders[i] != nullptr && !use_external_rps[i]) {
-                current_rps = encoders[i]->getRPS();
-            } else {
-                current_rps = external_rps[i];
+        float dt = Timebase::elapsed(last_time);
+        {
+            ScopedLock<Mutex> lock(config_mutex);
+            if (active) {
+                updateMotion(dt);
+                updateWheels(dt);
             }
-            double control_signal = pids[i]->compute(motor_control_data.motor_data[i].target_value, current_rps);
-            motors[i]->setSpeed(control_signal * 100);
         }
         ThisThread::sleep_for(10ms);
     }
 }
 
+void RobotControl::updateMotion(float dt) {
+    // ブレーキ中は機体速度を 0 にしておき、再開するときに静止から加速させる
+    // （再開が決まっていれば、この周期の updateWheels で解除するので、新しい目標は消さない）
+    if (safety.state == SAFETY_BRAKE && !safety_resume) {
+        profile.reset(0.0f, 0.0f, 0.0f);
+    }
+    // 速度プロファイルを 1 周期進めて各車輪の目標値を更新する
+    profile.setPeriod(dt);
+    profile.update();
+    // 途中の速度で車輪が飽和した場合、運動学が縮めた速度にプロファイルを合わせる
+    AppliedTwist applied = kinematics->calc(profile.getVx(), profile.getVy(), profile.getOmega(), motion_data);
+    if (applied.saturated) {
+        profile.limitVelocity(applied.vx_mm_s, applied.vy_mm_s, applied.omega_deg_s);
+    }
+    wheel_targets.write(motion_data);
+
+    // 差動二輪は左右のエンコーダから自己位置を更新する
+    ScopedLock<Mutex> lock(config_mutex);
+    if (two_wheel != nullptr && encoders[0] != nullptr && encoders[1] != nullptr) {
+        two_wheel->updateOdometry(*encoders[0], *encoders[1]);
+    }
+}
+
+void RobotControl::updateWheels(float dt) {
+    // この周期の間は motors / encoders / pids を差し替えさせない
+    ScopedLock<Mutex> lock(config_mutex);
+    if (safety_resume) {
+        safety_resume = false;
+        SafetyMonitor_reset(&safety);
+        for (int i = 0; i < 4; i++) {
+            if (pids[i] != nullptr) {
+                pids[i]->reset();  // ブレーキ中にたまった積分を捨てる
+            }
+            outputs[i].reset();
+        }
+    }
+
+    // 安全監視を先に進め、この周期の Duty の上限（倍率 × max_duty）を決める
+    // 拘束の判定には、今の速度を生んだ前の周期の Duty を使う
+    MotorControlData targets = wheel_targets.read();
+    double current_rps[4] = {0.0, 0.0, 0.0, 0.0};
+    for (int i = 0; i < 4; i++) {
+        if (motors[i] == nullptr || pids[i] == nullptr) {
+            continue;  // 使わない車輪（Omni3 の 4 輪目、差動二輪の 3・4 輪目など）
+        }
+        if (encoders[i] != nullptr && !use_external_rps[i]) {
+            current_rps[i] = encoders[i]->getRPS();
+        } else {
+            current_rps[i] = external_rps[i];
+        }
+        if (i != autotune_motor) {
+            SafetyMonitor_checkMotor(&safety, i, motor_control_data.motor_data[i].pwm_command,
+                                     targets.motor_data[i].target_value, current_rps[i], dt);
+        }
+        motor_control_data.motor_data[i].target_value = targets.motor_data[i].target_value;
+    }
+    float scale = SafetyMonitor_update(&safety, dt);
+
+    // ブレーキ中はオートチューンも打ち切る
+    if (safety.state == SAFETY_BRAKE) {
+        autotune_motor = -1;
+        for (int i = 0; i < 4; i++) {
+            if (motors[i] != nullptr && pids[i] != nullptr) {
+                motor_control_data.motor_data[i].pwm_command = 0.0;
+                motors[i]->brake();
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        if (motors[i] == nullptr || pids[i] == nullptr) {
+            continue;
+        }
+        float limit = outputs[i].getMaxDuty() * scale;
+        float duty;
+        if (i == autotune_motor) {
+            duty = PidAutotune_update(&autotune, current_rps[i], dt);
+            if (duty > limit) duty = limit;
+            if (duty < -limit) duty = -limit;
+            if (!PidAutotune_isRunning(&autotune)) {
+                if (autotune.state == PID_AUTOTUNE_DONE) {
+                    pids[i]->setGains(autotune.result.kp, autotune.result.ki, autotune.result.kd);
+                    pids[i]->reset();
+                }
+                autotune_motor = -1;
+            }
+        } else {
+            double target = targets.motor_data[i].target_value;
+            double feedforward = 0.0;
+            if (schedules[i] != nullptr) {
+                GainSchedulePoint gains = schedules[i]->lookup(target, battery_voltage);
+                pids[i]->setGains(gains.kp, gains.ki, gains.kd);
+                feedforward = gains.ff;
+            }
+            // PID が飽和するのを、出力段で Duty が上限に張り付くところに合わせる（フィードフォワードの分を除く）
+            float offset = static_cast<float>(feedforward) + outputs[i].getFeedforward(target);
+            pids[i]->setOutputLimits(-limit - offset, limit - offset);
+            double control_signal = pids[i]->compute(target, current_rps[i], dt) + feedforward;
+            duty = outputs[i].update(control_signal, target, dt, limit);
+        }
+        motor_control_data.motor_data[i].pwm_command = duty;
+        motors[i]->setDuty(duty);
+    }
+}
+
 double RobotControl::getMotorOutput(int motor_index) {
     if (motor_index >= 0 && motor_index < 4) {
         return motor_control_data.motor_data[motor_index].pwm_command;
@@ -85,6 +348,19 @@ double RobotControl::getMotorOutput(int motor_index) {
     return 0.0;
 }
 
+Position RobotControl::getPosition() {
+    if (two_wheel == nullptr) {
+        return {0.0f, 0.0f, 0.0f};
+    }
+    return two_wheel->getPosition();
+}
+
+void RobotControl::resetPosition(float x_mm, float y_mm, float theta_deg) {
+    if (two_wheel != nullptr) {
+        two_wheel->resetOdometry(x_mm, y_mm, theta_deg);
+    }
+}
+
 // 追加: 目標RPSを取得するメソッド
 double RobotControl::getTargetRPS(int motor_index) {
     if (motor_index >= 0 && motor_index < 4) {
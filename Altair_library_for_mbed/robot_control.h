@@ -3,28 +3,83 @@
 
 #include "mbed.h"
 #include "MotorDriver.h"
+#include "MotorOutput.h"
 #include "encoder.h"
 #include "PIDController.h"
+#include "pid_autotune.h"
+#include "GainSchedule.h"
+#include "MotionProfile.h"
 #include "Kinematics.h"
+#include "TwoWheelKinematics.h"
+#include "MultiRateExecutive.h"
+#include "safety_monitor.h"
+#include "Timebase.h"
 
 enum RobotMode {
     Mecanum_Mode,
     Omni3_Mode,
-    Omni4_Mode
+    Omni4_Mode,
+    TwoWheel_Mode   // 差動二輪（motor 0 が右、motor 1 が左。turning_radius_mm はタイヤ間距離の半分）
 };
 
+// 設定を実行時に行う（new で確保する）版。設定がコンパイル時に決まるなら StaticRobotControl.h の方が軽い
 class RobotControl {
 public:
     RobotControl(RobotMode mode, double wheel_radius_mm, double turning_radius_mm, ControlMode control_mode);
+    ~RobotControl();
 
+    // 制御中に呼んでもよい（制御ループの 1 周期が終わるのを待ってから差し替える）
     void configureMotor(int motor_index, PinName pin1, PinName pin2);
     void configureEncoder(int motor_index, PinName pinA, PinName pinB);
     void setExternalRPS(int motor_index, double rps);
     void setPIDGains(int motor_index, float kp, float ki, float kd, float time_constant);
+    void setOutputConfig(int motor_index, const MotorOutputConfig& config);
+    void setDecayMode(int motor_index, DecayMode decay_mode);
+    // 目標回転数に応じて PID ゲインとフィードフォワードを切り替える（nullptr で固定ゲインに戻す）
+    void setGainSchedule(int motor_index, const GainSchedule* schedule);
+    // ゲインスケジュールの電圧補正に使う電池電圧 [V]
+    void setBatteryVoltage(float voltage);
+    // 機体速度の加速度・躍度制限（既定は制限なし＝startControl の値をそのまま使う）
+    void setMotionLimits(const MotionProfileConfig& config);
+    // 車輪の目標値の上限（RPS_MODE なら rps、MMPS_MODE なら mm/s。0 で制限なし）
+    // 超える車輪があると、policy に従って機体速度を縮める（既定は全体を比率を保ったまま縮める）
+    void setWheelSpeedLimit(double limit, TwistLimitPolicy policy = TWIST_LIMIT_UNIFORM);
     void startControl(double vx_mm_s, double vy_mm_s, double omega_deg_s);
+    // 減速してからブレーキをかけ、制御ループを休ませる（減速の時間は setSafetyConfig の ramp_time）
+    // 制御スレッドは終わらせずに待たせるので、もう一度 startControl を呼べば再開する
     void stopControl();
     double getMotorOutput(int motor_index);
+
+    // 安全監視（指令の途絶・拘束・暴走で止める。既定はすべて監視しない）
+    // 速度の単位は RPS_MODE なら rps、MMPS_MODE なら mm/s。startControl / setTarget が指令の受信として数える
+    void setSafetyConfig(const SafetyConfig& config);
+    // すぐにブレーキをかける（resetSafety まで再開しない）
+    void emergencyStop();
+    // 異常を解除して制御を再開する（指令の途絶・停止要求だけなら、次の startControl / setTarget で自動的に再開する）
+    void resetSafety();
+    SafetyState getSafetyState();
+    uint8_t getSafetyFaults();
+    // 異常が始まってからブレーキまでの時間の最大値 [s]
+    float getSafetyLatency();
+
+    // リレー帰還オートチューン：指定モータだけ制御ループ内で試験し、終了後に PID ゲインへ反映する
+    void startAutotune(int motor_index, const PidAutotuneConfig& config);
+    bool isAutotuneRunning();
+    bool getAutotuneResult(PidAutotuneResult& result);
     
+    // 差動二輪の自己位置（TwoWheel_Mode で motor 0, 1 のエンコーダを設定したとき、制御ループ内で更新）
+    Position getPosition();
+    void resetPosition(float x_mm = 0.0f, float y_mm = 0.0f, float theta_deg = 0.0f);
+
+    // 制御ループの 2 つの段（startControl で始まるスレッドは 10ms ごとに両方を呼ぶ）
+    // MultiRateExecutive で別々の周期で回すときは startControl の代わりに setTarget を使う
+    //   updateMotion: 速度プロファイル → 運動学 → オドメトリ（dt: 呼ぶ周期 [s]）
+    //   updateWheels: 各車輪の速度 PID（dt: 呼ぶ周期 [s]）
+    // 2 つの段の間の車輪の目標値はスナップショットで受け渡すので、別のスレッドから呼んでよい
+    void setTarget(double vx_mm_s, double vy_mm_s, double omega_deg_s);
+    void updateMotion(float dt = 0.01f);
+    void updateWheels(float dt = 0.01f);
+
     // 追加: 目標RPSを取得するメソッド
     double getTargetRPS(int motor_index);
 
@@ -34,16 +89,32 @@ private:
     MotorDriver* motors[4];
     Encoder* encoders[4] = {nullptr};
     PIDController* pids[4];
+    MotorOutput outputs[4];
+    const GainSchedule* schedules[4];
+    float battery_voltage;
+    MotionProfile profile;
     MotorControlData motor_control_data;
+    MotorControlData motion_data;                 // updateMotion だけが使う
+    SnapshotBuffer<MotorControlData> wheel_targets; // updateMotion → updateWheels
+    Mutex config_mutex;   // motors / encoders / pids の差し替え、profile と kinematics の設定・目標の書き換えと、それを使う制御ループの 1 周期を排他する
     Kinematics* kinematics;
+    TwoWheelKinematics* two_wheel;
     Thread motor_control_thread;
-    bool running;
+    volatile bool running;   // false で制御スレッドを終わらせる（デストラクタだけ。mbed の Thread は start し直せない）
+    volatile bool active;    // 制御ループが車輪を動かすか（startControl で true、stopControl で false）
     bool thread_started;
 
+    PidAutotune autotune;
+    int autotune_motor;
+
+    SafetyMonitor safety;
+    volatile bool safety_resume;  // 次の updateWheels で異常を解除する
+
     double external_rps[4];
     bool use_external_rps[4];
 
     void controlLoop();
+
 };
 
 #endif // ROBOT_CONTROL_H
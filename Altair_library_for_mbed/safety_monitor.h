@@ -0,0 +1,336 @@
+#ifndef SAFETY_MONITOR_H_
+#define SAFETY_MONITOR_H_
+
+// 指令の途絶・エンコーダの拘束・暴走を監視して段階的に止める安全監視（ヘッダのみ、動的確保なし）
+// 制御ループの中で 1 周期ごとに、車輪ごとの SafetyMonitor_checkMotor のあとに SafetyMonitor_update を呼び、
+// 返り値の倍率を各モータの Duty の上限に掛ける（PID の出力制限もその上限から決めると、絞っている間も積分がたまらない）
+// state が SAFETY_BRAKE になったらブレーキをかける
+//   - 指令の途絶：SafetyMonitor_feed が command_timeout [s] 呼ばれない
+//   - 拘束      ：|Duty| >= stall_duty なのに |速度| < stall_speed が stall_time [s] 続く（ロック・エンコーダ断線）
+//   - 暴走      ：目標の向きに |目標| + runaway_margin を超える、または逆向きに runaway_margin を超える速度が
+//                 runaway_time [s] 続く（エンコーダの極性違い・PID の発散）
+// 指令の途絶と停止要求は ramp_time [s] かけて Duty を 0 まで絞ってからブレーキ、
+// 拘束・暴走・非常停止はすぐにブレーキをかける。異常は SafetyMonitor_reset まで保持する
+// 異常が始まってからブレーキまでの時間を計り、latency / max_latency に残す
+// （SafetyMonitor_latencyBound は update を決まった周期 dt で呼び続けたときの見積もり。
+//   周期が dt より延びたり揺れたりすると、延びた分だけ超えることがある）
+// feed と trip は別のスレッド・割り込みから呼んでよい（制御ループの側で取り込む）
+// CubeIDE / mbed / Arduino で同一内容
+
+#include <stdint.h>
+#if defined(__AVR__)
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#endif
+
+#ifndef SAFETY_MONITOR_MAX_MOTORS
+#define SAFETY_MONITOR_MAX_MOTORS 4
+#endif
+
+typedef enum
+{
+    SAFETY_RUN,        // 通常の制御
+    SAFETY_RAMP_DOWN,  // 減速中（Duty を絞っている）
+    SAFETY_BRAKE       // ブレーキ（reset まで出力しない）
+} SafetyState;
+
+// 異常の種類（faults はビットの OR）
+#define SAFETY_FAULT_COMMAND_TIMEOUT 0x01u  // 指令の途絶
+#define SAFETY_FAULT_STALL           0x02u  // 拘束
+#define SAFETY_FAULT_RUNAWAY         0x04u  // 暴走
+#define SAFETY_FAULT_STOP_REQUEST    0x08u  // 停止要求（stopControl など、減速して止める）
+#define SAFETY_FAULT_EMERGENCY       0x10u  // 非常停止（すぐブレーキ）
+
+// 減速を待たずにすぐブレーキをかける異常（新しい指令では再開しない）
+#define SAFETY_FAULT_BRAKE_NOW (SAFETY_FAULT_STALL | SAFETY_FAULT_RUNAWAY | SAFETY_FAULT_EMERGENCY)
+
+// 各項目とも 0 でその監視をしない（すべて 0 なら trip による停止だけ）
+typedef struct
+{
+    float command_timeout;  // 指令の有効期限 [s]
+    float stall_duty;       // 拘束判定の Duty（0〜1）
+    float stall_speed;      // 拘束判定の速度（測定値の単位）
+    float stall_time;       // 拘束判定の継続時間 [s]
+    float runaway_margin;   // 暴走判定の速度の余裕（測定値の単位）
+    float runaway_time;     // 暴走判定の継続時間 [s]
+    float ramp_time;        // 減速停止で Duty を 1 → 0 に絞る時間 [s]（0 なら減速せずにブレーキ）
+} SafetyConfig;
+
+typedef struct
+{
+    SafetyConfig config;
+    SafetyState state;
+    uint8_t faults;             // 起きた異常（reset まで保持）
+    volatile uint8_t requests;  // trip で要求され、まだ update で取り込んでいない異常
+    volatile uint32_t feeds;    // feed の回数
+    uint32_t seen_feeds;        // update で取り込んだ feed の回数
+    uint8_t detected;           // checkMotor で見つけた異常（次の update で取り込む）
+    float detected_age;         // そのうち最も古い異常の継続時間 [s]
+    float command_age;          // 最後の指令からの時間 [s]
+    float stall_timer[SAFETY_MONITOR_MAX_MOTORS];
+    float runaway_timer[SAFETY_MONITOR_MAX_MOTORS];
+    float scale;                // Duty の上限に掛ける倍率（1 → 0）
+    float fault_age;            // 異常が始まってからの時間 [s]
+    float latency;              // 直前の停止で、異常が始まってからブレーキまでの時間 [s]
+    float max_latency;          // その最大値 [s]
+} SafetyMonitor;
+
+// requests は trip（別のスレッド・割り込み）と update（制御ループ）の両方が書き換えるので、
+// 読んでから書き戻すまでの間に他方が入っても要求が消えないよう、1 回の不可分な操作で行う
+// feeds も feed（別のスレッド・割り込み）が数え、update が読むので、数えるのも読むのも不可分に行う
+// （8 ビットの AVR では 32 ビットの読み書きが 4 回に分かれ、途中に割り込まれると回数が消えたり壊れた値を読む）
+#if defined(__AVR__)
+// AVR には不可分な読み書きの命令がないので、割り込みを止めて行う（割り込みの中から呼んでもよい）
+static inline void SafetyMonitor_addRequests(volatile uint8_t *requests, uint8_t fault)
+{
+    uint8_t sreg = SREG;
+    cli();
+    *requests |= fault;
+    SREG = sreg;
+}
+
+static inline uint8_t SafetyMonitor_takeRequests(volatile uint8_t *requests)
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t taken = *requests;
+    *requests = 0;
+    SREG = sreg;
+    return taken;
+}
+
+static inline void SafetyMonitor_addFeed(volatile uint32_t *feeds)
+{
+    uint8_t sreg = SREG;
+    cli();
+    *feeds += 1;
+    SREG = sreg;
+}
+
+static inline uint32_t SafetyMonitor_readFeeds(volatile uint32_t *feeds)
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t value = *feeds;
+    SREG = sreg;
+    return value;
+}
+#else
+// GCC の __atomic 組み込み関数（snapshot.h と同じ）
+static inline void SafetyMonitor_addRequests(volatile uint8_t *requests, uint8_t fault)
+{
+    __atomic_fetch_or(requests, fault, __ATOMIC_SEQ_CST);
+}
+
+static inline uint8_t SafetyMonitor_takeRequests(volatile uint8_t *requests)
+{
+    return __atomic_exchange_n(requests, (uint8_t)0, __ATOMIC_SEQ_CST);
+}
+
+static inline void SafetyMonitor_addFeed(volatile uint32_t *feeds)
+{
+    __atomic_fetch_add(feeds, 1U, __ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t SafetyMonitor_readFeeds(volatile uint32_t *feeds)
+{
+    return __atomic_load_n(feeds, __ATOMIC_SEQ_CST);
+}
+#endif
+
+// 異常を解除して通常の制御に戻す（反応時間の記録は残す）
+// 解除するのは update で取り込んだ異常だけ。まだ取り込んでいない trip の要求は残り、次の update で止める
+static inline void SafetyMonitor_reset(SafetyMonitor *monitor)
+{
+    monitor->state = SAFETY_RUN;
+    monitor->faults = 0;
+    monitor->seen_feeds = SafetyMonitor_readFeeds(&monitor->feeds);
+    monitor->detected = 0;
+    monitor->detected_age = 0.0f;
+    monitor->command_age = 0.0f;
+    for (int i = 0; i < SAFETY_MONITOR_MAX_MOTORS; i++)
+    {
+        monitor->stall_timer[i] = 0.0f;
+        monitor->runaway_timer[i] = 0.0f;
+    }
+    monitor->scale = 1.0f;
+    monitor->fault_age = 0.0f;
+}
+
+static inline void SafetyMonitor_Init(SafetyMonitor *monitor, const SafetyConfig *config)
+{
+    monitor->config = *config;
+    monitor->requests = 0;
+    monitor->feeds = 0;
+    monitor->latency = 0.0f;
+    monitor->max_latency = 0.0f;
+    SafetyMonitor_reset(monitor);
+}
+
+// 指令を受け取るたびに呼ぶ
+static inline void SafetyMonitor_feed(SafetyMonitor *monitor)
+{
+    SafetyMonitor_addFeed(&monitor->feeds);
+}
+
+// 停止を要求する（SAFETY_FAULT_STOP_REQUEST で減速停止、SAFETY_FAULT_EMERGENCY ですぐブレーキ）
+static inline void SafetyMonitor_trip(SafetyMonitor *monitor, uint8_t fault)
+{
+    SafetyMonitor_addRequests(&monitor->requests, fault);
+}
+
+// 1 周期ごとに車輪ごとに呼ぶ。duty: 直前に出力した Duty、target / speed: 目標と測定の速度（同じ単位）
+static inline void SafetyMonitor_checkMotor(SafetyMonitor *monitor, int index, float duty, float target, float speed,
+                                            float dt)
+{
+    if (index < 0 || index >= SAFETY_MONITOR_MAX_MOTORS || monitor->state == SAFETY_BRAKE)
+    {
+        return;
+    }
+    const SafetyConfig *config = &monitor->config;
+    float abs_speed = (speed < 0.0f) ? -speed : speed;
+    float abs_duty = (duty < 0.0f) ? -duty : duty;
+
+    // 拘束：Duty を出しているのに回らない
+    float *stall = &monitor->stall_timer[index];
+    if (config->stall_duty > 0.0f && abs_duty >= config->stall_duty && abs_speed < config->stall_speed)
+    {
+        *stall += dt;
+        if (*stall >= config->stall_time)
+        {
+            monitor->detected |= SAFETY_FAULT_STALL;
+            if (*stall > monitor->detected_age)
+            {
+                monitor->detected_age = *stall;
+            }
+        }
+    }
+    else
+    {
+        *stall = 0.0f;
+    }
+
+    // 暴走：目標の向きに速すぎる、または逆向きに回っている
+    float *runaway = &monitor->runaway_timer[index];
+    float along = (target < 0.0f) ? -speed : speed;  // 目標の向きを正にした速度
+    float abs_target = (target < 0.0f) ? -target : target;
+    if (config->runaway_margin > 0.0f &&
+        (along > abs_target + config->runaway_margin || along < -config->runaway_margin))
+    {
+        *runaway += dt;
+        if (*runaway >= config->runaway_time)
+        {
+            monitor->detected |= SAFETY_FAULT_RUNAWAY;
+            if (*runaway > monitor->detected_age)
+            {
+                monitor->detected_age = *runaway;
+            }
+        }
+    }
+    else
+    {
+        *runaway = 0.0f;
+    }
+}
+
+static inline void SafetyMonitor_brake(SafetyMonitor *monitor)
+{
+    monitor->state = SAFETY_BRAKE;
+    monitor->scale = 0.0f;
+    monitor->latency = monitor->fault_age;
+    if (monitor->fault_age > monitor->max_latency)
+    {
+        monitor->max_latency = monitor->fault_age;
+    }
+}
+
+// checkMotor のあとに 1 周期ごとに呼ぶ。Duty の上限に掛ける倍率（0〜1）を返す
+static inline float SafetyMonitor_update(SafetyMonitor *monitor, float dt)
+{
+    const SafetyConfig *config = &monitor->config;
+    uint8_t detected = monitor->detected;
+    float age = monitor->detected_age;
+    monitor->detected = 0;
+    monitor->detected_age = 0.0f;
+
+    uint32_t feeds = SafetyMonitor_readFeeds(&monitor->feeds);
+    if (feeds != monitor->seen_feeds)
+    {
+        monitor->seen_feeds = feeds;
+        monitor->command_age = 0.0f;
+    }
+    else
+    {
+        monitor->command_age += dt;
+    }
+    if (config->command_timeout > 0.0f && monitor->command_age >= config->command_timeout)
+    {
+        detected |= SAFETY_FAULT_COMMAND_TIMEOUT;
+        float overdue = monitor->command_age - config->command_timeout;  // 期限を過ぎてからの時間
+        if (overdue > age)
+        {
+            age = overdue;
+        }
+    }
+
+    uint8_t requests = SafetyMonitor_takeRequests(&monitor->requests);
+    uint8_t fresh = (uint8_t)((detected | requests) & ~monitor->faults);
+    monitor->faults |= fresh;
+    if (monitor->state == SAFETY_BRAKE)
+    {
+        return 0.0f;
+    }
+
+    if (monitor->state == SAFETY_RAMP_DOWN)
+    {
+        monitor->fault_age += dt;
+    }
+    if (fresh)
+    {
+        // 反応時間は最初の異常から数える（すぐブレーキの異常は、その異常から）
+        if (monitor->state == SAFETY_RUN || (fresh & SAFETY_FAULT_BRAKE_NOW))
+        {
+            monitor->fault_age = age;
+        }
+        if ((fresh & SAFETY_FAULT_BRAKE_NOW) || config->ramp_time <= 0.0f)
+        {
+            SafetyMonitor_brake(monitor);
+            return 0.0f;
+        }
+        monitor->state = SAFETY_RAMP_DOWN;
+    }
+    if (monitor->state == SAFETY_RAMP_DOWN)
+    {
+        monitor->scale -= dt / config->ramp_time;
+        if (monitor->scale <= 1e-4f)
+        {
+            SafetyMonitor_brake(monitor);
+        }
+    }
+    return monitor->scale;
+}
+
+// 新しい指令で再開してよい停止か（指令の途絶と停止要求だけなら 1）
+static inline int SafetyMonitor_isRecoverable(const SafetyMonitor *monitor)
+{
+    return (monitor->faults & SAFETY_FAULT_BRAKE_NOW) == 0;
+}
+
+// 周期 dt で欠かさず呼んだときの、異常が始まってからブレーキまでの時間の見積もり [s]（有効な監視のうち最大）
+// 周期が揺れるときは、dt に最も長い周期を渡す
+static inline float SafetyMonitor_latencyBound(const SafetyMonitor *monitor, float dt)
+{
+    const SafetyConfig *config = &monitor->config;
+    float bound = (config->ramp_time > 0.0f) ? config->ramp_time + dt : dt;  // 途絶・停止要求
+    if (config->stall_duty > 0.0f && config->stall_time + dt > bound)
+    {
+        bound = config->stall_time + dt;
+    }
+    if (config->runaway_margin > 0.0f && config->runaway_time + dt > bound)
+    {
+        bound = config->runaway_time + dt;
+    }
+    return bound;
+}
+
+#endif /* SAFETY_MONITOR_H_ */
@@ -0,0 +1,197 @@
+#ifndef SERVO_MOTION_H_
+#define SERVO_MOTION_H_
+
+// サーボ 1 個分の校正と、速度・加速度を制限した補間（ヘッダのみ、動的確保なし）
+//   - 校正：可動範囲 [deg] と両端のパルス幅 [us]、取り付けのずれ、回転方向の反転
+//   - 補間：ServoMotion_update を一定周期で呼ぶと、目標角まで台形速度（max_velocity, max_acceleration）で動かす
+//     目標の手前では残り角で止まれる速度まで落とすので、行き過ぎずに止まる
+//   - パルス幅は角度の一次式（係数は Init で事前計算）で求める
+// サーボグループ（CubeIDE servo_group.c、mbed ServoGroup.h）から使う（CubeIDE / mbed で同一内容）
+
+#include <math.h>
+#include <stdint.h>
+
+typedef struct
+{
+    float min_angle;         // 可動範囲の下限 [deg]
+    float max_angle;         // 可動範囲の上限 [deg]
+    uint16_t min_pulse_us;   // min_angle のときのパルス幅 [us]
+    uint16_t max_pulse_us;   // max_angle のときのパルス幅 [us]
+    float offset;            // 取り付けのずれ [deg]（指令角に足してからパルス幅にする）
+    uint8_t inverted;        // 1 で回転方向を反転する
+    float max_velocity;      // 最大角速度 [deg/s]（0 で制限なし）
+    float max_acceleration;  // 最大角加速度 [deg/s^2]（0 で制限なし）
+} ServoCalibration;
+
+typedef struct
+{
+    ServoCalibration calibration;
+    float position;     // 現在の指令角 [deg]
+    float velocity;     // 現在の角速度 [deg/s]
+    float target;       // 目標角 [deg]
+    float pulse_base;   // パルス幅 = pulse_base + pulse_slope * 角度
+    float pulse_slope;
+    float pulse_low;    // パルス幅の範囲 [us]
+    float pulse_high;
+} ServoMotion;
+
+// 一般的なサーボ（0〜180 度で 500〜2500us、制限なし）
+static inline ServoCalibration ServoMotion_defaultCalibration(void)
+{
+    ServoCalibration calibration = {0.0f, 180.0f, 500, 2500, 0.0f, 0, 0.0f, 0.0f};
+    return calibration;
+}
+
+static inline float ServoMotion_clampAngle(const ServoMotion *servo, float angle)
+{
+    const ServoCalibration *calibration = &servo->calibration;
+    if (angle < calibration->min_angle)
+    {
+        return calibration->min_angle;
+    }
+    if (angle > calibration->max_angle)
+    {
+        return calibration->max_angle;
+    }
+    return angle;
+}
+
+// 校正を設定する（現在の角度はそのまま、可動範囲に収める）
+static inline void ServoMotion_setCalibration(ServoMotion *servo, const ServoCalibration *calibration)
+{
+    servo->calibration = *calibration;
+    float low = (float)calibration->min_pulse_us;
+    float high = (float)calibration->max_pulse_us;
+    float span = calibration->max_angle - calibration->min_angle;
+    float slope = (span > 0.0f) ? (high - low) / span : 0.0f;
+
+    // 反転なし：low + (angle + offset - min_angle) * slope
+    // 反転あり：high - (angle + offset - min_angle) * slope
+    float start = (calibration->offset - calibration->min_angle) * slope;
+    if (calibration->inverted)
+    {
+        servo->pulse_base = high - start;
+        servo->pulse_slope = -slope;
+    }
+    else
+    {
+        servo->pulse_base = low + start;
+        servo->pulse_slope = slope;
+    }
+    servo->pulse_low = (low < high) ? low : high;
+    servo->pulse_high = (low < high) ? high : low;
+
+    servo->position = ServoMotion_clampAngle(servo, servo->position);
+    servo->target = ServoMotion_clampAngle(servo, servo->target);
+}
+
+// angle: 初期角 [deg]（電源投入時の姿勢が分かっていればそれ、分からなければ最初に動かしたい角度）
+static inline void ServoMotion_Init(ServoMotion *servo, const ServoCalibration *calibration, float angle)
+{
+    servo->position = angle;
+    servo->velocity = 0.0f;
+    servo->target = angle;
+    ServoMotion_setCalibration(servo, calibration);
+}
+
+// 目標角を設定する（可動範囲に収める）
+static inline void ServoMotion_setTarget(ServoMotion *servo, float angle)
+{
+    servo->target = ServoMotion_clampAngle(servo, angle);
+}
+
+// 補間せずにその角度にする
+static inline void ServoMotion_jump(ServoMotion *servo, float angle)
+{
+    servo->position = ServoMotion_clampAngle(servo, angle);
+    servo->target = servo->position;
+    servo->velocity = 0.0f;
+}
+
+// 一定周期 dt [s] で呼び、補間した角度 [deg] を返す
+static inline float ServoMotion_update(ServoMotion *servo, float dt)
+{
+    const ServoCalibration *calibration = &servo->calibration;
+    float error = servo->target - servo->position;
+    float max_velocity = calibration->max_velocity;
+    float max_acceleration = calibration->max_acceleration;
+
+    if (max_velocity <= 0.0f && max_acceleration <= 0.0f)
+    {
+        servo->position = servo->target;
+        servo->velocity = 0.0f;
+        return servo->position;
+    }
+
+    // 目標に向かう速度：最大角速度と、残り角で止まれる速度の小さい方
+    float distance = fabsf(error);
+    float desired = (max_velocity > 0.0f) ? max_velocity : INFINITY;
+    if (max_acceleration > 0.0f)
+    {
+        // dt ごとに a·dt ずつ減速して distance で止まれる速度（連続時間の √(2·a·distance) の離散版）
+        float unit = max_acceleration * dt;
+        float stop = unit * (sqrtf(0.25f + 2.0f * distance / (unit * dt)) - 0.5f);
+        if (stop < desired)
+        {
+            desired = stop;
+        }
+    }
+    if (error < 0.0f)
+    {
+        desired = -desired;
+    }
+
+    if (max_acceleration > 0.0f)
+    {
+        float step = max_acceleration * dt;
+        float change = desired - servo->velocity;
+        if (change > step)
+        {
+            change = step;
+        }
+        else if (change < -step)
+        {
+            change = -step;
+        }
+        servo->velocity += change;
+    }
+    else
+    {
+        servo->velocity = desired;
+    }
+
+    // この周期で目標に届くなら目標で止める
+    float move = servo->velocity * dt;
+    if ((error >= 0.0f && move >= error) || (error <= 0.0f && move <= error))
+    {
+        servo->position = servo->target;
+        servo->velocity = 0.0f;
+    }
+    else
+    {
+        servo->position += move;
+    }
+    return servo->position;
+}
+
+// 現在の角度のパルス幅 [us]
+static inline uint16_t ServoMotion_pulse(const ServoMotion *servo)
+{
+    float pulse = servo->pulse_base + servo->pulse_slope * servo->position;
+    if (pulse < servo->pulse_low)
+    {
+        pulse = servo->pulse_low;
+    }
+    else if (pulse > servo->pulse_high)
+    {
+        pulse = servo->pulse_high;
+    }
+    return (uint16_t)(pulse + 0.5f);
+}
+
+static inline int ServoMotion_isSettled(const ServoMotion *servo)
+{
+    return servo->position == servo->target && servo->velocity == 0.0f;
+}
+
+#endif /* SERVO_MOTION_H_ */
@@ -0,0 +1,58 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+// レートの違うタスク間でデータを受け渡すロックなしのスナップショット（ヘッダのみ、動的確保なし）
+//   - 書き込み側は 1 つのタスク（または割り込み）だけ。読み出し側はいくつでもよい
+//   - バッファを 2 面持ち、書き込みは公開中でない面に書いてから番号を進めて切り替える
+//   - 読み出しはコピー中に番号が進んだらやり直す
+// 書き込み側は待たされず、高優先度の読み出し側が低優先度の書き込みに割り込んでも、
+// 書きかけでない方の面を読むのでやり直しにならない
+// CubeIDE / mbed で同一内容
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct
+{
+    volatile uint32_t seq;  // 書き込み回数（偶数回目は 0 面、奇数回目は 1 面が公開中）
+    uint8_t *buffer;        // size * 2 バイト
+    uint32_t size;          // データ 1 つ分のバイト数
+} Snapshot;
+
+static inline void Snapshot_barrier(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+// buffer には size * 2 バイトの領域を渡す（0 で初期化され、書き込み前の読み出しは 0 になる）
+static inline void Snapshot_Init(Snapshot *snapshot, void *buffer, uint32_t size)
+{
+    snapshot->seq = 0;
+    snapshot->buffer = (uint8_t *)buffer;
+    snapshot->size = size;
+    memset(buffer, 0, size * 2);
+}
+
+static inline void Snapshot_write(Snapshot *snapshot, const void *data)
+{
+    uint32_t next = snapshot->seq + 1;
+    memcpy(snapshot->buffer + (next & 1) * snapshot->size, data, snapshot->size);
+    Snapshot_barrier();
+    snapshot->seq = next;
+}
+
+// 最新のデータを data にコピーし、その書き込み回数を返す（0 はまだ書かれていない）
+static inline uint32_t Snapshot_read(const Snapshot *snapshot, void *data)
+{
+    uint32_t seq;
+    do
+    {
+        seq = snapshot->seq;
+        Snapshot_barrier();
+        memcpy(data, snapshot->buffer + (seq & 1) * snapshot->size, snapshot->size);
+        Snapshot_barrier();
+    } while (snapshot->seq != seq);
+    return seq;
+}
+
+#endif /* SNAPSHOT_H_ */